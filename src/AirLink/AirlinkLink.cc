@@ -131,21 +131,25 @@ bool AirlinkLink::_connect()
         }
     });
     MAVLinkProtocol *mavlink = qgcApp()->toolbox()->mavlinkProtocol();
-    auto conn = std::make_shared<QMetaObject::Connection>();
-    *conn = connect(mavlink, &MAVLinkProtocol::messageReceived, [this, conn] (LinkInterface* linkSrc, mavlink_message_t message) {
-        if (this != linkSrc || message.msgid != MAVLINK_MSG_ID_AIRLINK_AUTH_RESPONSE) {
+    auto subscriptionId = std::make_shared<int>(-1);
+    *subscriptionId = mavlink->subscribe(this, { { MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, MAVLINK_MSG_ID_AIRLINK_AUTH_RESPONSE } },
+                                         [this, mavlink, subscriptionId] (const MAVLinkProtocol::MessageBatch& messages) {
+        for (const MAVLinkProtocol::ReceivedMessageRef& received : messages) {
+            if (this != received.link) {
+                continue;
+            }
+            mavlink_airlink_auth_response_t responseMsg;
+            mavlink_msg_airlink_auth_response_decode(received.message, &responseMsg);
+            int answer = responseMsg.resp_type;
+            if (answer != AIRLINK_AUTH_RESPONSE_TYPE::AIRLINK_AUTH_OK) {
+                qDebug() << "Airlink auth failed";
+                continue;
+            }
+            qDebug() << "Connected successfully";
+            mavlink->unsubscribe(*subscriptionId);
+            _setConnectFlag(false);
             return;
         }
-        mavlink_airlink_auth_response_t responseMsg;
-        mavlink_msg_airlink_auth_response_decode(&message, &responseMsg);
-        int answer = responseMsg.resp_type;
-        if (answer != AIRLINK_AUTH_RESPONSE_TYPE::AIRLINK_AUTH_OK) {
-            qDebug() << "Airlink auth failed";
-            return;
-        }
-        qDebug() << "Connected successfully";
-        QObject::disconnect(*conn);
-        _setConnectFlag(false);
     });
     _setConnectFlag(true);
     pendingTimer->start(0);
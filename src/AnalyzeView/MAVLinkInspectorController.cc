@@ -29,7 +29,11 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkInspectorController::_vehicleRemoved);
     connect(multiVehicleManager, &MultiVehicleManager::activeVehicleChanged, this, &MAVLinkInspectorController::_setActiveVehicle);
     MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
-    connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
+    (void) mavlinkProtocol->subscribe(this, { MAVLinkProtocol::MessageFilter() }, [this](const MAVLinkProtocol::MessageBatch& messages) {
+        for (const MAVLinkProtocol::ReceivedMessageRef& received : messages) {
+            _receiveMessage(received.link, *received.message);
+        }
+    });
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
     _timeScaleSt.append(new TimeScale_st(this, tr("5 Sec"),   5 * 1000));
@@ -103,7 +103,7 @@ void APMSensorsComponentController::_startLogCalibration(void)
     }
     _cancelButton->setEnabled(_calTypeInProgress == QGCMAVLink::CalibrationMag);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _subscribeCalibrationMessages();
 }
 
 void APMSensorsComponentController::_startVisualCalibration(void)
@@ -116,7 +116,7 @@ void APMSensorsComponentController::_startVisualCalibration(void)
     
     _progressBar->setProperty("value", 0);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _subscribeCalibrationMessages();
 }
 
 void APMSensorsComponentController::_resetInternalState(void)
@@ -147,7 +147,10 @@ void APMSensorsComponentController::_resetInternalState(void)
 
 void APMSensorsComponentController::_stopCalibration(APMSensorsComponentController::StopCalibrationCode code)
 {
-    disconnect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    if (_calibrationSubscriptionId != -1) {
+        qgcApp()->toolbox()->mavlinkProtocol()->unsubscribe(_calibrationSubscriptionId);
+        _calibrationSubscriptionId = -1;
+    }
     _vehicle->vehicleLinkManager()->setCommunicationLostEnabled(true);
 
     disconnect(_vehicle, &Vehicle::textMessageReceived, this, &APMSensorsComponentController::_handleUASTextMessage);
@@ -681,6 +684,28 @@ void APMSensorsComponentController::_handleCommandLong(mavlink_message_t& messag
     }
 }
 
+/// Only the messages calibration handles are delivered while it runs
+void APMSensorsComponentController::_subscribeCalibrationMessages(void)
+{
+    if (_calibrationSubscriptionId != -1) {
+        return;
+    }
+
+    const int vehicleId = _vehicle->id();
+    static constexpr int anyId = MAVLinkProtocol::anyId;
+    _calibrationSubscriptionId = qgcApp()->toolbox()->mavlinkProtocol()->subscribe(this, {
+                                                                                       { vehicleId, anyId, MAVLINK_MSG_ID_COMMAND_ACK },
+                                                                                       { vehicleId, anyId, MAVLINK_MSG_ID_MAG_CAL_PROGRESS },
+                                                                                       { vehicleId, anyId, MAVLINK_MSG_ID_MAG_CAL_REPORT },
+                                                                                       { vehicleId, anyId, MAVLINK_MSG_ID_COMMAND_LONG }
+                                                                                   },
+                                                                                   [this](const MAVLinkProtocol::MessageBatch& messages) {
+        for (const MAVLinkProtocol::ReceivedMessageRef& received : messages) {
+            _mavlinkMessageReceived(received.link, *received.message);
+        }
+    });
+}
+
 void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
 {
     Q_UNUSED(link);
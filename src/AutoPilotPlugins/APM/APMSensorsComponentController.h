@@ -125,6 +125,7 @@ signals:
 private slots:
     void _handleUASTextMessage  (int uasId, int compId, int severity, QString text);
     void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
+    void _subscribeCalibrationMessages(void);
     void _mavCommandResult      (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
 
 private:
@@ -199,6 +200,7 @@ private:
 
     bool _restoreCompassCalFitness;
     float _previousCompassCalFitness;
+    int _calibrationSubscriptionId = -1;
     static constexpr const char* _compassCalFitnessParam = "COMPASS_CAL_FIT";
     
     static const int _supportedFirmwareCalVersion = 2;
@@ -11,7 +11,7 @@
 #include "LinkManager.h"
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
-#include "MAVLinkSigning.h"
+#include "MAVLinkProtocol.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
@@ -58,7 +58,7 @@ bool LinkInterface::initMavlinkSigning(void)
     if (!isSecureConnection()) {
         auto appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
         QByteArray signingKeyBytes = appSettings->mavlink2SigningKey()->rawValue().toByteArray();
-        if (MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(_mavlinkChannel), signingKeyBytes, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback)) {
+        if (qgcApp()->toolbox()->mavlinkProtocol()->initSigning(_mavlinkChannel, signingKeyBytes)) {
             if (signingKeyBytes.isEmpty()) {
                 qCDebug(LinkInterfaceLog) << "Signing disabled on channel" << _mavlinkChannel;
             } else {
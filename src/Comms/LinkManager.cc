@@ -162,14 +162,14 @@ bool LinkManager::createConnectedLink(SharedLinkConfigurationPtr &config)
     config->setLink(link);
 
     (void) connect(link.get(), &LinkInterface::communicationError, _app, &QGCApplication::criticalMessageBoxOnMainThread);
-    (void) connect(link.get(), &LinkInterface::bytesReceived, _mavlinkProtocol, &MAVLinkProtocol::receiveBytes);
-    (void) connect(link.get(), &LinkInterface::bytesSent, _mavlinkProtocol, &MAVLinkProtocol::logSentBytes);
     (void) connect(link.get(), &LinkInterface::disconnected, this, &LinkManager::_linkDisconnected);
 
+    _mavlinkProtocol->connectLink(link);
     _mavlinkProtocol->resetMetadataForLink(link.get());
     _mavlinkProtocol->setVersion(_mavlinkProtocol->getCurrentVersion());
 
     if (!link->_connect()) {
+        _mavlinkProtocol->disconnectLink(link.get());
         link->_freeMavlinkChannel();
         _rgLinks.removeAt(_rgLinks.indexOf(link));
         config->setLink(nullptr);
@@ -220,8 +220,7 @@ void LinkManager::_linkDisconnected()
     }
 
     (void) disconnect(link, &LinkInterface::communicationError, _app, &QGCApplication::criticalMessageBoxOnMainThread);
-    (void) disconnect(link, &LinkInterface::bytesReceived, _mavlinkProtocol, &MAVLinkProtocol::receiveBytes);
-    (void) disconnect(link, &LinkInterface::bytesSent, _mavlinkProtocol, &MAVLinkProtocol::logSentBytes);
+    _mavlinkProtocol->disconnectLink(link);
     (void) disconnect(link, &LinkInterface::disconnected, this, &LinkManager::_linkDisconnected);
 
     link->_freeMavlinkChannel();
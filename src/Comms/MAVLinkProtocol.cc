@@ -8,10 +8,13 @@
  ****************************************************************************/
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkFrameParser.h"
+#include "MAVLinkSigning.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
+#include "TelemetryLogWriter.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QSettings>
@@ -19,6 +22,10 @@
 #include <QtCore/QMetaType>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+
+#include <algorithm>
+#include <chrono>
 
 #include <QtQml/QtQml>
 
@@ -31,6 +38,283 @@ static QObject* mavlinkSingletonFactory(QQmlEngine*, QJSEngine*)
     return new QGCMAVLink();
 }
 
+MAVLinkProtocolWorker::MAVLinkProtocolWorker(TelemetryLogWriter* logWriter, QObject* parent)
+    : QObject(parent)
+    , _message({})
+    , _logWriter(logWriter)
+{
+    memset(_totalReceiveCounter, 0, sizeof(_totalReceiveCounter));
+    memset(_totalLossCounter,    0, sizeof(_totalLossCounter));
+    memset(_runningLossPercent,  0, sizeof(_runningLossPercent));
+    memset(_firstMessage,        1, sizeof(_firstMessage));
+    memset(_lastIndex,           0, sizeof(_lastIndex));
+    for (unsigned& version : _channelOutboundVersion) {
+        version = _outboundVersion;
+    }
+}
+
+MAVLinkProtocolWorker::~MAVLinkProtocolWorker()
+{
+
+}
+
+qint64 MAVLinkProtocolWorker::timestampUsecs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 MAVLinkProtocolWorker::takeReceivedMessages(QList<ReceivedMessage>& messages)
+{
+    messages.clear();
+
+    QMutexLocker locker(&_queueMutex);
+    messages.swap(_queuedMessages);
+    _queueDepth.storeRelaxed(0);
+
+    return messages.isEmpty() ? 0 : (timestampUsecs() - _queuedTimestampUsecs);
+}
+
+void MAVLinkProtocolWorker::setForwardingLinks(SharedLinkInterfacePtr& forwardingLink, SharedLinkInterfacePtr& forwardingSupportLink)
+{
+    // Swap so the previous links are released by the caller on the main thread
+    QMutexLocker locker(&_forwardingMutex);
+    _forwardingLink.swap(forwardingLink);
+    _forwardingSupportLink.swap(forwardingSupportLink);
+}
+
+void MAVLinkProtocolWorker::addLink(const LinkInterface* key, const WeakLinkInterfacePtr& link, uint8_t mavlinkChannel)
+{
+    // Never lock the link here, the last reference could then be dropped on the worker thread
+    LinkEntry entry;
+    entry.link = link;
+    entry.mavlinkChannel = mavlinkChannel;
+    _links[key] = entry;
+
+    _channelOutboundVersion[mavlinkChannel] = _outboundVersion;
+    QGCMAVLink::resetChannelReceiveStatus(mavlinkChannel);
+}
+
+void MAVLinkProtocolWorker::removeLink(const LinkInterface* link)
+{
+    (void) _links.remove(link);
+}
+
+void MAVLinkProtocolWorker::resetMetadataForChannel(uint8_t mavlinkChannel)
+{
+    _totalReceiveCounter[mavlinkChannel] = 0;
+    _totalLossCounter[mavlinkChannel]    = 0;
+    _runningLossPercent[mavlinkChannel]  = 0.0f;
+    for(int i = 0; i < 256; i++) {
+        _firstMessage[mavlinkChannel][i] =  1;
+    }
+
+    for (LinkEntry& entry : _links) {
+        if (entry.mavlinkChannel == mavlinkChannel) {
+            entry.decodedFirstMessage = false;
+        }
+    }
+}
+
+void MAVLinkProtocolWorker::setOutboundVersion(unsigned version)
+{
+    _outboundVersion = version;
+    for (const LinkEntry& entry : std::as_const(_links)) {
+        _channelOutboundVersion[entry.mavlinkChannel] = version;
+    }
+}
+
+void MAVLinkProtocolWorker::setChannelOutboundVersion(uint8_t mavlinkChannel, unsigned version)
+{
+    _channelOutboundVersion[mavlinkChannel] = version;
+}
+
+void MAVLinkProtocolWorker::initReceiveSigning(uint8_t mavlinkChannel, const QByteArray& key)
+{
+    if (!MAVLinkSigning::initReceiveSigning(static_cast<mavlink_channel_t>(mavlinkChannel), key, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback)) {
+        qCWarning(MAVLinkProtocolLog) << "Failed To enable Signing checks on channel" << mavlinkChannel;
+    }
+}
+
+void MAVLinkProtocolWorker::_firstMessageDecoded(const LinkEntry& entry, const mavlink_message_t& message)
+{
+    if ((message.magic != MAVLINK_STX_MAVLINK1) && (_channelOutboundVersion[entry.mavlinkChannel] < 200)) {
+        qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << entry.mavlinkChannel;
+        // Set all links to v2, the main thread changes the channel flags it packs with
+        setOutboundVersion(200);
+        emit outboundVersionChanged(200);
+    }
+}
+
+/**
+ * This method parses all incoming bytes and constructs a MAVLink packet.
+ * It can handle multiple links in parallel, as each link has it's own buffer/
+ * parsing state machine.
+ * @param link The interface to read from
+ * @see LinkInterface
+ **/
+void MAVLinkProtocolWorker::receiveBytes(LinkInterface* link, const QByteArray& bytes)
+{
+    // Since receiveBytes signals cross threads we can end up with signals in the queue
+    // that come through after the link is disconnected. For these we just drop the data
+    // since the link is closed.
+    const auto it = _links.find(link);
+    if (it == _links.end()) {
+        qCDebug(MAVLinkProtocolLog) << "receiveBytes: link gone!" << bytes.size() << " bytes arrived too late";
+        return;
+    }
+
+    LinkEntry& entry = it.value();
+    const uint8_t mavlinkChannel = entry.mavlinkChannel;
+
+    qsizetype position = 0;
+    while (position < bytes.size()) {
+        if (MAVLinkFrameParser::parseNext(mavlinkChannel, bytes, position, _message)) {
+            if (!entry.decodedFirstMessage) {
+                entry.decodedFirstMessage = true;
+                _firstMessageDecoded(entry, _message);
+            }
+            _updateLossStatistics(mavlinkChannel, _message);
+            _forwardMessage(_message);
+            _logMessage(_message);
+            _decodedMessages.append({ entry.link, _message });
+        }
+    }
+
+    if (_decodedMessages.isEmpty()) {
+        return;
+    }
+
+    bool queueWasEmpty;
+    {
+        QMutexLocker locker(&_queueMutex);
+        queueWasEmpty = _queuedMessages.isEmpty();
+        if (queueWasEmpty) {
+            _queuedMessages.swap(_decodedMessages);
+            _queuedTimestampUsecs = timestampUsecs();
+        } else {
+            _queuedMessages.append(_decodedMessages);
+        }
+        _queueDepth.storeRelaxed(_queuedMessages.count());
+    }
+    _decodedMessages.clear();
+
+    if (queueWasEmpty) {
+        // A single notification per batch, the main thread picks up everything queued until it runs
+        emit messagesQueued();
+    }
+}
+
+void MAVLinkProtocolWorker::_updateLossStatistics(uint8_t mavlinkChannel, const mavlink_message_t& message)
+{
+    uint8_t lastSeq = _lastIndex[message.sysid][message.compid];
+    uint8_t expectedSeq = lastSeq + 1;
+    // Increase receive counter
+    _totalReceiveCounter[mavlinkChannel]++;
+    // Determine what the next expected sequence number is, accounting for
+    // never having seen a message for this system/component pair.
+    if(_firstMessage[message.sysid][message.compid]) {
+        _firstMessage[message.sysid][message.compid] = 0;
+        lastSeq     = message.seq;
+        expectedSeq = message.seq;
+    }
+    // And if we didn't encounter that sequence number, record the error
+    if (message.seq != expectedSeq)
+    {
+        int lostMessages = 0;
+        //-- Account for overflow during packet loss
+        if(message.seq < expectedSeq) {
+            lostMessages = (message.seq + 255) - expectedSeq;
+        } else {
+            lostMessages = message.seq - expectedSeq;
+        }
+        // Log how many were lost
+        _totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
+    }
+
+    // And update the last sequence number for this system/component pair
+    _lastIndex[message.sysid][message.compid] = message.seq;
+    // Calculate new loss ratio
+    const uint64_t totalSent = _totalReceiveCounter[mavlinkChannel] + _totalLossCounter[mavlinkChannel];
+    float receiveLossPercent = static_cast<float>(static_cast<double>(_totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
+    receiveLossPercent *= 100.0f;
+    receiveLossPercent = (receiveLossPercent * 0.5f) + (_runningLossPercent[mavlinkChannel] * 0.5f);
+    _runningLossPercent[mavlinkChannel] = receiveLossPercent;
+
+    // Update MAVLink status on every 32th packet
+    if ((_totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
+        emit mavlinkMessageStatus(message.sysid, totalSent, _totalReceiveCounter[mavlinkChannel], _totalLossCounter[mavlinkChannel], receiveLossPercent);
+    }
+}
+
+void MAVLinkProtocolWorker::_forwardMessage(const mavlink_message_t& message)
+{
+    if (message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
+        return;
+    }
+
+    // The links are only written to while holding the mutex so the worker never ends up owning them
+    QMutexLocker locker(&_forwardingMutex);
+    if (!_forwardingLink && !_forwardingSupportLink) {
+        return;
+    }
+
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    const int len = mavlink_msg_to_send_buffer(buf, &message);
+    if (_forwardingLink) {
+        _forwardingLink->writeBytesThreadSafe((const char*)buf, len);
+    }
+    if (_forwardingSupportLink) {
+        _forwardingSupportLink->writeBytesThreadSafe((const char*)buf, len);
+    }
+}
+
+/// Timestamp for telemetry log records.
+/// This timestamp is saved in UTC time. We are only saving in ms precision because
+/// getting more than this isn't possible with Qt without a ton of extra code.
+quint64 MAVLinkProtocolWorker::_logTimestampUsecs(void)
+{
+    return static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+}
+
+void MAVLinkProtocolWorker::_logMessage(const mavlink_message_t& message)
+{
+    if (!_logWriter->isLogging()) {
+        return;
+    }
+
+    // Serialize on the stack, the writer copies the record into its ring buffer
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    const int len = mavlink_msg_to_send_buffer(buf, &message);
+    (void) _logWriter->writeRecord(_logTimestampUsecs(), reinterpret_cast<const char*>(buf), len);
+
+    // Check for the vehicle arming going by. This is used to trigger log save.
+    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        mavlink_heartbeat_t state;
+        mavlink_msg_heartbeat_decode(&message, &state);
+        if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+            _logWriter->setVehicleWasArmed();
+        }
+    }
+}
+
+/**
+ * This method logs all outgoing bytes to the telemetry log.
+ * @param link The interface the bytes were written to
+ * @see LinkInterface
+ **/
+void MAVLinkProtocolWorker::logSentBytes(LinkInterface* link, const QByteArray& bytes)
+{
+    Q_UNUSED(link);
+
+    if (!_logWriter->isLogging()) {
+        return;
+    }
+
+    (void) _logWriter->writeRecord(_logTimestampUsecs(), bytes.constData(), bytes.size());
+}
+
+/*===========================================================================*/
+
 /**
  * The default constructor will create a new MAVLink object sending heartbeats at
  * the MAVLINK_HEARTBEAT_DEFAULT_RATE to all connected links.
@@ -38,31 +322,59 @@ static QObject* mavlinkSingletonFactory(QQmlEngine*, QJSEngine*)
 MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _enable_version_check(true)
-    , _message({})
-    , _status({})
     , versionMismatchIgnore(false)
     , systemId(255)
     , _current_version(100)
     , _radio_version_mismatch_count(0)
-    , _logSuspendError(false)
-    , _logSuspendReplay(false)
-    , _vehicleWasArmed(false)
-    , _tempLogFile(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension))
+    , _logWriter(new TelemetryLogWriter(QString("%2.%3").arg(_tempLogFileTemplate).arg(_logFileExtension)))
+    , _logWriterThread(new QThread(this))
+    , _worker(new MAVLinkProtocolWorker(_logWriter))
+    , _workerThread(new QThread(this))
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
 {
-    memset(totalReceiveCounter, 0, sizeof(totalReceiveCounter));
-    memset(totalLossCounter,    0, sizeof(totalLossCounter));
-    memset(runningLossPercent,  0, sizeof(runningLossPercent));
-    memset(firstMessage,        1, sizeof(firstMessage));
-    memset(&_status,            0, sizeof(_status));
-    memset(&_message,           0, sizeof(_message));
+    _logWriter->moveToThread(_logWriterThread);
+
+    (void) connect(_logWriterThread, &QThread::finished, _logWriter, &QObject::deleteLater);
+
+    (void) connect(_logWriter, &TelemetryLogWriter::loggingStarted, this, &MAVLinkProtocol::checkTelemetrySavePath);
+    (void) connect(_logWriter, &TelemetryLogWriter::loggingFailed, this, &MAVLinkProtocol::_loggingFailed);
+    (void) connect(_logWriter, &TelemetryLogWriter::loggingStopped, this, &MAVLinkProtocol::_loggingStopped);
+
+    _logWriterThread->setObjectName("TelemetryLogWriter");
+    _logWriterThread->start(QThread::LowPriority);
+
+    _worker->moveToThread(_workerThread);
+
+    (void) connect(_workerThread, &QThread::finished, _worker, &QObject::deleteLater);
+
+    (void) connect(_worker, &MAVLinkProtocolWorker::messagesQueued, this, &MAVLinkProtocol::_deliverReceivedMessages);
+    (void) connect(_worker, &MAVLinkProtocolWorker::mavlinkMessageStatus, this, &MAVLinkProtocol::mavlinkMessageStatus);
+    (void) connect(_worker, &MAVLinkProtocolWorker::outboundVersionChanged, this, &MAVLinkProtocol::_outboundVersionChanged);
+
+    _workerThread->setObjectName("MAVLinkProtocol");
+    _workerThread->start();
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
     storeSettings();
-    _closeLogFile();
+
+    // Stop the producer first, the log writer then drains and closes the log file when it is destroyed at thread exit
+    _workerThread->quit();
+    _workerThread->wait();
+    _logWriterThread->quit();
+    _logWriterThread->wait();
+}
+
+void MAVLinkProtocol::_setChannelFlags(uint8_t mavlinkChannel, unsigned version)
+{
+    mavlink_status_t* const mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+    if (version < 200) {
+        mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    } else {
+        mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
 }
 
 void MAVLinkProtocol::setVersion(unsigned version)
@@ -70,19 +382,49 @@ void MAVLinkProtocol::setVersion(unsigned version)
     QList<SharedLinkInterfacePtr> sharedLinks = _linkMgr->links();
 
     for (int i = 0; i < sharedLinks.length(); i++) {
-        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(sharedLinks[i].get()->mavlinkChannel());
-
-        // Set flags for version
-        if (version < 200) {
-            mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-        } else {
-            mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-        }
+        _setChannelFlags(sharedLinks[i].get()->mavlinkChannel(), version);
     }
 
+    // The worker only keeps track of the version to detect the switch to mavlink 2.0
+    (void) QMetaObject::invokeMethod(_worker, [this, version]() {
+        _worker->setOutboundVersion(version);
+    }, Qt::QueuedConnection);
+
     _current_version = version;
 }
 
+void MAVLinkProtocol::setChannelVersion(uint8_t mavlinkChannel, unsigned version)
+{
+    _setChannelFlags(mavlinkChannel, version);
+
+    (void) QMetaObject::invokeMethod(_worker, [this, mavlinkChannel, version]() {
+        _worker->setChannelOutboundVersion(mavlinkChannel, version);
+    }, Qt::QueuedConnection);
+}
+
+bool MAVLinkProtocol::initSigning(uint8_t mavlinkChannel, const QByteArray& key)
+{
+    // Outgoing and incoming signing use separate copies of the signing state, so the signing timestamp
+    // of the messages packed here is never updated from the worker thread
+    if (!MAVLinkSigning::initSigning(static_cast<mavlink_channel_t>(mavlinkChannel), key, MAVLinkSigning::insecureConnectionAccceptUnsignedCallback)) {
+        return false;
+    }
+
+    (void) QMetaObject::invokeMethod(_worker, [this, mavlinkChannel, key]() {
+        _worker->initReceiveSigning(mavlinkChannel, key);
+    }, Qt::QueuedConnection);
+
+    return true;
+}
+
+/// The worker received a mavlink 2.0 packet on a link which still sends mavlink 1.0
+void MAVLinkProtocol::_outboundVersionChanged(unsigned version)
+{
+    if (version != _current_version) {
+        setVersion(version);
+    }
+}
+
 void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
 {
    QGCTool::setToolbox(toolbox);
@@ -105,6 +447,9 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
+   connect(_app->toolbox()->settingsManager()->appSettings()->forwardMavlink(), &Fact::rawValueChanged, this, &MAVLinkProtocol::_updateForwardingLinks);
+   connect(_linkMgr, &LinkManager::mavlinkSupportForwardingEnabledChanged, this, &MAVLinkProtocol::_updateForwardingLinks);
+
    emit versionCheckChanged(_enable_version_check);
 }
 
@@ -135,254 +480,262 @@ void MAVLinkProtocol::storeSettings()
 
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
-    int channel = link->mavlinkChannel();
-    totalReceiveCounter[channel] = 0;
-    totalLossCounter[channel]    = 0;
-    runningLossPercent[channel]  = 0.0f;
-    for(int i = 0; i < 256; i++) {
-        firstMessage[channel][i] =  1;
-    }
+    const uint8_t channel = link->mavlinkChannel();
+    (void) QMetaObject::invokeMethod(_worker, [this, channel]() {
+        _worker->resetMetadataForChannel(channel);
+    }, Qt::QueuedConnection);
     link->setDecodedFirstMavlinkPacket(false);
 }
 
-/**
- * This method parses all outcoming bytes and log a MAVLink packet.
- * @param link The interface to read from
- * @see LinkInterface
- **/
+void MAVLinkProtocol::connectLink(const SharedLinkInterfacePtr& link)
+{
+    const LinkInterface* const key = link.get();
+    const WeakLinkInterfacePtr weakLink = link;
+    const uint8_t channel = link->mavlinkChannel();
+    (void) QMetaObject::invokeMethod(_worker, [this, key, weakLink, channel]() {
+        _worker->addLink(key, weakLink, channel);
+    }, Qt::QueuedConnection);
 
-void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
+    (void) connect(link.get(), &LinkInterface::bytesReceived, _worker, &MAVLinkProtocolWorker::receiveBytes);
+    (void) connect(link.get(), &LinkInterface::bytesSent, _worker, &MAVLinkProtocolWorker::logSentBytes);
 
-    uint8_t bytes_time[sizeof(quint64)];
+    _setForwardingLinks(nullptr);
+}
 
-    Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
+void MAVLinkProtocol::disconnectLink(LinkInterface* link)
+{
+    (void) disconnect(link, &LinkInterface::bytesReceived, _worker, &MAVLinkProtocolWorker::receiveBytes);
+    (void) disconnect(link, &LinkInterface::bytesSent, _worker, &MAVLinkProtocolWorker::logSentBytes);
 
-        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+    (void) QMetaObject::invokeMethod(_worker, [this, link]() {
+        _worker->removeLink(link);
+    }, Qt::QueuedConnection);
 
-        qToBigEndian(time,bytes_time);
+    _setForwardingLinks(link);
+}
+
+void MAVLinkProtocol::_updateForwardingLinks(void)
+{
+    _setForwardingLinks(nullptr);
+}
 
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
+/// Pushes the current forwarding links to the worker
+///     @param removedLink Link which is going away and must no longer be forwarded to
+void MAVLinkProtocol::_setForwardingLinks(const LinkInterface* removedLink)
+{
+    SharedLinkInterfacePtr forwardingLink;
+    if (_app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
+        forwardingLink = _linkMgr->mavlinkForwardingLink();
+    }
 
-        int len = b.length();
+    SharedLinkInterfacePtr forwardingSupportLink;
+    if (_linkMgr->mavlinkSupportForwardingEnabled()) {
+        forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink();
+    }
 
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+    if (forwardingLink.get() == removedLink) {
+        forwardingLink.reset();
+    }
+    if (forwardingSupportLink.get() == removedLink) {
+        forwardingSupportLink.reset();
     }
 
+    // On return the previous links are released here on the main thread
+    _worker->setForwardingLinks(forwardingLink, forwardingSupportLink);
 }
 
-/**
- * This method parses all incoming bytes and constructs a MAVLink packet.
- * It can handle multiple links in parallel, as each link has it's own buffer/
- * parsing state machine.
- * @param link The interface to read from
- * @see LinkInterface
- **/
-
-void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
+void MAVLinkProtocol::_deliverReceivedMessages(void)
 {
-    // Since receiveBytes signals cross threads we can end up with signals in the queue
-    // that come through after the link is disconnected. For these we just drop the data
-    // since the link is closed.
-    SharedLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link);
-    if (!linkPtr) {
-        qCDebug(MAVLinkProtocolLog) << "receiveBytes: link gone!" << b.size() << " bytes arrived too late";
+    if (_deliveringMessages) {
+        // A handler is running a nested event loop. Pick the messages up once the current batch is done.
         return;
     }
+    _deliveringMessages = true;
 
-    uint8_t mavlinkChannel = link->mavlinkChannel();
-
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qCDebug(MAVLinkProtocolLog) << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
+    _messageQueueLatencyUsecs = _worker->takeReceivedMessages(_receivedMessages);
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
+    WeakLinkInterfacePtr currentLink;
+    SharedLinkInterfacePtr linkPtr;
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (_message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
-                forwardingEnabled = false;
+    for (const MAVLinkProtocolWorker::ReceivedMessage& received : _receivedMessages) {
+        if (currentLink.owner_before(received.link) || received.link.owner_before(currentLink)) {
+            currentLink = received.link;
+            linkPtr = currentLink.lock();
+            if (linkPtr && !_linkMgr->containsLink(linkPtr.get())) {
+                linkPtr.reset();
             }
-            if (forwardingEnabled) {
-                SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
+            if (linkPtr && !_batchLinks.contains(linkPtr)) {
+                _batchLinks.append(linkPtr);
             }
+        }
+        if (!linkPtr) {
+            // Link was disconnected after these messages were decoded
+            continue;
+        }
 
-            // MAVLink forwarding support
-            bool forwardingSupportEnabled = _linkMgr->mavlinkSupportForwardingEnabled();
-            if (_message.msgid == MAVLINK_MSG_ID_SETUP_SIGNING) {
-                forwardingSupportEnabled = false;
-            }
-            if (forwardingSupportEnabled) {
-                SharedLinkInterfacePtr forwardingSupportLink = _linkMgr->mavlinkForwardingSupportLink();
-
-                if (forwardingSupportLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingSupportLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+        _handleReceivedMessage(linkPtr.get(), received.message);
+        _routeMessage(linkPtr.get(), received.message);
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+        // Anyone handling the message could close the connection, so we check if it's
+        // expired and drop the remaining messages for it. _batchLinks holds the other reference.
+        if (2 == linkPtr.use_count()) {
+            linkPtr.reset();
+        }
+    }
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
-                _startLogging();
-                mavlink_high_latency_t highLatency;
-                mavlink_msg_high_latency_decode(&_message, &highLatency);
-                // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+    _dispatchSubscriptions();
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
-
-            // Detect if we are talking to an old radio not supporting v2
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
-            }
+    _receivedMessages.clear();
+    _batchLinks.clear();
+    _deliveringMessages = false;
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            }
-#endif
+    if (_worker->queueDepth() > 0) {
+        // Messages were queued while we were busy, the worker only notifies when the queue was empty
+        (void) QMetaObject::invokeMethod(this, &MAVLinkProtocol::_deliverReceivedMessages, Qt::QueuedConnection);
+    }
+}
+
+int MAVLinkProtocol::subscribe(QObject* context, const QList<MessageFilter>& filters, MessageBatchHandler handler)
+{
+    const int subscriptionId = _nextSubscriptionId++;
+
+    Subscription& subscription = _subscriptions[subscriptionId];
+    subscription.filters = filters;
+    subscription.handler = handler;
+    subscription.contextConnection = connect(context, &QObject::destroyed, this, [this, subscriptionId]() {
+        unsubscribe(subscriptionId);
+    });
+
+    for (const MessageFilter& filter : filters) {
+        _subscriptionRoutes[_routeKey(filter.sysid, filter.compid, filter.msgid)].append(subscriptionId);
+        _routePatternCounts[_routePattern(filter)]++;
+    }
+
+    return subscriptionId;
+}
+
+void MAVLinkProtocol::unsubscribe(int subscriptionId)
+{
+    auto it = _subscriptions.find(subscriptionId);
+    if (it == _subscriptions.end()) {
+        return;
+    }
+
+    (void) disconnect(it->contextConnection);
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
+    for (const MessageFilter& filter : it->filters) {
+        const quint64 key = _routeKey(filter.sysid, filter.compid, filter.msgid);
+        auto routeIt = _subscriptionRoutes.find(key);
+        if (routeIt != _subscriptionRoutes.end()) {
+            (void) routeIt->removeOne(subscriptionId);
+            if (routeIt->isEmpty()) {
+                (void) _subscriptionRoutes.erase(routeIt);
             }
+        }
+        _routePatternCounts[_routePattern(filter)]--;
+    }
+
+    (void) _subscriptions.erase(it);
+}
+
+quint64 MAVLinkProtocol::_routeKey(int sysid, int compid, int msgid)
+{
+    // anyId packs to zero in each field
+    return (static_cast<quint64>(sysid + 1) << 34) | (static_cast<quint64>(compid + 1) << 25) | static_cast<quint64>(msgid + 1);
+}
+
+int MAVLinkProtocol::_routePattern(const MessageFilter& filter)
+{
+    return ((filter.sysid != anyId) ? 4 : 0) | ((filter.compid != anyId) ? 2 : 0) | ((filter.msgid != anyId) ? 1 : 0);
+}
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
+/// Adds the message to the pending batch of each matching subscription
+void MAVLinkProtocol::_routeMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    if (_subscriptions.isEmpty()) {
+        return;
+    }
+
+    _batchRoutedMessageCount++;
+
+    for (int pattern = 0; pattern < 8; pattern++) {
+        if (_routePatternCounts[pattern] == 0) {
+            continue;
+        }
 
-            // Anyone handling the message could close the connection, which deletes the link,
-            // so we check if it's expired
-            if (1 == linkPtr.use_count()) {
-                break;
+        const quint64 key = _routeKey((pattern & 4) ? message.sysid : anyId,
+                                      (pattern & 2) ? message.compid : anyId,
+                                      (pattern & 1) ? static_cast<int>(message.msgid) : anyId);
+        const auto routeIt = _subscriptionRoutes.constFind(key);
+        if (routeIt == _subscriptionRoutes.constEnd()) {
+            continue;
+        }
+
+        for (const int subscriptionId : routeIt.value()) {
+            Subscription& subscription = _subscriptions[subscriptionId];
+            if (!subscription.pending.isEmpty() && (subscription.pending.last().message == &message)) {
+                // Already matched through another filter
+                continue;
+            }
+            if (subscription.pending.isEmpty()) {
+                _pendingSubscriptionIds.append(subscriptionId);
             }
+            subscription.pending.append({ link, &message });
+        }
+    }
+}
+
+/// Calls each subscription with pending messages once, in subscription order
+void MAVLinkProtocol::_dispatchSubscriptions(void)
+{
+    if (_batchRoutedMessageCount == 0) {
+        return;
+    }
 
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
+    std::sort(_pendingSubscriptionIds.begin(), _pendingSubscriptionIds.end());
+
+    MessageBatch batch;
+    for (const int subscriptionId : _pendingSubscriptionIds) {
+        // Handlers can add or remove subscriptions, so look each one up again
+        auto it = _subscriptions.find(subscriptionId);
+        if (it == _subscriptions.end()) {
+            continue;
         }
+
+        batch.swap(it->pending);
+        const MessageBatchHandler handler = it->handler;
+        handler(batch);
+        _subscriptionDispatchCount++;
+        _deliveredMessageCount += static_cast<quint64>(batch.count());
+        batch.clear();
+    }
+    _pendingSubscriptionIds.clear();
+
+    _routedMessageCount += _batchRoutedMessageCount;
+    _batchRoutedMessageCount = 0;
+}
+
+void MAVLinkProtocol::_handleReceivedMessage(LinkInterface* link, const mavlink_message_t& message)
+{
+    // The switch to mavlink 2.0 on the first packet is detected by the worker thread
+    link->setDecodedFirstMavlinkPacket(true);
+
+    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        _startLogging();
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+    } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
+        _startLogging();
+        mavlink_high_latency_t highLatency;
+        mavlink_msg_high_latency_decode(&message, &highLatency);
+        // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
+    } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+        _startLogging();
+        mavlink_high_latency2_t highLatency2;
+        mavlink_msg_high_latency2_decode(&message, &highLatency2);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
     }
 }
 
@@ -427,23 +780,6 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
     }
 }
 
-/// @brief Closes the log file if it is open
-bool MAVLinkProtocol::_closeLogFile(void)
-{
-    if (_tempLogFile.isOpen()) {
-        if (_tempLogFile.size() == 0) {
-            // Don't save zero byte files
-            _tempLogFile.remove();
-            return false;
-        } else {
-            _tempLogFile.flush();
-            _tempLogFile.close();
-            return true;
-        }
-    }
-    return false;
-}
-
 void MAVLinkProtocol::_startLogging(void)
 {
     //-- Are we supposed to write logs?
@@ -460,40 +796,28 @@ void MAVLinkProtocol::_startLogging(void)
         return;
     }
 #endif
-    //-- Log is always written to a temp file. If later the user decides they want
-    //   it, it's all there for them.
-    if (!_tempLogFile.isOpen()) {
-        if (!_logSuspendReplay) {
-            if (!_tempLogFile.open()) {
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Opening Flight Data file for writing failed. "
-                                                                      "Unable to write to %1. Please choose a different file location.").arg(_tempLogFile.fileName()));
-                _closeLogFile();
-                _logSuspendError = true;
-                return;
-            }
+    (void) QMetaObject::invokeMethod(_logWriter, "startLogging", Qt::QueuedConnection);
+}
 
-            qCDebug(MAVLinkProtocolLog) << "Temp log" << _tempLogFile.fileName();
-            emit checkTelemetrySavePath();
+void MAVLinkProtocol::_stopLogging(void)
+{
+    (void) QMetaObject::invokeMethod(_logWriter, "stopLogging", Qt::QueuedConnection);
+}
 
-            _logSuspendError = false;
-        }
-    }
+void MAVLinkProtocol::_loggingFailed(const QString& message)
+{
+    emit protocolStatusMessage(tr("MAVLink Protocol"), message);
 }
 
-void MAVLinkProtocol::_stopLogging(void)
+void MAVLinkProtocol::_loggingStopped(const QString& tempLogfile, bool vehicleWasArmed)
 {
-    if (_tempLogFile.isOpen()) {
-        if (_closeLogFile()) {
-            if ((_vehicleWasArmed || _app->toolbox()->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool()) &&
-                _app->toolbox()->settingsManager()->appSettings()->telemetrySave()->rawValue().toBool() &&
-                !_app->toolbox()->settingsManager()->appSettings()->disableAllPersistence()->rawValue().toBool()) {
-                emit saveTelemetryLog(_tempLogFile.fileName());
-            } else {
-                QFile::remove(_tempLogFile.fileName());
-            }
-        }
+    if ((vehicleWasArmed || _app->toolbox()->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool()) &&
+        _app->toolbox()->settingsManager()->appSettings()->telemetrySave()->rawValue().toBool() &&
+        !_app->toolbox()->settingsManager()->appSettings()->disableAllPersistence()->rawValue().toBool()) {
+        emit saveTelemetryLog(tempLogfile);
+    } else {
+        QFile::remove(tempLogfile);
     }
-    _vehicleWasArmed = false;
 }
 
 /// @brief Checks the temp directory for log files which may have been left there.
@@ -520,7 +844,21 @@ void MAVLinkProtocol::checkForLostLogFiles(void)
 
 void MAVLinkProtocol::suspendLogForReplay(bool suspend)
 {
-    _logSuspendReplay = suspend;
+    (void) QMetaObject::invokeMethod(_logWriter, [this, suspend]() {
+        _logWriter->suspendLogForReplay(suspend);
+    }, Qt::QueuedConnection);
+}
+
+void MAVLinkProtocol::setTelemetryLogFlushInterval(int msecs)
+{
+    (void) QMetaObject::invokeMethod(_logWriter, [this, msecs]() {
+        _logWriter->setFlushIntervalMSecs(msecs);
+    }, Qt::QueuedConnection);
+}
+
+quint64 MAVLinkProtocol::telemetryLogDroppedRecordCount() const
+{
+    return _logWriter->droppedRecordCount();
 }
 
 void MAVLinkProtocol::deleteTempLogFiles(void)
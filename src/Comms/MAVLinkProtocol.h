@@ -11,19 +11,117 @@
 
 #include "LinkInterface.h"
 #include "QGCMAVLink.h"
-#include "QGCTemporaryFile.h"
 #include "QGCToolbox.h"
 
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QMap>
+
+#include <functional>
 
 class LinkManager;
 class MultiVehicleManager;
 class QGCApplication;
+class TelemetryLogWriter;
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkProtocolLog)
 
+/// Runs the per-message receive path (parsing, loss accounting, forwarding and telemetry logging)
+/// on a dedicated thread. Decoded messages are queued and handed to MAVLinkProtocol on the main
+/// thread in batches. The worker parses with the receive state of the channels
+/// (QGCMAVLink::getChannelReceiveStatus), the state used to pack outgoing messages stays on the main thread.
+class MAVLinkProtocolWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct ReceivedMessage {
+        WeakLinkInterfacePtr    link;
+        mavlink_message_t       message;
+    };
+
+    /// @param logWriter Receives the telemetry log records, the worker is its only producer
+    MAVLinkProtocolWorker(TelemetryLogWriter* logWriter, QObject* parent = nullptr);
+    ~MAVLinkProtocolWorker();
+
+    /// Thread safe: Swaps the queued decoded messages into messages
+    ///     @return Time in usecs the oldest message has been waiting in the queue
+    qint64 takeReceivedMessages(QList<ReceivedMessage>& messages);
+
+    /// Thread safe: Number of decoded messages waiting for the main thread
+    int queueDepth() const { return _queueDepth.loadRelaxed(); }
+
+    /// Thread safe: Sets the links decoded messages are forwarded to. The worker never takes ownership
+    /// of the links so they are always destroyed on the main thread.
+    void setForwardingLinks(SharedLinkInterfacePtr& forwardingLink, SharedLinkInterfacePtr& forwardingSupportLink);
+
+    /// Monotonic time in usecs used for queue latency measurements
+    static qint64 timestampUsecs();
+
+public slots:
+    /// @param key Sender of the link's bytesReceived signal, only used for lookups
+    void addLink(const LinkInterface* key, const WeakLinkInterfacePtr& link, uint8_t mavlinkChannel);
+    void removeLink(const LinkInterface* link);
+    void resetMetadataForChannel(uint8_t mavlinkChannel);
+    /// Tracks the outbound version of all links, which is set on the main thread
+    void setOutboundVersion(unsigned version);
+    /// Tracks the outbound version of a single channel, a later setOutboundVersion overrides it
+    void setChannelOutboundVersion(uint8_t mavlinkChannel, unsigned version);
+    /// Sets up the signature checks of incoming messages for the channel, an empty key turns them off
+    void initReceiveSigning(uint8_t mavlinkChannel, const QByteArray& key);
+    void receiveBytes(LinkInterface* link, const QByteArray& bytes);
+    void logSentBytes(LinkInterface* link, const QByteArray& bytes);
+
+signals:
+    /// Emitted when decoded messages are added to an empty queue
+    void messagesQueued(void);
+    void mavlinkMessageStatus(int uasId, uint64_t totalSent, uint64_t totalReceived, uint64_t totalLoss, float lossPercent);
+    /// Emitted when an incoming mavlink 2.0 packet requires all links to switch to version
+    void outboundVersionChanged(unsigned version);
+
+private:
+    struct LinkEntry {
+        WeakLinkInterfacePtr    link;
+        uint8_t                 mavlinkChannel      = 0;
+        bool                    decodedFirstMessage = false;
+    };
+
+    void _firstMessageDecoded(const LinkEntry& entry, const mavlink_message_t& message);
+    void _updateLossStatistics(uint8_t mavlinkChannel, const mavlink_message_t& message);
+    void _forwardMessage(const mavlink_message_t& message);
+    void _logMessage(const mavlink_message_t& message);
+    static quint64 _logTimestampUsecs(void);
+
+    QHash<const LinkInterface*, LinkEntry> _links;    ///< Keyed by the signal sender, the key is never dereferenced
+    unsigned _outboundVersion = 100;
+    unsigned _channelOutboundVersion[MAVLINK_COMM_NUM_BUFFERS];   ///< Copy of the version the main thread packs with
+
+    uint8_t     _lastIndex[256][256];                               ///< Store the last received sequence ID for each system/componenet pair
+    uint8_t     _firstMessage[256][256];                            ///< First message flag
+    uint64_t    _totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< The total number of successfully received messages
+    uint64_t    _totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];        ///< Total messages lost during transmission.
+    float       _runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];      ///< Loss rate
+
+    mavlink_message_t _message;
+
+    QMutex                  _forwardingMutex;
+    SharedLinkInterfacePtr  _forwardingLink;
+    SharedLinkInterfacePtr  _forwardingSupportLink;
+
+    QList<ReceivedMessage>  _decodedMessages;               ///< Worker thread only, messages decoded from the current buffer
+    mutable QMutex          _queueMutex;
+    QList<ReceivedMessage>  _queuedMessages;                ///< Decoded messages waiting for the main thread
+    qint64                  _queuedTimestampUsecs = 0;      ///< Time the oldest queued message was added
+    QAtomicInt              _queueDepth;
+
+    TelemetryLogWriter*     _logWriter;
+};
+
 /**
  * @brief MAVLink micro air vehicle protocol reference implementation.
  *
@@ -62,22 +160,71 @@ public:
      */
     virtual void resetMetadataForLink(LinkInterface *link);
 
-    /// Suspend/Restart logging during replay.
+    /// Routes the bytes received/sent on the link through the protocol worker thread
+    void connectLink(const SharedLinkInterfacePtr& link);
+    /// Stops routing link traffic, must be called before the link is destroyed
+    void disconnectLink(LinkInterface* link);
+
+    /// Suspend/Restart logging during replay. Thread safe.
     void suspendLogForReplay(bool suspend);
 
-    /// Set protocol version
+    /// Sets how often buffered telemetry log records are written to disk. Thread safe.
+    void setTelemetryLogFlushInterval(int msecs);
+    /// @return Number of telemetry log records dropped because the disk could not keep up. Thread safe.
+    quint64 telemetryLogDroppedRecordCount() const;
+
+    /// Set protocol version of all links
     void setVersion(unsigned version);
+    /// Set protocol version of a single channel
+    void setChannelVersion(uint8_t mavlinkChannel, unsigned version);
+    /// Sets up signing for the channel. Outgoing signing is set up right away, the signature checks of
+    /// incoming messages are set up on the worker thread. An empty key turns signing off.
+    ///     @return false: signing could not be set up
+    bool initSigning(uint8_t mavlinkChannel, const QByteArray& key);
+
+    /// Wildcard for MessageFilter fields
+    static constexpr int anyId = -1;
+
+    /// Selects messages by source system, source component and message id
+    struct MessageFilter {
+        int sysid   = anyId;
+        int compid  = anyId;
+        int msgid   = anyId;
+    };
+
+    struct ReceivedMessageRef {
+        LinkInterface*              link;
+        const mavlink_message_t*    message;
+    };
+    typedef QList<ReceivedMessageRef> MessageBatch;
+    typedef std::function<void(const MessageBatch& messages)> MessageBatchHandler;
+
+    /// Registers handler for the messages which match any of the filters. The handler is called once per delivered
+    /// batch with all matching messages in receive order. The subscription is removed when context is destroyed.
+    ///     @return Id to pass to unsubscribe
+    int subscribe(QObject* context, const QList<MessageFilter>& filters, MessageBatchHandler handler);
+    void unsubscribe(int subscriptionId);
+
+    /// @return Number of active subscriptions
+    int subscriptionCount() const { return _subscriptions.count(); }
+    /// @return Number of messages routed through subscriptions
+    quint64 routedMessageCount() const { return _routedMessageCount; }
+    /// @return Number of batch handler calls made
+    quint64 subscriptionDispatchCount() const { return _subscriptionDispatchCount; }
+    /// @return Number of messages handed to handlers, which is the number of calls a per message signal would make
+    quint64 deliveredMessageCount() const { return _deliveredMessageCount; }
+    /// @return Calls saved by delivering the messages in batches instead of one call per delivered message
+    quint64 savedDispatchCount() const { return _deliveredMessageCount - _subscriptionDispatchCount; }
+
+    /// @return Number of decoded messages waiting to be delivered to the main thread
+    int messageQueueDepth() const { return _worker->queueDepth(); }
+    /// @return Time in usecs the oldest message of the last delivered batch waited in the queue
+    qint64 messageQueueLatencyUsecs() const { return _messageQueueLatencyUsecs; }
 
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
 public slots:
-    /** @brief Receive bytes from a communication interface */
-    void receiveBytes(LinkInterface* link, QByteArray b);
-
-    /** @brief Log bytes sent from a communication interface */
-    void logSentBytes(LinkInterface* link, QByteArray b);
-
     /** @brief Set the system id of this application */
     void setSystemId(int id);
 
@@ -97,14 +244,6 @@ public slots:
 
 protected:
     bool        _enable_version_check;                         ///< Enable checking of version match of MAV and QGC
-    uint8_t     lastIndex[256][256];                            ///< Store the last received sequence ID for each system/componenet pair
-    uint8_t     firstMessage[256][256];                         ///< First message flag
-    uint64_t    totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS];  ///< The total number of successfully received messages
-    uint64_t    totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< Total messages lost during transmission.
-    float       runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];   ///< Loss rate
-
-    mavlink_message_t _message;
-    mavlink_status_t _status;
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -115,8 +254,6 @@ signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /** @brief Message received and directly copied via signal */
-    void messageReceived(LinkInterface* link, mavlink_message_t message);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -148,20 +285,52 @@ signals:
 
 private slots:
     void _vehicleCountChanged(void);
+    void _deliverReceivedMessages(void);
+    void _outboundVersionChanged(unsigned version);
+    void _loggingFailed(const QString& message);
+    void _loggingStopped(const QString& tempLogfile, bool vehicleWasArmed);
+    void _updateForwardingLinks(void);
 
 private:
-    bool _closeLogFile(void);
+    struct Subscription {
+        QList<MessageFilter>    filters;
+        MessageBatchHandler     handler;
+        MessageBatch            pending;            ///< Messages routed to the subscription from the current batch
+        QMetaObject::Connection contextConnection;
+    };
+
+    void _handleReceivedMessage(LinkInterface* link, const mavlink_message_t& message);
+    void _routeMessage(LinkInterface* link, const mavlink_message_t& message);
+    void _dispatchSubscriptions(void);
+    static quint64 _routeKey(int sysid, int compid, int msgid);
+    static int _routePattern(const MessageFilter& filter);
+    void _setForwardingLinks(const LinkInterface* removedLink);
+    static void _setChannelFlags(uint8_t mavlinkChannel, unsigned version);
     void _startLogging(void);
     void _stopLogging(void);
 
-    bool _logSuspendError;      ///< true: Logging suspended due to error
-    bool _logSuspendReplay;     ///< true: Logging suspended due to replay
-    bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
-
-    QGCTemporaryFile    _tempLogFile;            ///< File to log to
     static constexpr const char* _tempLogFileTemplate   = "FlightDataXXXXXX";   ///< Template for temporary log file
     static constexpr const char* _logFileExtension      = "mavlink";            ///< Extension for log files
 
+    TelemetryLogWriter*     _logWriter = nullptr;
+    QThread*                _logWriterThread = nullptr;
+    MAVLinkProtocolWorker*  _worker = nullptr;
+    QThread*                _workerThread = nullptr;
+    QList<MAVLinkProtocolWorker::ReceivedMessage> _receivedMessages;    ///< Batch currently being delivered, reused to avoid allocations
+    qint64                  _messageQueueLatencyUsecs = 0;
+
+    int                         _nextSubscriptionId = 0;
+    QMap<int, Subscription>     _subscriptions;                 ///< Ordered by subscription id, which is the dispatch order
+    QHash<quint64, QList<int>>  _subscriptionRoutes;            ///< Route key to subscription ids
+    int                         _routePatternCounts[8] = {};    ///< Number of filters using each wildcard pattern
+    QList<int>                  _pendingSubscriptionIds;        ///< Subscriptions with messages in the current batch
+    QList<SharedLinkInterfacePtr> _batchLinks;                  ///< Keeps the links of the current batch alive during dispatch
+    int                         _batchRoutedMessageCount = 0;
+    bool                        _deliveringMessages = false;
+    quint64                     _routedMessageCount = 0;
+    quint64                     _subscriptionDispatchCount = 0;
+    quint64                     _deliveredMessageCount = 0;
+
     LinkManager*            _linkMgr;
     MultiVehicleManager*    _multiVehicleManager;
 };
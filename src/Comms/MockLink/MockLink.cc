@@ -11,6 +11,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCApplication.h"
 #include "LinkManager.h"
+#include "MAVLinkProtocol.h"
 #include "QGCLoggingCategory.h"
 
 #include <QtCore/QFile>
@@ -74,6 +75,8 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
     _vehicleType        = mockConfig->vehicleType();
     _sendStatusText     = mockConfig->sendStatusText();
     _failureMode        = mockConfig->failureMode();
+    _paramLossPercent   = mockConfig->paramLossPercent();
+    _paramLatencyMSecs  = mockConfig->paramLatencyMSecs();
     _vehicleSystemId    = mockConfig->incrementVehicleId() ?  _nextVehicleSystemId++ : _nextVehicleSystemId;
     _vehicleLatitude    = _defaultVehicleLatitude + ((_vehicleSystemId - 128) * 0.0001);
     _vehicleLongitude   = _defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001);
@@ -112,8 +115,7 @@ bool MockLink::_connect(void)
     if (!_connected) {
         _connected = true;
         // MockLinks use Mavlink 2.0
-        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel());
-        mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+        qgcApp()->toolbox()->mavlinkProtocol()->setChannelVersion(mavlinkChannel(), 200);
         mavlink_status_t* auxStatus = mavlink_get_channel_status(mavlinkAuxChannel());
         auxStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
         start();
@@ -874,7 +876,7 @@ void MockLink::_paramRequestListWorker(void)
                                           paramType,                                     // MAV_PARAM_TYPE
                                           cParameters,                                   // Total number of parameters
                                           _currentParamRequestListParamIndex);           // Index of this parameter
-        respondWithMavlinkMessage(responseMsg);
+        _respondWithParamValue(responseMsg);
     }
 
     // Move to next param index
@@ -923,7 +925,7 @@ void MockLink::_handleParamSet(const mavlink_message_t& msg)
                                       request.param_type,                                        // Send same type back
                                       _mapParamName2Value[componentId].count(),                  // Total number of parameters
                                       _mapParamName2Value[componentId].keys().indexOf(paramId)); // Index of this parameter
-    respondWithMavlinkMessage(responseMsg);
+    _respondWithParamValue(responseMsg);
 }
 
 void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
@@ -992,7 +994,22 @@ void MockLink::_handleParamRequestRead(const mavlink_message_t& msg)
                                       _mapParamName2MavParamType[componentId][paramId],          // Parameter type
                                       _mapParamName2Value[componentId].count(),                  // Total number of parameters
                                       _mapParamName2Value[componentId].keys().indexOf(paramId)); // Index of this parameter
-    respondWithMavlinkMessage(responseMsg);
+    _respondWithParamValue(responseMsg);
+}
+
+/// Sends a PARAM_VALUE through the simulated parameter loss and latency
+void MockLink::_respondWithParamValue(const mavlink_message_t& msg)
+{
+    if ((_paramLossPercent > 0) && (static_cast<int>(_paramLossGenerator.bounded(100)) < _paramLossPercent)) {
+        qCDebug(MockLinkVerboseLog) << "Simulated loss of param value";
+        return;
+    }
+
+    if (_paramLatencyMSecs > 0) {
+        QTimer::singleShot(_paramLatencyMSecs, this, [this, msg]() { respondWithMavlinkMessage(msg); });
+    } else {
+        respondWithMavlinkMessage(msg);
+    }
 }
 
 void MockLink::emitRemoteControlChannelRawChanged(int channel, uint16_t raw)
@@ -1442,6 +1459,8 @@ MockConfiguration::MockConfiguration(const MockConfiguration* source)
     _sendStatusText     = source->_sendStatusText;
     _incrementVehicleId = source->_incrementVehicleId;
     _failureMode        = source->_failureMode;
+    _paramLossPercent   = source->_paramLossPercent;
+    _paramLatencyMSecs  = source->_paramLatencyMSecs;
 }
 
 void MockConfiguration::copyFrom(const LinkConfiguration *source)
@@ -1459,6 +1478,8 @@ void MockConfiguration::copyFrom(const LinkConfiguration *source)
     _sendStatusText     = usource->_sendStatusText;
     _incrementVehicleId = usource->_incrementVehicleId;
     _failureMode        = usource->_failureMode;
+    _paramLossPercent   = usource->_paramLossPercent;
+    _paramLatencyMSecs  = usource->_paramLatencyMSecs;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1469,6 +1490,8 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_sendStatusTextKey,       _sendStatusText);
     settings.setValue(_incrementVehicleIdKey,   _incrementVehicleId);
     settings.setValue(_failureModeKey,          (int)_failureMode);
+    settings.setValue(_paramLossPercentKey,     _paramLossPercent);
+    settings.setValue(_paramLatencyMSecsKey,    _paramLatencyMSecs);
     settings.sync();
     settings.endGroup();
 }
@@ -1481,6 +1504,8 @@ void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
     _sendStatusText     = settings.value(_sendStatusTextKey, false).toBool();
     _incrementVehicleId = settings.value(_incrementVehicleIdKey, true).toBool();
     _failureMode        = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _paramLossPercent   = settings.value(_paramLossPercentKey, 0).toInt();
+    _paramLatencyMSecs  = settings.value(_paramLatencyMSecsKey, 0).toInt();
     settings.endGroup();
 }
 
@@ -1515,6 +1540,19 @@ MockLink*  MockLink::startPX4MockLink(bool sendStatusText, MockConfiguration::Fa
     return _startMockLinkWorker("PX4 MultiRotor MockLink", MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, sendStatusText, failureMode);
 }
 
+MockLink* MockLink::startPX4LossyParamMockLink(int paramLossPercent, int paramLatencyMSecs)
+{
+    MockConfiguration* mockConfig = new MockConfiguration("PX4 Lossy Param MockLink");
+
+    mockConfig->setFirmwareType(MAV_AUTOPILOT_PX4);
+    mockConfig->setVehicleType(MAV_TYPE_QUADROTOR);
+    mockConfig->setSendStatusText(false);
+    mockConfig->setParamLossPercent(paramLossPercent);
+    mockConfig->setParamLatencyMSecs(paramLatencyMSecs);
+
+    return _startMockLink(mockConfig);
+}
+
 MockLink*  MockLink::startGenericMockLink(bool sendStatusText, MockConfiguration::FailureMode_t failureMode)
 {
     return _startMockLinkWorker("Generic MockLink", MAV_AUTOPILOT_GENERIC, MAV_TYPE_QUADROTOR, sendStatusText, failureMode);
@@ -20,6 +20,7 @@
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QMap>
 #include <QtCore/QMutex>
+#include <QtCore/QRandomGenerator>
 
 Q_DECLARE_LOGGING_CATEGORY(MockLinkLog)
 Q_DECLARE_LOGGING_CATEGORY(MockLinkVerboseLog)
@@ -71,6 +72,14 @@ public:
     FailureMode_t failureMode(void) { return _failureMode; }
     void setFailureMode(FailureMode_t failureMode) { _failureMode = failureMode; }
 
+    /// Simulates a lossy, high latency link for parameter traffic: each PARAM_VALUE sent is dropped with
+    /// paramLossPercent probability and the rest are delayed by paramLatencyMSecs. The drops come from a fixed
+    /// seed, so every run loses the same share of the same sequence of responses.
+    int  paramLossPercent       (void) const                { return _paramLossPercent; }
+    void setParamLossPercent    (int paramLossPercent)      { _paramLossPercent = qBound(0, paramLossPercent, 100); }
+    int  paramLatencyMSecs      (void) const                { return _paramLatencyMSecs; }
+    void setParamLatencyMSecs   (int paramLatencyMSecs)     { _paramLatencyMSecs = qMax(0, paramLatencyMSecs); }
+
     // Overrides from LinkConfiguration
     LinkType    type            (void) const override                                         { return LinkConfiguration::TypeMock; }
     void        copyFrom        (const LinkConfiguration* source) override;
@@ -90,6 +99,8 @@ private:
     MAV_TYPE        _vehicleType        = MAV_TYPE_QUADROTOR;
     bool            _sendStatusText     = false;
     FailureMode_t   _failureMode        = FailNone;
+    int             _paramLossPercent   = 0;
+    int             _paramLatencyMSecs  = 0;
     bool            _incrementVehicleId = true;
     uint16_t        _boardVendorId      = 0;
     uint16_t        _boardProductId     = 0;
@@ -99,6 +110,8 @@ private:
     static constexpr const char* _sendStatusTextKey       = "SendStatusText";
     static constexpr const char* _incrementVehicleIdKey   = "IncrementVehicleId";
     static constexpr const char* _failureModeKey          = "FailureMode";
+    static constexpr const char* _paramLossPercentKey     = "ParamLossPercent";
+    static constexpr const char* _paramLatencyMSecsKey    = "ParamLatencyMSecs";
 };
 
 class MockLink : public LinkInterface
@@ -151,6 +164,9 @@ public:
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
     void resetMissionItemHandler(void) { _missionItemHandler.reset(); }
 
+    /// Simulates latency and loss for mission item transfers, see MockLinkMissionItemHandler::setLinkSimulation
+    void setMissionItemLinkSimulation(int latencyMsecs, int lossPct) { _missionItemHandler.setLinkSimulation(latencyMsecs, lossPct); }
+
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
@@ -164,6 +180,9 @@ public:
     static MockLink* startAPMArduSubMockLink        (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
     static MockLink* startAPMArduRoverMockLink      (bool sendStatusText, MockConfiguration::FailureMode_t failureMode = MockConfiguration::FailNone);
 
+    /// Starts a PX4 MockLink with simulated parameter loss and latency, see MockConfiguration::setParamLossPercent
+    static MockLink* startPX4LossyParamMockLink     (int paramLossPercent, int paramLatencyMSecs);
+
     // Special commands for testing Vehicle::sendMavCommandWithHandler
     static constexpr MAV_CMD MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED            = MAV_CMD_USER_1;
     static constexpr MAV_CMD MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED              = MAV_CMD_USER_2;
@@ -223,6 +242,7 @@ private:
     void _handleParamRequestList        (const mavlink_message_t& msg);
     void _handleParamSet                (const mavlink_message_t& msg);
     void _handleParamRequestRead        (const mavlink_message_t& msg);
+    void _respondWithParamValue         (const mavlink_message_t& msg);
     void _handleFTP                     (const mavlink_message_t& msg);
     void _handleCommandLong             (const mavlink_message_t& msg);
     void _handleInProgressCommandLong   (const mavlink_command_long_t& request);
@@ -304,6 +324,10 @@ private:
     bool _sendStatusText;
     bool _apmSendHomePositionOnEmptyList;
     MockConfiguration::FailureMode_t _failureMode;
+    int _paramLossPercent = 0;
+    int _paramLatencyMSecs = 0;
+    static constexpr quint32 _paramLossSeed = 0x51C0;
+    QRandomGenerator _paramLossGenerator { _paramLossSeed };   ///< Seeded so the simulated loss is the same on every run
 
     int _sendHomePositionDelayCount;
     int _sendGPSPositionDelayCount;
@@ -41,7 +41,7 @@ void MockLinkMissionItemHandler::_startMissionItemResponseTimer(void)
         _missionItemResponseTimer = new QTimer();
         connect(_missionItemResponseTimer, &QTimer::timeout, this, &MockLinkMissionItemHandler::_missionItemResponseTimeout);
     }
-    _missionItemResponseTimer->start(500);
+    _missionItemResponseTimer->start(500 + _simulatedLatencyMsecs);
 }
 
 bool MockLinkMissionItemHandler::handleMessage(const mavlink_message_t& msg)
@@ -52,11 +52,15 @@ bool MockLinkMissionItemHandler::handleMessage(const mavlink_message_t& msg)
         break;
 
     case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
-        _handleMissionRequest(msg);
+        if (!_simulateLoss()) {
+            _handleMissionRequest(msg);
+        }
         break;
 
     case MAVLINK_MSG_ID_MISSION_ITEM_INT:
-        _handleMissionItem(msg);
+        if (!_simulateLoss()) {
+            _handleMissionItem(msg);
+        }
         break;
 
     case MAVLINK_MSG_ID_MISSION_COUNT:
@@ -168,7 +172,7 @@ void MockLinkMissionItemHandler::_handleMissionRequestList(const mavlink_message
             _requestType,
             0
         );
-        _mockLink->respondWithMavlinkMessage(responseMsg);
+        _respond(responseMsg);
     }
 }
 
@@ -241,7 +245,7 @@ void MockLinkMissionItemHandler::_handleMissionRequest(const mavlink_message_t&
                                                    missionItemInt.param1, missionItemInt.param2, missionItemInt.param3, missionItemInt.param4,
                                                    missionItemInt.x, missionItemInt.y, missionItemInt.z,
                                                    _requestType);
-            _mockLink->respondWithMavlinkMessage(responseMsg);
+            _respond(responseMsg);
         }
     }
 }
@@ -321,7 +325,7 @@ void MockLinkMissionItemHandler::_requestNextMissionItem(int sequenceNumber)
                                                       _mavlinkProtocol->getComponentId(),
                                                       sequenceNumber,
                                                       _requestType);
-            _mockLink->respondWithMavlinkMessage(message);
+            _respond(message);
 
             // If response with Mission Item doesn't come before timer fires it's an error
             _startMissionItemResponseTimer();
@@ -346,15 +350,13 @@ void MockLinkMissionItemHandler::_sendAck(MAV_MISSION_RESULT ackType)
         _requestType,
         0
     );
-    _mockLink->respondWithMavlinkMessage(message);
+    _respond(message);
 }
 
 void MockLinkMissionItemHandler::_handleMissionItem(const mavlink_message_t& msg)
 {
     qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionItem write sequence";
     
-    _missionItemResponseTimer->stop();
-    
     MAV_MISSION_TYPE            missionType;
     uint16_t                    seq;
     mavlink_mission_item_int_t  missionItemInt;
@@ -362,6 +364,14 @@ void MockLinkMissionItemHandler::_handleMissionItem(const mavlink_message_t& msg
     mavlink_msg_mission_item_int_decode(&msg, &missionItemInt);
     missionType = static_cast<MAV_MISSION_TYPE>(missionItemInt.mission_type);
     seq = missionItemInt.seq;
+
+    if (_simulatedLossPct > 0 && seq != _writeSequenceIndex) {
+        // Late duplicate of an item which was re-requested, the re-request timer keeps running
+        qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionItem ignoring duplicate item seq:_writeSequenceIndex" << seq << _writeSequenceIndex;
+        return;
+    }
+
+    _missionItemResponseTimer->stop();
     
     switch (missionType) {
     case MAV_MISSION_TYPE_MISSION:
@@ -401,10 +411,43 @@ void MockLinkMissionItemHandler::_handleMissionItem(const mavlink_message_t& msg
 
 void MockLinkMissionItemHandler::_missionItemResponseTimeout(void)
 {
+    if (_simulatedLossPct > 0) {
+        qCDebug(MockLinkMissionItemHandlerLog) << "_missionItemResponseTimeout re-requesting lost item" << _writeSequenceIndex;
+        _requestNextMissionItem(_writeSequenceIndex);
+        return;
+    }
+
     qWarning() << "Timeout waiting for next MISSION_ITEM_INT";
     Q_ASSERT(false);
 }
 
+void MockLinkMissionItemHandler::_respond(const mavlink_message_t& msg)
+{
+    if (_simulatedLatencyMsecs > 0) {
+        // Equal intervals keep the responses in order
+        QTimer::singleShot(_simulatedLatencyMsecs, _mockLink, [this, msg]() { _mockLink->respondWithMavlinkMessage(msg); });
+    } else {
+        _mockLink->respondWithMavlinkMessage(msg);
+    }
+}
+
+bool MockLinkMissionItemHandler::_simulateLoss(void)
+{
+    if (_simulatedLossPct > 0 && static_cast<int>(_lossGenerator.bounded(100)) < _simulatedLossPct) {
+        qCDebug(MockLinkMissionItemHandlerLog) << "Dropping message due to link simulation";
+        return true;
+    }
+    return false;
+}
+
+void MockLinkMissionItemHandler::setLinkSimulation(int latencyMsecs, int lossPct)
+{
+    _simulatedLatencyMsecs = latencyMsecs;
+    _simulatedLossPct = lossPct;
+    // Fixed seed so benchmark runs drop the same messages
+    _lossGenerator.seed(1);
+}
+
 void MockLinkMissionItemHandler::sendUnexpectedMissionAck(MAV_MISSION_RESULT ackType)
 {
     _sendAck(ackType);
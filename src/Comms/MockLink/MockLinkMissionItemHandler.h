@@ -14,6 +14,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QMap>
+#include <QtCore/QRandomGenerator>
 #include <QtCore/QTimer>
 #include <QtCore/QLoggingCategory>
 
@@ -80,6 +81,12 @@ public:
 
     void setSendHomePositionOnEmptyList(bool sendHomePositionOnEmptyList) { _sendHomePositionOnEmptyList = sendHomePositionOnEmptyList; }
 
+    /// Simulates a slow, lossy link for benchmarking mission transfers. While loss is simulated the write sequence
+    /// re-requests missing items like a real vehicle does instead of treating a missing item as an error.
+    ///     @param latencyMsecs Delay added to every response
+    ///     @param lossPct Percentage of received MISSION_REQUEST_INT/MISSION_ITEM_INT messages which are dropped
+    void setLinkSimulation(int latencyMsecs, int lossPct);
+
 private slots:
     void _missionItemResponseTimeout(void);
 
@@ -92,6 +99,8 @@ private:
     void _requestNextMissionItem        (int sequenceNumber);
     void _sendAck                       (MAV_MISSION_RESULT ackType);
     void _startMissionItemResponseTimer (void);
+    void _respond                       (const mavlink_message_t& msg);
+    bool _simulateLoss                  (void);
 
 private:
     MockLink* _mockLink;
@@ -114,5 +123,8 @@ private:
     bool                _failReadRequestListFirstResponse;
     bool                _failReadRequest1FirstResponse;
     bool                _failWriteMissionCountFirstResponse;
+    int                 _simulatedLatencyMsecs = 0;
+    int                 _simulatedLossPct = 0;
+    QRandomGenerator    _lossGenerator;
 };
 
@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriter.h"
+#include "QGCTemporaryFile.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QTimer>
+#include <QtCore/QtEndian>
+#include <QtCore/QtMath>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TelemetryLogWriterLog, "TelemetryLogWriterLog")
+
+TelemetryLogWriter::TelemetryLogWriter(const QString& fileTemplate, qsizetype bufferSize, QObject* parent)
+    : QObject(parent)
+    , _capacity(static_cast<size_t>(qNextPowerOfTwo(static_cast<quint64>(qMax(bufferSize, qsizetype(64 * 1024)) - 1))))
+    , _mask(_capacity - 1)
+    , _buffer(new char[_capacity])
+    , _tempLogFile(new QGCTemporaryFile(fileTemplate, this))
+    , _flushTimer(new QTimer(this))
+{
+    (void) connect(_flushTimer, &QTimer::timeout, this, &TelemetryLogWriter::flush);
+}
+
+TelemetryLogWriter::~TelemetryLogWriter()
+{
+    // Whatever made it into the buffer before shutdown still belongs in the file. A non-empty
+    // file is left in the temp directory to be picked up by checkForLostLogFiles.
+    _logging.storeRelease(0);
+    (void) _drain();
+    (void) _closeLogFile();
+}
+
+bool TelemetryLogWriter::writeRecord(quint64 timestampUsecs, const char* data, qsizetype length)
+{
+    if (!isLogging()) {
+        return false;
+    }
+
+    const size_t recordLength = sizeof(quint64) + static_cast<size_t>(length);
+    const size_t writeIndex = _writeIndex.load(std::memory_order_relaxed);
+    const size_t readIndex = _readIndex.load(std::memory_order_acquire);
+
+    if ((_capacity - (writeIndex - readIndex)) < recordLength) {
+        // Drop the whole record so the file stays a valid sequence of timestamp/message pairs
+        (void) _droppedRecordCount.fetchAndAddRelaxed(1);
+        (void) _droppedByteCount.fetchAndAddRelaxed(recordLength);
+        return false;
+    }
+
+    char timestamp[sizeof(quint64)];
+    qToBigEndian(timestampUsecs, timestamp);
+    _copyIn(writeIndex, timestamp, sizeof(timestamp));
+    _copyIn(writeIndex + sizeof(timestamp), data, static_cast<size_t>(length));
+
+    _writeIndex.store(writeIndex + recordLength, std::memory_order_release);
+    return true;
+}
+
+void TelemetryLogWriter::_copyIn(size_t index, const char* data, size_t length)
+{
+    const size_t offset = index & _mask;
+    const size_t firstLength = qMin(length, _capacity - offset);
+    (void) memcpy(_buffer.get() + offset, data, firstLength);
+    if (firstLength < length) {
+        (void) memcpy(_buffer.get(), data + firstLength, length - firstLength);
+    }
+}
+
+void TelemetryLogWriter::setFlushIntervalMSecs(int msecs)
+{
+    _flushIntervalMSecs.storeRelaxed(msecs);
+    if (_flushTimer->isActive()) {
+        _flushTimer->start(msecs);
+    }
+}
+
+/// Writes the buffered records to the file in at most two contiguous chunks
+///     @return false: write to the file failed, the buffered records are discarded
+bool TelemetryLogWriter::_drain(void)
+{
+    if (!_tempLogFile->isOpen()) {
+        _discardBuffered();
+        return true;
+    }
+
+    size_t readIndex = _readIndex.load(std::memory_order_relaxed);
+    const size_t writeIndex = _writeIndex.load(std::memory_order_acquire);
+
+    while (readIndex != writeIndex) {
+        const size_t offset = readIndex & _mask;
+        const qint64 chunkLength = static_cast<qint64>(qMin(writeIndex - readIndex, _capacity - offset));
+        if (_tempLogFile->write(_buffer.get() + offset, chunkLength) != chunkLength) {
+            _discardBuffered();
+            return false;
+        }
+        readIndex += static_cast<size_t>(chunkLength);
+        _readIndex.store(readIndex, std::memory_order_release);
+    }
+
+    const quint64 droppedRecordCount = this->droppedRecordCount();
+    if (droppedRecordCount != _reportedDroppedRecordCount) {
+        qCWarning(TelemetryLogWriterLog) << "Disk not keeping up, records dropped:" << (droppedRecordCount - _reportedDroppedRecordCount) << "total:" << droppedRecordCount;
+        _reportedDroppedRecordCount = droppedRecordCount;
+    }
+
+    return true;
+}
+
+void TelemetryLogWriter::flush(void)
+{
+    if (!_drain()) {
+        // If there's an error logging data, raise an alert and stop logging.
+        _logSuspendError = true;
+        _updateLogging();
+        emit loggingFailed(tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile->fileName()));
+        stopLogging();
+    }
+}
+
+/// Throws away anything in the ring buffer. Only called from the writer thread.
+void TelemetryLogWriter::_discardBuffered(void)
+{
+    _readIndex.store(_writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void TelemetryLogWriter::_updateLogging(void)
+{
+    _logging.storeRelease((_tempLogFile->isOpen() && !_logSuspendError && !_logSuspendReplay) ? 1 : 0);
+}
+
+/// @brief Closes the log file if it is open
+bool TelemetryLogWriter::_closeLogFile(void)
+{
+    if (_tempLogFile->isOpen()) {
+        if (_tempLogFile->size() == 0) {
+            // Don't save zero byte files
+            _tempLogFile->remove();
+            return false;
+        } else {
+            _tempLogFile->close();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TelemetryLogWriter::startLogging(void)
+{
+    //-- Log is always written to a temp file. If later the user decides they want
+    //   it, it's all there for them.
+    if (_tempLogFile->isOpen() || _logSuspendReplay) {
+        return;
+    }
+
+    // Unbuffered since records are already gathered into large writes
+    if (!_tempLogFile->open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        emit loggingFailed(tr("Opening Flight Data file for writing failed. "
+                              "Unable to write to %1. Please choose a different file location.").arg(_tempLogFile->fileName()));
+        _closeLogFile();
+        _logSuspendError = true;
+        _updateLogging();
+        return;
+    }
+
+    qCDebug(TelemetryLogWriterLog) << "Temp log" << _tempLogFile->fileName();
+    _logSuspendError = false;
+    _discardBuffered();
+    _updateLogging();
+    _flushTimer->start(flushIntervalMSecs());
+    emit loggingStarted();
+}
+
+void TelemetryLogWriter::stopLogging(void)
+{
+    _flushTimer->stop();
+    _logging.storeRelease(0);
+
+    if (_tempLogFile->isOpen()) {
+        if (!_drain() && !_logSuspendError) {
+            _logSuspendError = true;
+            emit loggingFailed(tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile->fileName()));
+        }
+        if (_closeLogFile()) {
+            emit loggingStopped(_tempLogFile->fileName(), _vehicleWasArmed.loadRelaxed() != 0);
+        }
+    }
+    _vehicleWasArmed.storeRelaxed(0);
+}
+
+void TelemetryLogWriter::suspendLogForReplay(bool suspend)
+{
+    _logSuspendReplay = suspend;
+    _updateLogging();
+}
@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QLoggingCategory>
+
+#include <atomic>
+#include <memory>
+
+class QGCTemporaryFile;
+class QTimer;
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryLogWriterLog)
+
+/// Writes the temporary telemetry (.tlog) file from its own thread.
+/// Records are copied into a preallocated single producer/single consumer ring buffer without taking a lock or
+/// allocating, and drained to the file in large sequential writes once per flush interval. If the disk can't keep
+/// up, whole records are dropped and counted so the producer never waits on I/O.
+class TelemetryLogWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr qsizetype  defaultBufferSize           = 4 * 1024 * 1024;
+    static constexpr int        defaultFlushIntervalMSecs   = 250;
+
+    /// @param fileTemplate QGCTemporaryFile template for the log file
+    /// @param bufferSize Ring buffer size in bytes, rounded up to a power of two
+    TelemetryLogWriter(const QString& fileTemplate, qsizetype bufferSize = defaultBufferSize, QObject* parent = nullptr);
+    ~TelemetryLogWriter();
+
+    /// Producer side. Must only be called from a single thread at a time. Never blocks.
+    /// Appends the big endian timestamp followed by data as one tlog record.
+    ///     @return false: Not logging or the record was dropped
+    bool writeRecord(quint64 timestampUsecs, const char* data, qsizetype length);
+
+    /// Thread safe: true if records are currently being accepted
+    bool isLogging() const { return _logging.loadAcquire(); }
+
+    /// Thread safe: Marks the current log as containing an armed vehicle, used to decide whether it is saved
+    void setVehicleWasArmed() { _vehicleWasArmed.storeRelaxed(1); }
+
+    /// Thread safe: Number of records/bytes dropped because the ring buffer was full
+    quint64 droppedRecordCount() const { return _droppedRecordCount.loadRelaxed(); }
+    quint64 droppedByteCount() const { return _droppedByteCount.loadRelaxed(); }
+
+    qsizetype bufferSize() const { return static_cast<qsizetype>(_capacity); }
+    int flushIntervalMSecs() const { return _flushIntervalMSecs.loadRelaxed(); }
+
+public slots:
+    void setFlushIntervalMSecs(int msecs);
+    void startLogging(void);
+    void stopLogging(void);
+    void suspendLogForReplay(bool suspend);
+
+    /// Writes everything currently in the ring buffer to the file
+    void flush(void);
+
+signals:
+    void loggingStarted(void);
+    void loggingFailed(const QString& message);
+    void loggingStopped(const QString& tempLogfile, bool vehicleWasArmed);
+
+private:
+    void _copyIn(size_t index, const char* data, size_t length);
+    bool _drain(void);
+    void _updateLogging(void);
+    void _discardBuffered(void);
+    bool _closeLogFile(void);
+
+    size_t                  _capacity;
+    size_t                  _mask;
+    std::unique_ptr<char[]> _buffer;
+    std::atomic<size_t>     _writeIndex { 0 };      ///< Only advanced by the producer
+    std::atomic<size_t>     _readIndex { 0 };       ///< Only advanced by the writer thread
+
+    QAtomicInteger<quint64> _droppedRecordCount = 0;
+    QAtomicInteger<quint64> _droppedByteCount = 0;
+    quint64                 _reportedDroppedRecordCount = 0;
+
+    QAtomicInt              _logging = 0;
+    QAtomicInt              _vehicleWasArmed = 0;
+    QAtomicInt              _flushIntervalMSecs = defaultFlushIntervalMSecs;
+
+    bool _logSuspendError = false;      ///< true: Logging suspended due to error
+    bool _logSuspendReplay = false;     ///< true: Logging suspended due to replay
+
+    QGCTemporaryFile*   _tempLogFile = nullptr;
+    QTimer*             _flushTimer = nullptr;
+};
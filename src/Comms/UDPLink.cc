@@ -76,7 +76,7 @@ UDPLink::UDPLink(SharedLinkConfigurationPtr& config)
     auto allAddresses = QNetworkInterface::allAddresses();
     for (int i=0; i<allAddresses.count(); i++) {
         QHostAddress &address = allAddresses[i];
-        _localAddresses.append(QHostAddress(address));
+        _localAddresses.insert(QHostAddress(address));
     }
     moveToThread(this);
 }
@@ -89,6 +89,7 @@ UDPLink::~UDPLink()
     // Clear client list
     qDeleteAll(_sessionTargets);
     _sessionTargets.clear();
+    _sessionTargetKeys.clear();
     quit();
     // Wait for it to exit
     wait();
@@ -122,14 +123,7 @@ bool UDPLink::_isIpLocal(const QHostAddress& add)
     // On Windows, this is a very expensive call only Redmond would know
     // why. As such, we make it once and keep the list locally. If a new
     // interface shows up after we start, it won't be on this list.
-    for (int i=0; i<_localAddresses.count(); i++) {
-        QHostAddress &address = _localAddresses[i];
-        if (address == add) {
-            // This is a local address of the same host
-            return true;
-        }
-    }
-    return false;
+    return _localAddresses.contains(add);
 }
 
 void UDPLink::_writeBytes(const QByteArray &data)
@@ -145,7 +139,7 @@ void UDPLink::_writeBytes(const QByteArray &data)
     for (int i=0; i<_udpConfig->targetHosts().count(); i++) {
         UDPCLient* target = _udpConfig->targetHosts()[i];
         // Skip it if it's part of the session clients below
-        if(!contains_target(_sessionTargets, target->address, target->port)) {
+        if(!_sessionTargetKeys.contains(SessionTargetKey_t(target->address, target->port))) {
             _writeDataGram(data, target);
         }
     }
@@ -168,47 +162,113 @@ void UDPLink::readBytes()
     if (!_socket) {
         return;
     }
-    QByteArray databuffer;
-    while (_socket->hasPendingDatagrams())
+
+    // Datagrams are read straight into one contiguous buffer which is handed to the parser as a whole. The buffer
+    // keeps its allocation between calls, unless the parser still holds on to the previous one.
+    if (_receiveBuffer.isDetached()) {
+        _receiveBuffer.resize(0);
+    } else {
+        _receiveBuffer = QByteArray();
+        _receiveBuffer.reserve(kReceiveBufferReserve);
+    }
+
+    quint64 datagrams = 0;
+    quint64 socketCalls = 1;
+    while (_socket->hasPendingDatagrams() && (_receiveBuffer.size() < kMaxReceiveBatchBytes))
     {
-        QByteArray datagram;
-        datagram.resize(_socket->pendingDatagramSize());
+        const qint64 pendingSize = _socket->pendingDatagramSize();
+        socketCalls += 2;
+        if (pendingSize < 0) {
+            break;
+        }
+        const qsizetype offset = _receiveBuffer.size();
+        _receiveBuffer.resize(offset + pendingSize);
         QHostAddress sender;
         quint16 senderPort;
         // If the other end is reset then it will still report data available,
         // but will fail on the readDatagram call
-        qint64 slen = _socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        const qint64 slen = _socket->readDatagram(_receiveBuffer.data() + offset, pendingSize, &sender, &senderPort);
+        socketCalls++;
         if (slen == -1) {
+            _receiveBuffer.resize(offset);
             break;
         }
-        databuffer.append(datagram);
-        //-- Wait a bit before sending it over
-        if (databuffer.size() > 10 * 1024) {
-            emit bytesReceived(this, databuffer);
-            databuffer.clear();
-        }
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
-        }
-        QMutexLocker locker(&_sessionTargetsMutex);
-        if (!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
-        }
-        locker.unlock();
+        _receiveBuffer.resize(offset + slen);
+        datagrams++;
+        _addSessionTarget(sender, senderPort);
     }
-    //-- Send whatever is left
-    if (databuffer.size()) {
-        emit bytesReceived(this, databuffer);
+
+    _updateReceiveStatistics(datagrams, static_cast<quint64>(_receiveBuffer.size()), socketCalls);
+
+    if (!_receiveBuffer.isEmpty()) {
+        emit bytesReceived(this, _receiveBuffer);
     }
 }
 
+void UDPLink::_addSessionTarget(const QHostAddress& sender, quint16 senderPort)
+{
+    // Nearly every datagram comes from a sender seen before, which needs neither the lock nor the local address check
+    const SessionTargetKey_t senderKey(sender, senderPort);
+    if (_knownSenders.contains(senderKey)) {
+        return;
+    }
+    // It is only a shortcut, so start it over rather than letting every port a scanner uses pile up in it
+    if (_knownSenders.size() >= kMaxKnownSenders) {
+        _knownSenders.clear();
+    }
+    _knownSenders.insert(senderKey);
+
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    const SessionTargetKey_t targetKey(asender, senderPort);
+    QMutexLocker locker(&_sessionTargetsMutex);
+    if (!_sessionTargetKeys.contains(targetKey)) {
+        qDebug() << "Adding target" << asender << senderPort;
+        UDPCLient* target = new UDPCLient(asender, senderPort);
+        _sessionTargets.append(target);
+        _sessionTargetKeys.insert(targetKey);
+    }
+}
+
+void UDPLink::_updateReceiveStatistics(quint64 datagrams, quint64 bytes, quint64 socketCalls)
+{
+    _receivedDatagrams += datagrams;
+    _receivedBytes += bytes;
+    _readyReadCount++;
+    _socketCalls += socketCalls;
+
+    _receiveRateDatagrams += datagrams;
+    if (!_receiveRateTimer.isValid()) {
+        _receiveRateTimer.start();
+    } else {
+        const qint64 elapsed = _receiveRateTimer.elapsed();
+        if (elapsed >= 1000) {
+            _datagramsPerSecond = static_cast<quint32>((_receiveRateDatagrams * 1000) / static_cast<quint64>(elapsed));
+            _receiveRateDatagrams = 0;
+            _receiveRateTimer.restart();
+        }
+    }
+}
+
+UDPLink::ReceiveStatistics_t UDPLink::receiveStatistics(void) const
+{
+    ReceiveStatistics_t statistics;
+
+    statistics.datagrams            = _receivedDatagrams;
+    statistics.bytes                = _receivedBytes;
+    statistics.readyReadCount       = _readyReadCount;
+    statistics.socketCalls          = _socketCalls;
+    statistics.datagramsPerSecond   = _datagramsPerSecond;
+
+    return statistics;
+}
+
 void UDPLink::disconnect(void)
 {
     _running = false;
@@ -16,8 +16,13 @@
 #include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
 #include <QtNetwork/QHostAddress>
 
+#include <atomic>
+
 #if defined(QGC_ZEROCONF_ENABLED)
 #include <dns_sd.h>
 #endif
@@ -93,6 +98,8 @@ class UDPLink : public LinkInterface
 {
     Q_OBJECT
 
+    friend class UDPLinkTest;   // Unit test
+
 public:
     UDPLink(SharedLinkConfigurationPtr& config);
     virtual ~UDPLink();
@@ -105,6 +112,17 @@ public:
     // QThread overrides
     void run(void) override;
 
+    typedef struct {
+        quint64 datagrams;          ///< Datagrams received
+        quint64 bytes;              ///< Bytes received
+        quint64 readyReadCount;     ///< readyRead notifications handled, each hands one buffer to the parser
+        quint64 socketCalls;        ///< Socket calls made while receiving, each one is a system call
+        quint32 datagramsPerSecond; ///< Receive rate over the last complete one second window
+    } ReceiveStatistics_t;
+
+    /// Thread-safe
+    ReceiveStatistics_t receiveStatistics(void) const;
+
 public slots:
     void readBytes(void);
 
@@ -122,17 +140,34 @@ private:
     void _registerZeroconf  (uint16_t port, const std::string& regType);
     void _deregisterZeroconf(void);
     void _writeDataGram     (const QByteArray data, const UDPCLient* target);
+    void _addSessionTarget  (const QHostAddress& sender, quint16 senderPort);
+    void _updateReceiveStatistics(quint64 datagrams, quint64 bytes, quint64 socketCalls);
+
+    typedef QPair<QHostAddress, quint16> SessionTargetKey_t;
 
     bool                _running;
     QUdpSocket*         _socket;
     const UDPConfiguration*   _udpConfig;
     bool                _connectState;
     QList<UDPCLient*>   _sessionTargets;
+    QSet<SessionTargetKey_t> _sessionTargetKeys;    ///< Address/port of each of _sessionTargets
     QMutex              _sessionTargetsMutex;
-    QList<QHostAddress> _localAddresses;
+    QSet<SessionTargetKey_t> _knownSenders;         ///< Senders already added to _sessionTargets, link thread only, at most kMaxKnownSenders
+    QSet<QHostAddress>  _localAddresses;
+    QByteArray          _receiveBuffer;             ///< Reused across readBytes calls once the parser has let go of it
+    QElapsedTimer       _receiveRateTimer;
+    quint64             _receiveRateDatagrams = 0;
+    std::atomic<quint64> _receivedDatagrams{0};
+    std::atomic<quint64> _receivedBytes{0};
+    std::atomic<quint64> _readyReadCount{0};
+    std::atomic<quint64> _socketCalls{0};
+    std::atomic<quint32> _datagramsPerSecond{0};
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef       _dnssServiceRef;
 #endif
 
     static constexpr const char* kZeroconfRegistration = "_qgroundcontrol._udp";
+    static constexpr qsizetype kReceiveBufferReserve = 16 * 1024;
+    static constexpr qsizetype kMaxReceiveBatchBytes = 64 * 1024;   ///< Larger bursts are split over several readyRead
+    static constexpr qsizetype kMaxKnownSenders = 64;
 };
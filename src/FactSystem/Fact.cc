@@ -12,6 +12,7 @@
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
 
+#include <QtCore/QMetaMethod>
 #include <QtQml/QQmlEngine>
 
 Fact::Fact(QObject* parent)
@@ -108,10 +109,10 @@ void Fact::forceSetRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
+            _sendValueChangedSignal();
             //-- Must be in this order
             emit _containerRawValueChanged(rawValue());
-            emit rawValueChanged(_rawValue);
+            _emitRawValueChanged();
         }
     } else {
         qWarning() << kMissingMetadata << name();
@@ -125,12 +126,12 @@ void Fact::setRawValue(const QVariant& value)
         QString     errorString;
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
-            if (typedValue != _rawValue) {
+            if (_rawValue != typedValue) {
                 _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
+                _sendValueChangedSignal();
                 //-- Must be in this order
                 emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+                _emitRawValueChanged();
             }
         }
     } else {
@@ -138,6 +139,26 @@ void Fact::setRawValue(const QVariant& value)
     }
 }
 
+void Fact::_setTypedRawValue(const FactValue& typedValue)
+{
+    if (_rawValue != typedValue) {
+        _rawValue = typedValue;
+        _sendValueChangedSignal();
+        //-- Must be in this order
+        emit _containerRawValueChanged(rawValue());
+        _emitRawValueChanged();
+    }
+}
+
+/// The QVariant for the signal is only built if someone is listening
+void Fact::_emitRawValueChanged(void)
+{
+    static const QMetaMethod rawValueChangedSignal = QMetaMethod::fromSignal(&Fact::rawValueChanged);
+    if (isSignalConnected(rawValueChangedSignal)) {
+        emit rawValueChanged(rawValue());
+    }
+}
+
 void Fact::setCookedValue(const QVariant& value)
 {
     if (_metaData) {
@@ -177,12 +198,12 @@ void Fact::_containerSetRawValue(const QVariant& value)
 {
     if(_rawValue != value) {
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
-        emit rawValueChanged(_rawValue);
+        _sendValueChangedSignal();
+        _emitRawValueChanged();
     }
 
     // This always need to be signalled in order to support forceSetRawValue usage and waiting for vehicleUpdated signal
-    emit vehicleUpdated(_rawValue);
+    emit vehicleUpdated(rawValue());
 }
 
 QString Fact::name(void) const
@@ -198,10 +219,10 @@ int Fact::componentId(void) const
 QVariant Fact::cookedValue(void) const
 {
     if (_metaData) {
-        return _metaData->rawTranslator()(_rawValue);
+        return _metaData->rawTranslator()(rawValue());
     } else {
         qWarning() << kMissingMetadata << name();
-        return _rawValue;
+        return rawValue();
     }
 }
 
@@ -667,13 +688,15 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+void Fact::_sendValueChangedSignal(void)
 {
     if (_sendValueChangedSignals) {
-        emit valueChanged(value);
+        emit valueChanged(cookedValue());
         _deferredValueChangeSignal = false;
-    } else {
+    } else if (!_deferredValueChangeSignal) {
+        // The cooked value is only translated once the deferred signal goes out
         _deferredValueChangeSignal = true;
+        emit valueChangeDeferred();
     }
 }
 
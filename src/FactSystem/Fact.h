@@ -14,6 +14,9 @@
 #include <QtCore/QVariant>
 
 #include "FactMetaData.h"
+#include "FactValue.h"
+
+#include <type_traits>
 
 class FactValueSliderListModel;
 
@@ -80,7 +83,7 @@ public:
     Q_INVOKABLE QVariant clamp(const QString& cookedValue);
 
     QVariant        cookedValue             (void) const;   /// Value after translation
-    QVariant        rawValue                (void) const { return _rawValue; }  /// value prior to translation, careful
+    QVariant        rawValue                (void) const { return _rawValue.toVariant(); }  /// value prior to translation, careful
     int             componentId             (void) const;
     int             decimalPlaces           (void) const;
     QVariant        rawDefaultValue         (void) const;
@@ -135,6 +138,19 @@ public:
     QString rawValueStringFullPrecision(void) const;
 
     void setRawValue        (const QVariant& value);
+
+    /// Fast path for numeric telemetry values. The value is converted and compared in its typed storage
+    /// without building a QVariant.
+    template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+    void setRawValue(T value)
+    {
+        FactValue typedValue;
+        if (_metaData && typedValue.setNumeric(_metaData->type(), value)) {
+            _setTypedRawValue(typedValue);
+        } else {
+            setRawValue(QVariant::fromValue(value));
+        }
+    }
     void setCookedValue     (const QVariant& value);
     void setEnumIndex       (int index);
     void setEnumStringValue (const QString& value);
@@ -176,6 +192,10 @@ signals:
     void enumsChanged(void);
     void sendValueChangedSignalsChanged(bool sendValueChangedSignals);
 
+    /// Signalled when a valueChanged signal is first deferred. Used by FactGroup to only visit changed
+    /// facts when it sends out the deferred signals.
+    void valueChangeDeferred(void);
+
     /// QObject Property System signal for value property changes
     ///
     /// This signal is only meant for use by the QT property system. It should not be connected to by client code.
@@ -198,11 +218,13 @@ private:
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
+    void _setTypedRawValue(const FactValue& typedValue);
+    void _emitRawValueChanged(void);
 
     QString                     _name;
     int                         _componentId;
-    QVariant                    _rawValue;
+    FactValue                   _rawValue;
     FactMetaData::ValueType_t   _type;
     FactMetaData*               _metaData;
     bool                        _sendValueChangedSignals;
@@ -9,15 +9,18 @@
 
 
 #include "FactGroup.h"
+#include "FactGroupUpdateScheduler.h"
 
 #include <QtQml/QQmlEngine>
 
+#include <algorithm>
+
 FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent, bool ignoreCamelCase)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
+    _addToScheduler();
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
@@ -27,26 +30,41 @@ FactGroup::FactGroup(int updateRateMsecs, QObject* parent, bool ignoreCamelCase)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
 {
-    _setupTimer();
+    _addToScheduler();
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 }
 
-void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
+FactGroup::~FactGroup()
 {
-    QMap<QString, QString> defineMap;
-    _nameToFactMetaDataMap = FactMetaData::createMapFromJsonArray(jsonArray, defineMap, this);
+    // The scheduler may already be gone for groups which outlive it at application exit
+    FactGroupUpdateScheduler* const scheduler = FactGroupUpdateScheduler::instance();
+    if (scheduler) {
+        scheduler->removeFactGroup(this);
+    }
 }
 
-void FactGroup::_setupTimer()
+void FactGroup::_addToScheduler(void)
 {
+    // Groups with an update rate of 0 send their signals as values change
     if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
-        _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
-        _updateTimer.start();
+        FactGroupUpdateScheduler::instance()->addFactGroup(this);
+    }
+}
+
+void FactGroup::_setPeriodicUpdates(bool periodicUpdates)
+{
+    _periodicUpdates = periodicUpdates;
+    if (_periodicUpdates) {
+        FactGroupUpdateScheduler::instance()->scheduleUpdate();
     }
 }
 
+void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
+{
+    QMap<QString, QString> defineMap;
+    _nameToFactMetaDataMap = FactMetaData::createMapFromJsonArray(jsonArray, defineMap, this);
+}
+
 bool FactGroup::factExists(const QString& name)
 {
     if (name.contains(".")) {
@@ -123,7 +141,21 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
         return;
     }
 
+    // Value changes go out in batches from FactGroupUpdateScheduler, only the facts which changed are visited
     fact->setSendValueChangedSignals(_updateRateMSecs == 0);
+    (void) connect(fact, &Fact::valueChangeDeferred, this, [this, fact]() {
+        if (_deferredFacts.isEmpty()) {
+            FactGroupUpdateScheduler* const scheduler = FactGroupUpdateScheduler::instance();
+            if (scheduler) {
+                scheduler->scheduleUpdate();
+            }
+        }
+        _deferredFacts.append(fact);
+    });
+    (void) connect(fact, &QObject::destroyed, this, [this, fact]() {
+        (void) _deferredFacts.removeAll(fact);
+        std::replace(_updatingFacts.begin(), _updatingFacts.end(), fact, static_cast<Fact*>(nullptr));
+    });
     if (_nameToFactMetaDataMap.contains(name)) {
         fact->setMetaData(_nameToFactMetaDataMap[name], true /* setDefaultFromMetaData */);
     }
@@ -147,25 +179,34 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
 
 void FactGroup::_updateAllValues(void)
 {
-    for(Fact* fact: _nameToFactMap) {
-        fact->sendDeferredValueChangedSignal();
+    if (_deferredFacts.isEmpty()) {
+        return;
+    }
+
+    // Facts deferred again by a valueChanged handler are picked up on the next update
+    _updatingFacts.swap(_deferredFacts);
+    for (qsizetype i = 0; i < _updatingFacts.count(); i++) {
+        if (_updatingFacts[i]) {
+            _updatingFacts[i]->sendDeferredValueChangedSignal();
+        }
     }
+    _updatingFacts.clear();
 }
 
 void FactGroup::setLiveUpdates(bool liveUpdates)
 {
-    if (_updateTimer.interval() == 0) {
+    if (_updateRateMSecs == 0) {
         return;
     }
 
-    if (liveUpdates) {
-        _updateTimer.stop();
-    } else {
-        _updateTimer.start();
-    }
     for(Fact* fact: _nameToFactMap) {
         fact->setSendValueChangedSignals(liveUpdates);
     }
+
+    if (liveUpdates) {
+        // Values deferred before the switch must not wait for the next scheduled update
+        FactGroup::_updateAllValues();
+    }
 }
 
 
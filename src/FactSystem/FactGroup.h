@@ -11,6 +11,7 @@
 
 #include <QtCore/QStringList>
 #include <QtCore/QMap>
+#include <QtCore/QList>
 #include <QtCore/QTimer>
 #include <QtCore/QJsonArray>
 
@@ -27,6 +28,7 @@ class FactGroup : public QObject
 public:
     FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject* parent = nullptr, bool ignoreCamelCase = false);
     FactGroup(int updateRateMsecs, QObject* parent = nullptr, bool ignoreCamelCase = false);
+    ~FactGroup();
 
     Q_PROPERTY(QStringList  factNames           READ factNames          NOTIFY factNamesChanged)
     Q_PROPERTY(QStringList  factGroupNames      READ factGroupNames     NOTIFY factGroupNamesChanged)
@@ -67,8 +69,10 @@ protected:
     void _addFactGroup          (FactGroup* factGroup, const QString& name);
     void _loadFromJsonArray     (const QJsonArray jsonArray);
     void _setTelemetryAvailable (bool telemetryAvailable);
+    /// true: _updateAllValues is called at the update rate even when no value changed
+    void _setPeriodicUpdates    (bool periodicUpdates);
 
-    int  _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: immediate update
+    int  _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: every frame
 
     QMap<QString, Fact*>            _nameToFactMap;
     QMap<QString, FactGroup*>       _nameToFactGroupMap;
@@ -76,10 +80,14 @@ protected:
     QStringList                     _factNames;
 
 private:
-    void    _setupTimer (void);
-    QString _camelCase  (const QString& text);
+    QString _camelCase      (const QString& text);
+    void    _addToScheduler (void);
 
-    bool    _ignoreCamelCase    = false;
-    QTimer  _updateTimer;
-    bool    _telemetryAvailable = false;
+    bool            _ignoreCamelCase    = false;
+    bool            _telemetryAvailable = false;
+    bool            _periodicUpdates    = false;
+    QList<Fact*>    _deferredFacts;                 ///< Facts with a deferred valueChanged signal
+    QList<Fact*>    _updatingFacts;                 ///< Facts being signalled by _updateAllValues, reused to avoid allocations
+
+    friend class FactGroupUpdateScheduler;
 };
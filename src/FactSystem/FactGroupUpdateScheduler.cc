@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateScheduler.h"
+#include "FactGroup.h"
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(FactGroupUpdateSchedulerLog, "FactGroupUpdateSchedulerLog")
+
+Q_GLOBAL_STATIC(FactGroupUpdateScheduler, _factGroupUpdateScheduler)
+
+FactGroupUpdateScheduler* FactGroupUpdateScheduler::instance()
+{
+    return _factGroupUpdateScheduler();
+}
+
+FactGroupUpdateScheduler::FactGroupUpdateScheduler(QObject* parent)
+    : QObject(parent)
+{
+    _frameTimer.setSingleShot(false);
+    _frameTimer.setTimerType(Qt::PreciseTimer);
+    _frameTimer.setInterval(defaultFrameIntervalMSecs);
+    (void) connect(&_frameTimer, &QTimer::timeout, this, &FactGroupUpdateScheduler::processFrame);
+
+    _clock.start();
+}
+
+FactGroupUpdateScheduler::~FactGroupUpdateScheduler()
+{
+
+}
+
+void FactGroupUpdateScheduler::addFactGroup(FactGroup* factGroup)
+{
+    _factGroups.append(factGroup);
+}
+
+void FactGroupUpdateScheduler::scheduleUpdate(void)
+{
+    if (!_frameTimer.isActive()) {
+        _frameTimer.start();
+    }
+}
+
+void FactGroupUpdateScheduler::removeFactGroup(FactGroup* factGroup)
+{
+    const qsizetype index = _factGroups.indexOf(factGroup);
+    if (index < 0) {
+        return;
+    }
+
+    if (_processingFrame) {
+        // Compacted once the frame is done
+        _factGroups[index] = nullptr;
+        _factGroupsRemoved = true;
+    } else {
+        _factGroups.removeAt(index);
+    }
+
+    if (_factGroups.isEmpty()) {
+        _frameTimer.stop();
+    }
+}
+
+void FactGroupUpdateScheduler::setFrameIntervalMSecs(int msecs)
+{
+    qCDebug(FactGroupUpdateSchedulerLog) << "Frame interval" << msecs;
+    _frameTimer.setInterval(qMax(1, msecs));
+}
+
+void FactGroupUpdateScheduler::processFrame(void)
+{
+    const qint64 nowMSecs = _clock.elapsed();
+    bool updated = false;
+    bool waiting = false;
+
+    _processingFrame = true;
+    // Groups added by an update are picked up on the next frame
+    const qsizetype count = _factGroups.count();
+    for (qsizetype i = 0; i < count; i++) {
+        FactGroup* factGroup = _factGroups[i];
+        if (!factGroup || (!factGroup->_periodicUpdates && factGroup->_deferredFacts.isEmpty())) {
+            continue;
+        }
+        const qint64 rateMSecs = factGroup->_updateRateMSecs;
+        if ((rateMSecs <= 0) || ((nowMSecs / rateMSecs) != (_lastFrameMSecs / rateMSecs))) {
+            factGroup->_updateAllValues();
+            updated = true;
+        }
+        // The update may have removed the group
+        factGroup = _factGroups[i];
+        if (factGroup && (factGroup->_periodicUpdates || !factGroup->_deferredFacts.isEmpty())) {
+            waiting = true;
+        }
+    }
+    _processingFrame = false;
+
+    if (_factGroupsRemoved) {
+        (void) _factGroups.removeAll(nullptr);
+        _factGroupsRemoved = false;
+    }
+
+    _lastFrameMSecs = nowMSecs;
+    if (updated) {
+        _updateFrameCount++;
+    }
+    if (!waiting) {
+        _frameTimer.stop();
+    }
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QList>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QLoggingCategory>
+
+class FactGroup;
+
+Q_DECLARE_LOGGING_CATEGORY(FactGroupUpdateSchedulerLog)
+
+/// Sends the deferred Fact::valueChanged signals of all FactGroups from a single frame timer.
+/// A FactGroup is updated on the first frame after each multiple of its update rate, so groups with the
+/// same rate are updated together no matter which vehicle they belong to. Groups with an update rate of 0
+/// are not scheduled since they send their signals immediately. The frame timer only runs while values
+/// are waiting to be sent.
+class FactGroupUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FactGroupUpdateScheduler(QObject* parent = nullptr);
+    ~FactGroupUpdateScheduler();
+
+    static FactGroupUpdateScheduler* instance();
+
+    static constexpr int defaultFrameIntervalMSecs = 16;
+
+    void addFactGroup   (FactGroup* factGroup);
+    void removeFactGroup(FactGroup* factGroup);
+
+    /// Starts the frame timer if needed, called when a group has values waiting to be sent
+    void scheduleUpdate(void);
+    bool frameTimerActive(void) const { return _frameTimer.isActive(); }
+
+    /// Sets the frame interval, normally to match the display refresh rate
+    void setFrameIntervalMSecs(int msecs);
+    int  frameIntervalMSecs(void) const { return _frameTimer.interval(); }
+
+    /// @return Number of frames which updated at least one FactGroup
+    quint64 updateFrameCount(void) const { return _updateFrameCount; }
+
+public slots:
+    /// Updates all FactGroups which are due. Normally called by the frame timer, which is stopped
+    /// after a frame which leaves nothing waiting.
+    void processFrame(void);
+
+private:
+    QTimer              _frameTimer;
+    QElapsedTimer       _clock;
+    qint64              _lastFrameMSecs = 0;
+    QList<FactGroup*>   _factGroups;
+    bool                _processingFrame = false;
+    bool                _factGroupsRemoved = false;
+    quint64             _updateFrameCount = 0;
+};
@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactValue.h"
+
+FactValue& FactValue::operator=(const FactValue& other)
+{
+    if (this != &other) {
+        _clear();
+        _copy(other);
+    }
+    return *this;
+}
+
+FactValue& FactValue::operator=(const QVariant& variant)
+{
+    _clear();
+    _assign(variant);
+    return *this;
+}
+
+FactValue::Storage FactValue::_storageForVariant(const QVariant& variant)
+{
+    switch (variant.metaType().id()) {
+    case QMetaType::Int:
+        return StorageInt;
+    case QMetaType::UInt:
+        return StorageUInt;
+    case QMetaType::LongLong:
+        return StorageLongLong;
+    case QMetaType::ULongLong:
+        return StorageULongLong;
+    case QMetaType::Float:
+        return StorageFloat;
+    case QMetaType::Double:
+        return StorageDouble;
+    case QMetaType::Bool:
+        return StorageBool;
+    default:
+        return StorageVariant;
+    }
+}
+
+void FactValue::_assign(const QVariant& variant)
+{
+    _storage = _storageForVariant(variant);
+
+    switch (_storage) {
+    case StorageInt:
+        _int = variant.toInt();
+        break;
+    case StorageUInt:
+        _uint = variant.toUInt();
+        break;
+    case StorageLongLong:
+        _longLong = variant.toLongLong();
+        break;
+    case StorageULongLong:
+        _uLongLong = variant.toULongLong();
+        break;
+    case StorageFloat:
+        _float = variant.toFloat();
+        break;
+    case StorageDouble:
+        _double = variant.toDouble();
+        break;
+    case StorageBool:
+        _bool = variant.toBool();
+        break;
+    case StorageVariant:
+        _variant = new QVariant(variant);
+        break;
+    }
+}
+
+void FactValue::_copy(const FactValue& other)
+{
+    _storage = other._storage;
+    if (_storage == StorageVariant) {
+        _variant = new QVariant(*other._variant);
+    } else {
+        _uLongLong = other._uLongLong;
+    }
+}
+
+void FactValue::_clear(void)
+{
+    if (_storage == StorageVariant) {
+        delete _variant;
+        _storage = StorageInt;
+        _int = 0;
+    }
+}
+
+QVariant FactValue::toVariant(void) const
+{
+    switch (_storage) {
+    case StorageInt:
+        return QVariant(_int);
+    case StorageUInt:
+        return QVariant(_uint);
+    case StorageLongLong:
+        return QVariant(_longLong);
+    case StorageULongLong:
+        return QVariant(_uLongLong);
+    case StorageFloat:
+        return QVariant(_float);
+    case StorageDouble:
+        return QVariant(_double);
+    case StorageBool:
+        return QVariant(_bool);
+    case StorageVariant:
+        break;
+    }
+
+    return *_variant;
+}
+
+/// Only valid for two values with the same numeric storage. Matches QVariant comparison of equal types.
+bool FactValue::_numericEquals(const FactValue& other) const
+{
+    switch (_storage) {
+    case StorageInt:
+        return _int == other._int;
+    case StorageUInt:
+        return _uint == other._uint;
+    case StorageLongLong:
+        return _longLong == other._longLong;
+    case StorageULongLong:
+        return _uLongLong == other._uLongLong;
+    case StorageFloat:
+        return _float == other._float;
+    case StorageDouble:
+        return _double == other._double;
+    case StorageBool:
+        return _bool == other._bool;
+    case StorageVariant:
+        break;
+    }
+
+    return false;
+}
+
+bool FactValue::operator==(const FactValue& other) const
+{
+    if ((_storage == other._storage) && (_storage != StorageVariant)) {
+        return _numericEquals(other);
+    }
+
+    // Mixed types follow the QVariant rules
+    return toVariant() == other.toVariant();
+}
+
+bool FactValue::operator==(const QVariant& variant) const
+{
+    if ((_storage != StorageVariant) && (_storage == _storageForVariant(variant))) {
+        return _numericEquals(FactValue(variant));
+    }
+
+    return toVariant() == variant;
+}
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FactMetaData.h"
+
+#include <QtCore/QVariant>
+
+#include <limits>
+#include <type_traits>
+
+/// Compact storage for a Fact value.
+/// The numeric types produced by FactMetaData::convertAndValidateRaw are held inline in a tagged union. Anything
+/// else (strings, byte arrays, values of an unexpected type) goes into a heap allocated QVariant. A QVariant is only
+/// built for numeric values when the value is read through toVariant.
+class FactValue
+{
+public:
+    FactValue() = default;
+    FactValue(const QVariant& variant) { _assign(variant); }
+    FactValue(const FactValue& other) { _copy(other); }
+    ~FactValue() { _clear(); }
+
+    FactValue& operator=(const FactValue& other);
+    FactValue& operator=(const QVariant& variant);
+
+    void setValue(const QVariant& variant) { *this = variant; }
+
+    QVariant toVariant(void) const;
+
+    bool operator==(const FactValue& other) const;
+    bool operator!=(const FactValue& other) const { return !(*this == other); }
+    bool operator==(const QVariant& variant) const;
+    bool operator!=(const QVariant& variant) const { return !(*this == variant); }
+
+    /// Stores value converted the same way FactMetaData::convertAndValidateRaw(convertOnly) converts it for type,
+    /// without going through QVariant.
+    ///     @return false: No fast path for this type/value combination, use the QVariant conversion instead
+    template<typename T>
+    bool setNumeric(FactMetaData::ValueType_t type, T value);
+
+private:
+    enum Storage : quint8 {
+        StorageInt,
+        StorageUInt,
+        StorageLongLong,
+        StorageULongLong,
+        StorageFloat,
+        StorageDouble,
+        StorageBool,
+        StorageVariant,
+    };
+
+    static Storage _storageForVariant(const QVariant& variant);
+
+    template<typename Target, typename T>
+    static bool _fitsIn(T value);
+
+    void _assign(const QVariant& variant);
+    void _copy  (const FactValue& other);
+    void _clear (void);
+    bool _numericEquals(const FactValue& other) const;
+
+    union {
+        int         _int = 0;
+        uint        _uint;
+        qlonglong   _longLong;
+        qulonglong  _uLongLong;
+        float       _float;
+        double      _double;
+        bool        _bool;
+        QVariant*   _variant;
+    };
+    Storage _storage = StorageInt;
+};
+
+template<typename Target, typename T>
+bool FactValue::_fitsIn(T value)
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return true;
+    } else if constexpr (std::is_signed_v<T> && !std::is_signed_v<Target>) {
+        return (value >= 0) && (static_cast<std::make_unsigned_t<T>>(value) <= std::numeric_limits<Target>::max());
+    } else if constexpr (!std::is_signed_v<T> && std::is_signed_v<Target>) {
+        return value <= static_cast<std::make_unsigned_t<Target>>(std::numeric_limits<Target>::max());
+    } else {
+        return (value >= std::numeric_limits<Target>::min()) && (value <= std::numeric_limits<Target>::max());
+    }
+}
+
+template<typename T>
+bool FactValue::setNumeric(FactMetaData::ValueType_t type, T value)
+{
+    static_assert(std::is_arithmetic_v<T>, "FactValue::setNumeric requires an arithmetic type");
+
+    // Floating point to integer conversions as well as out of range integers are left to QVariant which
+    // rounds and range checks them.
+    switch (type) {
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        if constexpr (std::is_integral_v<T>) {
+            if (_fitsIn<int>(value)) {
+                _clear();
+                _storage = StorageInt;
+                _int = static_cast<int>(value);
+                return true;
+            }
+        }
+        break;
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        if constexpr (std::is_integral_v<T>) {
+            if (_fitsIn<uint>(value)) {
+                _clear();
+                _storage = StorageUInt;
+                _uint = static_cast<uint>(value);
+                return true;
+            }
+        }
+        break;
+    case FactMetaData::valueTypeInt64:
+        if constexpr (std::is_integral_v<T>) {
+            if (_fitsIn<qlonglong>(value)) {
+                _clear();
+                _storage = StorageLongLong;
+                _longLong = static_cast<qlonglong>(value);
+                return true;
+            }
+        }
+        break;
+    case FactMetaData::valueTypeUint64:
+        if constexpr (std::is_integral_v<T>) {
+            if (_fitsIn<qulonglong>(value)) {
+                _clear();
+                _storage = StorageULongLong;
+                _uLongLong = static_cast<qulonglong>(value);
+                return true;
+            }
+        }
+        break;
+    case FactMetaData::valueTypeFloat:
+        _clear();
+        _storage = StorageFloat;
+        _float = static_cast<float>(value);
+        return true;
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+    case FactMetaData::valueTypeDouble:
+        _clear();
+        _storage = StorageDouble;
+        _double = static_cast<double>(value);
+        return true;
+    case FactMetaData::valueTypeBool:
+        _clear();
+        _storage = StorageBool;
+        _bool = (value != 0);
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
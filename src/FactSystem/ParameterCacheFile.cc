@@ -0,0 +1,283 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCacheFile.h"
+#include "QGC.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QSaveFile>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(ParameterCacheFileLog, "ParameterCacheFileLog")
+
+struct ParameterCacheFile::Header {
+    char    magic[4];
+    quint32 version;
+    quint32 entryCount;
+    quint32 hashCrc;
+    quint32 namesOffset;
+    quint32 namesSize;
+    quint32 contentCrc;
+    quint32 reserved;
+};
+
+struct ParameterCacheFile::FileEntry {
+    quint32 nameOffset;
+    quint8  nameLength;
+    quint8  type;
+    quint16 reserved;
+    quint32 reserved2;
+    char    value[8];
+};
+
+static constexpr char _magic[4] = { 'Q', 'G', 'P', 'C' };
+
+ParameterCacheFile::~ParameterCacheFile()
+{
+    close();
+}
+
+bool ParameterCacheFile::write(const QString& fileName, const QList<Entry>& entries, quint32 hashCrc)
+{
+    static_assert(sizeof(Header) == 32, "ParameterCacheFile::Header layout changed");
+    static_assert(sizeof(FileEntry) == 20, "ParameterCacheFile::FileEntry layout changed");
+
+    QByteArray names;
+    QList<FileEntry> fileEntries;
+    fileEntries.reserve(entries.count());
+
+    for (const Entry& entry: entries) {
+        const QByteArray name = entry.name.toLatin1();
+        const size_t valueSize = FactMetaData::typeToSize(entry.type);
+        if (name.isEmpty() || (name.size() > 255) || (valueSize == 0) || (valueSize > sizeof(FileEntry::value))) {
+            qCWarning(ParameterCacheFileLog) << "Parameter can't be cached" << entry.name << entry.type;
+            return false;
+        }
+
+        FileEntry fileEntry{};
+        fileEntry.nameOffset = static_cast<quint32>(names.size());
+        fileEntry.nameLength = static_cast<quint8>(name.size());
+        fileEntry.type = static_cast<quint8>(entry.type);
+        // QVariant holds the smaller integer types widened to int/uint, the leading bytes are the value just as the
+        // _HASH_CHECK crc reads them
+        memcpy(fileEntry.value, entry.rawValue.constData(), qMin(valueSize, static_cast<size_t>(entry.rawValue.metaType().sizeOf())));
+
+        names.append(name);
+        fileEntries.append(fileEntry);
+    }
+
+    Header header{};
+    memcpy(header.magic, _magic, sizeof(header.magic));
+    header.version = version;
+    header.entryCount = static_cast<quint32>(fileEntries.count());
+    header.hashCrc = hashCrc;
+    header.namesOffset = static_cast<quint32>(sizeof(Header) + (fileEntries.count() * sizeof(FileEntry)));
+    header.namesSize = static_cast<quint32>(names.size());
+
+    QByteArray content(reinterpret_cast<const char*>(fileEntries.constData()), fileEntries.count() * sizeof(FileEntry));
+    content.append(names);
+    header.contentCrc = QGC::crc32(reinterpret_cast<const quint8*>(content.constData()), static_cast<unsigned>(content.size()), 0);
+
+    // Written to a temporary file first so a crash never leaves a partial cache behind
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(ParameterCacheFileLog) << "Unable to open cache file" << fileName << file.errorString();
+        return false;
+    }
+    (void) file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    (void) file.write(content);
+
+    return file.commit();
+}
+
+bool ParameterCacheFile::open(const QString& fileName)
+{
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    _size = _file.size();
+    if (_size < static_cast<qint64>(sizeof(Header))) {
+        qCWarning(ParameterCacheFileLog) << "Cache file too small" << fileName;
+        close();
+        return false;
+    }
+
+    _data = _file.map(0, _size);
+    if (!_data) {
+        qCWarning(ParameterCacheFileLog) << "Unable to map cache file" << fileName << _file.errorString();
+        close();
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, _data, sizeof(header));
+    const qint64 entriesEnd = static_cast<qint64>(sizeof(Header)) + (static_cast<qint64>(header.entryCount) * static_cast<qint64>(sizeof(FileEntry)));
+    if ((memcmp(header.magic, _magic, sizeof(_magic)) != 0) || (header.version != version) ||
+            (header.namesOffset != entriesEnd) || ((static_cast<qint64>(header.namesOffset) + header.namesSize) != _size)) {
+        qCDebug(ParameterCacheFileLog) << "Cache file header mismatch" << fileName << header.version;
+        close();
+        return false;
+    }
+
+    const quint32 contentCrc = QGC::crc32(_data + sizeof(Header), static_cast<unsigned>(_size - static_cast<qint64>(sizeof(Header))), 0);
+    if (contentCrc != header.contentCrc) {
+        qCWarning(ParameterCacheFileLog) << "Cache file checksum mismatch" << fileName;
+        close();
+        return false;
+    }
+
+    _entryCount = header.entryCount;
+    _hashCrc = header.hashCrc;
+    _names = reinterpret_cast<const char*>(_data) + header.namesOffset;
+
+    for (quint32 index = 0; index < _entryCount; index++) {
+        const FileEntry* entry = _entry(static_cast<int>(index));
+        if ((static_cast<quint64>(entry->nameOffset) + entry->nameLength) > header.namesSize) {
+            qCWarning(ParameterCacheFileLog) << "Cache file name table corrupt" << fileName;
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ParameterCacheFile::close(void)
+{
+    if (_data) {
+        (void) _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+    _size = 0;
+    _entryCount = 0;
+    _hashCrc = 0;
+    _names = nullptr;
+}
+
+const ParameterCacheFile::FileEntry* ParameterCacheFile::_entry(int index) const
+{
+    return reinterpret_cast<const FileEntry*>(_data + sizeof(Header)) + index;
+}
+
+QLatin1String ParameterCacheFile::_nameView(int index) const
+{
+    const FileEntry* entry = _entry(index);
+    return QLatin1String(_names + entry->nameOffset, entry->nameLength);
+}
+
+QString ParameterCacheFile::name(int index) const
+{
+    return QString(_nameView(index));
+}
+
+FactMetaData::ValueType_t ParameterCacheFile::type(int index) const
+{
+    return static_cast<FactMetaData::ValueType_t>(_entry(index)->type);
+}
+
+const char* ParameterCacheFile::valueData(int index) const
+{
+    return _entry(index)->value;
+}
+
+QVariant ParameterCacheFile::rawValue(int index) const
+{
+    const char* value = valueData(index);
+
+    switch (type(index)) {
+    case FactMetaData::valueTypeInt8:
+    {
+        qint8 int8;
+        memcpy(&int8, value, sizeof(int8));
+        return QVariant(static_cast<int>(int8));
+    }
+    case FactMetaData::valueTypeInt16:
+    {
+        qint16 int16;
+        memcpy(&int16, value, sizeof(int16));
+        return QVariant(static_cast<int>(int16));
+    }
+    case FactMetaData::valueTypeInt32:
+    {
+        qint32 int32;
+        memcpy(&int32, value, sizeof(int32));
+        return QVariant(static_cast<int>(int32));
+    }
+    case FactMetaData::valueTypeUint8:
+    {
+        quint8 uint8;
+        memcpy(&uint8, value, sizeof(uint8));
+        return QVariant(static_cast<uint>(uint8));
+    }
+    case FactMetaData::valueTypeUint16:
+    {
+        quint16 uint16;
+        memcpy(&uint16, value, sizeof(uint16));
+        return QVariant(static_cast<uint>(uint16));
+    }
+    case FactMetaData::valueTypeUint32:
+    {
+        quint32 uint32;
+        memcpy(&uint32, value, sizeof(uint32));
+        return QVariant(static_cast<uint>(uint32));
+    }
+    case FactMetaData::valueTypeInt64:
+    {
+        qint64 int64;
+        memcpy(&int64, value, sizeof(int64));
+        return QVariant(static_cast<qlonglong>(int64));
+    }
+    case FactMetaData::valueTypeUint64:
+    {
+        quint64 uint64;
+        memcpy(&uint64, value, sizeof(uint64));
+        return QVariant(static_cast<qulonglong>(uint64));
+    }
+    case FactMetaData::valueTypeFloat:
+    {
+        float flt;
+        memcpy(&flt, value, sizeof(flt));
+        return QVariant(flt);
+    }
+    case FactMetaData::valueTypeDouble:
+    {
+        double dbl;
+        memcpy(&dbl, value, sizeof(dbl));
+        return QVariant(dbl);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+int ParameterCacheFile::indexOf(const QString& name) const
+{
+    // Entries are sorted by name
+    int low = 0;
+    int high = count() - 1;
+    while (low <= high) {
+        const int mid = low + ((high - low) / 2);
+        const int result = QString::compare(_nameView(mid), name);
+        if (result == 0) {
+            return mid;
+        } else if (result < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
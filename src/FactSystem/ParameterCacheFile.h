@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FactMetaData.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QString>
+#include <QtCore/QVariant>
+
+Q_DECLARE_LOGGING_CATEGORY(ParameterCacheFileLog)
+
+/// Binary, memory mapped parameter cache for a single vehicle component.
+/// Layout, in host byte order since the cache never leaves the machine:
+///     Header      magic, version, entry count, vehicle hash (_HASH_CHECK) of the cached set, name table location,
+///                 crc32 of everything after the header
+///     Entries     fixed size, sorted by name: name table offset/length, FactMetaData::ValueType_t, value bytes
+///     Names       Latin-1 parameter names, not terminated
+/// The vehicle hash can be checked as soon as the file is opened, entries are only decoded when asked for.
+class ParameterCacheFile
+{
+public:
+    ParameterCacheFile() = default;
+    ~ParameterCacheFile();
+
+    ParameterCacheFile(const ParameterCacheFile&) = delete;
+    ParameterCacheFile& operator=(const ParameterCacheFile&) = delete;
+
+    struct Entry {
+        QString                     name;
+        FactMetaData::ValueType_t   type;
+        QVariant                    rawValue;
+    };
+
+    static constexpr quint32 version = 3;
+
+    /// Writes entries, which must be sorted by name, to fileName. fileName must not be open, Windows can't replace a
+    /// mapped file.
+    ///     @param hashCrc _HASH_CHECK value for the set of entries
+    static bool write(const QString& fileName, const QList<Entry>& entries, quint32 hashCrc);
+
+    /// Maps fileName and validates its header and checksum
+    bool open(const QString& fileName);
+    void close(void);
+
+    bool isOpen(void) const { return _data != nullptr; }
+
+    int     count   (void) const { return static_cast<int>(_entryCount); }
+    quint32 hashCrc (void) const { return _hashCrc; }
+
+    QString                     name    (int index) const;
+    FactMetaData::ValueType_t   type    (int index) const;
+    QVariant                    rawValue(int index) const;
+
+    /// @return Index of name, -1 if not found
+    int indexOf(const QString& name) const;
+
+    /// @return Value bytes in the layout QGC::crc32 hashes for the _HASH_CHECK, FactMetaData::typeToSize(type) long
+    const char* valueData(int index) const;
+
+private:
+    struct Header;
+    struct FileEntry;
+
+    const FileEntry* _entry(int index) const;
+    QLatin1String _nameView(int index) const;
+
+    QFile           _file;
+    const uchar*    _data           = nullptr;
+    qint64          _size           = 0;
+    quint32         _entryCount     = 0;
+    quint32         _hashCrc        = 0;
+    const char*     _names          = nullptr;
+};
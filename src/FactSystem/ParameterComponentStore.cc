@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterComponentStore.h"
+
+#include <QtCore/QHashFunctions>
+
+#include <algorithm>
+
+void ParameterWaitSet::insert(int key)
+{
+    if (key < 0) {
+        return;
+    }
+
+    if (key >= _waiting.size()) {
+        // Grow geometrically since name ids are added one at a time
+        const int newSize = qMax(key + 1, static_cast<int>(_waiting.size()) * 2);
+        _waiting.resize(newSize);
+        _retryCounts.resize(newSize);
+    }
+
+    if (!_waiting.testBit(key)) {
+        _waiting.setBit(key);
+        _count++;
+    }
+    _retryCounts[key] = 0;
+}
+
+void ParameterWaitSet::remove(int key)
+{
+    if (contains(key)) {
+        _waiting.clearBit(key);
+        _count--;
+    }
+}
+
+void ParameterWaitSet::clear(void)
+{
+    _waiting.fill(false);
+    _count = 0;
+}
+
+QList<int> ParameterWaitSet::keys(void) const
+{
+    QList<int> keys;
+
+    keys.reserve(_count);
+    for (int key = 0; (key < _waiting.size()) && (keys.count() < _count); key++) {
+        if (_waiting.testBit(key)) {
+            keys.append(key);
+        }
+    }
+
+    return keys;
+}
+
+int ParameterComponentStore::nameId(const QString& name) const
+{
+    if (_slots.isEmpty()) {
+        return invalidNameId;
+    }
+
+    // The index is never more than half full so there is always an empty slot to stop the probe
+    const size_t hash = qHash(name);
+    const qsizetype mask = _slots.count() - 1;
+    for (qsizetype slot = static_cast<qsizetype>(hash) & mask; ; slot = (slot + 1) & mask) {
+        const int id = _slots[slot];
+        if (id == invalidNameId) {
+            return invalidNameId;
+        }
+        if ((_hashes[id] == hash) && (_names[id] == name)) {
+            return id;
+        }
+    }
+}
+
+int ParameterComponentStore::internName(const QString& name)
+{
+    int id = nameId(name);
+    if (id != invalidNameId) {
+        return id;
+    }
+
+    id = static_cast<int>(_names.count());
+    _names.append(name);
+    _hashes.append(qHash(name));
+    _facts.append(nullptr);
+    _cacheIndices.append(-1);
+
+    if ((_names.count() * 2) > _slots.count()) {
+        _rehash(qMax(qsizetype(64), _slots.count() * 2));
+    } else {
+        _insertSlot(id);
+    }
+
+    return id;
+}
+
+Fact* ParameterComponentStore::fact(const QString& name) const
+{
+    const int id = nameId(name);
+    return (id == invalidNameId) ? nullptr : _facts[id];
+}
+
+bool ParameterComponentStore::hasParameter(const QString& name) const
+{
+    const int id = nameId(name);
+    return (id != invalidNameId) && hasParameter(id);
+}
+
+void ParameterComponentStore::setFact(int nameId, Fact* fact)
+{
+    const bool hadParameter = hasParameter(nameId);
+    _facts[nameId] = fact;
+    // The Fact now holds the value
+    _cacheIndices[nameId] = -1;
+    _updateFactCount(nameId, hadParameter);
+}
+
+void ParameterComponentStore::setCacheIndex(int nameId, int cacheIndex)
+{
+    const bool hadParameter = hasParameter(nameId);
+    _cacheIndices[nameId] = cacheIndex;
+    _updateFactCount(nameId, hadParameter);
+}
+
+void ParameterComponentStore::_updateFactCount(int nameId, bool hadParameter)
+{
+    if (!hadParameter && hasParameter(nameId)) {
+        _factCount++;
+    } else if (hadParameter && !hasParameter(nameId)) {
+        _factCount--;
+    }
+}
+
+QStringList ParameterComponentStore::factNames(void) const
+{
+    QStringList names;
+
+    names.reserve(_factCount);
+    for (int id = 0; id < _names.count(); id++) {
+        if (hasParameter(id)) {
+            names.append(_names[id]);
+        }
+    }
+    names.sort();
+
+    return names;
+}
+
+void ParameterComponentStore::waitForAllIndices(void)
+{
+    pendingIndexRequests.clear();
+    for (int paramIndex = 0; paramIndex < paramCount; paramIndex++) {
+        // This will add a new waiting index if needed and set the retry count for that index to 0
+        readIndexWaits.insert(paramIndex);
+        (void) pendingIndexRequests.insert(pendingIndexRequests.end(), paramIndex);
+    }
+    requestWindow.clearInFlight();
+}
+
+void ParameterComponentStore::clearIndexWaits(void)
+{
+    readIndexWaits.clear();
+    pendingIndexRequests.clear();
+    requestWindow.clearInFlight();
+}
+
+void ParameterComponentStore::requeueIndices(const QList<int>& paramIndices)
+{
+    for (const int paramIndex: paramIndices) {
+        if (readIndexWaits.contains(paramIndex)) {
+            (void) pendingIndexRequests.insert(paramIndex);
+        }
+    }
+}
+
+QList<int> ParameterComponentStore::sortedFactIds(void) const
+{
+    QList<int> ids;
+
+    ids.reserve(_factCount);
+    for (int id = 0; id < _names.count(); id++) {
+        if (hasParameter(id)) {
+            ids.append(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end(), [this](int id1, int id2) { return _names[id1] < _names[id2]; });
+
+    return ids;
+}
+
+void ParameterComponentStore::_insertSlot(int nameId)
+{
+    const qsizetype mask = _slots.count() - 1;
+    qsizetype slot = static_cast<qsizetype>(_hashes[nameId]) & mask;
+    while (_slots[slot] != invalidNameId) {
+        slot = (slot + 1) & mask;
+    }
+    _slots[slot] = nameId;
+}
+
+void ParameterComponentStore::_rehash(qsizetype slotCount)
+{
+    _slots.fill(invalidNameId, slotCount);
+    for (int id = 0; id < _names.count(); id++) {
+        _insertSlot(id);
+    }
+}
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "ParameterRequestWindow.h"
+
+#include <QtCore/QBitArray>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <memory>
+#include <set>
+
+class Fact;
+class ParameterCacheFile;
+
+/// Set of small integer keys (parameter indices or name ids) which are waiting on a response, each with a retry count
+class ParameterWaitSet
+{
+public:
+    bool contains(int key) const { return (key >= 0) && (key < _waiting.size()) && _waiting.testBit(key); }
+
+    /// Adds the key if needed and resets its retry count to 0
+    void insert(int key);
+    void remove(int key);
+    void clear (void);
+
+    int retryCount      (int key) const { return _retryCounts[key]; }
+    int bumpRetryCount  (int key) { return ++_retryCounts[key]; }
+
+    int count(void) const { return _count; }
+
+    /// @return Waiting keys in ascending order
+    QList<int> keys(void) const;
+
+private:
+    QBitArray   _waiting;
+    QList<int>  _retryCounts;
+    int         _count = 0;
+};
+
+/// Parameters of a single component.
+/// Each distinct parameter name is interned once and given a small integer id which indexes the contiguous name and
+/// Fact arrays as well as the name based wait sets. Names are found through an open addressing (linear probing) hash
+/// index over those ids. An interned name does not need to have a Fact yet, for example when a read is requested for
+/// a parameter which has not been received. A parameter loaded from the cache file only records its cache entry until
+/// its Fact is asked for.
+class ParameterComponentStore
+{
+public:
+    static constexpr int invalidNameId = -1;
+
+    /// @return Id for name, invalidNameId if the name has not been interned
+    int nameId(const QString& name) const;
+
+    /// @return Id for name, interning the name if needed
+    int internName(const QString& name);
+
+    const QString&  name        (int nameId) const { return _names[nameId]; }
+    int             nameCount   (void) const { return static_cast<int>(_names.count()); }
+
+    Fact*   fact    (int nameId) const { return _facts[nameId]; }
+    Fact*   fact    (const QString& name) const;
+    void    setFact (int nameId, Fact* fact);
+
+    /// @return Index of the parameter in cacheFile, -1 if it is not a cached parameter waiting for its Fact
+    int     cacheIndex      (int nameId) const { return _cacheIndices[nameId]; }
+    void    setCacheIndex   (int nameId, int cacheIndex);
+
+    /// @return true: name id has a Fact or a cache entry to create it from
+    bool    hasParameter    (int nameId) const { return _facts[nameId] || (_cacheIndices[nameId] >= 0); }
+    bool    hasParameter    (const QString& name) const;
+
+    /// @return Number of parameters, including the ones which don't have a Fact yet
+    int factCount(void) const { return _factCount; }
+
+    /// @return Parameter names, sorted
+    QStringList factNames(void) const;
+
+    /// @return Ids of the parameters, sorted by name
+    QList<int> sortedFactIds(void) const;
+
+    /// Puts every parameter index on the read wait list with nothing in flight
+    void waitForAllIndices(void);
+    /// Nothing is left to read by index
+    void clearIndexWaits(void);
+    /// Puts the indices which are still waiting back in line for a re-request
+    void requeueIndices(const QList<int>& paramIndices);
+
+    bool                    initialized = false;    ///< true: Parameter count is known and the index wait set has been setup
+    int                     paramCount = 0;         ///< Parameter count reported by the component
+    ParameterWaitSet        readIndexWaits;         ///< Keyed by parameter index
+    ParameterWaitSet        readNameWaits;          ///< Keyed by name id
+    ParameterWaitSet        writeNameWaits;         ///< Keyed by name id
+    ParameterRequestWindow  requestWindow;          ///< Index based re-requests in flight, keyed by parameter index
+    std::set<int>           pendingIndexRequests;   ///< readIndexWaits without a request in flight, in index order
+    std::shared_ptr<const ParameterCacheFile> cacheFile;   ///< Cache the parameters were loaded from, nullptr if none
+
+private:
+    void _insertSlot(int nameId);
+    void _rehash    (qsizetype slotCount);
+    void _updateFactCount(int nameId, bool hadParameter);
+
+    QList<QString>  _names;
+    QList<size_t>   _hashes;
+    QList<Fact*>    _facts;
+    QList<int>      _cacheIndices;
+    QList<int>      _slots;         ///< Hash index, power of two size, invalidNameId for an empty slot
+    int             _factCount = 0;
+};
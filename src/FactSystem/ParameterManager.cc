@@ -98,9 +98,11 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     connect(&_initialRequestTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_initialRequestTimeout);
 
     _waitingParamTimeoutTimer.setSingleShot(true);
-    _waitingParamTimeoutTimer.setInterval(3000);
+    _waitingParamTimeoutTimer.setInterval(_waitingParamTimeoutMSecs);
     connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
 
+    _requestClock.start();
+
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 }
@@ -111,14 +113,10 @@ void ParameterManager::_updateProgressBar(void)
     int waitingReadParamNameCount = 0;
     int waitingWriteParamCount = 0;
 
-    for (int compId: _waitingReadParamIndexMap.keys()) {
-        waitingReadParamIndexCount += _waitingReadParamIndexMap[compId].count();
-    }
-    for(int compId: _waitingReadParamNameMap.keys()) {
-        waitingReadParamNameCount += _waitingReadParamNameMap[compId].count();
-    }
-    for(int compId: _waitingWriteParamNameMap.keys()) {
-        waitingWriteParamCount += _waitingWriteParamNameMap[compId].count();
+    for (const ParameterComponentStore& store: _componentStores) {
+        waitingReadParamIndexCount += store.readIndexWaits.count();
+        waitingReadParamNameCount += store.readNameWaits.count();
+        waitingWriteParamCount += store.writeNameWaits.count();
     }
 
     if (waitingReadParamIndexCount == 0) {
@@ -163,7 +161,7 @@ void ParameterManager::_updateProgressBar(void)
 }
 
 
-void ParameterManager::mavlinkMessageReceived(mavlink_message_t message)
+void ParameterManager::mavlinkMessageReceived(const mavlink_message_t& message)
 {
     if (_tryftp && message.compid == MAV_COMP_ID_AUTOPILOT1 && !_initialLoadComplete)
         return;
@@ -282,49 +280,45 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     _initialRequestTimeoutTimer.stop();
     _waitingParamTimeoutTimer.stop();
 
-    // Update our total parameter counts
-    if (!_paramCountMap.contains(componentId)) {
-        _paramCountMap[componentId] = parameterCount;
+    ParameterComponentStore& store = _componentStores[componentId];
+
+    // If we've never seen this component id before, update our total parameter count and setup the index wait list
+    if (!store.initialized) {
+        store.initialized = true;
+        store.paramCount = parameterCount;
         _totalParamCount += parameterCount;
-    }
 
-    // If we've never seen this component id before, setup the index wait lists.
-    if (!_waitingReadParamIndexMap.contains(componentId)) {
         // Add all indices to the wait list, parameter index is 0-based
-        for (int waitingIndex=0; waitingIndex<parameterCount; waitingIndex++) {
-            // This will add the new component id, as well as the the new waiting index and set the retry count for that index to 0
-            _waitingReadParamIndexMap[componentId][waitingIndex] = 0;
-        }
-
-        // The read and write waiting lists for this component are initialized the empty
-        _waitingReadParamNameMap[componentId] = QMap<QString, int>();
-        _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
+        store.waitForAllIndices();
 
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Seeing component for first time - paramcount:" << parameterCount;
     }
 
-    if (!_waitingReadParamIndexMap[componentId].contains(parameterIndex) &&
-            !_waitingReadParamNameMap[componentId].contains(parameterName) &&
-            !_waitingWriteParamNameMap[componentId].contains(parameterName)) {
+    const int nameId = store.internName(parameterName);
+
+    if (!store.readIndexWaits.contains(parameterIndex) &&
+            !store.readNameWaits.contains(nameId) &&
+            !store.writeNameWaits.contains(nameId)) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Unrequested param update" << parameterName;
     }
 
     // Remove this parameter from the waiting lists
-    if (_waitingReadParamIndexMap[componentId].contains(parameterIndex)) {
-        _waitingReadParamIndexMap[componentId].remove(parameterIndex);
-        _indexBatchQueue.removeOne(parameterIndex);
+    if (store.readIndexWaits.contains(parameterIndex)) {
+        store.readIndexWaits.remove(parameterIndex);
+        (void) store.pendingIndexRequests.erase(parameterIndex);
+        store.requestWindow.responseReceived(parameterIndex, _requestClock.elapsed());
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
-    _waitingReadParamNameMap[componentId].remove(parameterName);
-    _waitingWriteParamNameMap[componentId].remove(parameterName);
-    if (_waitingReadParamIndexMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
+    store.readNameWaits.remove(nameId);
+    store.writeNameWaits.remove(nameId);
+    if (store.readIndexWaits.count() && ParameterManagerVerbose2Log().isDebugEnabled()) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "readIndexWaits:" << store.readIndexWaits.keys();
     }
-    if (_waitingReadParamNameMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
+    if (store.readNameWaits.count()) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "readNameWaits" << _waitingNames(store, store.readNameWaits);
     }
-    if (_waitingWriteParamNameMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingWriteParamNameMap" << _waitingWriteParamNameMap[componentId];
+    if (store.writeNameWaits.count()) {
+        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "writeNameWaits" << _waitingNames(store, store.writeNameWaits);
     }
 
     // Track how many parameters we are still waiting for
@@ -333,23 +327,17 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     int waitingReadParamNameCount = 0;
     int waitingWriteParamNameCount = 0;
 
-    for(int waitingComponentId: _waitingReadParamIndexMap.keys()) {
-        waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].count();
+    for (const ParameterComponentStore& waitingStore: _componentStores) {
+        waitingReadParamIndexCount += waitingStore.readIndexWaits.count();
+        waitingReadParamNameCount += waitingStore.readNameWaits.count();
+        waitingWriteParamNameCount += waitingStore.writeNameWaits.count();
     }
     if (waitingReadParamIndexCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamIndexCount:" << waitingReadParamIndexCount;
     }
-
-    for(int waitingComponentId: _waitingReadParamNameMap.keys()) {
-        waitingReadParamNameCount += _waitingReadParamNameMap[waitingComponentId].count();
-    }
     if (waitingReadParamNameCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamNameCount:" << waitingReadParamNameCount;
     }
-
-    for(int waitingComponentId: _waitingWriteParamNameMap.keys()) {
-        waitingWriteParamNameCount += _waitingWriteParamNameMap[waitingComponentId].count();
-    }
     if (waitingWriteParamNameCount) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingWriteParamNameCount:" << waitingWriteParamNameCount;
     }
@@ -361,7 +349,7 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         _waitingParamTimeoutTimer.start();
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
     } else {
-        if (!_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
+        if (!_hasComponentFacts(_vehicle->defaultComponentId())) {
             // Still waiting for parameters from default component
             qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer (still waiting for default component params)";
             _waitingParamTimeoutTimer.start();
@@ -372,22 +360,11 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
 
     _updateProgressBar();
 
-    Fact* fact = nullptr;
-    if (_mapCompId2FactMap.contains(componentId) && _mapCompId2FactMap[componentId].contains(parameterName)) {
-        fact = _mapCompId2FactMap[componentId][parameterName];
-    } else {
+    Fact* fact = store.fact(nameId);
+    if (!fact) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
-        fact = new Fact(componentId, parameterName, mavTypeToFactType(mavParamType), this);
-        FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(parameterName, fact->type());
-        fact->setMetaData(factMetaData);
-
-        _mapCompId2FactMap[componentId][parameterName] = fact;
-
-        // We need to know when the fact value changes so we can update the vehicle
-        connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
-
-        emit factAdded(componentId, fact);
+        fact = _createFact(componentId, store, nameId, mavTypeToFactType(mavParamType));
     }
 
     fact->_containerSetRawValue(parameterValue);
@@ -414,13 +391,13 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
 /// Writes the parameter update to mavlink, sets up for write wait
 void ParameterManager::_factRawValueUpdateWorker(int componentId, const QString& name, FactMetaData::ValueType_t valueType, const QVariant& rawValue)
 {
-    if (_waitingWriteParamNameMap.contains(componentId)) {
-        if (_waitingWriteParamNameMap[componentId].contains(name)) {
-            _waitingWriteParamNameMap[componentId].remove(name);
-        } else {
+    ParameterComponentStore* store = _componentStore(componentId);
+    if (store && store->initialized) {
+        const int nameId = store->internName(name);
+        if (!store->writeNameWaits.contains(nameId)) {
             _waitingWriteParamBatchCount++;
         }
-        _waitingWriteParamNameMap[componentId][name] = 0; // Add new entry and set retry count
+        store->writeNameWaits.insert(nameId); // Add new entry and set retry count
         _updateProgressBar();
         _waitingParamTimeoutTimer.start();
         _saveRequired = true;
@@ -535,14 +512,11 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
         }
     } else {
         // Reset index wait lists
-        for (int cid: _paramCountMap.keys()) {
+        for (auto it = _componentStores.begin(); it != _componentStores.end(); it++) {
             // Add/Update all indices to the wait list, parameter index is 0-based
-            if(componentId != MAV_COMP_ID_ALL && componentId != cid)
+            if (!it->initialized || (componentId != MAV_COMP_ID_ALL && componentId != it.key()))
                 continue;
-            for (int waitingIndex = 0; waitingIndex < _paramCountMap[cid]; waitingIndex++) {
-                // This will add a new waiting index if needed and set the retry count for that index to 0
-                _waitingReadParamIndexMap[cid][waitingIndex] = 0;
-            }
+            it->waitForAllIndices();
         }
         MAVLinkProtocol*        mavlink = qgcApp()->toolbox()->mavlinkProtocol();
         mavlink_message_t       msg;
@@ -578,15 +552,14 @@ void ParameterManager::refreshParameter(int componentId, const QString& paramNam
     componentId = _actualComponentId(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "refreshParameter - name:" << paramName << ")";
 
-    if (_waitingReadParamNameMap.contains(componentId)) {
-        QString mappedParamName = _remapParamNameToVersion(paramName);
+    ParameterComponentStore* store = _componentStore(componentId);
+    if (store && store->initialized) {
+        const int nameId = store->internName(_remapParamNameToVersion(paramName));
 
-        if (_waitingReadParamNameMap[componentId].contains(mappedParamName)) {
-            _waitingReadParamNameMap[componentId].remove(mappedParamName);
-        } else {
+        if (!store->readNameWaits.contains(nameId)) {
             _waitingReadParamNameBatchCount++;
         }
-        _waitingReadParamNameMap[componentId][mappedParamName] = 0;     // Add new wait entry and update retry count
+        store->readNameWaits.insert(nameId);    // Add new wait entry and update retry count
         _updateProgressBar();
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "restarting _waitingParamTimeout";
         _waitingParamTimeoutTimer.start();
@@ -602,7 +575,7 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
     componentId = _actualComponentId(componentId);
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "refreshParametersPrefix - name:" << namePrefix << ")";
 
-    for (const QString &paramName: _mapCompId2FactMap[componentId].keys()) {
+    for (const QString &paramName: parameterNames(componentId)) {
         if (paramName.startsWith(namePrefix)) {
             refreshParameter(componentId, paramName);
         }
@@ -611,41 +584,90 @@ void ParameterManager::refreshParametersPrefix(int componentId, const QString& n
 
 bool ParameterManager::parameterExists(int componentId, const QString& paramName)
 {
-    bool ret = false;
+    const ParameterComponentStore* store = _componentStore(_actualComponentId(componentId));
 
-    componentId = _actualComponentId(componentId);
-    if (_mapCompId2FactMap.contains(componentId)) {
-        ret = _mapCompId2FactMap[componentId].contains(_remapParamNameToVersion(paramName));
-    }
-
-    return ret;
+    return store && store->hasParameter(_remapParamNameToVersion(paramName));
 }
 
 Fact* ParameterManager::getParameter(int componentId, const QString& paramName)
 {
     componentId = _actualComponentId(componentId);
 
-    QString mappedParamName = _remapParamNameToVersion(paramName);
-    if (!_mapCompId2FactMap.contains(componentId) || !_mapCompId2FactMap[componentId].contains(mappedParamName)) {
+    const QString mappedParamName = _remapParamNameToVersion(paramName);
+    ParameterComponentStore* store = _componentStore(componentId);
+    const int nameId = store ? store->nameId(mappedParamName) : ParameterComponentStore::invalidNameId;
+    Fact* fact = (nameId != ParameterComponentStore::invalidNameId) ? _fact(componentId, *store, nameId) : nullptr;
+    if (!fact) {
         qgcApp()->reportMissingParameter(componentId, mappedParamName);
         return &_defaultFact;
     }
 
-    return _mapCompId2FactMap[componentId][mappedParamName];
+    return fact;
 }
 
 QStringList ParameterManager::parameterNames(int componentId)
+{
+    const ParameterComponentStore* store = _componentStore(_actualComponentId(componentId));
+
+    return store ? store->factNames() : QStringList();
+}
+
+ParameterComponentStore* ParameterManager::_componentStore(int componentId)
+{
+    auto it = _componentStores.find(componentId);
+    return (it == _componentStores.end()) ? nullptr : &it.value();
+}
+
+/// Returns the Fact for a parameter, creating it from the parameter cache the first time it is asked for
+Fact* ParameterManager::_fact(int componentId, ParameterComponentStore& store, int nameId)
+{
+    Fact* fact = store.fact(nameId);
+    const int cacheIndex = store.cacheIndex(nameId);
+    if (!fact && store.cacheFile && (cacheIndex >= 0)) {
+        const QVariant rawValue = store.cacheFile->rawValue(cacheIndex);
+        fact = _createFact(componentId, store, nameId, store.cacheFile->type(cacheIndex));
+        fact->_containerSetRawValue(rawValue);
+    }
+
+    return fact;
+}
+
+/// Creates the Fact for an interned parameter name, replacing its cache entry if it has one
+Fact* ParameterManager::_createFact(int componentId, ParameterComponentStore& store, int nameId, FactMetaData::ValueType_t type)
+{
+    Fact* fact = new Fact(componentId, store.name(nameId), type, this);
+    FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(fact->name(), fact->type());
+    fact->setMetaData(factMetaData);
+
+    store.setFact(nameId, fact);
+
+    // We need to know when the fact value changes so we can update the vehicle
+    connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
+
+    emit factAdded(componentId, fact);
+
+    return fact;
+}
+
+bool ParameterManager::_hasComponentFacts(int componentId) const
+{
+    auto it = _componentStores.constFind(componentId);
+    return (it != _componentStores.constEnd()) && (it->factCount() != 0);
+}
+
+QStringList ParameterManager::_waitingNames(const ParameterComponentStore& store, const ParameterWaitSet& waitSet) const
 {
     QStringList names;
 
-    for(const QString &paramName: _mapCompId2FactMap[_actualComponentId(componentId)].keys()) {
-        names << paramName;
+    for (int nameId: waitSet.keys()) {
+        names << store.name(nameId);
     }
 
     return names;
 }
 
-/// Requests missing index based parameters from the vehicle.
+/// Requests missing index based parameters from the vehicle. Each component has its own request window, so all
+/// components are re-requested from concurrently.
 ///     @param waitingParamTimeout: true: being called due to timeout, false: being called to re-fill the batch queue
 /// return true: Parameters were requested, false: No more requests needed
 bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
@@ -654,48 +676,84 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         return false;
     }
 
-    const int maxBatchSize = 10;
+    const qint64 nowMSecs = _requestClock.elapsed();
+    bool requestsInFlight = false;
 
     if (waitingParamTimeout) {
-        // We timed out, clear the queue and try again
         qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to timeout";
-        _indexBatchQueue.clear();
     } else {
-        qCDebug(ParameterManagerLog) << "Refilling index based batch queue due to received parameter";
+        qCDebug(ParameterManagerVerbose1Log) << "Refilling index based batch queue due to received parameter";
     }
 
-    for(int componentId: _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
-            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap count" << _waitingReadParamIndexMap[componentId].count();
-            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap" << _waitingReadParamIndexMap[componentId];
-        }
+    for (auto it = _componentStores.begin(); it != _componentStores.end(); it++) {
+        const int componentId = it.key();
+        ParameterWaitSet& readIndexWaits = it->readIndexWaits;
+        ParameterRequestWindow& requestWindow = it->requestWindow;
+        std::set<int>& pendingIndexRequests = it->pendingIndexRequests;
 
-        for(int paramIndex: _waitingReadParamIndexMap[componentId].keys()) {
-            if (_indexBatchQueue.contains(paramIndex)) {
-                // Don't add more than once
-                continue;
+        if (waitingParamTimeout) {
+            // Nothing came back from any of the requests in flight
+            if (requestWindow.inFlightCount()) {
+                it->requeueIndices(requestWindow.timeout());
             }
+        } else {
+            const QList<int> expired = requestWindow.takeExpired(nowMSecs);
+            if (!expired.isEmpty()) {
+                qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Index re-requests lost" << expired;
+                it->requeueIndices(expired);
+            }
+        }
 
-            if (_indexBatchQueue.count() > maxBatchSize) {
-                break;
+        if (readIndexWaits.count()) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "readIndexWaits count" << readIndexWaits.count();
+            if (ParameterManagerVerbose1Log().isDebugEnabled()) {
+                qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "readIndexWaits" << readIndexWaits.keys();
             }
+        }
 
-            _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
-            if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
+        // Only the indices without a request in flight are walked, this runs for every received parameter
+        while (requestWindow.canSend() && !pendingIndexRequests.empty()) {
+            const int paramIndex = *pendingIndexRequests.begin();
+            (void) pendingIndexRequests.erase(pendingIndexRequests.begin());
+
+            const int retryCount = readIndexWaits.bumpRetryCount(paramIndex);
+            if (_disableAllRetries || retryCount > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
                 _failedReadParamIndexMap[componentId] << paramIndex;
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
-                _waitingReadParamIndexMap[componentId].remove(paramIndex);
+                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Giving up on (paramIndex:" << paramIndex << "retryCount:" << retryCount << ")";
+                readIndexWaits.remove(paramIndex);
             } else {
                 // Retry again
-                _indexBatchQueue.append(paramIndex);
+                requestWindow.requestSent(paramIndex, nowMSecs, retryCount > 1 /* retransmit */);
                 _readParameterRaw(componentId, "", paramIndex);
-                qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << _waitingReadParamIndexMap[componentId][paramIndex] << ")";
+                qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Read re-request for (paramIndex:" << paramIndex << "retryCount:" << retryCount << ")";
             }
         }
+
+        if (requestWindow.inFlightCount()) {
+            requestsInFlight = true;
+            qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Request window - size:inFlight:timeout" << requestWindow.size() << requestWindow.inFlightCount() << requestWindow.timeoutMSecs();
+        }
+    }
+
+    _updateWaitingParamTimeoutInterval();
+
+    return requestsInFlight;
+}
+
+/// While index based re-requests are in flight the waiting param timeout follows the measured round trip time of
+/// the slowest component instead of the fixed timeout
+void ParameterManager::_updateWaitingParamTimeoutInterval(void)
+{
+    int intervalMSecs = 0;
+
+    for (const ParameterComponentStore& store: _componentStores) {
+        if (store.requestWindow.inFlightCount()) {
+            intervalMSecs = qMax(intervalMSecs, store.requestWindow.timeoutMSecs());
+        }
     }
 
-    return _indexBatchQueue.count() != 0;
+    _waitingParamTimeoutTimer.setInterval(intervalMSecs ? intervalMSecs : _waitingParamTimeoutMSecs);
 }
 
 void ParameterManager::_waitingParamTimeout(void)
@@ -706,7 +764,6 @@ void ParameterManager::_waitingParamTimeout(void)
 
     bool paramsRequested = false;
     const int maxBatchSize = 10;
-    int batchCount = 0;
 
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_waitingParamTimeout";
 
@@ -716,7 +773,7 @@ void ParameterManager::_waitingParamTimeout(void)
     // First check for any missing parameters from the initial index based load
     paramsRequested = _fillIndexBatchQueue(true /* waitingParamTimeout */);
 
-    if (!paramsRequested && !_waitingForDefaultComponent && !_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
+    if (!paramsRequested && !_waitingForDefaultComponent && !_hasComponentFacts(_vehicle->defaultComponentId())) {
         // Initial load is complete but we still don't have any default component params. Wait one more cycle to see if the
         // any show up.
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer - still don't have default component params" << _vehicle->defaultComponentId();
@@ -729,20 +786,24 @@ void ParameterManager::_waitingParamTimeout(void)
     _checkInitialLoadComplete();
 
     if (!paramsRequested) {
-        for(int componentId: _waitingWriteParamNameMap.keys()) {
-            for(const QString &paramName: _waitingWriteParamNameMap[componentId].keys()) {
+        for (auto it = _componentStores.begin(); it != _componentStores.end(); it++) {
+            const int componentId = it.key();
+            int batchCount = 0;
+            for(int nameId: it->writeNameWaits.keys()) {
+                const QString paramName = it->name(nameId);
                 paramsRequested = true;
-                _waitingWriteParamNameMap[componentId][paramName]++;   // Bump retry count
-                if (_waitingWriteParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
+                const int retryCount = it->writeNameWaits.bumpRetryCount(nameId);
+                if (retryCount <= _maxReadWriteRetry) {
                     Fact* fact = getParameter(componentId, paramName);
                     _sendParamSetToVehicle(componentId, paramName, fact->type(), fact->rawValue());
-                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << _waitingWriteParamNameMap[componentId][paramName] << ")";
+                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << retryCount << ")";
                     if (++batchCount > maxBatchSize) {
-                        goto Out;
+                        // Leave the rest for the next timeout, other components still get their batch
+                        break;
                     }
                 } else {
                     // Exceeded max retry count, notify user
-                    _waitingWriteParamNameMap[componentId].remove(paramName);
+                    it->writeNameWaits.remove(nameId);
                     QString errorMsg = tr("Parameter write failed: veh:%1 comp:%2 param:%3").arg(_vehicle->id()).arg(componentId).arg(paramName);
                     qCDebug(ParameterManagerLog) << errorMsg;
                     qgcApp()->showAppMessage(errorMsg);
@@ -752,19 +813,22 @@ void ParameterManager::_waitingParamTimeout(void)
     }
 
     if (!paramsRequested) {
-        for(int componentId: _waitingReadParamNameMap.keys()) {
-            for(const QString &paramName: _waitingReadParamNameMap[componentId].keys()) {
+        for (auto it = _componentStores.begin(); it != _componentStores.end(); it++) {
+            const int componentId = it.key();
+            int batchCount = 0;
+            for(int nameId: it->readNameWaits.keys()) {
+                const QString paramName = it->name(nameId);
                 paramsRequested = true;
-                _waitingReadParamNameMap[componentId][paramName]++;   // Bump retry count
-                if (_waitingReadParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
+                const int retryCount = it->readNameWaits.bumpRetryCount(nameId);
+                if (retryCount <= _maxReadWriteRetry) {
                     _readParameterRaw(componentId, paramName, -1);
-                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramName:" << paramName << "retryCount:" << _waitingReadParamNameMap[componentId][paramName] << ")";
+                    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramName:" << paramName << "retryCount:" << retryCount << ")";
                     if (++batchCount > maxBatchSize) {
-                        goto Out;
+                        break;
                     }
                 } else {
                     // Exceeded max retry count, notify user
-                    _waitingReadParamNameMap[componentId].remove(paramName);
+                    it->readNameWaits.remove(nameId);
                     QString errorMsg = tr("Parameter read failed: veh:%1 comp:%2 param:%3").arg(_vehicle->id()).arg(componentId).arg(paramName);
                     qCDebug(ParameterManagerLog) << errorMsg;
                     qgcApp()->showAppMessage(errorMsg);
@@ -773,7 +837,6 @@ void ParameterManager::_waitingParamTimeout(void)
         }
     }
 
-Out:
     if (paramsRequested) {
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer - re-request";
         _waitingParamTimeoutTimer.start();
@@ -864,18 +927,67 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
 
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    ParameterComponentStore* store = _componentStore(componentId);
+    if (!store) {
+        return;
+    }
 
-    for (const QString& paramName: _mapCompId2FactMap[componentId].keys()) {
-        const Fact *fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+    QList<ParameterCacheFile::Entry> entries;
+    entries.reserve(store->factCount());
+    for (int nameId: store->sortedFactIds()) {
+        const Fact* fact = store->fact(nameId);
+        if (fact) {
+            entries.append({ store->name(nameId), fact->type(), fact->rawValue() });
+        } else {
+            const int cacheIndex = store->cacheIndex(nameId);
+            entries.append({ store->name(nameId), store->cacheFile->type(cacheIndex), store->cacheFile->rawValue(cacheIndex) });
+        }
     }
 
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    // Windows can't replace a file which is still mapped. The entries hold copies of the cached values, so the previous
+    // mapping is released before the new file replaces it and the parameters without a Fact move over to the new file.
+    store->cacheFile.reset();
 
-    QDataStream ds(&cacheFile);
-    ds << cacheMap;
+    const QString cacheFileName = parameterCacheFile(vehicleId, componentId);
+    auto cacheFile = std::make_shared<ParameterCacheFile>();
+    if (ParameterCacheFile::write(cacheFileName, entries, _paramCacheHashCrc(entries)) && cacheFile->open(cacheFileName)) {
+        for (int cacheIndex = 0; cacheIndex < cacheFile->count(); cacheIndex++) {
+            const int nameId = store->nameId(cacheFile->name(cacheIndex));
+            if (!store->fact(nameId)) {
+                store->setCacheIndex(nameId, cacheIndex);
+            }
+        }
+        store->cacheFile = cacheFile;
+    } else {
+        qCWarning(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Unable to write parameter cache";
+
+        // Nothing is mapped anymore, the parameters still waiting on their Fact get it from the entries instead
+        for (const ParameterCacheFile::Entry& entry: entries) {
+            const int nameId = store->nameId(entry.name);
+            if (!store->fact(nameId)) {
+                _createFact(componentId, *store, nameId, entry.type)->_containerSetRawValue(entry.rawValue);
+            }
+        }
+    }
+}
+
+/// Computes the _HASH_CHECK value the vehicle reports for a parameter set
+quint32 ParameterManager::_paramCacheHashCrc(const QList<ParameterCacheFile::Entry>& entries)
+{
+    quint32 crc32_value = 0;
+
+    for (const ParameterCacheFile::Entry& entry: entries) {
+        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(entry.name, entry.type)->volatileValue()) {
+            // Does not take part in CRC
+            qCDebug(ParameterManagerLog) << "Volatile parameter" << entry.name;
+        } else {
+            const void *vdat = entry.rawValue.constData();
+            crc32_value = QGC::crc32((const uint8_t *)qPrintable(entry.name), entry.name.length(),  crc32_value);
+            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(entry.type), crc32_value);
+        }
+    }
+
+    return crc32_value;
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -886,56 +998,28 @@ QDir ParameterManager::parameterCacheDir()
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
 {
-    return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
+    return parameterCacheDir().filePath(QString("%1_%2.v%3").arg(vehicleId).arg(componentId).arg(ParameterCacheFile::version));
 }
 
 void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
 {
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
-    uint32_t crc32_value = 0;
-    /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
-        /* no local cache, just wait for them to come in*/
+    const QString cacheFileName = parameterCacheFile(vehicleId, componentId);
+    auto cacheFile = std::make_shared<ParameterCacheFile>();
+    if (!cacheFile->open(cacheFileName)) {
+        /* no usable local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
-
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
-
-    /* compute the crc of the local cache to check against the remote */
 
-    for (const QString& name: cacheMap.keys()) {
-        const ParamTypeVal&             paramTypeVal    = cacheMap[name];
-        const FactMetaData::ValueType_t fact_type       = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-
-        if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(name, fact_type)->volatileValue()) {
-            // Does not take part in CRC
-            qCDebug(ParameterManagerLog) << "Volatile parameter" << name;
-        } else {
-            const void *vdat = paramTypeVal.second.constData();
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            crc32_value = QGC::crc32((const uint8_t *)qPrintable(name), name.length(),  crc32_value);
-            crc32_value = QGC::crc32((const uint8_t *)vdat, FactMetaData::typeToSize(fact_type), crc32_value);
-        }
-    }
+    /* the crc of the cached set was computed when the cache was written, nothing needs to be decoded to check it */
+    const uint32_t crc32_value = cacheFile->hashCrc();
 
     /* if the two param set hashes match, just load from the disk */
     if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
-
-        int count = cacheMap.count();
-        int index = 0;
-        for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(fact_type);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
-        }
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFileName).absoluteFilePath());
+
+        _loadParamCache(componentId, cacheFile);
 
         SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
         if (sharedLink) {
@@ -979,8 +1063,12 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFileName).absoluteFilePath());
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
+            CacheMapName2ParamTypeVal cacheMap;
+            for (int cacheIndex = 0; cacheIndex < cacheFile->count(); cacheIndex++) {
+                cacheMap[cacheFile->name(cacheIndex)] = ParamTypeVal(cacheFile->type(cacheIndex), cacheFile->rawValue(cacheIndex));
+            }
             _debugCacheCRC[componentId] = true;
             _debugCacheMap[componentId] = cacheMap;
             for (const QString& name: cacheMap.keys()) {
@@ -991,6 +1079,52 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     }
 }
 
+/// Makes the cached parameters available without creating their Facts, see _fact
+void ParameterManager::_loadParamCache(int componentId, const std::shared_ptr<const ParameterCacheFile>& cacheFile)
+{
+    _initialRequestTimeoutTimer.stop();
+    _waitingParamTimeoutTimer.stop();
+
+    ParameterComponentStore& store = _componentStores[componentId];
+    if (!store.initialized) {
+        store.initialized = true;
+        store.paramCount = cacheFile->count();
+        _totalParamCount += store.paramCount;
+    }
+
+    // The cache holds the full parameter set, nothing is left to read by index
+    store.clearIndexWaits();
+    store.cacheFile = cacheFile;
+
+    for (int cacheIndex = 0; cacheIndex < cacheFile->count(); cacheIndex++) {
+        const int nameId = store.internName(cacheFile->name(cacheIndex));
+        if (!store.fact(nameId)) {
+            store.setCacheIndex(nameId, cacheIndex);
+        }
+    }
+
+    int waitingReadParamIndexCount = 0;
+    int waitingReadParamNameCount = 0;
+    int waitingWriteParamNameCount = 0;
+
+    for (const ParameterComponentStore& waitingStore: _componentStores) {
+        waitingReadParamIndexCount += waitingStore.readIndexWaits.count();
+        waitingReadParamNameCount += waitingStore.readNameWaits.count();
+        waitingWriteParamNameCount += waitingStore.writeNameWaits.count();
+    }
+    if (waitingReadParamIndexCount + waitingReadParamNameCount + waitingWriteParamNameCount || !_hasComponentFacts(_vehicle->defaultComponentId())) {
+        _waitingParamTimeoutTimer.start();
+    }
+
+    // Same bookkeeping as _handleParamValue so the cache is only rewritten when outstanding reads finish
+    _prevWaitingReadParamIndexCount = waitingReadParamIndexCount;
+    _prevWaitingReadParamNameCount = waitingReadParamNameCount;
+    _prevWaitingWriteParamNameCount = waitingWriteParamNameCount;
+
+    _updateProgressBar();
+    _checkInitialLoadComplete();
+}
+
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
 {
     QString missingErrors;
@@ -1064,14 +1198,11 @@ void ParameterManager::writeParametersToStream(QTextStream& stream)
     stream << "#\n";
     stream << "# Vehicle-Id Component-Id Name Value Type\n";
 
-    for (int componentId: _mapCompId2FactMap.keys()) {
-        for (const QString &paramName: _mapCompId2FactMap[componentId].keys()) {
-            Fact* fact = _mapCompId2FactMap[componentId][paramName];
-            if (fact) {
-                stream << _vehicle->id() << "\t" << componentId << "\t" << paramName << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(factTypeToMavType(fact->type())) << "\n";
-            } else {
-                qWarning() << "Internal error: missing fact";
-            }
+    for (auto it = _componentStores.begin(); it != _componentStores.end(); it++) {
+        const int componentId = it.key();
+        for (int nameId: it->sortedFactIds()) {
+            const Fact* fact = _fact(componentId, it.value(), nameId);
+            stream << _vehicle->id() << "\t" << componentId << "\t" << it->name(nameId) << "\t" << fact->rawValueStringFullPrecision() << "\t" << QString("%1").arg(factTypeToMavType(fact->type())) << "\n";
         }
     }
 
@@ -1163,14 +1294,14 @@ void ParameterManager::_checkInitialLoadComplete(void)
         return;
     }
 
-    for (int componentId: _waitingReadParamIndexMap.keys()) {
-        if (_waitingReadParamIndexMap[componentId].count()) {
+    for (const ParameterComponentStore& store: _componentStores) {
+        if (store.readIndexWaits.count()) {
             // We are still waiting on some parameters, not done yet
             return;
         }
     }
 
-    if (!_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
+    if (!_hasComponentFacts(_vehicle->defaultComponentId())) {
         // No default component params yet, not done yet
         return;
     }
@@ -1357,7 +1488,8 @@ void ParameterManager::_loadOfflineEditingParams(void)
         FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(defaultComponentId)->factMetaDataForName(paramName, fact->type());
         fact->setMetaData(factMetaData);
 
-        _mapCompId2FactMap[defaultComponentId][paramName] = fact;
+        ParameterComponentStore& store = _componentStores[defaultComponentId];
+        store.setFact(store.internName(paramName), fact);
     }
 
     _parametersReady = true;
@@ -1402,13 +1534,21 @@ void ParameterManager::_setLoadProgress(double loadProgress)
 
 QList<int> ParameterManager::componentIds(void)
 {
-    return _paramCountMap.keys();
+    QList<int> ids;
+
+    for (auto it = _componentStores.constBegin(); it != _componentStores.constEnd(); it++) {
+        if (it->initialized) {
+            ids << it.key();
+        }
+    }
+
+    return ids;
 }
 
 bool ParameterManager::pendingWrites(void)
 {
-    for (int compId: _waitingWriteParamNameMap.keys()) {
-        if (_waitingWriteParamNameMap[compId].count()) {
+    for (const ParameterComponentStore& store: _componentStores) {
+        if (store.writeNameWaits.count()) {
             return true;
         }
     }
@@ -1582,33 +1722,28 @@ bool ParameterManager::_parseParamFile(const QString& filename)
                                               ptype == AP_PARAM_INT32 ? FactMetaData::valueTypeInt32 :
                                               FactMetaData::valueTypeFloat);
 
-        Fact* fact = nullptr;
-        if (_mapCompId2FactMap.contains(componentId) && _mapCompId2FactMap[componentId].contains(parameterName)) {
-            fact = _mapCompId2FactMap[componentId][parameterName];
-        } else {
+        ParameterComponentStore& store = _componentStores[componentId];
+        const int nameId = store.internName(parameterName);
+        Fact* fact = store.fact(nameId);
+        if (!fact) {
             qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
-            fact = new Fact(componentId, parameterName, factType, this);
-            FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(parameterName, fact->type());
-            fact->setMetaData(factMetaData);
-
-            _mapCompId2FactMap[componentId][parameterName] = fact;
-
-            // We need to know when the fact value changes so we can update the vehicle
-            connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
-
-            emit factAdded(componentId, fact);
+            fact = _createFact(componentId, store, nameId, factType);
         }
         fact->_containerSetRawValue(parameterValue);
     }
 Success:
     file.close();
     /* Create empty waiting lists as we have all parameters */
-    _paramCountMap[componentId] = num_params;
+    {
+        ParameterComponentStore& store = _componentStores[componentId];
+        store.initialized = true;
+        store.paramCount = num_params;
+        store.clearIndexWaits();
+        store.readNameWaits.clear();
+        store.writeNameWaits.clear();
+    }
     _totalParamCount += num_params;
-    _waitingReadParamIndexMap[componentId] = QMap<int, int>();
-    _waitingReadParamNameMap[componentId] = QMap<QString, int>();
-    _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
     _checkInitialLoadComplete();
     _setLoadProgress(0.0);
     return true;
@@ -12,12 +12,15 @@
 #include <QtCore/QObject>
 #include <QtCore/QMap>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QTimer>
 #include <QtCore/QString>
 #include <QtCore/QLoggingCategory>
 
 #include "Fact.h"
 #include "FactMetaData.h"
+#include "ParameterCacheFile.h"
+#include "ParameterComponentStore.h"
 #include "MAVLinkLib.h"
 
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose1Log)
@@ -53,7 +56,7 @@ public:
     /// @return Location of parameter cache file
     static QString parameterCacheFile(int vehicleId, int componentId);
 
-    void mavlinkMessageReceived(mavlink_message_t message);
+    void mavlinkMessageReceived(const mavlink_message_t& message);
 
     QList<int> componentIds(void);
 
@@ -118,6 +121,8 @@ private:
     void    _sendParamSetToVehicle              (int componentId, const QString& paramName, FactMetaData::ValueType_t valueType, const QVariant& value);
     void    _writeLocalParamCache               (int vehicleId, int componentId);
     void    _tryCacheHashLoad                   (int vehicleId, int componentId, QVariant hash_value);
+    void    _loadParamCache                     (int componentId, const std::shared_ptr<const ParameterCacheFile>& cacheFile);
+    quint32 _paramCacheHashCrc                  (const QList<ParameterCacheFile::Entry>& entries);
     void    _loadMetaData                       (void);
     void    _clearMetaData                      (void);
     QString _remapParamNameToVersion            (const QString& paramName);
@@ -125,18 +130,24 @@ private:
     QString _logVehiclePrefix                   (int componentId);
     void    _setLoadProgress                    (double loadProgress);
     bool    _fillIndexBatchQueue                (bool waitingParamTimeout);
+    void    _updateWaitingParamTimeoutInterval  (void);
     void    _updateProgressBar                  (void);
     void    _checkInitialLoadComplete           (void);
     void    _ftpDownloadComplete                (const QString& fileName, const QString& errorMsg);
     void    _ftpDownloadProgress                (float progress);
     bool    _parseParamFile                     (const QString& filename);
+    ParameterComponentStore* _componentStore    (int componentId);
+    Fact*   _fact                               (int componentId, ParameterComponentStore& store, int nameId);
+    Fact*   _createFact                         (int componentId, ParameterComponentStore& store, int nameId, FactMetaData::ValueType_t type);
+    bool    _hasComponentFacts                  (int componentId) const;
+    QStringList _waitingNames                   (const ParameterComponentStore& store, const ParameterWaitSet& waitSet) const;
 
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
 
     Vehicle*            _vehicle;
     MAVLinkProtocol*    _mavlink;
 
-    QMap<int /* comp id */, QMap<QString /* parameter name */, Fact*>> _mapCompId2FactMap;
+    QMap<int /* comp id */, ParameterComponentStore> _componentStores;  ///< Parameters, parameter count and wait sets for each component
 
     double      _loadProgress;                  ///< Parameter load progess, [0.0,1.0]
     bool        _parametersReady;               ///< true: parameter load complete
@@ -170,12 +181,10 @@ private:
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
 
     bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
-    QList<int>  _indexBatchQueue;       ///< The current queue of index re-requests
 
-    QMap<int, int>                  _paramCountMap;             ///< Key: Component id, Value: count of parameters in this component
-    QMap<int, QMap<int, int> >      _waitingReadParamIndexMap;  ///< Key: Component id, Value: Map { Key: parameter index still waiting for, Value: retry count }
-    QMap<int, QMap<QString, int> >  _waitingReadParamNameMap;   ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
-    QMap<int, QMap<QString, int> >  _waitingWriteParamNameMap;  ///< Key: Component id, Value: Map { Key: parameter name still waiting for, Value: retry count }
+    static constexpr int _waitingParamTimeoutMSecs = 3000;  ///< Timeout when no index based re-requests are in flight
+    QElapsedTimer        _requestClock;                     ///< Timestamps index based re-requests for round trip measurement
+
     QMap<int, QList<int> >          _failedReadParamIndexMap;   ///< Key: Component id, Value: failed parameter index
 
     int _totalParamCount;                       ///< Number of parameters across all components
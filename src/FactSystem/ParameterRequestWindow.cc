@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterRequestWindow.h"
+
+#include <QtCore/QtGlobal>
+
+void ParameterRequestWindow::requestSent(int key, qint64 nowMSecs, bool retransmit)
+{
+    _inFlight.insert(key, Request{ nowMSecs, retransmit });
+}
+
+bool ParameterRequestWindow::responseReceived(int key, qint64 nowMSecs)
+{
+    auto it = _inFlight.constFind(key);
+    if (it == _inFlight.constEnd()) {
+        return false;
+    }
+
+    if (!it->retransmit) {
+        const double rttMSecs = static_cast<double>(nowMSecs - it->sentMSecs);
+        if (_rttSampled) {
+            _rttVarianceMSecs = (0.75 * _rttVarianceMSecs) + (0.25 * qAbs(_smoothedRttMSecs - rttMSecs));
+            _smoothedRttMSecs = (0.875 * _smoothedRttMSecs) + (0.125 * rttMSecs);
+        } else {
+            _smoothedRttMSecs = rttMSecs;
+            _rttVarianceMSecs = rttMSecs / 2;
+            _rttSampled = true;
+        }
+    }
+    _inFlight.erase(it);
+
+    if (_window < _slowStartThreshold) {
+        _window += 1;
+    } else {
+        _window += 1 / _window;
+    }
+    _window = qMin(_window, static_cast<double>(maxWindow));
+
+    // A response also ends any timeout backoff
+    _updateTimeout();
+
+    return true;
+}
+
+QList<int> ParameterRequestWindow::takeExpired(qint64 nowMSecs)
+{
+    QList<int> expired;
+
+    for (auto it = _inFlight.begin(); it != _inFlight.end(); ) {
+        if ((nowMSecs - it->sentMSecs) >= _timeoutMSecs) {
+            expired.append(it.key());
+            it = _inFlight.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    if (!expired.isEmpty()) {
+        _shrink();
+        _window = _slowStartThreshold;
+    }
+
+    return expired;
+}
+
+QList<int> ParameterRequestWindow::timeout(void)
+{
+    const QList<int> lost = _inFlight.keys();
+    _inFlight.clear();
+    _shrink();
+    _window = minWindow;
+    _timeoutMSecs = qMin(_timeoutMSecs * 2, maxTimeoutMSecs);
+
+    return lost;
+}
+
+void ParameterRequestWindow::_shrink(void)
+{
+    _slowStartThreshold = qMax(_window / 2, static_cast<double>(minWindow + 1));
+}
+
+void ParameterRequestWindow::_updateTimeout(void)
+{
+    if (_rttSampled) {
+        _timeoutMSecs = qBound(minTimeoutMSecs, static_cast<int>(_smoothedRttMSecs + (4 * _rttVarianceMSecs)), maxTimeoutMSecs);
+    }
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+
+/// Adaptive window for parameter read requests sent to a single component.
+/// Works like TCP congestion control: the number of requests allowed in flight grows by one per response in slow
+/// start and by one per window of responses after that. A request which is not answered within the timeout counts
+/// as a loss and halves the window, a timeout with nothing answered drops it back to minWindow. The timeout follows
+/// the measured round trip time (RFC 6298), retransmitted requests are not sampled (Karn's algorithm).
+class ParameterRequestWindow
+{
+public:
+    static constexpr int minWindow              = 1;
+    static constexpr int initialWindow          = 4;
+    static constexpr int maxWindow              = 64;
+    static constexpr int minTimeoutMSecs        = 200;
+    static constexpr int initialTimeoutMSecs    = 1000;
+    static constexpr int maxTimeoutMSecs        = 3000;
+
+    int     size            (void) const { return static_cast<int>(_window); }
+    int     inFlightCount   (void) const { return static_cast<int>(_inFlight.count()); }
+    bool    isInFlight      (int key) const { return _inFlight.contains(key); }
+    bool    canSend         (void) const { return inFlightCount() < size(); }
+    int     timeoutMSecs    (void) const { return _timeoutMSecs; }
+    int     smoothedRttMSecs(void) const { return static_cast<int>(_smoothedRttMSecs); }
+
+    ///     @param retransmit true: key has been requested before, its response can't be used to measure the round trip time
+    void requestSent(int key, qint64 nowMSecs, bool retransmit);
+
+    /// @return true: A request for key was in flight
+    bool responseReceived(int key, qint64 nowMSecs);
+
+    /// Removes the requests which have been in flight for longer than the timeout. Shrinks the window once if any did.
+    /// @return Keys of the expired requests
+    QList<int> takeExpired(qint64 nowMSecs);
+
+    /// Nothing came back within the timeout: all requests in flight are lost
+    /// @return Keys of the lost requests
+    QList<int> timeout(void);
+
+    /// Forgets the requests in flight, keeping the window and round trip time
+    void clearInFlight(void) { _inFlight.clear(); }
+
+private:
+    struct Request {
+        qint64  sentMSecs;
+        bool    retransmit;
+    };
+
+    void _shrink            (void);
+    void _updateTimeout     (void);
+
+    QHash<int, Request> _inFlight;
+    double              _window             = initialWindow;
+    double              _slowStartThreshold = maxWindow;
+    double              _smoothedRttMSecs   = 0;
+    double              _rttVarianceMSecs   = 0;
+    bool                _rttSampled         = false;
+    int                 _timeoutMSecs       = initialTimeoutMSecs;
+};
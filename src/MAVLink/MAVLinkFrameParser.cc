@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameParser.h"
+#include "QGCMAVLink.h"
+
+#include <cstring>
+
+namespace
+{
+
+constexpr qsizetype _v1HeaderLen = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+constexpr qsizetype _v2HeaderLen = MAVLINK_NUM_HEADER_BYTES;
+
+enum class FrameResult {
+    Ok,
+    BadFrame,
+    Incomplete
+};
+
+/// @return Offset of the first v1 or v2 start byte, length if there is none
+qsizetype _findStx(const uint8_t *data, qsizetype length)
+{
+    const void *const v2 = memchr(data, MAVLINK_STX, static_cast<size_t>(length));
+    const qsizetype v2Offset = v2 ? (static_cast<const uint8_t*>(v2) - data) : length;
+    const void *const v1 = memchr(data, MAVLINK_STX_MAVLINK1, static_cast<size_t>(v2Offset));
+    return v1 ? (static_cast<const uint8_t*>(v1) - data) : v2Offset;
+}
+
+/// Validates and decodes the frame which starts at frame[0]. Mirrors the checks done by
+/// mavlink_frame_char_buffer for an unsigned channel, including zero fill of truncated payloads.
+FrameResult _decodeFrame(const uint8_t *frame, qsizetype available, mavlink_message_t &message, qsizetype &frameLength)
+{
+    const bool mavlink1 = (frame[0] == MAVLINK_STX_MAVLINK1);
+    const qsizetype headerLen = mavlink1 ? _v1HeaderLen : _v2HeaderLen;
+    if (available < headerLen) {
+        return FrameResult::Incomplete;
+    }
+
+    const uint8_t payloadLen = frame[1];
+    uint8_t incompatFlags = 0;
+    uint8_t compatFlags = 0;
+    uint8_t seq, sysid, compid;
+    uint32_t msgid;
+    if (mavlink1) {
+        seq = frame[2];
+        sysid = frame[3];
+        compid = frame[4];
+        msgid = frame[5];
+    } else {
+        incompatFlags = frame[2];
+        if ((incompatFlags & ~MAVLINK_IFLAG_MASK) != 0) {
+            // Unknown incompatible flag, the state machine drops these as well
+            return FrameResult::BadFrame;
+        }
+        compatFlags = frame[3];
+        seq = frame[4];
+        sysid = frame[5];
+        compid = frame[6];
+        msgid = frame[7] | (frame[8] << 8) | (static_cast<uint32_t>(frame[9]) << 16);
+    }
+
+    const qsizetype signatureLen = (incompatFlags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+    frameLength = headerLen + payloadLen + MAVLINK_NUM_CHECKSUM_BYTES + signatureLen;
+    if (available < frameLength) {
+        return FrameResult::Incomplete;
+    }
+
+    const mavlink_msg_entry_t *const entry = mavlink_get_msg_entry(msgid);
+    const uint8_t crcExtra = entry ? entry->crc_extra : 0;
+
+    uint16_t crc;
+    crc_init(&crc);
+    crc_accumulate_buffer(&crc, reinterpret_cast<const char*>(frame + 1), static_cast<uint16_t>(headerLen - 1 + payloadLen));
+    crc_accumulate(crcExtra, &crc);
+
+    const uint8_t *const ck = frame + headerLen + payloadLen;
+    if ((ck[0] != (crc & 0xFF)) || (ck[1] != (crc >> 8))) {
+        return FrameResult::BadFrame;
+    }
+
+    message.checksum = crc;
+    message.magic = frame[0];
+    message.len = payloadLen;
+    message.incompat_flags = incompatFlags;
+    message.compat_flags = compatFlags;
+    message.seq = seq;
+    message.sysid = sysid;
+    message.compid = compid;
+    message.msgid = msgid;
+
+    char *const payload = _MAV_PAYLOAD_NON_CONST(&message);
+    (void) memcpy(payload, frame + headerLen, payloadLen);
+    if (entry && (payloadLen < entry->max_msg_len)) {
+        // Zero fill to cope with MAVLink 2 payload truncation
+        (void) memset(payload + payloadLen, 0, entry->max_msg_len - payloadLen);
+    }
+
+    message.ck[0] = ck[0];
+    message.ck[1] = ck[1];
+    if (signatureLen > 0) {
+        (void) memcpy(message.signature, ck + MAVLINK_NUM_CHECKSUM_BYTES, signatureLen);
+    }
+
+    return FrameResult::Ok;
+}
+
+/// Keeps the same mavlink_status_t bookkeeping as mavlink_frame_char_buffer does for a good frame
+void _updateChannelStatus(mavlink_status_t *status, const mavlink_message_t &message)
+{
+    status->msg_received = MAVLINK_FRAMING_OK;
+    status->parse_error = 0;
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+
+    status->current_rx_seq = message.seq;
+    if (status->packet_rx_success_count == 0) {
+        status->packet_rx_drop_count = 0;
+    }
+    status->packet_rx_success_count++;
+}
+
+/// Keeps the same mavlink_status_t bookkeeping as mavlink_parse_char does for a bad CRC or unknown incompatible flags
+void _updateChannelStatusBadFrame(mavlink_status_t *status)
+{
+    status->parse_error++;
+    status->msg_received = MAVLINK_FRAMING_INCOMPLETE;
+    status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+}
+
+/// mavlink_parse_char on the receive state of a channel instead of the mavlink_get_channel_status() state
+bool _parseChar(mavlink_message_t *buffer, mavlink_status_t *status, uint8_t c, mavlink_message_t &message)
+{
+    mavlink_status_t frameStatus;
+    const uint8_t result = mavlink_frame_char_buffer(buffer, status, c, &message, &frameStatus);
+    if ((result == MAVLINK_FRAMING_BAD_CRC) || (result == MAVLINK_FRAMING_BAD_SIGNATURE)) {
+        _updateChannelStatusBadFrame(status);
+        if (c == MAVLINK_STX) {
+            status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+            buffer->len = 0;
+            mavlink_start_checksum(buffer);
+        }
+        return false;
+    }
+
+    return (result == MAVLINK_FRAMING_OK);
+}
+
+} // namespace
+
+namespace MAVLinkFrameParser
+{
+
+bool parseNext(uint8_t channel, QByteArrayView bytes, qsizetype &position, mavlink_message_t &message)
+{
+    mavlink_status_t *const status = QGCMAVLink::getChannelReceiveStatus(channel);
+    mavlink_message_t *const buffer = QGCMAVLink::getChannelReceiveBuffer(channel);
+    if (!status || !buffer) {
+        position = bytes.size();
+        return false;
+    }
+
+    const uint8_t *const data = reinterpret_cast<const uint8_t*>(bytes.data());
+    const qsizetype size = bytes.size();
+
+    while (position < size) {
+        if (status->signing || (status->parse_state > MAVLINK_PARSE_STATE_IDLE)) {
+            // Signature checking and frames carried over from the previous buffer stay with the state machine
+            if (_parseChar(buffer, status, data[position++], message)) {
+                return true;
+            }
+            continue;
+        }
+
+        const qsizetype stx = position + _findStx(data + position, size - position);
+        if (stx >= size) {
+            position = size;
+            return false;
+        }
+
+        qsizetype frameLength = 0;
+        switch (_decodeFrame(data + stx, size - stx, message, frameLength)) {
+        case FrameResult::Ok:
+            _updateChannelStatus(status, message);
+            position = stx + frameLength;
+            return true;
+        case FrameResult::BadFrame:
+            // Resync on the next start byte following this one
+            _updateChannelStatusBadFrame(status);
+            position = stx + 1;
+            break;
+        case FrameResult::Incomplete:
+            // The frame continues in the next buffer. Prime the state machine with the tail so it completes there.
+            for (position = stx; position < size; position++) {
+                (void) _parseChar(buffer, status, data[position], message);
+            }
+            return false;
+        }
+    }
+
+    return false;
+}
+
+} // namespace MAVLinkFrameParser
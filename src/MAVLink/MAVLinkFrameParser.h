@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArrayView>
+
+#include "MAVLinkLib.h"
+
+/// Buffer oriented replacement for calling mavlink_parse_char once per byte.
+/// Complete frames found in the buffer are located with memchr, CRC checked as a whole and
+/// decoded in place. Frames which are split across buffers, as well as all traffic on signed
+/// channels, are handed to the per-channel mavlink state machine so behaviour is unchanged.
+namespace MAVLinkFrameParser
+{
+    /// Decodes the next message from bytes starting at position
+    ///     @param channel mavlink channel whose receive state (QGCMAVLink::getChannelReceiveStatus) holds the parse state for the stream
+    ///     @param position in: offset to start scanning at, out: offset following the consumed bytes
+    ///     @param message filled in with the decoded message
+    /// @return true: message was decoded, false: all bytes consumed without completing a message
+    bool parseNext(uint8_t channel, QByteArrayView bytes, qsizetype &position, mavlink_message_t &message);
+}; // namespace MAVLinkFrameParser
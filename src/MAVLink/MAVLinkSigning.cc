@@ -52,6 +52,35 @@ void _setSigningTimestamp(mavlink_signing_t *signing)
     signing->timestamp = signing_timestamp;
 }
 
+bool _initStatusSigning(mavlink_status_t *status, mavlink_signing_t *signing, mavlink_signing_streams_t *signing_streams, mavlink_channel_t channel, QByteArrayView key, mavlink_accept_unsigned_t callback)
+{
+    if (!status) {
+        return false;
+    }
+
+    if (!key.isEmpty() && !callback) {
+        qWarning() << Q_FUNC_INFO << "callback must be specified";
+        return false;
+    }
+
+    if (key.isEmpty()) {
+        status->signing = nullptr;
+        status->signing_streams = nullptr;
+    } else {
+        signing->link_id = channel;
+        signing->flags |= MAVLINK_SIGNING_FLAG_SIGN_OUTGOING;
+        signing->accept_unsigned_callback = callback;
+
+        _setSigningKey(signing, key);
+        _setSigningTimestamp(signing);
+
+        status->signing = signing;
+        status->signing_streams = signing_streams;
+    }
+
+    return true;
+}
+
 } // namespace
 
 namespace MAVLinkSigning
@@ -74,36 +103,25 @@ bool insecureConnectionAccceptUnsignedCallback(const mavlink_status_t *status, u
     return unsigned_messages.contains(message_id);
 }
 
-/// Initialize the signing for a channel, both incoming and outgoing
+/// Initialize the signing for outgoing messages on a channel
 /// If key is empty signing will be turned off for channel
 bool initSigning(mavlink_channel_t channel, QByteArrayView key, mavlink_accept_unsigned_t callback)
 {
-    if (!key.isEmpty() && !callback) {
-        qWarning() << Q_FUNC_INFO << "callback must be specified";
-        return false;
-    }
-
-    mavlink_status_t* const status = mavlink_get_channel_status(channel);
-    if (key.isEmpty()) {
-        status->signing = nullptr;
-        status->signing_streams = nullptr;
-    } else {
-        static mavlink_signing_t s_signing[MAVLINK_COMM_NUM_BUFFERS];
-        static mavlink_signing_streams_t s_signing_streams;
+    static mavlink_signing_t s_signing[MAVLINK_COMM_NUM_BUFFERS];
+    static mavlink_signing_streams_t s_signing_streams;
 
-        mavlink_signing_t* const signing = &s_signing[channel];
-        signing->link_id = channel;
-        signing->flags |= MAVLINK_SIGNING_FLAG_SIGN_OUTGOING;
-        signing->accept_unsigned_callback = callback;
-
-        _setSigningKey(signing, key);
-        _setSigningTimestamp(signing);
+    return _initStatusSigning(mavlink_get_channel_status(channel), &s_signing[channel], &s_signing_streams, channel, key, callback);
+}
 
-        status->signing = signing;
-        status->signing_streams = &s_signing_streams;
-    }
+/// Initialize the signature checks of incoming messages on a channel. The receive state has its own
+/// copy of the signing state, so checking signatures never touches the outgoing signing timestamp.
+/// If key is empty signing will be turned off for channel
+bool initReceiveSigning(mavlink_channel_t channel, QByteArrayView key, mavlink_accept_unsigned_t callback)
+{
+    static mavlink_signing_t s_signing[MAVLINK_COMM_NUM_BUFFERS];
+    static mavlink_signing_streams_t s_signing_streams;
 
-    return true;
+    return _initStatusSigning(QGCMAVLink::getChannelReceiveStatus(channel), &s_signing[channel], &s_signing_streams, channel, key, callback);
 }
 
 bool checkSigningLinkId(mavlink_channel_t channel, const mavlink_message_t &message)
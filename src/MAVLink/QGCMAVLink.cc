@@ -34,6 +34,39 @@ mavlink_status_t* mavlink_get_channel_status(uint8_t channel)
 }
 #endif
 
+mavlink_status_t* QGCMAVLink::getChannelReceiveStatus(uint8_t channel)
+{
+    static mavlink_status_t s_receiveStatus[MAVLINK_COMM_NUM_BUFFERS];
+
+    if (!isValidChannel(channel)) {
+        qCWarning(QGCMAVLinkLog) << Q_FUNC_INFO << "Invalid Channel Number:" << channel;
+        return nullptr;
+    }
+
+    return &s_receiveStatus[channel];
+}
+
+mavlink_message_t* QGCMAVLink::getChannelReceiveBuffer(uint8_t channel)
+{
+    static mavlink_message_t s_receiveBuffer[MAVLINK_COMM_NUM_BUFFERS];
+
+    if (!isValidChannel(channel)) {
+        qCWarning(QGCMAVLinkLog) << Q_FUNC_INFO << "Invalid Channel Number:" << channel;
+        return nullptr;
+    }
+
+    return &s_receiveBuffer[channel];
+}
+
+/// Same as mavlink_reset_channel_status for the receive state
+void QGCMAVLink::resetChannelReceiveStatus(uint8_t channel)
+{
+    mavlink_status_t* const status = getChannelReceiveStatus(channel);
+    if (status) {
+        status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    }
+}
+
 QGCMAVLink::QGCMAVLink(QObject *parent)
     : QObject(parent)
 {
@@ -159,4 +159,11 @@ public:
     static bool isValidChannel(mavlink_channel_t channel) { return isValidChannel(static_cast<uint8_t>(channel)); }
 
     static mavlink_status_t* getChannelStatus(mavlink_channel_t channel) { return mavlink_get_channel_status(static_cast<uint8_t>(channel)); }
+
+    /// The receive state of a channel is kept apart from the mavlink_get_channel_status() state used to pack
+    /// outgoing messages. Parsing runs on the MAVLinkProtocol worker thread while messages are packed on the
+    /// main thread, this way the two never share version flags, sequence numbers or the signing timestamp.
+    static mavlink_status_t* getChannelReceiveStatus(uint8_t channel);
+    static mavlink_message_t* getChannelReceiveBuffer(uint8_t channel);
+    static void resetChannelReceiveStatus(uint8_t channel);
 };
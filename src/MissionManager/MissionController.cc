@@ -36,6 +36,8 @@
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 
+#include <limits>
+
 #define UPDATE_TIMEOUT 5000 ///< How often we check for bounding box changes
 
 QGC_LOGGING_CATEGORY(MissionControllerLog, "MissionControllerLog")
@@ -59,10 +61,15 @@ MissionController::MissionController(PlanMasterController* masterController, QOb
 
     // The follow is used to compress multiple recalc calls in a row to into a single call.
     connect(this, &MissionController::_recalcMissionFlightStatusSignal, this, &MissionController::_recalcMissionFlightStatus,   Qt::QueuedConnection);
+    connect(this, &MissionController::_recalcMissionFlightStatusFromItemSignal, this, &MissionController::_recalcMissionFlightStatus, Qt::QueuedConnection);
     connect(this, &MissionController::_recalcFlightPathSegmentsSignal,  this, &MissionController::_recalcFlightPathSegments,    Qt::QueuedConnection);
     qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&MissionController::_recalcMissionFlightStatusSignal));
+    qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&MissionController::_recalcMissionFlightStatusFromItemSignal));
     qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&MissionController::_recalcFlightPathSegmentsSignal));
     qgcApp()->addCompressedSignal(QMetaMethod::fromSignal(&MissionController::recalcTerrainProfile));
+
+    // Whoever asks for a recalc without naming an item invalidates the flight status of the whole mission
+    connect(this, &MissionController::_recalcMissionFlightStatusSignal, this, [this]() { _flightStatusRecalcIndex = 0; });
 }
 
 MissionController::~MissionController()
@@ -70,37 +77,46 @@ MissionController::~MissionController()
 
 }
 
-void MissionController::_resetMissionFlightStatus(void)
-{
-    _missionFlightStatus.totalDistance =        0.0;
-    _missionFlightStatus.maxTelemetryDistance = 0.0;
-    _missionFlightStatus.totalTime =            0.0;
-    _missionFlightStatus.hoverTime =            0.0;
-    _missionFlightStatus.cruiseTime =           0.0;
-    _missionFlightStatus.hoverDistance =        0.0;
-    _missionFlightStatus.cruiseDistance =       0.0;
-    _missionFlightStatus.cruiseSpeed =          _controllerVehicle->defaultCruiseSpeed();
-    _missionFlightStatus.hoverSpeed =           _controllerVehicle->defaultHoverSpeed();
-    _missionFlightStatus.vehicleSpeed =         _controllerVehicle->multiRotor() || _managerVehicle->vtol() ? _missionFlightStatus.hoverSpeed : _missionFlightStatus.cruiseSpeed;
-    _missionFlightStatus.vehicleYaw =           qQNaN();
-    _missionFlightStatus.gimbalYaw =            qQNaN();
-    _missionFlightStatus.gimbalPitch =          qQNaN();
-    _missionFlightStatus.mAhBattery =           0;
-    _missionFlightStatus.hoverAmps =            0;
-    _missionFlightStatus.cruiseAmps =           0;
-    _missionFlightStatus.ampMinutesAvailable =  0;
-    _missionFlightStatus.hoverAmpsTotal =       0;
-    _missionFlightStatus.cruiseAmpsTotal =      0;
-    _missionFlightStatus.batteryChangePoint =   -1;
-    _missionFlightStatus.batteriesRequired =    -1;
-    _missionFlightStatus.vtolMode =             _missionContainsVTOLTakeoff ? QGCMAVLink::VehicleClassMultiRotor : QGCMAVLink::VehicleClassFixedWing;
-
-    _controllerVehicle->firmwarePlugin()->batteryConsumptionData(_controllerVehicle, _missionFlightStatus.mAhBattery, _missionFlightStatus.hoverAmps, _missionFlightStatus.cruiseAmps);
-    if (_missionFlightStatus.mAhBattery != 0) {
+MissionController::MissionFlightStatus_t MissionController::_initialMissionFlightStatus(void)
+{
+    MissionFlightStatus_t status;
+
+    status.totalDistance =        0.0;
+    status.maxTelemetryDistance = 0.0;
+    status.totalTime =            0.0;
+    status.hoverTime =            0.0;
+    status.cruiseTime =           0.0;
+    status.hoverDistance =        0.0;
+    status.cruiseDistance =       0.0;
+    status.cruiseSpeed =          _controllerVehicle->defaultCruiseSpeed();
+    status.hoverSpeed =           _controllerVehicle->defaultHoverSpeed();
+    status.vehicleSpeed =         _controllerVehicle->multiRotor() || _managerVehicle->vtol() ? status.hoverSpeed : status.cruiseSpeed;
+    status.vehicleYaw =           qQNaN();
+    status.gimbalYaw =            qQNaN();
+    status.gimbalPitch =          qQNaN();
+    status.mAhBattery =           0;
+    status.hoverAmps =            0;
+    status.cruiseAmps =           0;
+    status.ampMinutesAvailable =  0;
+    status.hoverAmpsTotal =       0;
+    status.cruiseAmpsTotal =      0;
+    status.batteryChangePoint =   -1;
+    status.batteriesRequired =    -1;
+    status.vtolMode =             _missionContainsVTOLTakeoff ? QGCMAVLink::VehicleClassMultiRotor : QGCMAVLink::VehicleClassFixedWing;
+
+    _controllerVehicle->firmwarePlugin()->batteryConsumptionData(_controllerVehicle, status.mAhBattery, status.hoverAmps, status.cruiseAmps);
+    if (status.mAhBattery != 0) {
         double batteryPercentRemainingAnnounce = qgcApp()->toolbox()->settingsManager()->appSettings()->batteryPercentRemainingAnnounce()->rawValue().toDouble();
-        _missionFlightStatus.ampMinutesAvailable = static_cast<double>(_missionFlightStatus.mAhBattery) / 1000.0 * 60.0 * ((100.0 - batteryPercentRemainingAnnounce) / 100.0);
+        status.ampMinutesAvailable = static_cast<double>(status.mAhBattery) / 1000.0 * 60.0 * ((100.0 - batteryPercentRemainingAnnounce) / 100.0);
     }
 
+    return status;
+}
+
+void MissionController::_resetMissionFlightStatus(void)
+{
+    _missionFlightStatus = _initialMissionFlightStatus();
+
     emit missionDistanceChanged(_missionFlightStatus.totalDistance);
     emit missionTimeChanged();
     emit missionHoverDistanceChanged(_missionFlightStatus.hoverDistance);
@@ -869,29 +885,28 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     }
 
     // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId
+    QHash<int, int> doJumpIdToSequenceNumber;
+    QList<SimpleMissionItem*> doJumpItems;
     for (int i=0; i<visualItems->count(); i++) {
         if (visualItems->value<VisualMissionItem*>(i)->isSimpleItem()) {
-            SimpleMissionItem* doJumpItem = visualItems->value<SimpleMissionItem*>(i);
-            if (doJumpItem->command() == MAV_CMD_DO_JUMP) {
-                bool found = false;
-                int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
-                for (int j=0; j<visualItems->count(); j++) {
-                    if (visualItems->value<VisualMissionItem*>(j)->isSimpleItem()) {
-                        SimpleMissionItem* targetItem = visualItems->value<SimpleMissionItem*>(j);
-                        if (targetItem->missionItem().doJumpId() == findDoJumpId) {
-                            doJumpItem->missionItem().setParam1(targetItem->sequenceNumber());
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-                if (!found) {
-                    errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
-                    return false;
-                }
+            SimpleMissionItem* simpleItem = visualItems->value<SimpleMissionItem*>(i);
+            const int doJumpId = simpleItem->missionItem().doJumpId();
+            if (!doJumpIdToSequenceNumber.contains(doJumpId)) {
+                doJumpIdToSequenceNumber[doJumpId] = simpleItem->sequenceNumber();
+            }
+            if (simpleItem->command() == MAV_CMD_DO_JUMP) {
+                doJumpItems.append(simpleItem);
             }
         }
     }
+    for (SimpleMissionItem* doJumpItem: doJumpItems) {
+        int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
+        if (!doJumpIdToSequenceNumber.contains(findDoJumpId)) {
+            errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
+            return false;
+        }
+        doJumpItem->missionItem().setParam1(doJumpIdToSequenceNumber[findDoJumpId]);
+    }
 
     return true;
 }
@@ -1179,11 +1194,14 @@ FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemP
     connect(pair.second, &VisualMissionItem::coordinateChanged,     segment,    &FlightPathSegment::setCoordinate2);
     connect(pair.second, &VisualMissionItem::amslEntryAltChanged,   segment,    &FlightPathSegment::setCoord2AMSLAlt);
 
-    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    // Only the flight status from the items the segment connects onward is affected by segment changes
+    VisualMissionItem* firstItem =  pair.first;
+    VisualMissionItem* secondItem = pair.second;
+    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       [this, secondItem]() { _recalcMissionFlightStatusFrom(secondItem); });
 
     connect(segment,    &FlightPathSegment::totalDistanceChanged,       this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       [this, firstItem]() { _recalcMissionFlightStatusFrom(firstItem); });
+    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       [this, secondItem]() { _recalcMissionFlightStatusFrom(secondItem); });
     connect(segment,    &FlightPathSegment::amslTerrainHeightsChanged,  this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
     connect(segment,    &FlightPathSegment::terrainCollisionChanged,    this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
 
@@ -1509,42 +1527,134 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
     }
 }
 
+void MissionController::_recalcMissionFlightStatusFrom(VisualMissionItem* visualItem)
+{
+    // An item which is no longer in the list (or not yet) falls back to a recalc of the whole mission
+    _flightStatusRecalcIndex = qMin(_flightStatusRecalcIndex, qMax(_visualItems->indexOf(visualItem), 0));
+    emit _recalcMissionFlightStatusFromItemSignal();
+}
+
+MissionController::FlightStatusContext_t MissionController::_currentFlightStatusContext(void)
+{
+    FlightStatusContext_t context;
+
+    context.initialStatus =         _initialMissionFlightStatus();
+    context.homeCoordinate =        _settingsItem->coordinate();
+    context.multiRotor =            _controllerVehicle->multiRotor();
+    context.vtol =                  _controllerVehicle->vtol();
+    context.showGimbalOnlyWhenSet = _planViewSettings->showGimbalOnlyWhenSet()->rawValue().toBool();
+    context.ascentSpeed =           _appSettings->offlineEditingAscentSpeed()->rawValue().toDouble();
+
+    return context;
+}
+
+bool MissionController::_sameFlightStatusContext(const FlightStatusContext_t& context1, const FlightStatusContext_t& context2)
+{
+    // Only the values _initialMissionFlightStatus takes from outside the mission need comparing, the rest are constants
+    const MissionFlightStatus_t& status1 = context1.initialStatus;
+    const MissionFlightStatus_t& status2 = context2.initialStatus;
+
+    return status1.cruiseSpeed == status2.cruiseSpeed &&
+            status1.hoverSpeed == status2.hoverSpeed &&
+            status1.vehicleSpeed == status2.vehicleSpeed &&
+            status1.vtolMode == status2.vtolMode &&
+            status1.mAhBattery == status2.mAhBattery &&
+            status1.hoverAmps == status2.hoverAmps &&
+            status1.cruiseAmps == status2.cruiseAmps &&
+            status1.ampMinutesAvailable == status2.ampMinutesAvailable &&
+            context1.homeCoordinate == context2.homeCoordinate &&
+            context1.multiRotor == context2.multiRotor &&
+            context1.vtol == context2.vtol &&
+            context1.showGimbalOnlyWhenSet == context2.showGimbalOnlyWhenSet &&
+            context1.ascentSpeed == context2.ascentSpeed;
+}
+
+bool MissionController::_flightStatusPrefixValid(int index)
+{
+    if (index >= _flightStatusPrefixes.count()) {
+        return false;
+    }
+
+    // The cached prefixes are only valid if no item was inserted, removed or moved in front of index
+    for (int i=0; i<=index; i++) {
+        if (_flightStatusPrefixes[i].item != (*_visualItems)[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void MissionController::_recalcMissionFlightStatus()
 {
     if (!_visualItems->count()) {
         return;
     }
 
+    int startIndex = _flightStatusRecalcIndex;
+    _flightStatusRecalcIndex = std::numeric_limits<int>::max();
+    if (startIndex >= _visualItems->count()) {
+        // Compressed duplicate of a recalc which already ran
+        return;
+    }
+
+    const FlightStatusContext_t context = _currentFlightStatusContext();
+    if (startIndex != 0 && (!_sameFlightStatusContext(context, _flightStatusContext) || !_flightStatusPrefixValid(startIndex))) {
+        startIndex = 0;
+    }
+    _flightStatusContext = context;
+
+    const double prevMinAMSLAltitude = _minAMSLAltitude;
+    const double prevMaxAMSLAltitude = _maxAMSLAltitude;
+
     bool                firstCoordinateItem =           true;
     VisualMissionItem*  lastFlyThroughVI =   qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
     bool homePositionValid = _settingsItem->coordinate().isValid();
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus startIndex:count" << startIndex << _visualItems->count();
 
     // If home position is valid we can calculate distances between all waypoints.
     // If home position is not valid we can only calculate distances between waypoints which are
     // both relative altitude.
 
-    // No values for first item
-    lastFlyThroughVI->setAltDifference(0);
-    lastFlyThroughVI->setAzimuth(0);
-    lastFlyThroughVI->setDistance(0);
-    lastFlyThroughVI->setDistanceFromStart(0);
-
-    _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
-
-    _resetMissionFlightStatus();
-
     bool   linkStartToHome =            false;
     bool   foundRTL =                   false;
     double totalHorizontalDistance =    0;
 
-    for (int i=0; i<_visualItems->count(); i++) {
+    if (startIndex == 0) {
+        // No values for first item
+        lastFlyThroughVI->setAltDifference(0);
+        lastFlyThroughVI->setAzimuth(0);
+        lastFlyThroughVI->setDistance(0);
+        lastFlyThroughVI->setDistanceFromStart(0);
+
+        _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
+
+        _resetMissionFlightStatus();
+    } else {
+        // Items in front of startIndex are unchanged, pick up the walk where it reached the first changed item
+        const FlightStatusPrefix_t& prefix = _flightStatusPrefixes[startIndex];
+
+        _missionFlightStatus =      prefix.missionFlightStatus;
+        lastFlyThroughVI =          prefix.lastFlyThroughVI;
+        totalHorizontalDistance =   prefix.totalHorizontalDistance;
+        _minAMSLAltitude =          prefix.minAMSLAltitude;
+        _maxAMSLAltitude =          prefix.maxAMSLAltitude;
+        firstCoordinateItem =       prefix.firstCoordinateItem;
+        linkStartToHome =           prefix.linkStartToHome;
+        foundRTL =                  prefix.foundRTL;
+    }
+
+    _flightStatusPrefixes.resize(_visualItems->count());
+
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem*  item =          qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         SimpleMissionItem*  simpleItem =    qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem =   qobject_cast<ComplexMissionItem*>(item);
 
+        _flightStatusPrefixes[i] = { item, _missionFlightStatus, lastFlyThroughVI, totalHorizontalDistance, _minAMSLAltitude, _maxAMSLAltitude, firstCoordinateItem, linkStartToHome, foundRTL };
+
         if (simpleItem && simpleItem->mavCommand() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
             foundRTL = true;
         }
@@ -1754,9 +1864,13 @@ void MissionController::_recalcMissionFlightStatus()
     emit minAMSLAltitudeChanged         (_minAMSLAltitude);
     emit maxAMSLAltitudeChanged         (_maxAMSLAltitude);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. Percentages in front of startIndex only change with the altitude range.
+    auto sameAltitude = [](double alt1, double alt2) { return alt1 == alt2 || (qIsNaN(alt1) && qIsNaN(alt2)); };
+    if (!sameAltitude(_minAMSLAltitude, prevMinAMSLAltitude) || !sameAltitude(_maxAMSLAltitude, prevMaxAMSLAltitude)) {
+        startIndex = 0;
+    }
     double altRange = _maxAMSLAltitude - _minAMSLAltitude;
-    for (int i=0; i<_visualItems->count(); i++) {
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1940,13 +2054,13 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     setDirty(false);
 
     connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
     connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
 
     if (visualItem->isSimpleItem()) {
@@ -1960,10 +2074,10 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
+            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, [this, visualItem]() { _recalcMissionFlightStatusFrom(visualItem); });
             connect(complexItem, &ComplexMissionItem::isIncompleteChanged,          this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
         } else {
             qWarning() << "ComplexMissionItem not found";
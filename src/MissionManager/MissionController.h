@@ -299,7 +299,8 @@ signals:
     void minAMSLAltitudeChanged             (double minAMSLAltitude);
     void maxAMSLAltitudeChanged             (double maxAMSLAltitude);
     void recalcTerrainProfile               (void);
-    void _recalcMissionFlightStatusSignal   (void);
+    void _recalcMissionFlightStatusSignal   (void);     ///< Recalcs flight status for the whole mission
+    void _recalcMissionFlightStatusFromItemSignal(void);///< Recalcs flight status from _flightStatusRecalcIndex forward
     void _recalcFlightPathSegmentsSignal    (void);
     void globalAltitudeModeChanged          (void);
 
@@ -344,6 +345,9 @@ private:
     void                    _scanForAdditionalSettings          (QmlObjectListModel* visualItems, PlanMasterController* masterController);
     void                    _setPlannedHomePositionFromFirstCoordinate(const QGeoCoordinate& clickCoordinate);
     void                    _resetMissionFlightStatus           (void);
+    MissionFlightStatus_t   _initialMissionFlightStatus         (void);
+    void                    _recalcMissionFlightStatusFrom      (VisualMissionItem* visualItem);
+    bool                    _flightStatusPrefixValid            (int index);
     void                    _addHoverTime                       (double hoverTime, double hoverDistance, int waypointIndex);
     void                    _addCruiseTime                      (double cruiseTime, double cruiseDistance, int wayPointIndex);
     void                    _updateBatteryInfo                  (int waypointIndex);
@@ -403,6 +407,37 @@ private:
     double                      _maxAMSLAltitude =              0;
     bool                        _missionContainsVTOLTakeoff =   false;
 
+    /// Walk state of _recalcMissionFlightStatus prior to processing an item. Caching it for each item allows a recalc
+    /// to resume from the first changed item instead of walking the whole mission again.
+    typedef struct {
+        VisualMissionItem*      item;
+        MissionFlightStatus_t   missionFlightStatus;
+        VisualMissionItem*      lastFlyThroughVI;
+        double                  totalHorizontalDistance;
+        double                  minAMSLAltitude;
+        double                  maxAMSLAltitude;
+        bool                    firstCoordinateItem;
+        bool                    linkStartToHome;
+        bool                    foundRTL;
+    } FlightStatusPrefix_t;
+
+    /// Inputs outside of the item list which affect every item. A change to any of them invalidates all prefixes.
+    typedef struct {
+        MissionFlightStatus_t   initialStatus;
+        QGeoCoordinate          homeCoordinate;
+        bool                    multiRotor;
+        bool                    vtol;
+        bool                    showGimbalOnlyWhenSet;
+        double                  ascentSpeed;
+    } FlightStatusContext_t;
+
+    FlightStatusContext_t       _currentFlightStatusContext     (void);
+    static bool                 _sameFlightStatusContext        (const FlightStatusContext_t& context1, const FlightStatusContext_t& context2);
+
+    QList<FlightStatusPrefix_t> _flightStatusPrefixes;
+    FlightStatusContext_t       _flightStatusContext;
+    int                         _flightStatusRecalcIndex =      0;  ///< First item which needs a flight status recalc, >= item count for none
+
     QGroundControlQmlGlobal::AltMode _globalAltMode = QGroundControlQmlGlobal::AltitudeModeRelative;
 
     static constexpr const char* _settingsGroup =                 "MissionController";
@@ -13,8 +13,12 @@
 #include "MAVLinkProtocol.h"
 #include "QGCApplication.h"
 #include "MissionCommandTree.h"
+#include "SettingsManager.h"
+#include "PlanViewSettings.h"
 #include "QGCLoggingCategory.h"
 
+#include <algorithm>
+
 QGC_LOGGING_CATEGORY(PlanManagerLog, "PlanManagerLog")
 
 PlanManager::PlanManager(Vehicle* vehicle, MAV_MISSION_TYPE planType)
@@ -137,6 +141,7 @@ void PlanManager::loadFromVehicle(void)
     }
 
     _retryCount = 0;
+    _pipelinedRead = qgcApp()->toolbox()->settingsManager()->planViewSettings()->pipelinedMissionDownload()->rawValue().toBool();
     _setTransactionInProgress(TransactionRead);
     _connectToMavlink();
     _requestList();
@@ -196,6 +201,8 @@ void PlanManager::_ackTimeout(void)
         } else {
             _retryCount++;
             qCDebug(PlanManagerLog) << tr("Retrying %1 MISSION_REQUEST retry Count").arg(_planTypeString()) << _retryCount;
+            // A pipelined read re-requests every missing item in the window as this single retry
+            _itemIndicesRequested.clear();
             _requestNextMissionItem();
         }
         break;
@@ -290,7 +297,13 @@ bool PlanManager::_checkForExpectedAck(AckType_t receivedAck)
 void PlanManager::_readTransactionComplete(void)
 {
     qCDebug(PlanManagerLog) << "_readTransactionComplete read sequence complete";
-    
+
+    if (_pipelinedRead) {
+        std::sort(_missionItems.begin(), _missionItems.end(), [](const MissionItem* item1, const MissionItem* item2) {
+            return item1->sequenceNumber() < item2->sequenceNumber();
+        });
+    }
+
     SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
     if (sharedLink) {
         mavlink_message_t       message;
@@ -353,7 +366,28 @@ void PlanManager::_requestNextMissionItem(void)
         return;
     }
 
-    qCDebug(PlanManagerLog) << QStringLiteral("_requestNextMissionItem %1 sequenceNumber:retry").arg(_planTypeString()) << _itemIndicesToRead[0] << _retryCount;
+    if (_pipelinedRead) {
+        // Keep the oldest missing items requested, only the ones without a request in flight are sent
+        int inFlight = 0;
+        for (int sequenceNumber: _itemIndicesToRead) {
+            if (inFlight == _maxPipelinedRequests) {
+                break;
+            }
+            if (!_itemIndicesRequested.contains(sequenceNumber)) {
+                _itemIndicesRequested.insert(sequenceNumber);
+                _sendMissionRequest(sequenceNumber);
+            }
+            inFlight++;
+        }
+    } else {
+        _sendMissionRequest(_itemIndicesToRead[0]);
+    }
+    _startAckTimeout(AckMissionItem);
+}
+
+void PlanManager::_sendMissionRequest(int sequenceNumber)
+{
+    qCDebug(PlanManagerLog) << QStringLiteral("_sendMissionRequest %1 sequenceNumber:retry").arg(_planTypeString()) << sequenceNumber << _retryCount;
 
     SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
     if (sharedLink) {
@@ -365,11 +399,10 @@ void PlanManager::_requestNextMissionItem(void)
                                                   &message,
                                                   _vehicle->id(),
                                                   MAV_COMP_ID_AUTOPILOT1,
-                                                  _itemIndicesToRead[0],
+                                                  sequenceNumber,
                                                   _planType);
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
-    _startAckTimeout(AckMissionItem);
 }
 
 void PlanManager::_handleMissionItem(const mavlink_message_t& message)
@@ -439,6 +472,7 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message)
     
     if (_itemIndicesToRead.contains(seq)) {
         _itemIndicesToRead.removeOne(seq);
+        _itemIndicesRequested.remove(seq);
 
         MissionItem* item = new MissionItem(seq,
                                             command,
@@ -467,8 +501,13 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message)
         return;
     }
 
-    emit progressPctChanged((double)seq / (double)_missionItemCountToRead);
-    
+    if (_pipelinedRead) {
+        // Items arrive out of order once a request had to be repeated
+        emit progressPctChanged((double)(_missionItemCountToRead - _itemIndicesToRead.count()) / (double)_missionItemCountToRead);
+    } else {
+        emit progressPctChanged((double)seq / (double)_missionItemCountToRead);
+    }
+
     _retryCount = 0;
     if (_itemIndicesToRead.count() == 0) {
         _readTransactionComplete();
@@ -480,6 +519,7 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message)
 void PlanManager::_clearMissionItems(void)
 {
     _itemIndicesToRead.clear();
+    _itemIndicesRequested.clear();
     _clearAndDeleteMissionItems();
 }
 
@@ -807,6 +847,7 @@ void PlanManager::_finishTransaction(bool success, bool apmGuidedItemWrite)
     _disconnectFromMavlink();
 
     _itemIndicesToRead.clear();
+    _itemIndicesRequested.clear();
     _itemIndicesToWrite.clear();
 
     // First thing we do is clear the transaction. This way inProgesss is off when we signal transaction complete.
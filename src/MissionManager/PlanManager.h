@@ -10,6 +10,7 @@
 #pragma once
 
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
 #include <QtCore/QLoggingCategory>
 
@@ -72,6 +73,8 @@ public:
     // When actively retrying to request mission items, use a shorter timeout instead.
     static const int _retryTimeoutMilliseconds = 250;
     static const int _maxRetryCount = 5;
+    // Number of MISSION_REQUEST_INTs kept in flight during a pipelined read
+    static const int _maxPipelinedRequests = 16;
 
 signals:
     void newMissionItemsAvailable   (bool removeAllRequested);
@@ -114,6 +117,7 @@ protected:
     void _handleMissionRequest(const mavlink_message_t& message);
     void _handleMissionAck(const mavlink_message_t& message);
     void _requestNextMissionItem(void);
+    void _sendMissionRequest(int sequenceNumber);
     void _clearMissionItems(void);
     void _sendError(ErrorCode_t errorCode, const QString& errorMsg);
     QString _ackTypeToString(AckType_t ackType);
@@ -142,6 +146,8 @@ protected:
     bool                _resumeMission;
     QList<int>          _itemIndicesToWrite;    ///< List of mission items which still need to be written to vehicle
     QList<int>          _itemIndicesToRead;     ///< List of mission items which still need to be requested from vehicle
+    QSet<int>           _itemIndicesRequested;  ///< Items of _itemIndicesToRead with a request in flight, pipelined read only
+    bool                _pipelinedRead = false; ///< true: Read keeps up to _maxPipelinedRequests requests in flight
     int                 _lastMissionRequest;    ///< Index of item last requested by MISSION_REQUEST
     int                 _missionItemCountToRead;///< Count of all mission items to read
 
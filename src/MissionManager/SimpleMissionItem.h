@@ -81,9 +81,9 @@ public:
     CameraSection*  cameraSection       (void) { return _cameraSection; }
     SpeedSection*   speedSection        (void) { return _speedSection; }
 
-    QmlObjectListModel* textFieldFacts  (void) { return &_textFieldFacts; }
-    QmlObjectListModel* nanFacts        (void) { return &_nanFacts; }
-    QmlObjectListModel* comboboxFacts   (void) { return &_comboboxFacts; }
+    QmlObjectListModel* textFieldFacts  (void) { _buildEditorFacts(); return &_textFieldFacts; }
+    QmlObjectListModel* nanFacts        (void) { _buildEditorFacts(); return &_nanFacts; }
+    QmlObjectListModel* comboboxFacts   (void) { _buildEditorFacts(); return &_comboboxFacts; }
 
     void setRawEdit(bool rawEdit);
     void setAltitudeMode(QGroundControlQmlGlobal::AltMode altitudeMode);
@@ -173,6 +173,8 @@ private:
     void _updateOptionalSections(void);
     void _rebuildNaNFacts       (void);
     void _rebuildComboBoxFacts  (void);
+    void _buildEditorFacts      (void);
+    FactMetaData* _paramMetaData(int paramIndex);
 
     MissionItem     _missionItem;
     bool            _rawEdit =                  false;
@@ -190,9 +192,12 @@ private:
     Fact                                _altitudeFact;
     Fact                                _amslAltAboveTerrainFact;
 
+    // The editor fact lists and the param meta data they use are only built once the editor asks for them. Most items of a
+    // large loaded mission are never edited.
     QmlObjectListModel  _textFieldFacts;
     QmlObjectListModel  _nanFacts;
     QmlObjectListModel  _comboboxFacts;
+    bool                _editorFactsBuilt = false;
     
     static FactMetaData*    _altitudeMetaData;
     static FactMetaData*    _commandMetaData;
@@ -201,13 +206,7 @@ private:
     static FactMetaData*    _latitudeMetaData;
     static FactMetaData*    _longitudeMetaData;
 
-    FactMetaData    _param1MetaData;
-    FactMetaData    _param2MetaData;
-    FactMetaData    _param3MetaData;
-    FactMetaData    _param4MetaData;
-    FactMetaData    _param5MetaData;
-    FactMetaData    _param6MetaData;
-    FactMetaData    _param7MetaData;
+    FactMetaData*   _rgParamMetaData[7] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
 
     static constexpr const char* _jsonAltitudeModeKey =           "AltitudeMode";
     static constexpr const char* _jsonAltitudeKey =               "Altitude";
@@ -19,8 +19,10 @@
 #include "FirmwarePlugin.h"
 #include "KMLPlanDomDocument.h"
 #include "Vehicle.h"
+#include "TerrainTileManager.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QJsonArray>
 
 QGC_LOGGING_CATEGORY(TransectStyleComplexItemLog, "TransectStyleComplexItemLog")
@@ -36,10 +38,12 @@ TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterC
     , _terrainAdjustToleranceFact       (settingsGroup, _metaDataMap[terrainAdjustToleranceName])
     , _terrainAdjustMaxClimbRateFact    (settingsGroup, _metaDataMap[terrainAdjustMaxClimbRateName])
     , _terrainAdjustMaxDescentRateFact  (settingsGroup, _metaDataMap[terrainAdjustMaxDescentRateName])
+    , _buildTransectsInBackground       (!qgcApp()->runningUnitTests())
 {
     _terrainPolyPathQueryTimer.setInterval(qgcApp()->runningUnitTests() ? 10 : _terrainQueryTimeoutMsecs);
     _terrainPolyPathQueryTimer.setSingleShot(true);
     connect(&_terrainPolyPathQueryTimer, &QTimer::timeout, this, &TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo);
+    connect(&_transectsBuildWatcher, &QFutureWatcher<QList<QList<CoordInfo_t>>>::finished, this, &TransectStyleComplexItem::_transectsBuildFinished);
 
     // The follow is used to compress multiple recalc calls in a row to into a single call.
     connect(this, &TransectStyleComplexItem::_updateFlightPathSegmentsSignal, this, &TransectStyleComplexItem::_updateFlightPathSegmentsDontCallDirectly,   Qt::QueuedConnection);
@@ -51,7 +55,7 @@ TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterC
     connect(&_terrainAdjustMaxClimbRateFact,            &Fact::valueChanged,                this, &TransectStyleComplexItem::_rebuildTransects);
     connect(&_terrainAdjustMaxDescentRateFact,          &Fact::valueChanged,                this, &TransectStyleComplexItem::_rebuildTransects);
     connect(&_terrainAdjustToleranceFact,               &Fact::valueChanged,                this, &TransectStyleComplexItem::_rebuildTransects);
-    connect(&_surveyAreaPolygon,                        &QGCMapPolygon::pathChanged,        this, &TransectStyleComplexItem::_rebuildTransects);
+    connect(&_surveyAreaPolygon,                        &QGCMapPolygon::pathChanged,        this, &TransectStyleComplexItem::_surveyAreaPolygonPathChanged);
     connect(&_cameraTriggerInTurnAroundFact,            &Fact::valueChanged,                this, &TransectStyleComplexItem::_rebuildTransects);
     connect(_cameraCalc.adjustedFootprintSide(),        &Fact::valueChanged,                this, &TransectStyleComplexItem::_rebuildTransects);
     connect(_cameraCalc.adjustedFootprintFrontal(),     &Fact::valueChanged,                this, &TransectStyleComplexItem::_rebuildTransects);
@@ -128,6 +132,8 @@ void TransectStyleComplexItem::setDirty(bool dirty)
 
 void TransectStyleComplexItem::_save(QJsonObject& complexObject)
 {
+    _finishTransectsBuild();
+
     QJsonObject innerObject;
 
     innerObject[JsonHelper::jsonVersionKey] =       2;
@@ -388,12 +394,90 @@ void TransectStyleComplexItem::_rebuildTransects(void)
         return;
     }
 
+    // Supersedes any background build
+    const bool buildInProgress = transectsBuildInProgress();
+    _transectsBuildGeneration++;
+    _pendingTransectsBuilder = TransectsBuilder_t();
+
     _transects.clear();
     _rgPathHeightInfo.clear();
     _rgFlightPathCoordInfo.clear();
 
     _rebuildTransectsPhase1();
+    _transectsRebuilt();
+
+    if (buildInProgress != transectsBuildInProgress()) {
+        emit readyForSaveStateChanged();
+    }
+}
+
+void TransectStyleComplexItem::_surveyAreaPolygonPathChanged(void)
+{
+    if (_ignoreRecalc) {
+        return;
+    }
+
+    TransectsBuilder_t builder;
+    if (_buildTransectsInBackground) {
+        builder = _transectsBuilder();
+    }
+    if (!builder) {
+        _rebuildTransects();
+        return;
+    }
+
+    // Only the newest edit is built, one build at a time. Edits which arrive while a build is in flight replace
+    // each other and the build in flight is dropped once it finishes.
+    const bool buildInProgress = transectsBuildInProgress();
+    _pendingTransectsBuilder = builder;
+    if (!_transectsBuildRunning) {
+        _startPendingTransectsBuild();
+    }
+    if (!buildInProgress) {
+        emit readyForSaveStateChanged();
+    }
+}
 
+void TransectStyleComplexItem::_startPendingTransectsBuild(void)
+{
+    _runningTransectsBuildGeneration = ++_transectsBuildGeneration;
+    _transectsBuildRunning = true;
+    const TransectsBuilder_t builder = _pendingTransectsBuilder;
+    _pendingTransectsBuilder = TransectsBuilder_t();
+    _transectsBuildWatcher.setFuture(QtConcurrent::run(builder));
+}
+
+void TransectStyleComplexItem::_transectsBuildFinished(void)
+{
+    _transectsBuildRunning = false;
+
+    if (_pendingTransectsBuilder) {
+        _startPendingTransectsBuild();
+        return;
+    }
+
+    if (_runningTransectsBuildGeneration == _transectsBuildGeneration) {
+        qCDebug(TransectStyleComplexItemLog) << "_transectsBuildFinished";
+
+        _transects = _transectsBuildWatcher.result();
+        _rgPathHeightInfo.clear();
+        _rgFlightPathCoordInfo.clear();
+        _transectsRebuilt();
+    }
+
+    emit readyForSaveStateChanged();
+}
+
+void TransectStyleComplexItem::_finishTransectsBuild(void)
+{
+    if (transectsBuildInProgress()) {
+        // Rebuilding right here is quicker than waiting for the build in flight plus the edits queued behind it
+        _rebuildTransects();
+    }
+}
+
+void TransectStyleComplexItem::_transectsRebuilt(void)
+{
     _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
 
     switch (_cameraCalc.distanceMode()) {
@@ -565,17 +649,15 @@ void TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo(void)
 {
     qCDebug(TransectStyleComplexItemLog) << "_reallyQueryTransectsPathHeightInfo";
 
-    // Clear any previous queries
-    if (_currentTerrainPolyPathQuery) {
-        disconnect(_currentTerrainPolyPathQuery);
-        _currentTerrainPolyPathQuery = nullptr;
-    }
+    // Clear any previous queries, results still in flight are for an older set of transects
+    _terrainSegmentQueryGeneration++;
+    _pendingTerrainSegmentQueries = 0;
     if (_currentTerrainAtCoordinateQuery) {
         disconnect(_currentTerrainAtCoordinateQuery);
         _currentTerrainAtCoordinateQuery = nullptr;
     }
 
-    // Append all transects into a single PolyPath query
+    // Append all transects into a single path
     QList<QGeoCoordinate> transectPoints;
     for (const QList<CoordInfo_t>& transect: _transects) {
         for (const CoordInfo_t& coordInfo: transect) {
@@ -583,11 +665,114 @@ void TransectStyleComplexItem::_reallyQueryTransectsPathHeightInfo(void)
         }
     }
 
-    if (transectPoints.count() > 1) {
-        _currentTerrainPolyPathQuery = new TerrainPolyPathQuery(true /* autoDelete */);
-        connect(_currentTerrainPolyPathQuery, &TerrainPolyPathQuery::terrainDataReceived, this, &TransectStyleComplexItem::_polyPathTerrainData);
-        _currentTerrainPolyPathQuery->requestData(transectPoints);
+    if (transectPoints.count() < 2) {
+        return;
+    }
+
+    // Segments which are in the cache didn't change since the last query. The others are queried with one poly path
+    // query per run of consecutive changed segments.
+    QList<QList<QGeoCoordinate>>    rgRunPoints;
+    QList<QList<TerrainSegmentKey>> rgRunSegmentKeys;
+    bool inRun = false;
+    _terrainSegmentKeys.clear();
+    for (int i=0; i<transectPoints.count() - 1; i++) {
+        const TerrainSegmentKey segmentKey = _terrainSegmentKey(transectPoints[i], transectPoints[i + 1]);
+        _terrainSegmentKeys.append(segmentKey);
+        if (_terrainSegmentCache.contains(segmentKey)) {
+            inRun = false;
+            continue;
+        }
+        if (!inRun) {
+            rgRunPoints.append(QList<QGeoCoordinate>{ transectPoints[i] });
+            rgRunSegmentKeys.append(QList<TerrainSegmentKey>());
+            inRun = true;
+        }
+        rgRunPoints.last().append(transectPoints[i + 1]);
+        rgRunSegmentKeys.last().append(segmentKey);
+    }
+
+    _terrainSegmentsRequested = 0;
+    _terrainSamplesRequested = 0;
+    for (const QList<TerrainSegmentKey>& runSegmentKeys: rgRunSegmentKeys) {
+        _terrainSegmentsRequested += runSegmentKeys.count();
+    }
+
+    if (rgRunPoints.isEmpty()) {
+        _terrainSegmentQueriesComplete();
+        return;
+    }
+
+    const quint64 generation = _terrainSegmentQueryGeneration;
+    TerrainTileManager* const tileManager = _terrainTileManager ? _terrainTileManager : TerrainTileManager::instance();
+    _pendingTerrainSegmentQueries = rgRunPoints.count();
+    for (int i=0; i<rgRunPoints.count(); i++) {
+        const QList<TerrainSegmentKey> runSegmentKeys = rgRunSegmentKeys[i];
+        TerrainPolyPathQuery* polyPathQuery = new TerrainPolyPathQuery(tileManager, true /* autoDelete */, this);
+        connect(polyPathQuery, &TerrainPolyPathQuery::terrainDataReceived, this, [this, polyPathQuery, generation, runSegmentKeys](bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo) {
+            if (!success) {
+                // Poly path queries only delete themselves on success
+                polyPathQuery->deleteLater();
+            }
+            _segmentPathTerrainData(generation, runSegmentKeys, success, rgPathHeightInfo);
+        });
+        polyPathQuery->requestData(rgRunPoints[i]);
+    }
+}
+
+void TransectStyleComplexItem::_segmentPathTerrainData(quint64 generation, const QList<TerrainSegmentKey>& segmentKeys, bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo)
+{
+    if (generation != _terrainSegmentQueryGeneration) {
+        // Transects changed since the query was sent
+        return;
+    }
+
+    if (!success || (rgPathHeightInfo.count() != segmentKeys.count())) {
+        _terrainSegmentQueryGeneration++;
+        _pendingTerrainSegmentQueries = 0;
+        _polyPathTerrainData(false, QList<TerrainPathQuery::PathHeightInfo_t>());
+        return;
+    }
+
+    for (int i=0; i<segmentKeys.count(); i++) {
+        _terrainSegmentCache[segmentKeys[i]] = rgPathHeightInfo[i];
+        _terrainSamplesRequested += rgPathHeightInfo[i].heights.count();
+    }
+
+    if (--_pendingTerrainSegmentQueries == 0) {
+        _terrainSegmentQueriesComplete();
+    }
+}
+
+void TransectStyleComplexItem::_terrainSegmentQueriesComplete(void)
+{
+    // Only the segments of the current transects are kept, the next edit is compared against them
+    QHash<TerrainSegmentKey, TerrainPathQuery::PathHeightInfo_t> terrainSegmentCache;
+    QList<TerrainPathQuery::PathHeightInfo_t> rgPathHeightInfo;
+    rgPathHeightInfo.reserve(_terrainSegmentKeys.count());
+    for (const TerrainSegmentKey& segmentKey: _terrainSegmentKeys) {
+        const TerrainPathQuery::PathHeightInfo_t pathHeightInfo = _terrainSegmentCache.value(segmentKey);
+        rgPathHeightInfo.append(pathHeightInfo);
+        terrainSegmentCache.insert(segmentKey, pathHeightInfo);
     }
+    _terrainSegmentCache.swap(terrainSegmentCache);
+
+    qCDebug(TransectStyleComplexItemLog) << "_terrainSegmentQueriesComplete re-requested segments:samples" << _terrainSegmentsRequested << _terrainSamplesRequested
+                                         << "total segments" << _terrainSegmentKeys.count();
+
+    _polyPathTerrainData(true, rgPathHeightInfo);
+}
+
+TransectStyleComplexItem::TerrainSegmentKey TransectStyleComplexItem::_terrainSegmentKey(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
+{
+    // Endpoints which round to the same 1e-7 degrees (about a centimeter) are the same segment. Samples along a segment
+    // are always TerrainTileCopernicus::tileValueSpacingMeters apart, so the endpoints determine the samples.
+    auto coordKey = [](const QGeoCoordinate& coord) {
+        const quint64 latitude = static_cast<quint64>(qRound64(coord.latitude() * 1e7) + 900000000);
+        const quint64 longitude = static_cast<quint64>(qRound64(coord.longitude() * 1e7) + 1800000000);
+        return (latitude << 32) | longitude;
+    };
+
+    return TerrainSegmentKey(coordKey(fromCoord), coordKey(toCoord));
 }
 
 void TransectStyleComplexItem::_queryMissionItemCoordHeights(void)
@@ -599,8 +784,8 @@ void TransectStyleComplexItem::_queryMissionItemCoordHeights(void)
     if (_currentTerrainAtCoordinateQuery) {
         qCWarning(TransectStyleComplexItemLog) << "Internal error: _queryMissionItemCoordHeights called multiple times";
         // We are already waiting on another query. We don't care about those results any more.
-        disconnect(_currentTerrainPolyPathQuery);
-        _currentTerrainPolyPathQuery = nullptr;
+        disconnect(_currentTerrainAtCoordinateQuery);
+        _currentTerrainAtCoordinateQuery = nullptr;
     }
 
     // We need terrain heights below each mission item we fly through which is terrain frame
@@ -633,7 +818,6 @@ void TransectStyleComplexItem::_polyPathTerrainData(bool success, const QList<Te
         _adjustForAvailableTerrainData();
         emit readyForSaveStateChanged();
     }
-    _currentTerrainPolyPathQuery = nullptr;
 }
 
 void TransectStyleComplexItem::_missionItemCoordTerrainData(bool success, QList<double> heights)
@@ -649,7 +833,7 @@ void TransectStyleComplexItem::_missionItemCoordTerrainData(bool success, QList<
         _adjustForAvailableTerrainData();
         emit readyForSaveStateChanged();
     }
-    _currentTerrainPolyPathQuery = nullptr;
+    _currentTerrainAtCoordinateQuery = nullptr;
 }
 
 TransectStyleComplexItem::ReadyForSaveState TransectStyleComplexItem::readyForSaveState(void) const
@@ -667,7 +851,7 @@ TransectStyleComplexItem::ReadyForSaveState TransectStyleComplexItem::readyForSa
         // Not following terrain so always ready on terrain
         terrainReady = true;
     }
-    bool polygonNotReady = !_surveyAreaPolygon.isValid();
+    bool polygonNotReady = !_surveyAreaPolygon.isValid() || transectsBuildInProgress();
     return (polygonNotReady || _wizardMode) ?
                 NotReadyForSaveData :
                 (terrainReady ? ReadyForSave : NotReadyForSaveTerrain);
@@ -1108,6 +1292,8 @@ void TransectStyleComplexItem::_handleHoverAndCaptureEnabled(QVariant enabled)
 
 void TransectStyleComplexItem::appendMissionItems(QList<MissionItem*>& items, QObject* missionItemParent)
 {
+    _finishTransectsBuild();
+
     if (_loadedMissionItems.count()) {
         // We have mission items from the loaded plan, use those
         _appendLoadedMissionItems(items, missionItemParent);
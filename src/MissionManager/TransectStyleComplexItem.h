@@ -16,16 +16,24 @@
 #include "CameraCalc.h"
 #include "TerrainQuery.h"
 
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QPair>
+
+#include <functional>
 
 Q_DECLARE_LOGGING_CATEGORY(TransectStyleComplexItemLog)
 
 class PlanMasterController;
+class TerrainTileManager;
 
 class TransectStyleComplexItem : public ComplexMissionItem
 {
     Q_OBJECT
 
+    friend class TransectStyleComplexItemTest;  // Unit test
+
 public:
     TransectStyleComplexItem(PlanMasterController* masterController, bool flyView, QString settignsGroup);
 
@@ -70,6 +78,13 @@ public:
     bool    hoverAndCaptureEnabled  (void) const { return hoverAndCapture()->rawValue().toBool(); }
     bool    triggerCamera           (void) const { return triggerDistance() != 0; }
 
+    /// true: Survey polygon edits rebuild the transects on a worker thread, if the item supports it. Other changes
+    /// always rebuild right away. Defaults to true outside of unit tests.
+    void setBuildTransectsInBackground(bool buildTransectsInBackground) { _buildTransectsInBackground = buildTransectsInBackground; }
+
+    /// @return true: transects are being rebuilt in the background, the current ones are out of date
+    bool transectsBuildInProgress(void) const { return (_transectsBuildRunning && (_runningTransectsBuildGeneration == _transectsBuildGeneration)) || _pendingTransectsBuilder; }
+
     // Used internally only by unit tests
     int _transectCount(void) const { return _transects.count(); }
 
@@ -173,6 +188,12 @@ protected:
         CoordType       coordType;
     } CoordInfo_t;
 
+    typedef std::function<QList<QList<CoordInfo_t>>(void)> TransectsBuilder_t;
+
+    /// Called on the gui thread for a background rebuild of the transects. The returned builder must only use a snapshot
+    /// of the current inputs since it runs on a worker thread. An empty builder rebuilds through _rebuildTransectsPhase1.
+    virtual TransectsBuilder_t _transectsBuilder(void) { return TransectsBuilder_t(); }
+
     QVariantList                                _visualTransectPoints;                          ///< Used to draw the flight path visuals on the screen
     QList<QList<CoordInfo_t>>                   _transects;
     QList<TerrainPathQuery::PathHeightInfo_t>   _rgPathHeightInfo;                              ///< Path height for each segment includes turn segments
@@ -214,6 +235,8 @@ protected:
 
 private slots:
     void _reallyQueryTransectsPathHeightInfo        (void);
+    void _surveyAreaPolygonPathChanged              (void);
+    void _transectsBuildFinished                    (void);
     void _handleHoverAndCaptureEnabled              (QVariant enabled);
     void _updateFlightPathSegmentsDontCallDirectly  (void);
     void _segmentTerrainCollisionChanged            (bool terrainCollision) final;
@@ -227,6 +250,8 @@ private:
         bool useConditionGate;
     } BuildMissionItemsState_t;
 
+    typedef QPair<quint64, quint64> TerrainSegmentKey;  ///< Quantized from/to coordinates of a path segment
+
     void    _queryTransectsPathHeightInfo                                   (void);
     void    _queryMissionItemCoordHeights                                   (void);
     void    _adjustForAvailableTerrainData                                  (void);
@@ -239,10 +264,31 @@ private:
     double  _altitudeBetweenCoords                                          (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double percentTowardsTo);
     int     _maxPathHeight                                                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
     BuildMissionItemsState_t _buildMissionItemsState                        (void) const;
+    void    _segmentPathTerrainData                                         (quint64 generation, const QList<TerrainSegmentKey>& segmentKeys, bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo);
+    void    _terrainSegmentQueriesComplete                                  (void);
+    void    _transectsRebuilt                                               (void);
+    void    _startPendingTransectsBuild                                     (void);
+    void    _finishTransectsBuild                                           (void);
+
+    static TerrainSegmentKey _terrainSegmentKey                             (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
 
-    TerrainPolyPathQuery*       _currentTerrainPolyPathQuery        = nullptr;
     TerrainAtCoordinateQuery*   _currentTerrainAtCoordinateQuery    = nullptr;
     QTimer                      _terrainPolyPathQueryTimer;
+    TerrainTileManager*         _terrainTileManager                 = nullptr;  ///< Answers the transect path queries, nullptr: TerrainTileManager::instance()
+
+    QHash<TerrainSegmentKey, TerrainPathQuery::PathHeightInfo_t>    _terrainSegmentCache;               ///< Path heights of the segments of the last queried transects
+    QList<TerrainSegmentKey>                                        _terrainSegmentKeys;                ///< Segments of the transects being queried, in path order
+    quint64                                                         _terrainSegmentQueryGeneration = 0; ///< Bumped whenever queries in flight become stale
+    int                                                             _pendingTerrainSegmentQueries = 0;
+    int                                                             _terrainSegmentsRequested = 0;      ///< Segments re-queried for the last edit
+    int                                                             _terrainSamplesRequested = 0;       ///< Terrain samples re-queried for the last edit
+
+    bool                                        _buildTransectsInBackground;
+    QFutureWatcher<QList<QList<CoordInfo_t>>>   _transectsBuildWatcher;
+    TransectsBuilder_t                          _pendingTransectsBuilder;           ///< Newest polygon edit, waiting on the build in flight
+    quint64                                     _transectsBuildGeneration = 0;      ///< Bumped by every rebuild, stale background results are dropped
+    quint64                                     _runningTransectsBuildGeneration = 0;
+    bool                                        _transectsBuildRunning = false;     ///< Set until the watcher's finished signal is handled, which is later than the future finishes
 
     // Deprecated json keys
     static constexpr const char* _jsonTerrainFollowKeyDeprecated       = "FollowTerrain";
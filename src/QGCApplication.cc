@@ -20,6 +20,7 @@
 #include <QtCore/QRegularExpression>
 #include <QtGui/QFontDatabase>
 #include <QtGui/QIcon>
+#include <QtGui/QScreen>
 #include <QtQuick/QQuickWindow>
 #include <QtQuick/QQuickImageProvider>
 #include <QtQuickControls2/QQuickStyle>
@@ -47,6 +48,7 @@
 #include "AutoPilotPlugin.h"
 #include "VehicleComponent.h"
 #include "MultiVehicleManager.h"
+#include "FactGroupUpdateScheduler.h"
 #include "Vehicle.h"
 #include "JoystickConfigController.h"
 #include "JoystickManager.h"
@@ -427,6 +429,12 @@ void QGCApplication::_initForNormalAppBoot()
     if (rootWindow) {
         rootWindow->scheduleRenderJob(new FinishVideoInitialization(_toolbox->videoManager()),
                 QQuickWindow::BeforeSynchronizingStage);
+
+        // Batch Fact value updates once per display refresh
+        const QScreen* screen = rootWindow->screen();
+        if (screen && (screen->refreshRate() > 0)) {
+            FactGroupUpdateScheduler::instance()->setFrameIntervalMSecs(qRound(1000.0 / screen->refreshRate()));
+        }
     }
 
     // Safe to show popup error messages now that main window is created
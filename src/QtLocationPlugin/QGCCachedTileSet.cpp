@@ -88,7 +88,7 @@ void QGCCachedTileSet::createDownloadTask()
 void QGCCachedTileSet::resumeDownloadTask()
 {
     _cancelPending = false;
-    QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, "*");
+    QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, UrlFactory::kAllTilesKey);
     getQGCMapEngine()->addTask(task);
     createDownloadTask();
 }
@@ -164,14 +164,14 @@ void QGCCachedTileSet::_prepareDownload()
         const int mapId = UrlFactory::getQtMapIdFromProviderType(tile->type());
         QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(mapId, tile->x(), tile->y(), tile->z());
         request.setOriginatingObject(this);
-        request.setAttribute(QNetworkRequest::User, tile->hash());
+        request.setAttribute(QNetworkRequest::User, QVariant::fromValue(tile->key()));
 
         QNetworkReply* const reply = _networkManager->get(request);
         reply->setParent(this);
         QGCFileDownload::setIgnoreSSLErrorsIfNeeded(*reply);
         (void) connect(reply, &QNetworkReply::finished, this, &QGCCachedTileSet::_networkReplyFinished);
         (void) connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
-        (void) _replies.insert(tile->hash(), reply);
+        (void) _replies.insert(tile->key(), reply);
 
         delete tile;
         if (!_batchRequested && !_noMoreTiles && (_tilesToDownload.count() < (QGeoTileFetcherQGC::concurrentDownloads(_type) * 10))) {
@@ -198,18 +198,16 @@ void QGCCachedTileSet::_networkReplyFinished()
         return;
     }
 
-    const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    if (hash.isEmpty()) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Empty Hash";
+    const quint64 key = reply->request().attribute(QNetworkRequest::User).toULongLong();
+    if (key == UrlFactory::kInvalidTileKey) {
+        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Invalid Key";
         return;
     }
 
-    if (_replies.contains(hash)) {
-        (void) _replies.remove(hash);
-    } else {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Reply not in list: " << hash;
+    if (!_replies.remove(key)) {
+        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Reply not in list: " << key;
     }
-    qCDebug(QGCCachedTileSetLog) << "Tile fetched:" << hash;
+    qCDebug(QGCCachedTileSetLog) << "Tile fetched:" << key;
 
     QByteArray image = reply->readAll();
     if (image.isEmpty()) {
@@ -217,7 +215,7 @@ void QGCCachedTileSet::_networkReplyFinished()
         return;
     }
 
-    const QString type = UrlFactory::tileHashToType(hash);
+    const QString type = UrlFactory::tileKeyToType(key);
     const SharedMapProvider mapProvider = UrlFactory::getMapProviderFromProviderType(type);
     Q_CHECK_PTR(mapProvider);
 
@@ -236,9 +234,9 @@ void QGCCachedTileSet::_networkReplyFinished()
         return;
     }
 
-    QGeoFileTileCacheQGC::cacheTile(type, hash, image, format, _id);
+    QGeoFileTileCacheQGC::cacheTile(type, key, image, format, _id);
 
-    QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
+    QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, key);
     getQGCMapEngine()->addTask(task);
 
     setSavedTileSize(_savedTileSize + image.size());
@@ -263,23 +261,21 @@ void QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
 
     setErrorCount(_errorCount + 1);
 
-    const QString hash = reply->request().attribute(QNetworkRequest::User).toString();
-    if (hash.isEmpty()) {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Empty Hash";
+    const quint64 key = reply->request().attribute(QNetworkRequest::User).toULongLong();
+    if (key == UrlFactory::kInvalidTileKey) {
+        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Invalid Key";
         return;
     }
 
-    if (_replies.contains(hash)) {
-        (void) _replies.remove(hash);
-    } else {
-        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Reply not in list:" << hash;
+    if (!_replies.remove(key)) {
+        qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Reply not in list:" << key;
     }
 
     if (error != QNetworkReply::OperationCanceledError) {
         qCWarning(QGCCachedTileSetLog) << Q_FUNC_INFO << "Error:" << reply->errorString();
     }
 
-    QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
+    QGCUpdateTileDownloadStateTask* const task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, key);
     getQGCMapEngine()->addTask(task);
 
     _prepareDownload();
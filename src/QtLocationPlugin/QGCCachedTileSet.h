@@ -64,6 +64,7 @@ class QGCCachedTileSet : public QObject
     Q_PROPERTY(quint64      id                  READ    id                  CONSTANT)
     Q_PROPERTY(bool         deleting            READ    deleting            NOTIFY deletingChanged)
     Q_PROPERTY(bool         downloading         READ    downloading         NOTIFY downloadingChanged)
+    Q_PROPERTY(int          creationProgress    READ    creationProgress    NOTIFY creationProgressChanged)
     Q_PROPERTY(quint32      errorCount          READ    errorCount          NOTIFY errorCountChanged)
     Q_PROPERTY(QString      errorCountStr       READ    errorCountStr       NOTIFY errorCountChanged)
     Q_PROPERTY(bool         selected            READ    selected            WRITE  setSelected  NOTIFY selectedChanged)
@@ -107,6 +108,8 @@ public:
     bool defaultSet() const { return _defaultSet; }
     bool deleting() const { return _deleting; }
     bool downloading() const { return _downloading; }
+    /// @return Percentage of the download list prepared while the set is created, 100 once it is
+    int creationProgress() const { return _creationProgress; }
     quint32 errorCount() const { return _errorCount; }
     QString errorCountStr() const;
     bool selected() const { return _selected; }
@@ -136,11 +139,13 @@ public:
     void setDefaultSet(bool def) { _defaultSet = def; }
     void setDeleting(bool del) { if (del != _deleting) { _deleting = del; emit deletingChanged(); } }
     void setDownloading(bool down) { if (down != _downloading) { _downloading = down; emit downloadingChanged(); } }
+    void setCreationProgress(int percentage) { if (percentage != _creationProgress) { _creationProgress = percentage; emit creationProgressChanged(); } }
     void setErrorCount(quint32 count) { if (count != _errorCount) { _errorCount = count; emit errorCountChanged(); } }
 
 signals:
     void deletingChanged();
     void downloadingChanged();
+    void creationProgressChanged();
     void totalTileCountChanged();
     void uniqueTileCountChanged();
     void uniqueTileSizeChanged();
@@ -178,6 +183,7 @@ private:
     quint32 _errorCount = 0;
     int _minZoom = 3;
     int _maxZoom = 3;
+    int _creationProgress = 100;
     bool _defaultSet = false;
     bool _deleting = false;
     bool _downloading = false;
@@ -187,7 +193,7 @@ private:
     bool _cancelPending = false;
     QDateTime _creationDate;
 
-    QHash<QString, QNetworkReply*> _replies;
+    QHash<quint64, QNetworkReply*> _replies;    ///< Keyed by tile key
     QQueue<QGCTile*> _tilesToDownload;
     QGCMapEngineManager *_manager = nullptr;
     QNetworkAccessManager *_networkManager = nullptr;
@@ -89,7 +89,7 @@ void QGCMapEngine::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32
     if (!m_prunning && (defaultsize > maxSize)) {
         m_prunning = true;
 
-        const quint64 amountToPrune = defaultsize - maxSize;
+        const quint64 amountToPrune = defaultsize - static_cast<quint64>(maxSize * kPruneLowWatermark);
         QGCPruneCacheTask* const task = new QGCPruneCacheTask(amountToPrune);
         (void) connect(task, &QGCPruneCacheTask::pruned, this, &QGCMapEngine::_pruned);
         (void) addTask(task);
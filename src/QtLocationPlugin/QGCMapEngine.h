@@ -50,6 +50,10 @@ private slots:
 private:
     QGCCacheWorker *m_worker = nullptr;
     bool m_prunning = false;
+
+    /// Pruning starts once the default set exceeds the maximum cache size and frees space down to this fraction of
+    /// it, so it doesn't run again for every tile saved after it
+    static constexpr double kPruneLowWatermark = 0.9;
 };
 
 extern QGCMapEngine *getQGCMapEngine();
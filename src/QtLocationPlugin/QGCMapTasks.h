@@ -18,10 +18,13 @@
 
 #pragma once
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
 #include <QtCore/QString>
 
+#include <atomic>
+
 #include "QGCTile.h"
 #include "QGCCacheTile.h"
 #include "QGCCachedTileSet.h"
@@ -44,7 +47,8 @@ public:
         taskPruneCache,
         taskReset,
         taskExport,
-        taskImport
+        taskImport,
+        taskCheckTotals
     };
     Q_ENUM(TaskType);
 
@@ -56,6 +60,14 @@ public:
 
     TaskType type() const { return m_type; }
 
+    /// A canceled task which has not started yet is dropped by the worker without emitting anything
+    void cancel() { m_canceled = true; }
+    bool isCanceled() const { return m_canceled; }
+
+    /// Started by the worker when the task is queued
+    void startQueueTimer() { m_queueTimer.start(); }
+    qint64 queuedNSecs() const { return m_queueTimer.nsecsElapsed(); }
+
     void setError(const QString &errorString = QString())
     {
         emit error(m_type, errorString);
@@ -66,6 +78,8 @@ signals:
 
 private:
     const TaskType m_type = TaskType::taskInit;
+    std::atomic_bool m_canceled = false;
+    QElapsedTimer m_queueTimer;
 };
 
 //-----------------------------------------------------------------------------
@@ -116,8 +130,14 @@ public:
         emit tileSetSaved(m_tileSet);
     }
 
+    void setProgress(int percentage)
+    {
+        emit actionProgress(percentage);
+    }
+
 signals:
     void tileSetSaved(QGCCachedTileSet *tileSet);
+    void actionProgress(int percentage);
 
 private:
     QGCCachedTileSet* const m_tileSet = nullptr;
@@ -131,9 +151,9 @@ class QGCFetchTileTask : public QGCMapTask
     Q_OBJECT
 
 public:
-    explicit QGCFetchTileTask(const QString &hash, QObject *parent = nullptr)
+    explicit QGCFetchTileTask(quint64 key, QObject *parent = nullptr)
         : QGCMapTask(QGCMapTask::taskFetchTile, parent)
-        , m_hash(hash)
+        , m_key(key)
     {}
     ~QGCFetchTileTask() = default;
 
@@ -142,13 +162,13 @@ public:
         emit tileFetched(tile);
     }
 
-    QString hash() const { return m_hash; }
+    quint64 key() const { return m_key; }
 
 signals:
     void tileFetched(QGCCacheTile *tile);
 
 private:
-    const QString m_hash;
+    const quint64 m_key = 0;
 };
 
 //-----------------------------------------------------------------------------
@@ -210,22 +230,23 @@ class QGCUpdateTileDownloadStateTask : public QGCMapTask
     Q_OBJECT
 
 public:
-    QGCUpdateTileDownloadStateTask(quint64 setID, QGCTile::TileState state, const QString &hash, QObject *parent = nullptr)
+    /// @param key Tile key, UrlFactory::kAllTilesKey for all tiles of the set
+    QGCUpdateTileDownloadStateTask(quint64 setID, QGCTile::TileState state, quint64 key, QObject *parent = nullptr)
         : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState, parent)
         , m_setID(setID)
         , m_state(state)
-        , m_hash(hash)
+        , m_key(key)
     {}
     ~QGCUpdateTileDownloadStateTask() = default;
 
-    QString hash() const { return m_hash; }
+    quint64 key() const { return m_key; }
     quint64 setID() const { return m_setID; }
     QGCTile::TileState state() const { return m_state; }
 
 private:
     const quint64 m_setID = 0;
     const QGCTile::TileState m_state = QGCTile::StatePending;
-    const QString m_hash;
+    const quint64 m_key = 0;
 };
 
 //-----------------------------------------------------------------------------
@@ -306,6 +327,35 @@ private:
 
 //-----------------------------------------------------------------------------
 
+/// Recounts the cache totals the worker maintains and compares them with the maintained values
+class QGCCheckTotalsTask : public QGCMapTask
+{
+    Q_OBJECT
+
+public:
+    /// @param repair Replace the maintained totals with the recounted ones when they differ
+    explicit QGCCheckTotalsTask(bool repair = false, QObject *parent = nullptr)
+        : QGCMapTask(QGCMapTask::taskCheckTotals, parent)
+        , m_repair(repair)
+    {}
+    ~QGCCheckTotalsTask() = default;
+
+    bool repair() const { return m_repair; }
+
+    void setTotalsChecked(bool consistent)
+    {
+        emit totalsChecked(consistent);
+    }
+
+signals:
+    void totalsChecked(bool consistent);
+
+private:
+    const bool m_repair = false;
+};
+
+//-----------------------------------------------------------------------------
+
 class QGCResetTask : public QGCMapTask
 {
     Q_OBJECT
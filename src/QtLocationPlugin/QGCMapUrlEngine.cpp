@@ -23,6 +23,9 @@
 #include "ElevationMapProvider.h"
 #include <QGCLoggingCategory.h>
 
+#include <QtCore/QHash>
+#include <QtCore/qalgorithms.h>
+
 QGC_LOGGING_CATEGORY(QGCMapUrlEngineLog, "qgc.qtlocationplugin.qgcmapurlengine")
 
 const QList<SharedMapProvider> UrlFactory::_providers = {
@@ -239,31 +242,110 @@ QStringList UrlFactory::getProviderTypes()
     return types;
 }
 
-QString UrlFactory::providerTypeFromHash(int hash)
+int UrlFactory::hashFromProviderType(QStringView type)
 {
-    for (const SharedMapProvider &provider : _providers) {
-        if (hashFromProviderType(provider->getMapName()) == hash) {
-            return provider->getMapName();
+    return static_cast<int>(qHash(type) >> 1);
+}
+
+QString UrlFactory::getTileHash(QStringView type, int x, int y, int z)
+{
+    const int hash = hashFromProviderType(type);
+    return QString::asprintf("%010d%08d%08d%03d", hash, x, y, z);
+}
+
+quint16 UrlFactory::providerIdFromProviderType(QStringView type)
+{
+    return qChecksum(type.toLatin1());
+}
+
+const QHash<quint16, QString>& UrlFactory::_providerTypesById()
+{
+    // Providers whose ids collide map to an empty type, neither of them gets keys
+    static const QHash<quint16, QString> providerTypes = []() {
+        QHash<quint16, QString> types;
+        for (const SharedMapProvider &provider : _providers) {
+            const quint16 providerId = providerIdFromProviderType(provider->getMapName());
+            if (types.contains(providerId)) {
+                qCCritical(QGCMapUrlEngineLog) << Q_FUNC_INFO << "provider id" << providerId << "of" << provider->getMapName() << "already used by" << types.value(providerId);
+                types[providerId].clear();
+            } else {
+                (void) types.insert(providerId, provider->getMapName());
+            }
         }
+        return types;
+    }();
+
+    return providerTypes;
+}
+
+quint64 UrlFactory::getTileKey(QStringView type, int x, int y, int z)
+{
+    // Out of range values would spill into the bits of the zoom marker or the provider id
+    if ((z < 0) || (z > MAX_MAP_ZOOM) || (x < 0) || (x >= (1 << z)) || (y < 0) || (y >= (1 << z))) {
+        qCWarning(QGCMapUrlEngineLog) << Q_FUNC_INFO << "tile out of range:" << type << x << y << z;
+        return kInvalidTileKey;
     }
 
-    qCWarning(QGCMapUrlEngineLog) << Q_FUNC_INFO << "provider not found from hash:" << hash;
-    return QStringLiteral("");
+    const quint16 providerId = providerIdFromProviderType(type);
+    const QHash<quint16, QString> &providerTypes = _providerTypesById();
+    if (providerTypes.contains(providerId) && providerTypes.value(providerId).isEmpty()) {
+        qCWarning(QGCMapUrlEngineLog) << Q_FUNC_INFO << "provider id is not unique:" << type;
+        return kInvalidTileKey;
+    }
+
+    // The marker bit above the x and y bits gives the zoom level back
+    const quint64 tileIndex = (Q_UINT64_C(1) << (2 * z)) | (static_cast<quint64>(y) << z) | static_cast<quint64>(x);
+    return (static_cast<quint64>(providerId) << kTileKeyProviderShift) | tileIndex;
 }
 
-int UrlFactory::hashFromProviderType(QStringView type)
+QString UrlFactory::tileKeyToType(quint64 tileKey)
 {
-    return static_cast<int>(qHash(type) >> 1);
+    const quint16 providerId = static_cast<quint16>(tileKey >> kTileKeyProviderShift);
+    const QString type = _providerTypesById().value(providerId);
+    if (type.isEmpty()) {
+        qCWarning(QGCMapUrlEngineLog) << Q_FUNC_INFO << "provider not found from id:" << providerId;
+    }
+
+    return type;
 }
 
-QString UrlFactory::tileHashToType(QStringView tileHash)
+void UrlFactory::tileKeyToXYZ(quint64 tileKey, int &x, int &y, int &z)
 {
-    const int providerHash = tileHash.mid(0,10).toInt();
-    return providerTypeFromHash(providerHash);
+    const quint64 tileIndex = tileKey & ((Q_UINT64_C(1) << kTileKeyProviderShift) - 1);
+    if (tileIndex == 0) {
+        x = y = z = 0;
+        return;
+    }
+
+    const int markerBit = 63 - static_cast<int>(qCountLeadingZeroBits(tileIndex));
+    z = markerBit / 2;
+    const quint64 mask = (Q_UINT64_C(1) << z) - 1;
+    x = static_cast<int>(tileIndex & mask);
+    y = static_cast<int>((tileIndex >> z) & mask);
 }
 
-QString UrlFactory::getTileHash(QStringView type, int x, int y, int z)
+quint64 UrlFactory::tileHashToKey(QStringView tileHash)
 {
-    const int hash = hashFromProviderType(type);
-    return QString::asprintf("%010d%08d%08d%03d", hash, x, y, z);
+    if (tileHash.size() != 29) {
+        return kInvalidTileKey;
+    }
+
+    bool providerOk = false, xOk = false, yOk = false, zOk = false;
+    const int providerHash = tileHash.mid(0, 10).toInt(&providerOk);
+    const int x = tileHash.mid(10, 8).toInt(&xOk);
+    const int y = tileHash.mid(18, 8).toInt(&yOk);
+    const int z = tileHash.mid(26, 3).toInt(&zOk);
+    if (!providerOk || !xOk || !yOk || !zOk || (z < 0) || (z > MAX_MAP_ZOOM) ||
+            (x < 0) || (x >= (1 << z)) || (y < 0) || (y >= (1 << z))) {
+        return kInvalidTileKey;
+    }
+
+    // No warning, tiles of providers which have since been removed are expected here
+    for (const SharedMapProvider &provider : _providers) {
+        if (hashFromProviderType(provider->getMapName()) == providerHash) {
+            return getTileKey(provider->getMapName(), x, y, z);
+        }
+    }
+
+    return kInvalidTileKey;
 }
@@ -19,6 +19,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QByteArrayView>
+#include <QtCore/QHash>
 #include <QtCore/QStringView>
 
 class MapProvider;
@@ -50,14 +51,29 @@ public:
     static QString getProviderTypeFromQtMapId(int qtMapId);
     static std::shared_ptr<const MapProvider> getMapProviderFromQtMapId(int qtMapId);
     static std::shared_ptr<const MapProvider> getMapProviderFromProviderType(QStringView type);
-    static QString providerTypeFromHash(int hash);
 
     static int hashFromProviderType(QStringView type);
-    static QString tileHashToType(QStringView tileHash);
     static QString getTileHash(QStringView type, int x, int y, int z);
 
+    /// Tile cache key: provider id in the high bits, then zoom level, x and y packed as a quadtree index.
+    /// The provider id is a checksum of the provider name so keys stay the same across builds and releases.
+    /// @return kInvalidTileKey if x, y or z are out of range or the provider id is shared with another provider
+    static quint64 getTileKey(QStringView type, int x, int y, int z);
+    static QString tileKeyToType(quint64 tileKey);
+    static void tileKeyToXYZ(quint64 tileKey, int &x, int &y, int &z);
+    /// @return Key for a tile hash of the old fixed width string format, 0 if it can't be parsed
+    static quint64 tileHashToKey(QStringView tileHash);
+    static quint16 providerIdFromProviderType(QStringView type);
+
+    static constexpr quint64 kInvalidTileKey = 0;   ///< Not a valid key, every key has its zoom level marker bit set
+    static constexpr quint64 kAllTilesKey = UINT64_MAX;
+
 private:
+    static const QHash<quint16, QString>& _providerTypesById();
+
     static const QList<std::shared_ptr<const MapProvider>> _providers;
+
+    static constexpr int kTileKeyProviderShift = 47;  ///< Tile index of zoom level 23 needs 47 bits
 };
 
 typedef std::shared_ptr<const MapProvider> SharedMapProvider;
@@ -29,14 +29,14 @@ public:
     int y() const { return m_y; }
     int z() const { return m_z; }
     quint64 tileSet() const { return m_tileSet;  }
-    QString hash() const { return m_hash; }
+    quint64 key() const { return m_key; }
     QString type() const { return m_type; }
 
     void setX(int x) { m_x = x; }
     void setY(int y) { m_y = y; }
     void setZ(int z) { m_z = z; }
     void setTileSet(quint64 tileSet) { m_tileSet = tileSet;  }
-    void setHash(const QString &hash) { m_hash = hash; }
+    void setKey(quint64 key) { m_key = key; }
     void setType(const QString &type) { m_type = type; }
 
 private:
@@ -44,7 +44,7 @@ private:
     int m_y = 0;
     int m_z = 0;
     quint64 m_tileSet = UINT64_MAX;
-    QString m_hash;
+    quint64 m_key = 0;
     QString m_type = QStringLiteral("Invalid");
 };
 Q_DECLARE_METATYPE(QGCTile)
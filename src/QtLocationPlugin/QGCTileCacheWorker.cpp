@@ -24,11 +24,16 @@
 
 #include <QtCore/QDateTime>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QSettings>
+#include <QtCore/QStringList>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlError>
+#include <QtSql/QSqlRecord>
+
+#include <algorithm>
 
 QByteArray QGCCacheWorker::_bingNoTileImage;
 
@@ -36,6 +41,7 @@ QGC_LOGGING_CATEGORY(QGCTileCacheWorkerLog, "qgc.qtlocationplugin.qgctilecachewo
 
 QGCCacheWorker::QGCCacheWorker(QObject* parent)
     : QThread(parent)
+    , _session(QStringLiteral("%1_%2").arg(kSession).arg(reinterpret_cast<quintptr>(this)))
 {
     // qCDebug(QGCTileCacheWorkerLog) << Q_FUNC_INFO << this;
 }
@@ -48,7 +54,11 @@ QGCCacheWorker::~QGCCacheWorker()
 void QGCCacheWorker::stop()
 {
     QMutexLocker lock(&_taskQueueMutex);
-    qDeleteAll(_taskQueue);
+    for (QQueue<QGCMapTask*> &queue: _taskQueues) {
+        qDeleteAll(queue);
+        queue.clear();
+    }
+    _pendingSaves.clear();
     lock.unlock();
 
     if(this->isRunning()) {
@@ -66,7 +76,14 @@ bool QGCCacheWorker::enqueueTask(QGCMapTask *task)
 
     // TODO: Prepend Stop Task Instead?
     QMutexLocker lock(&_taskQueueMutex);
-    _taskQueue.enqueue(task);
+    task->startQueueTimer();
+    if (task->type() == QGCMapTask::taskCacheTile) {
+        QGCSaveTileTask* const saveTask = static_cast<QGCSaveTileTask*>(task);
+        if (!_pendingSaves.contains(saveTask->tile()->key())) {
+            _pendingSaves.insert(saveTask->tile()->key(), saveTask);
+        }
+    }
+    _taskQueues[_taskPriority(task->type())].enqueue(task);
     lock.unlock();
 
     if (isRunning()) {
@@ -97,14 +114,23 @@ QGCCacheWorker::run()
 
     QMutexLocker lock(&_taskQueueMutex);
     while (true) {
-        if (!_taskQueue.isEmpty()) {
-            QGCMapTask* const task = _taskQueue.dequeue();
+        const QList<QGCMapTask*> tasks = _dequeueTasks();
+        if (!tasks.isEmpty()) {
             lock.unlock();
-            _runTask(task);
+            if (tasks.first()->type() == QGCMapTask::taskCacheTile) {
+                _saveTiles(tasks);
+            } else {
+                _runTask(tasks.first());
+            }
             lock.relock();
-            task->deleteLater();
+            for (QGCMapTask* const task: tasks) {
+                task->deleteLater();
+            }
 
-            const qsizetype count = _taskQueue.count();
+            qsizetype count = 0;
+            for (const QQueue<QGCMapTask*> &queue: _taskQueues) {
+                count += queue.count();
+            }
             if (count > 100) {
                 _updateTimeout = kLongTimeout;
             } else if (count < 25) {
@@ -114,29 +140,130 @@ QGCCacheWorker::run()
             if ((count == 0) || _updateTimer.hasExpired(_updateTimeout)) {
                 if (_valid) {
                     lock.unlock();
+                    _saveTileAccess();
                     _updateTotals();
                     lock.relock();
                 }
             }
         } else {
             (void) _waitc.wait(lock.mutex(), 5000);
-            if (_taskQueue.isEmpty()) {
+            if (std::all_of(std::begin(_taskQueues), std::end(_taskQueues), [](const QQueue<QGCMapTask*> &queue) { return queue.isEmpty(); })) {
                 break;
             }
         }
     }
     lock.unlock();
 
+    _logTaskWaits();
+    _saveTileAccess();
     _disconnectDB();
 }
 
+QGCCacheWorker::TaskWait QGCCacheWorker::taskWait(QGCMapTask::TaskType type) const
+{
+    QMutexLocker lock(&_taskQueueMutex);
+    return _taskWaits.value(type);
+}
+
+QGCCacheWorker::TaskPriority QGCCacheWorker::_taskPriority(QGCMapTask::TaskType type)
+{
+    switch (type) {
+    case QGCMapTask::taskFetchTile:
+        return priorityInteractive;
+    case QGCMapTask::taskPruneCache:
+    case QGCMapTask::taskCheckTotals:
+        // Running these after tasks queued later doesn't change their outcome
+        return priorityMaintenance;
+    default:
+        return priorityNormal;
+    }
+}
+
+/// Takes the next tasks to run off the queues, called with the queue mutex held.
+///     @return Consecutive tile saves up to kSaveBatchSize, a single task otherwise, empty if nothing is queued
+QList<QGCMapTask*> QGCCacheWorker::_dequeueTasks()
+{
+    QQueue<QGCMapTask*> &maintenanceQueue = _taskQueues[priorityMaintenance];
+    const bool maintenanceDue = !maintenanceQueue.isEmpty() && (maintenanceQueue.head()->queuedNSecs() > (kMaintenanceWaitMSecs * 1000000));
+
+    QList<QGCMapTask*> tasks;
+    const auto takeTasks = [this, &tasks](QQueue<QGCMapTask*> &queue) {
+        while (!queue.isEmpty() && (tasks.isEmpty() || ((tasks.first()->type() == QGCMapTask::taskCacheTile) && (queue.head()->type() == QGCMapTask::taskCacheTile) && (tasks.count() < kSaveBatchSize)))) {
+            QGCMapTask* const task = queue.dequeue();
+            if (task->type() == QGCMapTask::taskCacheTile) {
+                const quint64 key = static_cast<QGCSaveTileTask*>(task)->tile()->key();
+                if (_pendingSaves.value(key) == task) {
+                    (void) _pendingSaves.remove(key);
+                }
+            }
+            if (task->isCanceled()) {
+                qCDebug(QGCTileCacheWorkerLog) << "Dropping canceled task" << task->type();
+                task->deleteLater();
+                continue;
+            }
+            _recordTaskWait(task);
+            tasks.append(task);
+        }
+    };
+
+    if (maintenanceDue) {
+        takeTasks(maintenanceQueue);
+    }
+    for (QQueue<QGCMapTask*> &queue: _taskQueues) {
+        if (!tasks.isEmpty()) {
+            break;
+        }
+        takeTasks(queue);
+    }
+
+    return tasks;
+}
+
+void QGCCacheWorker::_recordTaskWait(const QGCMapTask *task)
+{
+    const qint64 nsecs = task->queuedNSecs();
+    TaskWait &wait = _taskWaits[task->type()];
+    wait.count++;
+    wait.totalNSecs += nsecs;
+    wait.maxNSecs = qMax(wait.maxNSecs, nsecs);
+}
+
+void QGCCacheWorker::_logTaskWaits() const
+{
+    if (!QGCTileCacheWorkerLog().isDebugEnabled()) {
+        return;
+    }
+
+    QMutexLocker lock(&_taskQueueMutex);
+    for (auto it = _taskWaits.constBegin(); it != _taskWaits.constEnd(); ++it) {
+        const TaskWait &wait = it.value();
+        qCDebug(QGCTileCacheWorkerLog) << "Queue wait" << static_cast<QGCMapTask::TaskType>(it.key())
+                                       << "count:" << wait.count
+                                       << "avg ms:" << (static_cast<double>(wait.totalNSecs) / wait.count / 1e6)
+                                       << "max ms:" << (static_cast<double>(wait.maxNSecs) / 1e6);
+    }
+}
+
+/// @return Copy of the tile waiting in a queued save, nullptr if no save for key is queued
+QGCCacheTile *QGCCacheWorker::_pendingSaveTile(quint64 key)
+{
+    QMutexLocker lock(&_taskQueueMutex);
+    QGCSaveTileTask* const task = _pendingSaves.value(key);
+    if (!task) {
+        return nullptr;
+    }
+
+    const QGCCacheTile* const tile = task->tile();
+    return new QGCCacheTile(tile->key(), tile->img(), tile->format(), tile->type());
+}
+
 void QGCCacheWorker::_runTask(QGCMapTask *task)
 {
     switch (task->type()) {
     case QGCMapTask::taskInit:
         break;
     case QGCMapTask::taskCacheTile:
-        _saveTile(task);
+        _saveTiles({ task });
         break;
     case QGCMapTask::taskFetchTile:
         _getTile(task);
@@ -171,6 +298,9 @@ void QGCCacheWorker::_runTask(QGCMapTask *task)
     case QGCMapTask::taskImport:
         _importSets(task);
         break;
+    case QGCMapTask::taskCheckTotals:
+        _checkTotals(task);
+        break;
     default:
         qCWarning(QGCTileCacheWorkerLog) << Q_FUNC_INFO << "given unhandled task type" << task->type();
         break;
@@ -199,13 +329,13 @@ QGCCacheWorker::_deleteBingNoTileTiles()
     QSqlQuery query(*_db);
     QString s;
     //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, tile, hash FROM Tiles WHERE LENGTH(tile) = %1").arg(noTileBytes.length());
+    s = QString("SELECT tileID, tile, tileKey FROM Tiles WHERE LENGTH(tile) = %1").arg(noTileBytes.length());
     QList<quint64> idsToDelete;
     if (query.exec(s)) {
         while(query.next()) {
             if (query.value(1).toByteArray() == noTileBytes) {
                 idsToDelete.append(query.value(0).toULongLong());
-                qCDebug(QGCTileCacheWorkerLog) << "_deleteBingNoTileTiles HASH:" << query.value(2).toString();
+                qCDebug(QGCTileCacheWorkerLog) << "_deleteBingNoTileTiles KEY:" << query.value(2).toULongLong();
             }
         }
         for (const quint64 tileId: idsToDelete) {
@@ -253,33 +383,44 @@ QGCCacheWorker::_getDefaultTileSet()
 
 //-----------------------------------------------------------------------------
 void
-QGCCacheWorker::_saveTile(QGCMapTask *mtask)
+QGCCacheWorker::_saveTiles(const QList<QGCMapTask*> &tasks)
 {
-    if(_valid) {
-        QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
-        QSqlQuery query(*_db);
-        query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-        query.addBindValue(task->tile()->hash());
-        query.addBindValue(task->tile()->format());
-        query.addBindValue(task->tile()->img());
-        query.addBindValue(task->tile()->img().size());
-        query.addBindValue(task->tile()->type());
-        query.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
-        if(query.exec()) {
-            quint64 tileID = query.lastInsertId().toULongLong();
-            quint64 setID = task->tile()->tileSet() == UINT64_MAX ? _getDefaultTileSet() : task->tile()->tileSet();
-            QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-            query.prepare(s);
-            if(!query.exec()) {
-                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
+    if(!_valid) {
+        qWarning() << "Map Cache SQL error (saveTile() open db):" << _db->lastError();
+        return;
+    }
+    QSqlQuery* const tileQuery = _preparedQuery(_saveTileQuery, "INSERT INTO Tiles(tileKey, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+    QSqlQuery* const setTileQuery = _preparedQuery(_saveSetTileQuery, "INSERT INTO SetTiles(tileID, setID) VALUES(?, ?)");
+    if(!tileQuery || !setTileQuery) {
+        return;
+    }
+    const bool transaction = _db->transaction();
+    const qint64 date = QDateTime::currentSecsSinceEpoch();
+    for(QGCMapTask* const mtask : tasks) {
+        const QGCCacheTile* const tile = static_cast<QGCSaveTileTask*>(mtask)->tile();
+        tileQuery->bindValue(0, static_cast<qint64>(tile->key()));
+        tileQuery->bindValue(1, tile->format());
+        tileQuery->bindValue(2, tile->img());
+        tileQuery->bindValue(3, tile->img().size());
+        tileQuery->bindValue(4, tile->type());
+        tileQuery->bindValue(5, date);
+        if(tileQuery->exec()) {
+            const quint64 tileID = tileQuery->lastInsertId().toULongLong();
+            const quint64 setID = tile->tileSet() == UINT64_MAX ? _getDefaultTileSet() : tile->tileSet();
+            setTileQuery->bindValue(0, tileID);
+            setTileQuery->bindValue(1, setID);
+            if(!setTileQuery->exec()) {
+                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << setTileQuery->lastError().text();
             }
-            qCDebug(QGCTileCacheWorkerLog) << "_saveTile() HASH:" << task->tile()->hash();
+            qCDebug(QGCTileCacheWorkerLog) << "_saveTile() KEY:" << tile->key();
         } else {
             //-- Tile was already there.
             //   QtLocation some times requests the same tile twice in a row. The first is saved, the second is already there.
         }
-    } else {
-        qWarning() << "Map Cache SQL error (saveTile() open db):" << _db->lastError();
+    }
+    if(transaction && !_db->commit()) {
+        qWarning() << "Map Cache SQL error (commit tiles):" << _db->lastError();
+        (void) _db->rollback();
     }
 }
 
@@ -292,21 +433,33 @@ QGCCacheWorker::_getTile(QGCMapTask* mtask)
     }
     bool found = false;
     QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
-    if(query.exec(s)) {
-        if(query.next()) {
-            const QByteArray& arrray   = query.value(0).toByteArray();
-            const QString& format  = query.value(1).toString();
-            const QString& type = query.value(2).toString();
-            qCDebug(QGCTileCacheWorkerLog) << "_getTile() (Found in DB) HASH:" << task->hash();
-            QGCCacheTile* tile = new QGCCacheTile(task->hash(), arrray, format, type);
+    QSqlQuery* const query = _preparedQuery(_getTileQuery, "SELECT tile, format, type, tileID FROM Tiles WHERE tileKey = ?");
+    if(query) {
+        query->bindValue(0, static_cast<qint64>(task->key()));
+        if(query->exec() && query->next()) {
+            const QByteArray& arrray   = query->value(0).toByteArray();
+            const QString& format  = query->value(1).toString();
+            const QString& type = query->value(2).toString();
+            qCDebug(QGCTileCacheWorkerLog) << "_getTile() (Found in DB) KEY:" << task->key();
+            QGCCacheTile* tile = new QGCCacheTile(task->key(), arrray, format, type);
+            task->setTileFetched(tile);
+            (void) _accessedTiles.insert(query->value(3).toULongLong());
+            found = true;
+        }
+        //-- Don't keep the read transaction open, it would hold back WAL checkpoints
+        query->finish();
+    }
+    if(!found) {
+        //-- Saves run after fetches, so the tile may still be waiting in the queue
+        QGCCacheTile* const tile = _pendingSaveTile(task->key());
+        if(tile) {
+            qCDebug(QGCTileCacheWorkerLog) << "_getTile() (Queued to save) KEY:" << task->key();
             task->setTileFetched(tile);
             found = true;
         }
     }
     if(!found) {
-        qCDebug(QGCTileCacheWorkerLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
+        qCDebug(QGCTileCacheWorkerLog) << "_getTile() (NOT in DB) KEY:" << task->key();
         task->setError("Tile not in cache database");
     }
 }
@@ -360,72 +513,48 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
         set->setTotalTileSize(_defaultSize);
         return;
     }
-    QSqlQuery subquery(*_db);
-    QString sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(set->id());
-    qCDebug(QGCTileCacheWorkerLog) << "_updateSetTotals(): " << sq;
-    if(subquery.exec(sq)) {
-        if(subquery.next()) {
-            set->setSavedTileCount(subquery.value(0).toUInt());
-            set->setSavedTileSize(subquery.value(1).toULongLong());
-            qCDebug(QGCTileCacheWorkerLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
-            //-- Update (estimated) size
-            quint64 avg = UrlFactory::averageSizeForType(set->type());
-            if(set->totalTileCount() <= set->savedTileCount()) {
-                //-- We're done so the saved size is the total size
-                set->setTotalTileSize(set->savedTileSize());
-            } else {
-                //-- Otherwise we need to estimate it.
-                if(set->savedTileCount() > 10 && set->savedTileSize()) {
-                    avg = set->savedTileSize() / set->savedTileCount();
-                }
-                set->setTotalTileSize(avg * set->totalTileCount());
-            }
-            //-- Now figure out the count for tiles unique to this set
-            quint32 ucount = 0;
-            quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
-            if(subquery.exec(sq)) {
-                if(subquery.next()) {
-                    //-- This is only accurate when all tiles are downloaded
-                    ucount = subquery.value(0).toUInt();
-                    usize  = subquery.value(1).toULongLong();
-                }
-            }
-            //-- If we haven't downloaded it all, estimate size of unique tiles
-            quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
-            if(!ucount) {
-                usize = expectedUcount * avg;
-            } else {
-                expectedUcount = ucount;
-            }
-            set->setUniqueTileCount(expectedUcount);
-            set->setUniqueTileSize(usize);
+    const SetTotals_t totals = _readSetTotals(set->id());
+    set->setSavedTileCount(static_cast<quint32>(totals.tileCount));
+    set->setSavedTileSize(totals.tileSize);
+    qCDebug(QGCTileCacheWorkerLog) << "Set" << set->id() << "Totals:" << set->savedTileCount() << " " << set->savedTileSize() << "Expected: " << set->totalTileCount() << " " << set->totalTilesSize();
+    //-- Update (estimated) size
+    quint64 avg = UrlFactory::averageSizeForType(set->type());
+    if(set->totalTileCount() <= set->savedTileCount()) {
+        //-- We're done so the saved size is the total size
+        set->setTotalTileSize(set->savedTileSize());
+    } else {
+        //-- Otherwise we need to estimate it.
+        if(set->savedTileCount() > 10 && set->savedTileSize()) {
+            avg = set->savedTileSize() / set->savedTileCount();
         }
+        set->setTotalTileSize(avg * set->totalTileCount());
+    }
+    //-- Now figure out the count for tiles unique to this set
+    //-- This is only accurate when all tiles are downloaded
+    const quint32 ucount = static_cast<quint32>(totals.uniqueCount);
+    quint64 usize = totals.uniqueSize;
+    //-- If we haven't downloaded it all, estimate size of unique tiles
+    quint32 expectedUcount = set->totalTileCount() - set->savedTileCount();
+    if(!ucount) {
+        usize = expectedUcount * avg;
+    } else {
+        expectedUcount = ucount;
     }
+    set->setUniqueTileCount(expectedUcount);
+    set->setUniqueTileSize(usize);
 }
 
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_updateTotals()
 {
-    QSqlQuery query(*_db);
-    QString s;
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
-    qCDebug(QGCTileCacheWorkerLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _totalCount = query.value(0).toUInt();
-            _totalSize  = query.value(1).toULongLong();
-        }
-    }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
-    qCDebug(QGCTileCacheWorkerLog) << "_updateTotals(): " << s;
-    if(query.exec(s)) {
-        if(query.next()) {
-            _defaultCount = query.value(0).toUInt();
-            _defaultSize  = query.value(1).toULongLong();
-        }
-    }
+    const SetTotals_t totals = _readSetTotals(0);
+    _totalCount = static_cast<quint32>(totals.tileCount);
+    _totalSize  = totals.tileSize;
+    const SetTotals_t defaultTotals = _readSetTotals(_getDefaultTileSet());
+    _defaultCount = static_cast<quint32>(defaultTotals.uniqueCount);
+    _defaultSize  = defaultTotals.uniqueSize;
+    qCDebug(QGCTileCacheWorkerLog) << "_updateTotals():" << _totalCount << _totalSize << _defaultCount << _defaultSize;
     emit updateTotals(_totalCount, _totalSize, _defaultCount, _defaultSize);
     if (!_updateTimer.isValid()) {
         _updateTimer.start();
@@ -435,17 +564,49 @@ QGCCacheWorker::_updateTotals()
 }
 
 //-----------------------------------------------------------------------------
-quint64 QGCCacheWorker::_findTile(const QString &hash)
+QGCCacheWorker::SetTotals_t
+QGCCacheWorker::_readSetTotals(quint64 setID)
 {
-    quint64 tileID = 0;
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tileID FROM Tiles WHERE hash = \"%1\"").arg(hash);
-    if(query.exec(s)) {
-        if(query.next()) {
-            tileID = query.value(0).toULongLong();
+    SetTotals_t totals = { 0, 0, 0, 0 };
+    QSqlQuery* const query = _preparedQuery(_getSetTotalsQuery, "SELECT tileCount, tileSize, uniqueCount, uniqueSize FROM SetTotals WHERE setID = ?");
+    if(query) {
+        query->bindValue(0, static_cast<qint64>(setID));
+        //-- A set without a row has no tiles yet
+        if(query->exec() && query->next()) {
+            totals.tileCount   = query->value(0).toULongLong();
+            totals.tileSize    = query->value(1).toULongLong();
+            totals.uniqueCount = query->value(2).toULongLong();
+            totals.uniqueSize  = query->value(3).toULongLong();
+        }
+        query->finish();
+    }
+    return totals;
+}
+
+//-----------------------------------------------------------------------------
+QGCCacheWorker::SetTotals_t
+QGCCacheWorker::_countSetTotals(QSqlDatabase& db, quint64 setID)
+{
+    SetTotals_t totals = { 0, 0, 0, 0 };
+    QSqlQuery query(db);
+    QString s;
+    if(setID == 0) {
+        s = QString("SELECT COUNT(size), SUM(size) FROM Tiles");
+    } else {
+        s = QString("SELECT COUNT(size), SUM(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(setID);
+    }
+    if(query.exec(s) && query.next()) {
+        totals.tileCount = query.value(0).toULongLong();
+        totals.tileSize  = query.value(1).toULongLong();
+    }
+    if(setID != 0) {
+        s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
+        if(query.exec(s) && query.next()) {
+            totals.uniqueCount = query.value(0).toULongLong();
+            totals.uniqueSize  = query.value(1).toULongLong();
         }
     }
-    return tileID;
+    return totals;
 }
 
 //-----------------------------------------------------------------------------
@@ -454,8 +615,9 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
 {
     if(_valid) {
         //-- Create Tile Set
-        quint32 actual_count = 0;
         QGCCreateTileSetTask* task = static_cast<QGCCreateTileSetTask*>(mtask);
+        //-- The set and its tiles go in together, a failure leaves neither behind
+        (void) _db->transaction();
         QSqlQuery query(*_db);
         query.prepare("INSERT INTO TileSets("
             "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, date"
@@ -473,51 +635,90 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
         query.addBindValue(QDateTime::currentDateTime().toSecsSinceEpoch());
         if(!query.exec()) {
             qWarning() << "Map Cache SQL error (add tileSet into TileSets):" << query.lastError().text();
+            (void) _db->rollback();
         } else {
             //-- Get just created (auto-incremented) setID
-            quint64 setID = query.lastInsertId().toULongLong();
-            task->tileSet()->setId(setID);
+            const quint64 setID = query.lastInsertId().toULongLong();
             //-- Prepare Download List
-            _db->transaction();
+            const QString type = task->tileSet()->type();
+            QList<QGCTileSet> zoomSets;
+            quint64 tileCount = 0;
             for(int z = task->tileSet()->minZoom(); z <= task->tileSet()->maxZoom(); z++) {
-                QGCTileSet set = UrlFactory::getTileCount(z,
+                zoomSets.append(UrlFactory::getTileCount(z,
                     task->tileSet()->topleftLon(), task->tileSet()->topleftLat(),
-                    task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), task->tileSet()->type());
-                QString type = task->tileSet()->type();
-                for(int x = set.tileX0; x <= set.tileX1; x++) {
-                    for(int y = set.tileY0; y <= set.tileY1; y++) {
-                        //-- See if tile is already downloaded
-                        QString hash = UrlFactory::getTileHash(type, x, y, z);
-                        quint64 tileID = _findTile(hash);
-                        if(!tileID) {
-                            //-- Set to download
-                            query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(?, ?, ?, ?, ? ,? ,?)");
-                            query.addBindValue(setID);
-                            query.addBindValue(hash);
-                            query.addBindValue(UrlFactory::getQtMapIdFromProviderType(type));
-                            query.addBindValue(x);
-                            query.addBindValue(y);
-                            query.addBindValue(z);
-                            query.addBindValue(0);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into TilesDownload):" << query.lastError().text();
-                                mtask->setError("Error creating tile set download list");
-                                return;
-                            } else
-                                actual_count++;
-                        } else {
-                            //-- Tile already in the database. No need to dowload.
-                            QString s = QString("INSERT OR IGNORE INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(tileID).arg(setID);
-                            query.prepare(s);
-                            if(!query.exec()) {
-                                qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
-                            }
-                            qCDebug(QGCTileCacheWorkerLog) << "_createTileSet() Already Cached HASH:" << hash;
+                    task->tileSet()->bottomRightLon(), task->tileSet()->bottomRightLat(), type));
+                tileCount += zoomSets.last().tileCount;
+            }
+            //-- The keys of the area are staged first and matched against the cache in bulk, instead of a lookup and an
+            //   insert per tile. Rows go in by y then x which is ascending key order.
+            QSqlQuery stageQuery(*_db);
+            if(!query.exec("CREATE TEMP TABLE IF NOT EXISTS TileSetTiles (tileKey INTEGER PRIMARY KEY, x INTEGER, y INTEGER, z INTEGER)") ||
+                    !query.exec("DELETE FROM TileSetTiles") ||
+                    !stageQuery.prepare("INSERT OR IGNORE INTO TileSetTiles(tileKey, x, y, z) VALUES(?, ?, ?, ?)")) {
+                qWarning() << "Map Cache SQL error (stage tile set):" << query.lastError().text() << stageQuery.lastError().text();
+                (void) _db->rollback();
+                mtask->setError("Error creating tile set download list");
+                return;
+            }
+            quint64 stagedCount = 0;
+            int lastProgress = -1;
+            for(int i = 0; i < zoomSets.count(); i++) {
+                const QGCTileSet& set = zoomSets[i];
+                const int z = task->tileSet()->minZoom() + i;
+                for(int y = set.tileY0; y <= set.tileY1; y++) {
+                    for(int x = set.tileX0; x <= set.tileX1; x++) {
+                        const quint64 tileKey = UrlFactory::getTileKey(type, x, y, z);
+                        if(tileKey == UrlFactory::kInvalidTileKey) {
+                            continue;
+                        }
+                        stageQuery.bindValue(0, static_cast<qint64>(tileKey));
+                        stageQuery.bindValue(1, x);
+                        stageQuery.bindValue(2, y);
+                        stageQuery.bindValue(3, z);
+                        if(!stageQuery.exec()) {
+                            qWarning() << "Map Cache SQL error (stage tile):" << stageQuery.lastError().text();
+                            (void) _db->rollback();
+                            mtask->setError("Error creating tile set download list");
+                            return;
+                        }
+                        //-- Staging is most of the work, the bulk inserts below get the last 10%
+                        const int progress = static_cast<int>(++stagedCount * 90 / qMax(tileCount, stagedCount));
+                        if(progress != lastProgress) {
+                            lastProgress = progress;
+                            task->setProgress(progress);
                         }
                     }
                 }
             }
-            _db->commit();
+            stageQuery.finish();
+            //-- Tiles already in the cache join the set, the rest go on its download list
+            query.prepare("INSERT INTO SetTiles(tileID, setID) SELECT A.tileID, ? FROM TileSetTiles B INNER JOIN Tiles A ON A.tileKey = B.tileKey");
+            query.addBindValue(setID);
+            bool res = query.exec();
+            if(res) {
+                qCDebug(QGCTileCacheWorkerLog) << "_createTileSet() Already Cached:" << query.numRowsAffected();
+                query.prepare("INSERT OR IGNORE INTO TilesDownload(setID, tileKey, type, x, y, z, state) "
+                              "SELECT ?, B.tileKey, ?, B.x, B.y, B.z, 0 FROM TileSetTiles B LEFT JOIN Tiles A ON A.tileKey = B.tileKey WHERE A.tileID IS NULL");
+                query.addBindValue(setID);
+                query.addBindValue(UrlFactory::getQtMapIdFromProviderType(type));
+                res = query.exec();
+            }
+            if(!res) {
+                qWarning() << "Map Cache SQL error (add tiles into TilesDownload):" << query.lastError().text();
+                (void) _db->rollback();
+                mtask->setError("Error creating tile set download list");
+                return;
+            }
+            qCDebug(QGCTileCacheWorkerLog) << "_createTileSet() To Download:" << query.numRowsAffected() << "of" << stagedCount;
+            (void) query.exec("DELETE FROM TileSetTiles");
+            if(!_db->commit()) {
+                qWarning() << "Map Cache SQL error (commit tile set):" << _db->lastError().text();
+                (void) _db->rollback();
+                mtask->setError("Error saving tile set");
+                return;
+            }
+            task->tileSet()->setId(setID);
+            task->setProgress(100);
             //-- Done
             _updateSetTotals(task->tileSet());
             task->setTileSetSaved();
@@ -537,20 +738,23 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     QQueue<QGCTile*> tiles;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
+    QString s = QString("SELECT tileKey FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
     if(query.exec(s)) {
         while(query.next()) {
             QGCTile* tile = new QGCTile;
             // tile->setTileSet(task->setID());
-            tile->setHash(query.value("hash").toString());
-            tile->setType(UrlFactory::getProviderTypeFromQtMapId(query.value("type").toInt()));
-            tile->setX(query.value("x").toInt());
-            tile->setY(query.value("y").toInt());
-            tile->setZ(query.value("z").toInt());
+            tile->setKey(query.value("tileKey").toULongLong());
+            //-- Map ids can change between builds, the provider in the key does not
+            tile->setType(UrlFactory::tileKeyToType(tile->key()));
+            int x, y, z;
+            UrlFactory::tileKeyToXYZ(tile->key(), x, y, z);
+            tile->setX(x);
+            tile->setY(y);
+            tile->setZ(z);
             tiles.enqueue(tile);
         }
         for(int i = 0; i < tiles.size(); i++) {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
+            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and tileKey = %3").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->key());
             if(!query.exec(s)) {
                 qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
             }
@@ -570,12 +774,12 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
     QSqlQuery query(*_db);
     QString s;
     if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
+        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND tileKey = %2").arg(task->setID()).arg(task->key());
     } else {
-        if(task->hash() == "*") {
+        if(task->key() == UrlFactory::kAllTilesKey) {
             s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
         } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND tileKey = %3").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->key());
         }
     }
     if(!query.exec(s)) {
@@ -591,26 +795,47 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
         return;
     }
     QGCPruneCacheTask* task = static_cast<QGCPruneCacheTask*>(mtask);
+    _saveTileAccess();
+    //-- Walk tiles in no set other than the default one, least recently used first, until enough space is freed
     QSqlQuery query(*_db);
-    QString s;
-    //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
-    qint64 amount = (qint64)task->amount();
-    QList<quint64> tlist;
-    if(query.exec(s)) {
-        while(query.next() && amount >= 0) {
-            tlist << query.value(0).toULongLong();
-            amount -= query.value(1).toULongLong();
-            qCDebug(QGCTileCacheWorkerLog) << "_pruneCache() HASH:" << query.value(2).toString();
+    QString s = QString("SELECT A.tileID, A.size FROM TileAccess A WHERE NOT EXISTS (SELECT 1 FROM SetTiles B WHERE B.tileID = A.tileID AND B.setID <> %1) ORDER BY A.access ASC").arg(_getDefaultTileSet());
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (select tiles to prune):" << query.lastError().text();
+        return;
+    }
+    QList<qint64> tileIDs;
+    quint64 size = 0;
+    while((size < task->amount()) && query.next()) {
+        tileIDs.append(query.value(0).toLongLong());
+        size += query.value(1).toULongLong();
+    }
+    query.finish();
+    //-- Deleted in chunks within one transaction, a single statement listing every id could exceed the SQL length limit
+    if(!tileIDs.isEmpty()) {
+        const bool transaction = _db->transaction();
+        bool res = true;
+        qsizetype preparedCount = 0;
+        for(qsizetype i = 0; res && (i < tileIDs.count()); i += kPruneChunkSize) {
+            const qsizetype count = qMin(static_cast<qsizetype>(kPruneChunkSize), tileIDs.count() - i);
+            if(count != preparedCount) {
+                preparedCount = count;
+                res = query.prepare(QString("DELETE FROM Tiles WHERE tileID IN (%1)").arg(QStringList(count, QStringLiteral("?")).join(',')));
+            }
+            for(qsizetype j = 0; res && (j < count); j++) {
+                query.bindValue(static_cast<int>(j), tileIDs[i + j]);
+            }
+            res = res && query.exec();
         }
-        while(tlist.count()) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
-            tlist.removeFirst();
-            if(!query.exec(s))
-                break;
+        if(res && (!transaction || _db->commit())) {
+            qCDebug(QGCTileCacheWorkerLog) << "_pruneCache() tiles:bytes" << tileIDs.count() << size;
+        } else {
+            qWarning() << "Map Cache SQL error (prune tiles):" << query.lastError().text() << _db->lastError();
+            if(transaction) {
+                (void) _db->rollback();
+            }
         }
-        task->setPruned();
     }
+    task->setPruned();
 }
 
 //-----------------------------------------------------------------------------
@@ -667,6 +892,7 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    _clearPreparedQueries();
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -677,6 +903,11 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     query.exec(s);
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
+    s = QString("DROP TABLE SetTotals");
+    query.exec(s);
+    s = QString("DROP TABLE TileAccess");
+    query.exec(s);
+    _accessedTiles.clear();
     _valid = _createDB(*_db);
     task->setResetCompleted();
 }
@@ -711,6 +942,8 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
         dbImport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
         if (dbImport->open()) {
             QSqlQuery query(*dbImport);
+            //-- Sets exported before tile keys still identify their tiles by hash
+            const bool importHashes = dbImport->record("Tiles").contains("hash");
             //-- Prepare progress report
             quint64 tileCount = 0;
             quint64 currentCount = 0;
@@ -790,13 +1023,16 @@ QGCCacheWorker::_importSets(QGCMapTask* mtask)
                             _db->transaction();
                             while(subQuery.next()) {
                                 tilesFound++;
-                                QString hash    = subQuery.value("hash").toString();
+                                const quint64 key = importHashes ? UrlFactory::tileHashToKey(subQuery.value("hash").toString()) : subQuery.value("tileKey").toULongLong();
+                                if(key == UrlFactory::kInvalidTileKey) {
+                                    continue;
+                                }
                                 QString format  = subQuery.value("format").toString();
                                 QByteArray img  = subQuery.value("tile").toByteArray();
                                 int type        = subQuery.value("type").toInt();
                                 //-- Save tile
-                                cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                cQuery.addBindValue(hash);
+                                cQuery.prepare("INSERT INTO Tiles(tileKey, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+                                cQuery.addBindValue(static_cast<qint64>(key));
                                 cQuery.addBindValue(format);
                                 cQuery.addBindValue(img);
                                 cQuery.addBindValue(img.size());
@@ -930,13 +1166,13 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
                             QSqlQuery subQuery(*_db);
                             if(subQuery.exec(s)) {
                                 if(subQuery.next()) {
-                                    QString hash    = subQuery.value("hash").toString();
+                                    const qint64 key = subQuery.value("tileKey").toLongLong();
                                     QString format  = subQuery.value("format").toString();
                                     QByteArray img  = subQuery.value("tile").toByteArray();
                                     int type        = subQuery.value("type").toInt();
                                     //-- Save tile
-                                    exportQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                    exportQuery.addBindValue(hash);
+                                    exportQuery.prepare("INSERT INTO Tiles(tileKey, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
+                                    exportQuery.addBindValue(key);
                                     exportQuery.addBindValue(format);
                                     exportQuery.addBindValue(img);
                                     exportQuery.addBindValue(img.size());
@@ -969,6 +1205,45 @@ QGCCacheWorker::_exportSets(QGCMapTask* mtask)
     task->setExportCompleted();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_checkTotals(QGCMapTask* mtask)
+{
+    if(!_testTask(mtask)) {
+        return;
+    }
+    QGCCheckTotalsTask* task = static_cast<QGCCheckTotalsTask*>(mtask);
+    QList<quint64> setIDs = { 0 };
+    QSqlQuery query(*_db);
+    if(query.exec("SELECT setID FROM TileSets")) {
+        while(query.next()) {
+            setIDs.append(query.value(0).toULongLong());
+        }
+    }
+    bool consistent = true;
+    for(const quint64 setID : setIDs) {
+        const SetTotals_t counted = _countSetTotals(*_db, setID);
+        const SetTotals_t maintained = _readSetTotals(setID);
+        if((counted.tileCount != maintained.tileCount) || (counted.tileSize != maintained.tileSize) ||
+                (counted.uniqueCount != maintained.uniqueCount) || (counted.uniqueSize != maintained.uniqueSize)) {
+            qCWarning(QGCTileCacheWorkerLog) << "Totals mismatch set:" << setID
+                << "counted" << counted.tileCount << counted.tileSize << counted.uniqueCount << counted.uniqueSize
+                << "maintained" << maintained.tileCount << maintained.tileSize << maintained.uniqueCount << maintained.uniqueSize;
+            consistent = false;
+        }
+    }
+    if(!consistent && task->repair()) {
+        (void) _db->transaction();
+        if(!_rebuildTotals(*_db) || !_db->commit()) {
+            qWarning() << "Map Cache SQL error (rebuild totals):" << _db->lastError();
+            (void) _db->rollback();
+            task->setError("Error rebuilding cache totals");
+        }
+        _updateTotals();
+    }
+    task->setTotalsChecked(consistent);
+}
+
 //-----------------------------------------------------------------------------
 bool QGCCacheWorker::_testTask(QGCMapTask* mtask)
 {
@@ -984,6 +1259,7 @@ bool
 QGCCacheWorker::_init()
 {
     _failed = false;
+    _migrationFailed = false;
     if(!_databasePath.isEmpty()) {
         qCDebug(QGCTileCacheWorkerLog) << "Mapping cache directory:" << _databasePath;
         //-- Initialize Database
@@ -997,6 +1273,10 @@ QGCCacheWorker::_init()
             _failed = true;
         }
         _disconnectDB();
+        //-- Start over with an empty cache, the old one stays on disk
+        if(_migrationFailed && _backupDatabase()) {
+            return _init();
+        }
     } else {
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
@@ -1008,23 +1288,83 @@ QGCCacheWorker::_init()
 bool
 QGCCacheWorker::_connectDB()
 {
-    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession)));
+    _db.reset(new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session)));
     _db->setDatabaseName(_databasePath);
     _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
     _valid = _db->open();
+    if(_valid) {
+        _configureDB();
+    }
     return _valid;
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_configureDB()
+{
+    //-- With a write ahead log a commit appends to the log instead of rewriting pages, and synchronous NORMAL only
+    //   syncs the log at checkpoints. A crash can lose the most recently cached tiles but leaves the database intact.
+    QSqlQuery query(*_db);
+    if(!query.exec("PRAGMA journal_mode = WAL")) {
+        qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (journal_mode):" << query.lastError().text();
+    }
+    if(!query.exec("PRAGMA synchronous = NORMAL")) {
+        qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (synchronous):" << query.lastError().text();
+    }
+    //-- Negative cache_size is in KiB
+    (void) query.exec(QString("PRAGMA cache_size = -%1").arg(kPageCacheKiB));
+    (void) query.exec("PRAGMA temp_store = MEMORY");
+}
+
+//-----------------------------------------------------------------------------
+QSqlQuery*
+QGCCacheWorker::_preparedQuery(std::unique_ptr<QSqlQuery> &query, const char *sql)
+{
+    if(!query) {
+        query = std::make_unique<QSqlQuery>(*_db);
+        if(!query->prepare(sql)) {
+            qWarning() << "Map Cache SQL error (prepare):" << sql << query->lastError().text();
+            query.reset();
+        }
+    }
+    return query.get();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_clearPreparedQueries()
+{
+    _saveTileQuery.reset();
+    _saveSetTileQuery.reset();
+    _getTileQuery.reset();
+    _getSetTotalsQuery.reset();
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
 {
     bool res = false;
     QSqlQuery query(db);
+    //-- Databases from before tile keys are converted in place. The old tables are moved aside and copied over once
+    //   the new ones exist, all in one transaction.
+    const bool migrate = db.record("Tiles").contains("hash");
+    //-- Totals are counted once for databases from before they were maintained
+    const bool countTotals = !db.tables().contains("SetTotals");
+    QElapsedTimer migrateTimer;
+    if(migrate) {
+        //-- Runs once, but blocks the map cache until it is done, which takes a while for caches of several GB
+        qCInfo(QGCTileCacheWorkerLog) << "Converting map tile cache to tile keys:" << _databasePath;
+        migrateTimer.start();
+        (void) db.transaction();
+        (void) query.exec("DROP INDEX IF EXISTS hash");
+        (void) query.exec("ALTER TABLE Tiles RENAME TO HashTiles");
+        (void) query.exec("ALTER TABLE TilesDownload RENAME TO HashTilesDownload");
+    }
     if(!query.exec(
         "CREATE TABLE IF NOT EXISTS Tiles ("
         "tileID INTEGER PRIMARY KEY NOT NULL, "
-        "hash TEXT NOT NULL UNIQUE, "
+        "tileKey INTEGER NOT NULL UNIQUE, "
         "format TEXT NOT NULL, "
         "tile BLOB NULL, "
         "size INTEGER, "
@@ -1033,8 +1373,6 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
     {
         qWarning() << "Map Cache SQL error (create Tiles db):" << query.lastError().text();
     } else {
-        query.exec("CREATE INDEX IF NOT EXISTS hash ON Tiles ( hash, size, type ) ");
-             
         if(!query.exec(
             "CREATE TABLE IF NOT EXISTS TileSets ("
             "setID INTEGER PRIMARY KEY NOT NULL, "
@@ -1063,7 +1401,7 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
                 if(!query.exec(
                     "CREATE TABLE IF NOT EXISTS TilesDownload ("
                     "setID INTEGER, "
-                    "hash TEXT NOT NULL UNIQUE, "
+                    "tileKey INTEGER NOT NULL UNIQUE, "
                     "type INTEGER, "
                     "x INTEGER, "
                     "y INTEGER, "
@@ -1073,11 +1411,34 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
                     qWarning() << "Map Cache SQL error (create TilesDownload db):" << query.lastError().text();
                 } else {
                     //-- Database it ready for use
-                    res = true;
+                    res = _createTileAccess(db) && _createTotals(db);
                 }
             }
         }
     }
+    if(migrate) {
+        res = res && _migrateTileKeys(db);
+        if(res && db.commit()) {
+            //-- Give back the space of the old tables and their text indices
+            if(!query.exec("VACUUM")) {
+                qCWarning(QGCTileCacheWorkerLog) << "Map Cache SQL error (vacuum):" << query.lastError().text();
+            }
+            qCInfo(QGCTileCacheWorkerLog) << "Converted map tile cache to tile keys in" << migrateTimer.elapsed() << "ms";
+        } else {
+            qWarning() << "Map Cache SQL error (converting tile hashes):" << query.lastError().text() << db.lastError();
+            (void) db.rollback();
+            res = false;
+            _migrationFailed = true;
+        }
+    }
+    if(res && countTotals) {
+        (void) db.transaction();
+        res = _rebuildTotals(db) && db.commit();
+        if(!res) {
+            qWarning() << "Map Cache SQL error (counting totals):" << db.lastError();
+            (void) db.rollback();
+        }
+    }
     //-- Create default tile set
     if(res && createDefault) {
         QString s = QString("SELECT name FROM TileSets WHERE name = \"%1\"").arg("Default Tile Set");
@@ -1096,19 +1457,255 @@ QGCCacheWorker::_createDB(QSqlDatabase& db, bool createDefault)
             qWarning() << "Map Cache SQL error (Looking for default tile set):" << db.lastError();
         }
     }
-    if(!res) {
+    //-- The rollback left a cache which failed to convert as it was, _init() sets it aside
+    if(!res && !_migrationFailed) {
         QFile file(_databasePath);
         file.remove();
     }
     return res;
 }
 
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_backupDatabase()
+{
+    const QString backupPath = QStringLiteral("%1.%2.bak").arg(_databasePath, QDateTime::currentDateTime().toString("yyyyMMddhhmmss"));
+    if(!QFile::rename(_databasePath, backupPath)) {
+        qCritical() << "Map Cache could not move" << _databasePath << "to" << backupPath;
+        return false;
+    }
+    //-- A write ahead log left behind belongs to the old database
+    for(const QLatin1String suffix : {QLatin1String("-wal"), QLatin1String("-shm")}) {
+        if(QFile::exists(_databasePath + suffix)) {
+            (void) QFile::rename(_databasePath + suffix, backupPath + suffix);
+        }
+    }
+    qWarning() << "Map tile cache could not be converted to tile keys, it was kept as" << backupPath;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_migrateTileKeys(QSqlDatabase& db)
+{
+    QSqlQuery query(db);
+    QSqlQuery keyQuery(db);
+    quint64 dropped = 0;
+    //-- Only the hashes are read here, the tile data is copied in a single statement through a table of converted keys
+    if(!query.exec("CREATE TEMP TABLE TileKeys (tileID INTEGER PRIMARY KEY, tileKey INTEGER)") ||
+            !keyQuery.prepare("INSERT INTO TileKeys(tileID, tileKey) VALUES(?, ?)") ||
+            !query.exec("SELECT tileID, hash FROM HashTiles")) {
+        qWarning() << "Map Cache SQL error (reading tile hashes):" << query.lastError().text() << keyQuery.lastError().text();
+        return false;
+    }
+    while(query.next()) {
+        //-- Tiles of providers which no longer exist can't be converted
+        const quint64 key = UrlFactory::tileHashToKey(query.value(1).toString());
+        if(key == UrlFactory::kInvalidTileKey) {
+            dropped++;
+            continue;
+        }
+        keyQuery.bindValue(0, query.value(0));
+        keyQuery.bindValue(1, static_cast<qint64>(key));
+        if(!keyQuery.exec()) {
+            qWarning() << "Map Cache SQL error (converting tile hash):" << keyQuery.lastError().text();
+            return false;
+        }
+    }
+    keyQuery.finish();
+    if(!query.exec("INSERT OR IGNORE INTO Tiles(tileID, tileKey, format, tile, size, type, date) "
+                   "SELECT A.tileID, B.tileKey, A.format, A.tile, A.size, A.type, A.date FROM HashTiles A INNER JOIN TileKeys B ON A.tileID = B.tileID") ||
+            !query.exec("DELETE FROM SetTiles WHERE tileID NOT IN (SELECT tileID FROM Tiles)") ||
+            !query.exec("DROP TABLE HashTiles") ||
+            !query.exec("DROP TABLE TileKeys")) {
+        qWarning() << "Map Cache SQL error (copying tiles):" << query.lastError().text();
+        return false;
+    }
+    //-- Pending downloads of tile sets
+    if(query.exec("SELECT setID, hash, type, x, y, z, state FROM HashTilesDownload")) {
+        if(!keyQuery.prepare("INSERT OR IGNORE INTO TilesDownload(setID, tileKey, type, x, y, z, state) VALUES(?, ?, ?, ?, ?, ?, ?)")) {
+            qWarning() << "Map Cache SQL error (prepare TilesDownload):" << keyQuery.lastError().text();
+            return false;
+        }
+        while(query.next()) {
+            const quint64 key = UrlFactory::tileHashToKey(query.value(1).toString());
+            if(key == UrlFactory::kInvalidTileKey) {
+                dropped++;
+                continue;
+            }
+            keyQuery.bindValue(0, query.value(0));
+            keyQuery.bindValue(1, static_cast<qint64>(key));
+            for(int i = 2; i < 7; i++) {
+                keyQuery.bindValue(i, query.value(i));
+            }
+            if(!keyQuery.exec()) {
+                qWarning() << "Map Cache SQL error (converting TilesDownload):" << keyQuery.lastError().text();
+                return false;
+            }
+        }
+        keyQuery.finish();
+        (void) query.exec("DROP TABLE HashTilesDownload");
+    }
+    qCInfo(QGCTileCacheWorkerLog) << "Converted tile hashes to tile keys, dropped:" << dropped;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_createTotals(QSqlDatabase& db)
+{
+    //-- Tile count and size of every set are kept up to date by triggers, so reading the totals doesn't have to scan the
+    //   tile tables. A tile is unique to a set while it has a single SetTiles row. Set id 0 counts all tiles.
+    static const char* const statements[] = {
+        "CREATE TABLE IF NOT EXISTS SetTotals ("
+        "setID INTEGER PRIMARY KEY NOT NULL, "
+        "tileCount INTEGER DEFAULT 0, "
+        "tileSize INTEGER DEFAULT 0, "
+        "uniqueCount INTEGER DEFAULT 0, "
+        "uniqueSize INTEGER DEFAULT 0)",
+        "INSERT OR IGNORE INTO SetTotals(setID) VALUES(0)",
+        "CREATE INDEX IF NOT EXISTS SetTilesTileID ON SetTiles ( tileID )",
+        "CREATE INDEX IF NOT EXISTS SetTilesSetID ON SetTiles ( setID )",
+        "CREATE TRIGGER IF NOT EXISTS TilesInsertTotals AFTER INSERT ON Tiles BEGIN "
+        "UPDATE SetTotals SET tileCount = tileCount + 1, tileSize = tileSize + IFNULL(NEW.size, 0) WHERE setID = 0; "
+        "END",
+        //-- The tile is still there while its set memberships go, so they can take its size off their sets
+        "CREATE TRIGGER IF NOT EXISTS TilesDeleteTotals BEFORE DELETE ON Tiles BEGIN "
+        "DELETE FROM SetTiles WHERE tileID = OLD.tileID; "
+        "UPDATE SetTotals SET tileCount = tileCount - 1, tileSize = tileSize - IFNULL(OLD.size, 0) WHERE setID = 0; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS SetTilesInsertTotals AFTER INSERT ON SetTiles BEGIN "
+        "INSERT OR IGNORE INTO SetTotals(setID) VALUES(NEW.setID); "
+        //-- A tile shared for the first time is no longer unique to the set it was in
+        "UPDATE SetTotals SET uniqueCount = uniqueCount - 1, uniqueSize = uniqueSize - IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) "
+        "WHERE (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 2 "
+        "AND setID = (SELECT setID FROM SetTiles WHERE tileID = NEW.tileID AND rowid <> NEW.rowid); "
+        "UPDATE SetTotals SET tileCount = tileCount + 1, "
+        "tileSize = tileSize + IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0), "
+        "uniqueCount = uniqueCount + ((SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 1), "
+        "uniqueSize = uniqueSize + CASE WHEN (SELECT COUNT(*) FROM SetTiles WHERE tileID = NEW.tileID) = 1 THEN IFNULL((SELECT size FROM Tiles WHERE tileID = NEW.tileID), 0) ELSE 0 END "
+        "WHERE setID = NEW.setID; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS SetTilesDeleteTotals AFTER DELETE ON SetTiles BEGIN "
+        "UPDATE SetTotals SET tileCount = tileCount - 1, "
+        "tileSize = tileSize - IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0), "
+        "uniqueCount = uniqueCount - ((SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 0), "
+        "uniqueSize = uniqueSize - CASE WHEN (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 0 THEN IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) ELSE 0 END "
+        "WHERE setID = OLD.setID; "
+        //-- A tile left in a single set becomes unique to it
+        "UPDATE SetTotals SET uniqueCount = uniqueCount + 1, uniqueSize = uniqueSize + IFNULL((SELECT size FROM Tiles WHERE tileID = OLD.tileID), 0) "
+        "WHERE (SELECT COUNT(*) FROM SetTiles WHERE tileID = OLD.tileID) = 1 "
+        "AND setID = (SELECT setID FROM SetTiles WHERE tileID = OLD.tileID); "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS TileSetsDeleteTotals AFTER DELETE ON TileSets BEGIN "
+        "DELETE FROM SetTotals WHERE setID = OLD.setID; "
+        "END",
+    };
+    QSqlQuery query(db);
+    for(const char* const statement : statements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (create SetTotals):" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_createTileAccess(QSqlDatabase& db)
+{
+    //-- Last access of every tile in msecs, kept apart from Tiles so marking a tile read doesn't rewrite its image.
+    //   Tiles start out at their save date, which is all that is known for tiles from before access was kept.
+    const bool fill = !db.tables().contains("TileAccess");
+    static const char* const statements[] = {
+        "CREATE TABLE IF NOT EXISTS TileAccess ("
+        "tileID INTEGER PRIMARY KEY NOT NULL, "
+        "access INTEGER DEFAULT 0, "
+        "size INTEGER DEFAULT 0)",
+        "CREATE INDEX IF NOT EXISTS TileAccessAccess ON TileAccess ( access )",
+        "CREATE TRIGGER IF NOT EXISTS TilesInsertAccess AFTER INSERT ON Tiles BEGIN "
+        "INSERT OR REPLACE INTO TileAccess(tileID, access, size) VALUES(NEW.tileID, NEW.date * 1000, IFNULL(NEW.size, 0)); "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS TilesDeleteAccess AFTER DELETE ON Tiles BEGIN "
+        "DELETE FROM TileAccess WHERE tileID = OLD.tileID; "
+        "END",
+    };
+    QSqlQuery query(db);
+    for(const char* const statement : statements) {
+        if(!query.exec(statement)) {
+            qWarning() << "Map Cache SQL error (create TileAccess):" << query.lastError().text();
+            return false;
+        }
+    }
+    if(fill && !query.exec("INSERT OR IGNORE INTO TileAccess(tileID, access, size) SELECT tileID, date * 1000, IFNULL(size, 0) FROM Tiles")) {
+        qWarning() << "Map Cache SQL error (fill TileAccess):" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_rebuildTotals(QSqlDatabase& db)
+{
+    QList<quint64> setIDs = { 0 };
+    QSqlQuery query(db);
+    if(!query.exec("SELECT setID FROM TileSets")) {
+        return false;
+    }
+    while(query.next()) {
+        setIDs.append(query.value(0).toULongLong());
+    }
+    if(!query.exec("DELETE FROM SetTotals") ||
+            !query.prepare("INSERT INTO SetTotals(setID, tileCount, tileSize, uniqueCount, uniqueSize) VALUES(?, ?, ?, ?, ?)")) {
+        return false;
+    }
+    for(const quint64 setID : setIDs) {
+        const SetTotals_t totals = _countSetTotals(db, setID);
+        query.bindValue(0, static_cast<qint64>(setID));
+        query.bindValue(1, static_cast<qint64>(totals.tileCount));
+        query.bindValue(2, static_cast<qint64>(totals.tileSize));
+        query.bindValue(3, static_cast<qint64>(totals.uniqueCount));
+        query.bindValue(4, static_cast<qint64>(totals.uniqueSize));
+        if(!query.exec()) {
+            return false;
+        }
+    }
+    qCDebug(QGCTileCacheWorkerLog) << "Counted totals of" << setIDs.count() << "sets";
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_saveTileAccess()
+{
+    //-- Reads are only noted while tiles are fetched and written here in one statement
+    if(_accessedTiles.isEmpty() || !_valid) {
+        return;
+    }
+    QStringList tileIDs;
+    tileIDs.reserve(_accessedTiles.count());
+    for(const quint64 tileID : std::as_const(_accessedTiles)) {
+        tileIDs.append(QString::number(tileID));
+    }
+    _accessedTiles.clear();
+    QSqlQuery query(*_db);
+    const QString s = QString("UPDATE TileAccess SET access = %1 WHERE tileID IN (%2)").arg(QDateTime::currentMSecsSinceEpoch()).arg(tileIDs.join(','));
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (update TileAccess):" << query.lastError().text();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCacheWorker::_disconnectDB()
 {
+    //-- Statements must be released before their connection
+    _clearPreparedQueries();
+    _accessedTiles.clear();
     if (_db) {
         _db.reset();
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     }
 }
@@ -18,18 +18,26 @@
 
 #pragma once
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QMutex>
 #include <QtCore/QQueue>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QThread>
 #include <QtCore/QWaitCondition>
 
+#include <memory>
+
+#include "QGCMapTasks.h"
+
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheWorkerLog)
 
-class QGCMapTask;
 class QGCCachedTileSet;
 class QSqlDatabase;
+class QSqlQuery;
 
 class QGCCacheWorker : public QThread
 {
@@ -41,6 +49,15 @@ public:
 
     void setDatabaseFile(const QString &path) { _databasePath = path; }
 
+    /// Time tasks of one type spent queued before they ran
+    struct TaskWait {
+        quint64 count = 0;
+        qint64 totalNSecs = 0;
+        qint64 maxNSecs = 0;
+    };
+
+    TaskWait taskWait(QGCMapTask::TaskType type) const;
+
 public slots:
     bool enqueueTask(QGCMapTask *task);
     void stop();
@@ -52,9 +69,22 @@ protected:
     void run() final;
 
 private:
+    /// Tasks are run highest priority first, in queue order within a priority
+    enum TaskPriority {
+        priorityInteractive,    ///< Tile fetches for the map on screen
+        priorityNormal,         ///< Tile saves and tile set edits, which must keep their order
+        priorityMaintenance,    ///< Runs when nothing else is waiting
+        priorityCount
+    };
+
+    static TaskPriority _taskPriority(QGCMapTask::TaskType type);
+    QList<QGCMapTask*> _dequeueTasks();
+    void _recordTaskWait(const QGCMapTask *task);
+    void _logTaskWaits() const;
+    QGCCacheTile *_pendingSaveTile(quint64 key);
     void _runTask(QGCMapTask *task);
 
-    void _saveTile(QGCMapTask *task);
+    void _saveTiles(const QList<QGCMapTask*> &tasks);
     void _getTile(QGCMapTask *task);
     void _getTileSets(QGCMapTask *task);
     void _createTileSet(QGCMapTask *task);
@@ -66,24 +96,56 @@ private:
     void _resetCacheDatabase(QGCMapTask *task);
     void _importSets(QGCMapTask *task);
     void _exportSets(QGCMapTask *task);
+    void _checkTotals(QGCMapTask *task);
     bool _testTask(QGCMapTask *task);
 
     bool _connectDB();
+    void _configureDB();
     void _disconnectDB();
+    QSqlQuery *_preparedQuery(std::unique_ptr<QSqlQuery> &query, const char *sql);
+    void _clearPreparedQueries();
     bool _createDB(QSqlDatabase &db, bool createDefault = true);
+    bool _migrateTileKeys(QSqlDatabase &db);
+    /// Moves the database and its journal files aside, named after the time
+    bool _backupDatabase();
+    bool _createTileAccess(QSqlDatabase &db);
+    bool _createTotals(QSqlDatabase &db);
+    bool _rebuildTotals(QSqlDatabase &db);
     bool _findTileSetID(const QString &name, quint64 &setID);
     bool _init();
-    quint64 _findTile(const QString &hash);
     quint64 _getDefaultTileSet();
     void _deleteBingNoTileTiles();
     void _deleteTileSet(quint64 id);
     void _updateSetTotals(QGCCachedTileSet *set);
     void _updateTotals();
+    void _saveTileAccess();
+
+    /// Tile count and size of a set, and of the tiles which belong to no other set. Set id 0 holds all tiles in the
+    /// cache, its unique values are not used.
+    typedef struct {
+        quint64 tileCount;
+        quint64 tileSize;
+        quint64 uniqueCount;
+        quint64 uniqueSize;
+    } SetTotals_t;
+
+    /// @return Totals as maintained by the SetTotals triggers
+    SetTotals_t _readSetTotals(quint64 setID);
+    /// @return Totals counted from the tile tables
+    static SetTotals_t _countSetTotals(QSqlDatabase &db, quint64 setID);
 
     std::shared_ptr<QSqlDatabase> _db = nullptr;
-    QMutex _taskQueueMutex;
-    QQueue<QGCMapTask*> _taskQueue;
+    const QString _session;
+    std::unique_ptr<QSqlQuery> _saveTileQuery;
+    std::unique_ptr<QSqlQuery> _saveSetTileQuery;
+    std::unique_ptr<QSqlQuery> _getTileQuery;
+    std::unique_ptr<QSqlQuery> _getSetTotalsQuery;
+    mutable QMutex _taskQueueMutex;
+    QQueue<QGCMapTask*> _taskQueues[priorityCount];
+    QHash<quint64, QGCSaveTileTask*> _pendingSaves;  ///< Queued saves by tile key, first one queued for a key
+    QHash<int, TaskWait> _taskWaits;                 ///< Keyed by QGCMapTask::TaskType
     QWaitCondition _waitc;
+    QSet<quint64> _accessedTiles;   ///< Tile ids read since the last _saveTileAccess()
     QString _databasePath;
     quint32 _defaultCount = 0;
     quint32 _totalCount = 0;
@@ -94,10 +156,15 @@ private:
     int _updateTimeout = kShortTimeout;
     std::atomic_bool _failed = false;
     std::atomic_bool _valid = false;
+    bool _migrationFailed = false;  ///< Set by _createDB() when the tile hash conversion was rolled back
 
     static QByteArray _bingNoTileImage;
     static constexpr const char *kSession = "QGeoTileWorkerSession";
     static constexpr const char *kExportSession = "QGeoTileExportSession";
     static constexpr int kShortTimeout = 2;
     static constexpr int kLongTimeout = 5;
+    static constexpr int kSaveBatchSize = 256;  ///< Most queued tile saves written in one transaction
+    static constexpr int kPruneChunkSize = 500; ///< Most tiles deleted by one statement, below the SQLite bound parameter limit
+    static constexpr qint64 kMaintenanceWaitMSecs = 5000;   ///< Maintenance tasks queued this long are no longer held back
+    static constexpr int kPageCacheKiB = 16 * 1024;
 };
@@ -45,10 +45,10 @@ QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager
         setCached(false);
     }, Qt::AutoConnection);
 
-    QGCFetchTileTask* const task = QGeoFileTileCacheQGC::createFetchTileTask(UrlFactory::getProviderTypeFromQtMapId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
-    (void) connect(task, &QGCFetchTileTask::tileFetched, this, &QGeoTiledMapReplyQGC::_cacheReply);
-    (void) connect(task, &QGCMapTask::error, this, &QGeoTiledMapReplyQGC::_cacheError);
-    getQGCMapEngine()->addTask(task);
+    _fetchTask = QGeoFileTileCacheQGC::createFetchTileTask(UrlFactory::getProviderTypeFromQtMapId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
+    (void) connect(_fetchTask, &QGCFetchTileTask::tileFetched, this, &QGeoTiledMapReplyQGC::_cacheReply);
+    (void) connect(_fetchTask, &QGCMapTask::error, this, &QGeoTiledMapReplyQGC::_cacheError);
+    getQGCMapEngine()->addTask(_fetchTask);
 }
 
 QGeoTiledMapReplyQGC::~QGeoTiledMapReplyQGC()
@@ -202,5 +202,11 @@ void QGeoTiledMapReplyQGC::_cacheError(QGCMapTask::TaskType type, QStringView er
 
 void QGeoTiledMapReplyQGC::abort()
 {
+    // Tile is no longer wanted, typically scrolled off screen, so don't leave the cache worker a lookup to do
+    if (_fetchTask) {
+        _fetchTask->cancel();
+        (void) disconnect(_fetchTask, nullptr, this, nullptr);
+    }
+
     QGeoTiledMapReply::abort();
 }
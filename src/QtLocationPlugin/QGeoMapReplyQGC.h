@@ -10,6 +10,7 @@
 #pragma once
 
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QPointer>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
@@ -43,6 +44,7 @@ private:
 
     QNetworkAccessManager *_networkManager = nullptr;
     QNetworkRequest _request;
+    QPointer<QGCFetchTileTask> _fetchTask;      ///< Until the cache worker is done with it
 
     static QByteArray _bingNoTileImage;
     static QByteArray _badTile;
@@ -1050,6 +1050,24 @@ Item {
                         }
                     }
                 }
+
+                Repeater {
+                    model: QGroundControl.mapEngineManager.creatingTileSets
+
+                    delegate: Column {
+                        width:      firstButton.width
+                        spacing:    ScreenTools.defaultFontPixelHeight * 0.25
+                        QGCLabel {
+                            text:   qsTr("Preparing %1").arg(object.name)
+                        }
+                        ProgressBar {
+                            width:  parent.width
+                            from:   0
+                            to:     100
+                            value:  object.creationProgress
+                        }
+                    }
+                }
             }
         }
         Row {
@@ -42,6 +42,7 @@ QGCMapEngineManager *QGCMapEngineManager::instance()
 QGCMapEngineManager::QGCMapEngineManager(QObject *parent)
     : QObject(parent)
     , _tileSets(new QmlObjectListModel(this))
+    , _creatingTileSets(new QmlObjectListModel(this))
 {
     (void) qmlRegisterUncreatableType<QGCMapEngineManager>("QGroundControl.QGCMapEngineManager", 1, 0, "QGCMapEngineManager", "Reference only");
 
@@ -53,6 +54,7 @@ QGCMapEngineManager::QGCMapEngineManager(QObject *parent)
 QGCMapEngineManager::~QGCMapEngineManager()
 {
     _tileSets->clear();
+    _creatingTileSets->clear();
 
     // qCDebug(QGCMapEngineManagerLog) << Q_FUNC_INFO << this;
 }
@@ -134,10 +136,7 @@ void QGCMapEngineManager::startDownload(const QString &name, const QString &mapT
         set->setTotalTileCount(static_cast<quint32>(_imageSet.tileCount));
         set->setType(mapType);
 
-        QGCCreateTileSetTask* const task = new QGCCreateTileSetTask(set);
-        (void) connect(task, &QGCCreateTileSetTask::tileSetSaved, this, &QGCMapEngineManager::_tileSetSaved);
-        (void) connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
-        (void) getQGCMapEngine()->addTask(task);
+        _createTileSet(set);
     } else {
         qCWarning(QGCMapEngineManagerLog) << Q_FUNC_INFO << "No Tiles to save";
     }
@@ -155,19 +154,38 @@ void QGCMapEngineManager::startDownload(const QString &name, const QString &mapT
         set->setTotalTileCount(static_cast<quint32>(_elevationSet.tileCount));
         set->setType(kElevationMapType);
 
-        QGCCreateTileSetTask* const task = new QGCCreateTileSetTask(set);
-        (void) connect(task, &QGCCreateTileSetTask::tileSetSaved, this, &QGCMapEngineManager::_tileSetSaved);
-        (void) connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
-        (void) getQGCMapEngine()->addTask(task);
+        _createTileSet(set);
     } else {
         qCWarning(QGCMapEngineManagerLog) << Q_FUNC_INFO << "No Tiles to save";
     }
 }
 
+void QGCMapEngineManager::_createTileSet(QGCCachedTileSet *set)
+{
+    // The task deletes the set if it can't be created, which takes it off the list again
+    set->setCreationProgress(0);
+    (void) _creatingTileSets->append(set);
+    (void) connect(set, &QObject::destroyed, this, [this](QObject *object) {
+        if (_creatingTileSets->contains(object)) {
+            (void) _creatingTileSets->removeOne(object);
+        }
+    });
+
+    QGCCreateTileSetTask* const task = new QGCCreateTileSetTask(set);
+    (void) connect(task, &QGCCreateTileSetTask::tileSetSaved, this, &QGCMapEngineManager::_tileSetSaved);
+    (void) connect(task, &QGCCreateTileSetTask::actionProgress, set, &QGCCachedTileSet::setCreationProgress);
+    (void) connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+    (void) getQGCMapEngine()->addTask(task);
+}
+
 void QGCMapEngineManager::_tileSetSaved(QGCCachedTileSet *set)
 {
     qCDebug(QGCMapEngineManagerLog) << "New tile set saved (" << set->name() << "). Starting download...";
 
+    if (_creatingTileSets->contains(set)) {
+        (void) _creatingTileSets->removeOne(set);
+    }
+    set->setCreationProgress(100);
     (void) _tileSets->append(set);
     emit tileSetsChanged();
     set->createDownloadTask();
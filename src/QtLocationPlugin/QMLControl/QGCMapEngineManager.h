@@ -38,6 +38,7 @@ class QGCMapEngineManager : public QObject
     Q_PROPERTY(int                  actionProgress  READ actionProgress                             NOTIFY actionProgressChanged)
     Q_PROPERTY(int                  selectedCount   READ selectedCount                              NOTIFY selectedCountChanged)
     Q_PROPERTY(QmlObjectListModel   *tileSets       READ tileSets                                   NOTIFY tileSetsChanged)
+    Q_PROPERTY(QmlObjectListModel   *creatingTileSets READ creatingTileSets                         CONSTANT)
     Q_PROPERTY(QString              errorMessage    READ errorMessage                               NOTIFY errorMessageChanged)
     Q_PROPERTY(QString              tileCountStr    READ tileCountStr                               NOTIFY tileCountChanged)
     Q_PROPERTY(QString              tileSizeStr     READ tileSizeStr                                NOTIFY tileSizeChanged)
@@ -80,6 +81,8 @@ public:
     int actionProgress() const { return _actionProgress; }
     int selectedCount() const;
     QmlObjectListModel *tileSets() { return _tileSets; }
+    /// Sets which are still being created, each reports its own creationProgress. They move to tileSets once saved.
+    QmlObjectListModel *creatingTileSets() { return _creatingTileSets; }
     QString errorMessage() const { return _errorMessage; }
     QString tileCountStr() const;
     QString tileSizeStr() const;
@@ -118,7 +121,10 @@ private slots:
     void _updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
 
 private:
+    void _createTileSet(QGCCachedTileSet *set);
+
     QmlObjectListModel *_tileSets = nullptr;
+    QmlObjectListModel *_creatingTileSets = nullptr;
     QGCTileSet _imageSet;
     QGCTileSet _elevationSet;
     ImportAction _importAction = ActionNone;
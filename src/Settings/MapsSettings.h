@@ -21,4 +21,6 @@ public:
 
     DEFINE_SETTINGFACT(maxCacheDiskSize)
     DEFINE_SETTINGFACT(maxCacheMemorySize)
+    DEFINE_SETTINGFACT(maxTerrainCacheDiskSize)
+    DEFINE_SETTINGFACT(maxTerrainCacheMemorySize)
 };
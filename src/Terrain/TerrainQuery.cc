@@ -10,19 +10,48 @@
 #include "TerrainQuery.h"
 #include "TerrainQueryAirMap.h"
 #include "TerrainTileManager.h"
+#include "TerrainTileCopernicus.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtCore/QMap>
 #include <QtCore/QTimer>
+#include <QtCore/QtMath>
 
 QGC_LOGGING_CATEGORY(TerrainQueryLog, "qgc.terrain.terrainquery")
 QGC_LOGGING_CATEGORY(TerrainQueryVerboseLog, "qgc.terrain.terrainquery.verbose")
 
 Q_GLOBAL_STATIC(TerrainAtCoordinateBatchManager, _terrainAtCoordinateBatchManager)
 
+namespace {
+
+/// Coordinates which round to the same 1e-7 degrees (about a centimeter) share a key
+quint64 _coordinateKey(const QGeoCoordinate &coordinate)
+{
+    const quint64 latitude = static_cast<quint64>(qRound64(coordinate.latitude() * 1e7) + 900000000);
+    const quint64 longitude = static_cast<quint64>(qRound64(coordinate.longitude() * 1e7) + 1800000000);
+    return (latitude << 32) | longitude;
+}
+
+/// Terrain tile holding the coordinate, same tiling as the Copernicus elevation provider
+quint64 _tileKey(const QGeoCoordinate &coordinate)
+{
+    const quint64 tileY = static_cast<quint64>(qFloor((coordinate.latitude() + 90.0) / TerrainTileCopernicus::tileSizeDegrees));
+    const quint64 tileX = static_cast<quint64>(qFloor((coordinate.longitude() + 180.0) / TerrainTileCopernicus::tileSizeDegrees));
+    return (tileY << 32) | tileX;
+}
+
+}
+
 TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(QObject *parent)
+    : TerrainAtCoordinateBatchManager(TerrainTileManager::instance(), parent)
+{
+
+}
+
+TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(TerrainTileManager *tileManager, QObject *parent)
     : QObject(parent)
+    , _tileManager(tileManager)
     , _batchTimer(new QTimer(this))
-    , _terrainQuery(new TerrainOfflineAirMapQuery(this))
 {
     // qCDebug(TerrainQueryLog) << Q_FUNC_INFO << this;
 
@@ -30,7 +59,6 @@ TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(QObject *parent
     _batchTimer->setInterval(_batchTimeout);
 
     (void) connect(_batchTimer, &QTimer::timeout, this, &TerrainAtCoordinateBatchManager::_sendNextBatch);
-    (void) connect(_terrainQuery, &TerrainQueryInterface::coordinateHeightsReceived, this, &TerrainAtCoordinateBatchManager::_coordinateHeights);
 }
 
 TerrainAtCoordinateBatchManager::~TerrainAtCoordinateBatchManager()
@@ -49,138 +77,137 @@ void TerrainAtCoordinateBatchManager::addQuery(TerrainAtCoordinateQuery *terrain
         return;
     }
 
-    (void) connect(terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
-    const QueuedRequestInfo_t queuedRequestInfo = {
-        terrainAtCoordinateQuery,
-        coordinates
-    };
-    _requestQueue.enqueue(queuedRequestInfo);
-
-    if (!_batchTimer->isActive()) {
-        _batchTimer->start();
+    // A miss starts downloading the missing tiles, so the batch only has to wait for them to arrive
+    bool error;
+    QList<double> altitudes;
+    if (_tileManager->getAltitudesForCoordinates(coordinates, altitudes, error)) {
+        qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "answered from cache error:count" << error << coordinates.count();
+        if (error) {
+            altitudes.clear();
+        }
+        terrainAtCoordinateQuery->signalTerrainData(!error, altitudes);
+        return;
     }
-}
 
-void TerrainAtCoordinateBatchManager::_sendNextBatch()
-{
-    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "_state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
+    (void) connect(terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
 
-    if (_state != TerrainQuery::State::Idle) {
-        // Waiting for last download the complete, wait some more
-        qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "waiting for current batch, restarting timer";
-        _batchTimer->start();
-        return;
-    }
+    const quint64 requestId = _nextRequestId++;
+    QueuedRequestInfo_t &requestInfo = _requests[requestId];
+    requestInfo.terrainAtCoordinateQuery = terrainAtCoordinateQuery;
+    requestInfo.coordinateKeys.reserve(coordinates.count());
+    requestInfo.cUnresolved = 0;
 
-    if (_requestQueue.isEmpty()) {
-        return;
-    }
+    for (const QGeoCoordinate &coordinate: coordinates) {
+        const quint64 coordinateKey = _coordinateKey(coordinate);
+        requestInfo.coordinateKeys.append(coordinateKey);
 
-    _sentRequests.clear();
-
-    // Convert coordinates to point strings for json query
-    QList<QGeoCoordinate> coords;
-    int requestQueueAdded = 0;
-    while (!_requestQueue.isEmpty()) {
-        const QueuedRequestInfo_t requestInfo = _requestQueue.dequeue();
-        const SentRequestInfo_t sentRequestInfo = {
-            requestInfo.terrainAtCoordinateQuery,
-            false,
-            requestInfo.coordinates.count()
-        };
-        (void) _sentRequests.append(sentRequestInfo);
-        coords += requestInfo.coordinates;
-        requestQueueAdded++;
-        if (coords.count() > 50) {
-            break;
+        auto it = _pendingCoordinates.find(coordinateKey);
+        if (it == _pendingCoordinates.end()) {
+            it = _pendingCoordinates.insert(coordinateKey, { coordinate, {}, false });
+        }
+        // The request is always the last one added, which catches duplicates within the request
+        if (it->requestIds.isEmpty() || (it->requestIds.constLast() != requestId)) {
+            it->requestIds.append(requestId);
+            requestInfo.cUnresolved++;
         }
     }
 
-    (void) _requestQueue.append(_requestQueue.mid(requestQueueAdded));
-    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "requesting next batch _state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
+    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "requests:pending coordinates" << _requests.count() << _pendingCoordinates.count();
 
-    _state = TerrainQuery::State::Downloading;
-    _terrainQuery->requestCoordinateHeights(coords);
+    if (!_batchTimer->isActive()) {
+        _batchTimer->start();
+    }
 }
 
-void TerrainAtCoordinateBatchManager::_batchFailed()
+void TerrainAtCoordinateBatchManager::_sendNextBatch()
 {
-    const QList<double> noHeights;
-
-    for (const SentRequestInfo_t &sentRequestInfo: _sentRequests) {
-        if (!sentRequestInfo.queryObjectDestroyed) {
-            (void) disconnect(sentRequestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
-            sentRequestInfo.terrainAtCoordinateQuery->signalTerrainData(false, noHeights);
+    // Ordered by tile so the batches go out in a stable order
+    QMap<quint64, QList<quint64>> tileBatches;
+    for (auto it = _pendingCoordinates.begin(); it != _pendingCoordinates.end(); ++it) {
+        if (!it->sent) {
+            it->sent = true;
+            tileBatches[_tileKey(it->coordinate)].append(it.key());
         }
     }
 
-    _sentRequests.clear();
+    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "batches:pending coordinates" << tileBatches.count() << _pendingCoordinates.count();
+
+    for (const QList<quint64> &coordinateKeys: std::as_const(tileBatches)) {
+        QList<QGeoCoordinate> coordinates;
+        coordinates.reserve(coordinateKeys.count());
+        for (const quint64 coordinateKey: coordinateKeys) {
+            coordinates.append(_pendingCoordinates.value(coordinateKey).coordinate);
+        }
+
+        TerrainQueryInterface* const batchQuery = new TerrainQueryInterface(this);
+        (void) connect(batchQuery, &TerrainQueryInterface::coordinateHeightsReceived, this, [this, batchQuery, coordinateKeys](bool success, const QList<double> &heights) {
+            batchQuery->deleteLater();
+            _batchHeights(coordinateKeys, success, heights);
+        });
+        _tileManager->addCoordinateQuery(batchQuery, coordinates);
+    }
 }
 
-void TerrainAtCoordinateBatchManager::_queryObjectDestroyed(QObject *terrainAtCoordinateQuery)
+void TerrainAtCoordinateBatchManager::_batchHeights(const QList<quint64> &coordinateKeys, bool success, const QList<double> &heights)
 {
-    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "TerrainAtCoordinateQuery" << terrainAtCoordinateQuery;
+    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "signalled success:count" << success << heights.count();
 
-    int i = 0;
-    while (i < _requestQueue.count()) {
-        const QueuedRequestInfo_t &requestInfo = _requestQueue[i];
-        if (requestInfo.terrainAtCoordinateQuery == terrainAtCoordinateQuery) {
-            qCDebug(TerrainQueryLog) << "Removing deleted provider from _requestQueue index:terrainAtCoordinateQuery" << i << requestInfo.terrainAtCoordinateQuery;
-            (void) _requestQueue.removeAt(i);
-        } else {
-            i++;
-        }
+    if (success && (heights.count() != coordinateKeys.count())) {
+        qCWarning(TerrainQueryLog) << Q_FUNC_INFO << "Internal Error: height count mismatch" << heights.count() << coordinateKeys.count();
+        success = false;
     }
 
-    for (SentRequestInfo_t &sentRequestInfo : _sentRequests) {
-        if (sentRequestInfo.terrainAtCoordinateQuery == terrainAtCoordinateQuery) {
-            qCDebug(TerrainQueryLog) << "Zombieing deleted provider from _sentRequests index:terrainAtCoordinateQuery" << sentRequestInfo.terrainAtCoordinateQuery;
-            sentRequestInfo.queryObjectDestroyed = true;
+    for (qsizetype i = 0; i < coordinateKeys.count(); i++) {
+        const PendingCoordinateInfo_t coordinateInfo = _pendingCoordinates.take(coordinateKeys[i]);
+        for (const quint64 requestId: coordinateInfo.requestIds) {
+            const auto it = _requests.find(requestId);
+            if (it == _requests.end()) {
+                // Failed already or the query object is gone
+                continue;
+            }
+
+            if (!success) {
+                _signalRequest(requestId, false);
+                continue;
+            }
+
+            (void) it->heights.insert(coordinateKeys[i], heights[i]);
+            if (--it->cUnresolved == 0) {
+                _signalRequest(requestId, true);
+            }
         }
     }
 }
 
-QString TerrainAtCoordinateBatchManager::_stateToString(TerrainQuery::State state)
+void TerrainAtCoordinateBatchManager::_signalRequest(quint64 requestId, bool success)
 {
-    switch (state) {
-    case TerrainQuery::State::Idle:
-        return QStringLiteral("Idle");
-    case TerrainQuery::State::Downloading:
-        return QStringLiteral("Downloading");
-    default:
-        break;
+    const QueuedRequestInfo_t requestInfo = _requests.take(requestId);
+
+    QList<double> heights;
+    if (success) {
+        heights.reserve(requestInfo.coordinateKeys.count());
+        for (const quint64 coordinateKey: requestInfo.coordinateKeys) {
+            heights.append(requestInfo.heights.value(coordinateKey));
+        }
     }
 
-    return QStringLiteral("State unknown");
+    qCDebug(TerrainQueryVerboseLog) << Q_FUNC_INFO << "returned TerrainCoordinateQuery:success:count" << requestInfo.terrainAtCoordinateQuery << success << heights.count();
+    (void) disconnect(requestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
+    requestInfo.terrainAtCoordinateQuery->signalTerrainData(success, heights);
 }
 
-void TerrainAtCoordinateBatchManager::_coordinateHeights(bool success, const QList<double> &heights)
+void TerrainAtCoordinateBatchManager::_queryObjectDestroyed(QObject *terrainAtCoordinateQuery)
 {
-    _state = TerrainQuery::State::Idle;
-
-    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "signalled success:count" << success << heights.count();
-
-    if (!success) {
-        _batchFailed();
-        return;
-    }
+    qCDebug(TerrainQueryLog) << Q_FUNC_INFO << "TerrainAtCoordinateQuery" << terrainAtCoordinateQuery;
 
-    int currentIndex = 0;
-    for (const SentRequestInfo_t &sentRequestInfo: _sentRequests) {
-        if (sentRequestInfo.queryObjectDestroyed) {
-            continue;
+    // Coordinates the request was waiting on are still looked up, other requests may share them
+    for (auto it = _requests.begin(); it != _requests.end();) {
+        if (it->terrainAtCoordinateQuery == terrainAtCoordinateQuery) {
+            qCDebug(TerrainQueryLog) << "Removing deleted provider from _requests terrainAtCoordinateQuery" << terrainAtCoordinateQuery;
+            it = _requests.erase(it);
+        } else {
+            ++it;
         }
-
-        qCDebug(TerrainQueryVerboseLog) << Q_FUNC_INFO << "returned TerrainCoordinateQuery:count" << sentRequestInfo.terrainAtCoordinateQuery << sentRequestInfo.cCoord;
-        (void) disconnect(sentRequestInfo.terrainAtCoordinateQuery, &TerrainAtCoordinateQuery::destroyed, this, &TerrainAtCoordinateBatchManager::_queryObjectDestroyed);
-        const QList<double> requestAltitudes = heights.mid(currentIndex, sentRequestInfo.cCoord);
-        sentRequestInfo.terrainAtCoordinateQuery->signalTerrainData(true, requestAltitudes);
-        currentIndex += sentRequestInfo.cCoord;
-    }
-    _sentRequests.clear();
-
-    if (!_requestQueue.isEmpty()) {
-        _batchTimer->start();
     }
 }
 
@@ -223,9 +250,15 @@ void TerrainAtCoordinateQuery::signalTerrainData(bool success, const QList<doubl
 /*===========================================================================*/
 
 TerrainPathQuery::TerrainPathQuery(bool autoDelete, QObject *parent)
+    : TerrainPathQuery(TerrainTileManager::instance(), autoDelete, parent)
+{
+
+}
+
+TerrainPathQuery::TerrainPathQuery(TerrainTileManager *tileManager, bool autoDelete, QObject *parent)
    : QObject(parent)
    , _autoDelete(autoDelete)
-   , _terrainQuery(new TerrainOfflineAirMapQuery(this))
+   , _terrainQuery(new TerrainOfflineAirMapQuery(tileManager, this))
 {
     // qCDebug(AudioOutputLog) << Q_FUNC_INFO << this;
 
@@ -257,9 +290,15 @@ void TerrainPathQuery::_pathHeights(bool success, double distanceBetween, double
 /*===========================================================================*/
 
 TerrainPolyPathQuery::TerrainPolyPathQuery(bool autoDelete, QObject *parent)
+    : TerrainPolyPathQuery(TerrainTileManager::instance(), autoDelete, parent)
+{
+
+}
+
+TerrainPolyPathQuery::TerrainPolyPathQuery(TerrainTileManager *tileManager, bool autoDelete, QObject *parent)
     : QObject(parent)
     , _autoDelete(autoDelete)
-    , _pathQuery(new TerrainPathQuery(false, this))
+    , _pathQuery(new TerrainPathQuery(tileManager, false, this))
 {
     // qCDebug(AudioOutputLog) << Q_FUNC_INFO << this;
 
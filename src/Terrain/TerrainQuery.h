@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
@@ -34,13 +35,21 @@ Q_DECLARE_LOGGING_CATEGORY(TerrainQueryVerboseLog)
 /*===========================================================================*/
 
 class TerrainAtCoordinateQuery;
+class TerrainTileManager;
 
+/// Merges the coordinates of all TerrainAtCoordinateQuery requests. Queries which can be answered from the terrain
+/// tile cache are answered right away. The coordinates of the others are collected for a short while, duplicates
+/// (identical to about a centimeter) are only looked up once, and one batch per terrain tile is handed to the
+/// TerrainTileManager. Batches don't wait on each other, so every request is answered as soon as its own tiles are in.
 class TerrainAtCoordinateBatchManager : public QObject
 {
     Q_OBJECT
 
 public:
     explicit TerrainAtCoordinateBatchManager(QObject *parent = nullptr);
+
+    /// @param tileManager Answers the batches
+    explicit TerrainAtCoordinateBatchManager(TerrainTileManager *tileManager, QObject *parent = nullptr);
     ~TerrainAtCoordinateBatchManager();
 
     static TerrainAtCoordinateBatchManager *instance();
@@ -49,30 +58,31 @@ public:
 
 private slots:
     void _sendNextBatch();
-    void _queryObjectDestroyed(QObject *elevationProvider);
-    void _coordinateHeights(bool success, const QList<double> &heights);
+    void _queryObjectDestroyed(QObject *terrainAtCoordinateQuery);
 
 private:
     struct QueuedRequestInfo_t {
         TerrainAtCoordinateQuery *terrainAtCoordinateQuery;
-        QList<QGeoCoordinate> coordinates;
+        QList<quint64> coordinateKeys;                  ///< One per requested coordinate, in request order
+        QHash<quint64, double> heights;                 ///< Heights received so far, by coordinate key
+        qsizetype cUnresolved;                          ///< Distinct coordinates still waiting for a height
     };
 
-    struct SentRequestInfo_t {
-        TerrainAtCoordinateQuery *terrainAtCoordinateQuery;
-        bool queryObjectDestroyed;
-        qsizetype cCoord;
+    struct PendingCoordinateInfo_t {
+        QGeoCoordinate coordinate;
+        QList<quint64> requestIds;                      ///< Requests waiting on the coordinate
+        bool sent;                                      ///< true: part of a batch which is in flight
     };
 
-    void _batchFailed();
-    QString _stateToString(TerrainQuery::State state);
+    void _batchHeights(const QList<quint64> &coordinateKeys, bool success, const QList<double> &heights);
+    void _signalRequest(quint64 requestId, bool success);
 
-    QQueue<QueuedRequestInfo_t> _requestQueue;
-    QList<SentRequestInfo_t> _sentRequests;
-    TerrainQuery::State _state = TerrainQuery::State::Idle;
+    TerrainTileManager *_tileManager = nullptr;
+    QHash<quint64, QueuedRequestInfo_t> _requests;                  ///< By request id
+    QHash<quint64, PendingCoordinateInfo_t> _pendingCoordinates;    ///< By coordinate key
+    quint64 _nextRequestId = 0;
     QTimer *_batchTimer = nullptr;
-    TerrainQueryInterface *_terrainQuery = nullptr;
-    static constexpr int _batchTimeout = 500;
+    static constexpr int _batchTimeout = 50;
 };
 
 /*===========================================================================*/
@@ -115,6 +125,9 @@ class TerrainPathQuery : public QObject
 public:
     /// @param autoDelete true: object will delete itself after it signals results
     explicit TerrainPathQuery(bool autoDelete, QObject *parent = nullptr);
+
+    /// @param tileManager Answers the query
+    TerrainPathQuery(TerrainTileManager *tileManager, bool autoDelete, QObject *parent = nullptr);
     ~TerrainPathQuery();
 
     /// Async terrain query for terrain heights between two lat/lon coordinates. When the query is done, the terrainData() signal
@@ -150,6 +163,9 @@ class TerrainPolyPathQuery : public QObject
 public:
     ///     @param autoDelete true: object will delete itself after it signals results
     explicit TerrainPolyPathQuery(bool autoDelete, QObject *parent = nullptr);
+
+    /// @param tileManager Answers the query
+    TerrainPolyPathQuery(TerrainTileManager *tileManager, bool autoDelete, QObject *parent = nullptr);
     ~TerrainPolyPathQuery();
 
     /// Async terrain query for terrain heights for the paths between each specified QGeoCoordinate.
@@ -275,7 +275,14 @@ void TerrainAirMapQuery::_parseCarpetData(const QJsonValue &carpetJson)
 /*===========================================================================*/
 
 TerrainOfflineAirMapQuery::TerrainOfflineAirMapQuery(QObject *parent)
+    : TerrainOfflineAirMapQuery(TerrainTileManager::instance(), parent)
+{
+
+}
+
+TerrainOfflineAirMapQuery::TerrainOfflineAirMapQuery(TerrainTileManager *tileManager, QObject *parent)
     : TerrainQueryInterface(parent)
+    , _tileManager(tileManager)
 {
     // qCDebug(AudioOutputLog) << Q_FUNC_INFO << this;
 
@@ -294,11 +301,11 @@ void TerrainOfflineAirMapQuery::requestCoordinateHeights(const QList<QGeoCoordin
     }
 
     _queryMode = TerrainQuery::QueryModeCoordinates;
-    TerrainTileManager::instance()->addCoordinateQuery(this, coordinates);
+    _tileManager->addCoordinateQuery(this, coordinates);
 }
 
 void TerrainOfflineAirMapQuery::requestPathHeights(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord)
 {
     _queryMode = TerrainQuery::QueryModePath;
-    TerrainTileManager::instance()->addPathQuery(this, fromCoord, toCoord);
+    _tileManager->addPathQuery(this, fromCoord, toCoord);
 }
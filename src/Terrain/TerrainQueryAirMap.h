@@ -20,6 +20,7 @@ Q_DECLARE_LOGGING_CATEGORY(TerrainQueryAirMapVerboseLog)
 
 class QGeoCoordinate;
 class QNetworkAccessManager;
+class TerrainTileManager;
 
 class TerrainAirMapQuery : public TerrainQueryInterface
 {
@@ -57,8 +58,14 @@ class TerrainOfflineAirMapQuery : public TerrainQueryInterface
 
 public:
     explicit TerrainOfflineAirMapQuery(QObject *parent = nullptr);
+
+    /// @param tileManager Answers the queries
+    TerrainOfflineAirMapQuery(TerrainTileManager *tileManager, QObject *parent);
     ~TerrainOfflineAirMapQuery();
 
     void requestCoordinateHeights(const QList<QGeoCoordinate> &coordinates) final;
     void requestPathHeights(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord) final;
+
+private:
+    TerrainTileManager *_tileManager = nullptr;
 };
@@ -13,6 +13,9 @@
 #include <QtCore/QtNumeric>
 #include <QtPositioning/QGeoCoordinate>
 
+#include <algorithm>
+#include <cstring>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "qgc.terrain.terraintile");
 
 TerrainTile::TerrainTile()
@@ -21,11 +24,17 @@ TerrainTile::TerrainTile()
 }
 
 TerrainTile::TerrainTile(const QByteArray &byteArray)
-    : _tileInfo(*reinterpret_cast<const TileInfo_t*>(byteArray.constData()))
 {
     // qCDebug(TerrainTileLog) << Q_FUNC_INFO << this;
 
-    if (((_tileInfo.neLon - _tileInfo.swLon) < 0.0) || ((_tileInfo.neLat - _tileInfo.swLat) < 0.0)) {
+    // Tiles are also read back from the disk cache, check the size before looking at the header
+    if (byteArray.size() < static_cast<qsizetype>(sizeof(TileInfo_t))) {
+        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
+        return;
+    }
+    memcpy(&_tileInfo, byteArray.constData(), sizeof(TileInfo_t));
+
+    if (((_tileInfo.neLon - _tileInfo.swLon) < 0.0) || ((_tileInfo.neLat - _tileInfo.swLat) < 0.0) || (_tileInfo.gridSizeLat <= 0) || (_tileInfo.gridSizeLon <= 0)) {
         qCWarning(TerrainTileLog) << this << "Tile extent is infeasible";
         _isValid = false;
         return;
@@ -40,32 +49,20 @@ TerrainTile::TerrainTile(const QByteArray &byteArray)
     qCDebug(TerrainTileLog) << this << "TileInfo: min, max, avg:" << _tileInfo.minElevation << _tileInfo.maxElevation << _tileInfo.avgElevation;
     qCDebug(TerrainTileLog) << this << "TileInfo: cell size:" << _cellSizeLat << _cellSizeLon;
 
-    const int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    const int cTileBytesAvailable = byteArray.size();
-
-    if (cTileBytesAvailable < cTileHeaderBytes) {
-        qCWarning(TerrainTileLog) << "Terrain tile binary data too small for TileInfo_s header";
-        return;
-    }
-
-    const int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
-    if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
+    const qsizetype cTileHeaderBytes = static_cast<qsizetype>(sizeof(TileInfo_t));
+    const qsizetype cTileDataBytes = static_cast<qsizetype>(sizeof(int16_t)) * _tileInfo.gridSizeLat * _tileInfo.gridSizeLon;
+    if (byteArray.size() < cTileHeaderBytes + cTileDataBytes) {
         qCWarning(TerrainTileLog) << "Terrain tile binary data too small for tile data";
         return;
     }
 
-    _elevationData.resize(_tileInfo.gridSizeLat);
-    for (int k = 0; k < _tileInfo.gridSizeLat; k++) {
-        _elevationData[k].resize(_tileInfo.gridSizeLon);
-    }
-
-    int valueIndex = 0;
-    const int16_t* const pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _tileInfo.gridSizeLat; i++) {
-        for (int j = 0; j < _tileInfo.gridSizeLon; j++) {
-            _elevationData[i][j] = pTileData[valueIndex++];
-        }
+    // The grid is used in place, the tile only holds a reference to the serialized data. A buffer which doesn't
+    // start at a suitably aligned address (raw data or a slice) is copied once.
+    _serializedData = byteArray;
+    if ((reinterpret_cast<quintptr>(_serializedData.constData()) % alignof(TileInfo_t)) != 0) {
+        _serializedData = QByteArray(byteArray.constData(), byteArray.size());
     }
+    _elevationData = reinterpret_cast<const int16_t*>(_serializedData.constData() + cTileHeaderBytes);
 
     _isValid = true;
 }
@@ -75,6 +72,11 @@ TerrainTile::~TerrainTile()
     // qCDebug(TerrainTileLog) << Q_FUNC_INFO << this;
 }
 
+qsizetype TerrainTile::memoryBytes() const
+{
+    return static_cast<qsizetype>(sizeof(*this)) + _serializedData.size();
+}
+
 double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
 {
     if (!_isValid) {
@@ -85,8 +87,8 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
     const double latDeltaSw = coordinate.latitude() - _tileInfo.swLat;
     const double lonDeltaSw = coordinate.longitude() - _tileInfo.swLon;
 
-    const int16_t latIndex = qFloor(latDeltaSw / _cellSizeLat);
-    const int16_t lonIndex = qFloor(lonDeltaSw / _cellSizeLon);
+    const int latIndex = qFloor(latDeltaSw / _cellSizeLat);
+    const int lonIndex = qFloor(lonDeltaSw / _cellSizeLon);
 
     const bool latIndexInvalid = (latIndex < 0) || (latIndex > (_tileInfo.gridSizeLat - 1));
     const bool lonIndexInvalid = (lonIndex < 0) || (lonIndex > (_tileInfo.gridSizeLon - 1));
@@ -96,13 +98,7 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
         return qQNaN();
     }
 
-    if ((latIndex >= _elevationData.size()) || (lonIndex >= _elevationData[latIndex].size())) {
-        qCWarning(TerrainTileLog).noquote() << this << "Internal error: _elevationData size inconsistent _tileInfo << coordinate" << coordinate
-            << "\n\t_tillIndo.gridSizeLat: " << _tileInfo.gridSizeLat << " _tileInfo.gridSizeLon: " << _tileInfo.gridSizeLon
-            << "\n\t_data.size(): " << _elevationData.size() << " _elevationData[latIndex].size(): " << _elevationData[latIndex].size();
-        return qQNaN();
-    }
-    const auto elevation = _elevationData[latIndex][lonIndex];
+    const int16_t elevation = _elevationData[(latIndex * _tileInfo.gridSizeLon) + lonIndex];
 
     if (elevation < _tileInfo.minElevation) {
         qCWarning(TerrainTileLog) << this << "Warning: elevation read is below min elevation in tile:" << elevation << "<" << _tileInfo.minElevation;
@@ -114,3 +110,66 @@ double TerrainTile::elevation(const QGeoCoordinate &coordinate) const
 
     return static_cast<double>(elevation);
 }
+
+QList<double> TerrainTile::bilinearElevations(const QList<QGeoCoordinate> &coordinates) const
+{
+    const qsizetype count = coordinates.count();
+
+    QList<double> latitudes(count);
+    QList<double> longitudes(count);
+    for (qsizetype i = 0; i < count; i++) {
+        latitudes[i] = coordinates[i].latitude();
+        longitudes[i] = coordinates[i].longitude();
+    }
+
+    QList<double> elevations(count);
+    bilinearElevations(latitudes.constData(), longitudes.constData(), elevations.data(), count);
+
+    return elevations;
+}
+
+void TerrainTile::bilinearElevations(const double *latitudes, const double *longitudes, double *elevations, qsizetype count) const
+{
+    if (!_isValid) {
+        qCWarning(TerrainTileLog) << this << "Request for elevation, but tile is invalid.";
+        std::fill(elevations, elevations + count, qQNaN());
+        return;
+    }
+
+    // Samples sit at the cell centers, positions are in cell units relative to the south west sample
+    const int rows = _tileInfo.gridSizeLat;
+    const int columns = _tileInfo.gridSizeLon;
+    const double maxRow = rows - 1;
+    const double maxColumn = columns - 1;
+    const double latScale = 1.0 / _cellSizeLat;
+    const double lonScale = 1.0 / _cellSizeLon;
+    const double nan = qQNaN();
+    const int16_t* const data = _elevationData;
+
+    // Straight line code without calls or early exits so the compiler can vectorize the loop
+    for (qsizetype i = 0; i < count; i++) {
+        const double row = ((latitudes[i] - _tileInfo.swLat) * latScale) - 0.5;
+        const double column = ((longitudes[i] - _tileInfo.swLon) * lonScale) - 0.5;
+        const bool inside = (row >= -0.5) && (row < (rows - 0.5)) && (column >= -0.5) && (column < (columns - 0.5));
+
+        // Half a cell around the outer samples is held at the edge value. Positions outside the tile, including NaN and
+        // infinite ones which fail every comparison, read the south west sample and are masked below.
+        const double clampedRow = inside ? std::clamp(row, 0.0, maxRow) : 0.0;
+        const double clampedColumn = inside ? std::clamp(column, 0.0, maxColumn) : 0.0;
+        const int row0 = static_cast<int>(clampedRow);
+        const int column0 = static_cast<int>(clampedColumn);
+        const int row1 = std::min(row0 + 1, rows - 1);
+        const int column1 = std::min(column0 + 1, columns - 1);
+        const double rowFraction = clampedRow - row0;
+        const double columnFraction = clampedColumn - column0;
+
+        const double sw = data[(row0 * columns) + column0];
+        const double se = data[(row0 * columns) + column1];
+        const double nw = data[(row1 * columns) + column0];
+        const double ne = data[(row1 * columns) + column1];
+        const double south = sw + ((se - sw) * columnFraction);
+        const double north = nw + ((ne - nw) * columnFraction);
+
+        elevations[i] = inside ? (south + ((north - south) * rowFraction)) : nan;
+    }
+}
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <QtCore/QByteArray>
 #include <QtCore/QList>
 #include <QtCore/QLoggingCategory>
 
@@ -21,7 +22,8 @@ class TerrainTile
 public:
     TerrainTile();
 
-    /// Constructor from serialized elevation data (either from file or web)
+    /// Constructor from serialized elevation data (either from file or web). The tile keeps a reference to byteArray
+    /// and reads the elevation grid from it in place.
     ///    @param document
     explicit TerrainTile(const QByteArray &byteArray);
     ~TerrainTile();
@@ -35,6 +37,16 @@ public:
     ///    @return elevation
     double elevation(const QGeoCoordinate &coordinate) const;
 
+    /// Evaluates the elevations at the given coordinates, bilinearly interpolated between the four surrounding grid
+    /// values
+    ///    @param coordinates
+    ///    @return elevations, NaN for coordinates outside the tile
+    QList<double> bilinearElevations(const QList<QGeoCoordinate> &coordinates) const;
+
+    /// Batch version of bilinearElevations for coordinates held as separate latitude/longitude arrays
+    ///    @param[out] elevations count values, NaN for coordinates outside the tile
+    void bilinearElevations(const double *latitudes, const double *longitudes, double *elevations, qsizetype count) const;
+
     /// Accessor for the minimum elevation of the tile
     ///    @return minimum elevation
     double minElevation() const { return (_isValid ? static_cast<double>(_tileInfo.minElevation) : qQNaN()); }
@@ -47,6 +59,10 @@ public:
     ///    @return average elevation
     double avgElevation() const { return (_isValid ? _tileInfo.avgElevation : qQNaN()); }
 
+    /// Approximate memory held by the tile, used for cache accounting
+    ///    @return size in bytes
+    qsizetype memoryBytes() const;
+
 protected:
     struct TileInfo_t {
         double  swLat, swLon, neLat, neLon;
@@ -57,8 +73,9 @@ protected:
 
 private:
     TileInfo_t _tileInfo{};
-    QList<QList<int16_t>> _elevationData;   /// 2D elevation data array
-    double _cellSizeLat = 0.0;              /// data grid size in latitude direction
-    double _cellSizeLon = 0.0;              /// data grid size in longitude direction
-    bool _isValid = false;                  /// data loaded is valid
+    QByteArray _serializedData;                 /// Serialized tile, owns the elevation data
+    const int16_t *_elevationData = nullptr;    /// Row major elevation grid, south to north, west to east
+    double _cellSizeLat = 0.0;                  /// data grid size in latitude direction
+    double _cellSizeLon = 0.0;                  /// data grid size in longitude direction
+    bool _isValid = false;                      /// data loaded is valid
 };
@@ -0,0 +1,364 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileCache.h"
+#include "TerrainTile.h"
+#include "QGCLoggingCategory.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThreadPool>
+
+QGC_LOGGING_CATEGORY(TerrainTileCacheLog, "qgc.terrain.terraintilecache")
+
+TerrainTileCache::TerrainTileCache(const QString &diskPath, qint64 maxMemoryBytes, qint64 maxDiskBytes, QThreadPool *diskThreadPool)
+    : _memory(maxMemoryBytes)
+    , _diskPath(diskPath)
+    , _diskEnabled(!diskPath.isEmpty())
+    , _diskThreadPool(diskThreadPool)
+    , _maxDiskBytes(maxDiskBytes)
+{
+    // qCDebug(TerrainTileCacheLog) << Q_FUNC_INFO << this;
+
+    if (_diskEnabled) {
+        _initializeDirectory();
+    }
+}
+
+TerrainTileCache::~TerrainTileCache()
+{
+    // qCDebug(TerrainTileCacheLog) << Q_FUNC_INFO << this;
+
+    if (_diskEnabled) {
+        _writeIndex();
+    }
+}
+
+std::shared_ptr<const TerrainTile> TerrainTileCache::tile(const QString &hash)
+{
+    bool onDisk = false;
+    const SharedTile cachedTile = memoryTile(hash, &onDisk);
+    if (cachedTile || !onDisk) {
+        return cachedTile;
+    }
+
+    return diskTile(hash);
+}
+
+std::shared_ptr<const TerrainTile> TerrainTileCache::memoryTile(const QString &hash, bool *onDisk)
+{
+    QMutexLocker lock(&_mutex);
+
+    const SharedTile* const cachedTile = _memory.object(hash);
+    const bool diskEntry = !cachedTile && _diskEnabled && _diskEntries.contains(hash);
+    if (onDisk) {
+        *onDisk = diskEntry;
+    }
+
+    if (cachedTile) {
+        _statistics.memoryHits++;
+        return *cachedTile;
+    }
+
+    if (!diskEntry) {
+        _statistics.misses++;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const TerrainTile> TerrainTileCache::diskTile(const QString &hash)
+{
+    {
+        QMutexLocker lock(&_mutex);
+
+        // Another thread may have loaded it in the meantime
+        const SharedTile* const cachedTile = _memory.object(hash);
+        if (cachedTile) {
+            _statistics.memoryHits++;
+            return *cachedTile;
+        }
+        if (!_diskEnabled || !_diskEntries.contains(hash)) {
+            _statistics.misses++;
+            return nullptr;
+        }
+    }
+
+    const QByteArray serializedTile = _readDisk(hash);
+    const SharedTile newTile = serializedTile.isEmpty() ? nullptr : std::make_shared<const TerrainTile>(serializedTile);
+    const bool valid = newTile && newTile->isValid();
+
+    {
+        QMutexLocker lock(&_mutex);
+
+        // The entry may have been evicted while the file was read
+        const bool diskEntry = _diskEntries.contains(hash);
+        if (!valid) {
+            if (diskEntry) {
+                qCWarning(TerrainTileCacheLog) << "Removing unreadable cached tile" << hash;
+                _removeDiskEntry(hash);
+            }
+            _statistics.misses++;
+            return nullptr;
+        }
+
+        _statistics.diskHits++;
+        if (diskEntry) {
+            _touchDisk(hash);
+        }
+        (void) _insertMemory(hash, newTile);
+    }
+
+    return newTile;
+}
+
+bool TerrainTileCache::insert(const QString &hash, const QByteArray &serializedTile, std::shared_ptr<const TerrainTile> *decodedTile)
+{
+    if (serializedTile.isEmpty()) {
+        return false;
+    }
+
+    const SharedTile newTile = std::make_shared<const TerrainTile>(serializedTile);
+    if (!newTile->isValid()) {
+        return false;
+    }
+    if (decodedTile) {
+        *decodedTile = newTile;
+    }
+
+    bool cached = false;
+    bool writeDisk = false;
+    {
+        QMutexLocker lock(&_mutex);
+
+        cached = _memory.contains(hash) || _insertMemory(hash, newTile);
+        if (_diskEnabled) {
+            writeDisk = !_diskEntries.contains(hash) && !_pendingDiskWrites.contains(hash);
+            if (writeDisk) {
+                _pendingDiskWrites.insert(hash);
+            }
+            // A tile larger than the disk limit is evicted as soon as it is written
+            cached = cached || _diskEntries.contains(hash) || ((kFileHeaderBytes + serializedTile.size()) <= _maxDiskBytes);
+        }
+    }
+
+    if (writeDisk) {
+        if (_diskThreadPool) {
+            _diskThreadPool->start([this, hash, serializedTile]() {
+                _writeDisk(hash, serializedTile);
+            });
+        } else {
+            _writeDisk(hash, serializedTile);
+        }
+    }
+
+    if (!cached) {
+        qCWarning(TerrainTileCacheLog) << "Tile is too large to be cached" << hash;
+    }
+    return cached;
+}
+
+void TerrainTileCache::setMaxMemoryBytes(qint64 maxMemoryBytes)
+{
+    QMutexLocker lock(&_mutex);
+
+    const qsizetype count = _memory.count();
+    _memory.setMaxCost(maxMemoryBytes);
+    _statistics.memoryEvictions += count - _memory.count();
+}
+
+void TerrainTileCache::setMaxDiskBytes(qint64 maxDiskBytes)
+{
+    QMutexLocker lock(&_mutex);
+
+    _maxDiskBytes = maxDiskBytes;
+    _removeOldDiskEntries();
+}
+
+TerrainTileCache::Statistics TerrainTileCache::statistics() const
+{
+    QMutexLocker lock(&_mutex);
+
+    Statistics statistics = _statistics;
+    statistics.memoryTileCount = static_cast<int>(_memory.count());
+    statistics.memoryBytes = _memory.totalCost();
+    statistics.diskTileCount = static_cast<int>(_diskEntries.count());
+    statistics.diskBytes = _diskBytes;
+
+    return statistics;
+}
+
+void TerrainTileCache::clearMemory()
+{
+    QMutexLocker lock(&_mutex);
+
+    _memory.clear();
+}
+
+bool TerrainTileCache::_insertMemory(const QString &hash, const SharedTile &tile)
+{
+    // QCache drops least recently used tiles to make room, and rejects a tile larger than the whole cache
+    const qsizetype count = _memory.count();
+    if (!_memory.insert(hash, new SharedTile(tile), tile->memoryBytes())) {
+        return false;
+    }
+
+    const qsizetype evicted = count + 1 - _memory.count();
+    if (evicted > 0) {
+        _statistics.memoryEvictions += evicted;
+        qCDebug(TerrainTileCacheLog) << "Evicted tiles from memory" << evicted;
+    }
+    return true;
+}
+
+QByteArray TerrainTileCache::_readDisk(const QString &hash) const
+{
+    QFile file(_fileName(hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(TerrainTileCacheLog) << "Failed to open" << file.fileName() << file.errorString();
+        return QByteArray();
+    }
+
+    quint32 header[2] = { 0, 0 };
+    if ((file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header)) || (header[0] != kFileMagic) || (header[1] != kFileVersion)) {
+        qCWarning(TerrainTileCacheLog) << "Invalid header" << file.fileName();
+        return QByteArray();
+    }
+
+    return file.readAll();
+}
+
+bool TerrainTileCache::_writeFile(const QString &hash, const QByteArray &serializedTile) const
+{
+    QSaveFile file(_fileName(hash));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(TerrainTileCacheLog) << "Failed to open" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    const quint32 header[2] = { kFileMagic, kFileVersion };
+    static_assert(static_cast<qint64>(sizeof(header)) == kFileHeaderBytes);
+    (void) file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    (void) file.write(serializedTile);
+    if (!file.commit()) {
+        qCWarning(TerrainTileCacheLog) << "Failed to write" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void TerrainTileCache::_writeDisk(const QString &hash, const QByteArray &serializedTile)
+{
+    const bool written = _writeFile(hash, serializedTile);
+
+    QMutexLocker lock(&_mutex);
+
+    (void) _pendingDiskWrites.remove(hash);
+    if (written) {
+        _addDiskEntry(hash, kFileHeaderBytes + serializedTile.size());
+        _removeOldDiskEntries();
+    }
+}
+
+void TerrainTileCache::_touchDisk(const QString &hash)
+{
+    DiskEntry &entry = _diskEntries[hash];
+    (void) _diskAccessOrder.remove(entry.accessCounter);
+    entry.accessCounter = _nextAccessCounter++;
+    _diskAccessOrder.insert(entry.accessCounter, hash);
+}
+
+void TerrainTileCache::_addDiskEntry(const QString &hash, qint64 size)
+{
+    const DiskEntry entry = { _nextAccessCounter++, size };
+    _diskEntries.insert(hash, entry);
+    _diskAccessOrder.insert(entry.accessCounter, hash);
+    _diskBytes += entry.size;
+}
+
+void TerrainTileCache::_initializeDirectory()
+{
+    if (!_diskPath.exists() && !QDir().mkpath(_diskPath.path())) {
+        qCWarning(TerrainTileCacheLog) << "Failed to create dir" << _diskPath.path();
+        return;
+    }
+
+    QHash<QString, qint64> fileSizes;
+    const QFileInfoList fileInfos = _diskPath.entryInfoList({ QStringLiteral("*") + kFileExtension }, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &fileInfo: fileInfos) {
+        fileSizes.insert(fileInfo.completeBaseName(), fileInfo.size());
+    }
+
+    // Access order of the previous run first, then the tiles it did not record (written after the index, or before
+    // there was one) oldest first
+    QFile indexFile(_diskPath.filePath(kIndexFileName));
+    if (indexFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!indexFile.atEnd()) {
+            const QString hash = QString::fromLatin1(indexFile.readLine()).trimmed();
+            const auto it = fileSizes.constFind(hash);
+            if (it != fileSizes.constEnd()) {
+                _addDiskEntry(hash, it.value());
+                (void) fileSizes.erase(it);
+            }
+        }
+    }
+    for (const QFileInfo &fileInfo: fileInfos) {
+        const QString hash = fileInfo.completeBaseName();
+        if (fileSizes.contains(hash)) {
+            _addDiskEntry(hash, fileInfo.size());
+        }
+    }
+
+    qCDebug(TerrainTileCacheLog) << "Found cached tiles:bytes" << _diskEntries.count() << _diskBytes;
+
+    _removeOldDiskEntries();
+}
+
+void TerrainTileCache::_writeIndex() const
+{
+    QMutexLocker lock(&_mutex);
+
+    QSaveFile file(_diskPath.filePath(kIndexFileName));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(TerrainTileCacheLog) << "Failed to open" << file.fileName() << file.errorString();
+        return;
+    }
+
+    for (const QString &hash: _diskAccessOrder) {
+        (void) file.write(hash.toLatin1());
+        (void) file.write("\n");
+    }
+    if (!file.commit()) {
+        qCWarning(TerrainTileCacheLog) << "Failed to write" << file.fileName() << file.errorString();
+    }
+}
+
+void TerrainTileCache::_removeOldDiskEntries()
+{
+    while ((_diskBytes > _maxDiskBytes) && !_diskAccessOrder.isEmpty()) {
+        const QString hash = _diskAccessOrder.first();
+        qCDebug(TerrainTileCacheLog) << "Removing cache entry counter:hash" << _diskAccessOrder.firstKey() << hash;
+        _removeDiskEntry(hash);
+        _statistics.diskEvictions++;
+    }
+}
+
+void TerrainTileCache::_removeDiskEntry(const QString &hash)
+{
+    const DiskEntry entry = _diskEntries.take(hash);
+    (void) _diskAccessOrder.remove(entry.accessCounter);
+    _diskBytes -= entry.size;
+    (void) QFile::remove(_fileName(hash));
+}
+
+QString TerrainTileCache::_fileName(const QString &hash) const
+{
+    return _diskPath.filePath(hash + kFileExtension);
+}
@@ -0,0 +1,122 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QCache>
+#include <QtCore/QDir>
+#include <QtCore/QHash>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+
+#include <memory>
+
+class QThreadPool;
+class TerrainTile;
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainTileCacheLog)
+
+/// Two tier cache of terrain tiles keyed by tile hash.
+/// Decoded tiles are kept in memory up to a maximum total size, least recently used first out. Every tile is also
+/// written in its serialized form to a directory, so tiles dropped from memory and tiles from previous runs are
+/// reloaded from disk instead of the network. The directory is bounded in size the same way.
+/// Notes:
+/// - an empty directory path disables the disk tier
+/// - only one instance per directory must exist
+/// - thread-safe, files are read and written without holding the lock
+/// - files are written on the disk thread pool if there is one, which must be done with them before the cache is
+///   destroyed, otherwise on the inserting thread
+/// - the disk access order is kept in an index file written when the cache is destroyed
+class TerrainTileCache
+{
+public:
+    struct Statistics {
+        quint64     memoryHits      = 0;
+        quint64     diskHits        = 0;
+        quint64     misses          = 0;
+        quint64     memoryEvictions = 0;
+        quint64     diskEvictions   = 0;
+        int         memoryTileCount = 0;
+        qint64      memoryBytes     = 0;
+        int         diskTileCount   = 0;
+        qint64      diskBytes       = 0;
+    };
+
+    TerrainTileCache(const QString &diskPath, qint64 maxMemoryBytes, qint64 maxDiskBytes, QThreadPool *diskThreadPool = nullptr);
+    ~TerrainTileCache();
+
+    /// Looks the tile up in memory, then on disk. Blocks on the disk read, see memoryTile().
+    ///     @return nullptr if the tile is not cached
+    std::shared_ptr<const TerrainTile> tile(const QString &hash);
+
+    /// Looks the tile up in memory only
+    ///     @param[out] onDisk true: tile is not in memory but in the disk tier, load it with diskTile()
+    ///     @return nullptr if the tile is not in memory
+    std::shared_ptr<const TerrainTile> memoryTile(const QString &hash, bool *onDisk = nullptr);
+
+    /// Reads the tile from the disk tier and adds it to memory. Meant for worker threads.
+    ///     @return nullptr if the tile is not cached or unreadable
+    std::shared_ptr<const TerrainTile> diskTile(const QString &hash);
+
+    /// Decodes serializedTile and adds it to both tiers. The tile shows up in the disk tier once its file is written.
+    ///     @param[out] decodedTile the decoded tile if the data is valid, also when neither tier kept it
+    ///     @return false: tile data is invalid or the tile is too large for both tiers
+    bool insert(const QString &hash, const QByteArray &serializedTile, std::shared_ptr<const TerrainTile> *decodedTile = nullptr);
+
+    void setMaxMemoryBytes(qint64 maxMemoryBytes);
+    void setMaxDiskBytes(qint64 maxDiskBytes);
+
+    Statistics statistics() const;
+
+    /// Drops all tiles from memory, the disk tier is kept
+    void clearMemory();
+
+private:
+    typedef std::shared_ptr<const TerrainTile> SharedTile;
+
+    struct DiskEntry {
+        quint64 accessCounter;
+        qint64  size;
+    };
+
+    /// @return false: tile is larger than the memory tier
+    bool _insertMemory(const QString &hash, const SharedTile &tile);
+    QByteArray _readDisk(const QString &hash) const;
+    bool _writeFile(const QString &hash, const QByteArray &serializedTile) const;
+    void _writeDisk(const QString &hash, const QByteArray &serializedTile);
+    void _touchDisk(const QString &hash);
+    void _addDiskEntry(const QString &hash, qint64 size);
+    void _initializeDirectory();
+    void _writeIndex() const;
+    void _removeOldDiskEntries();
+    void _removeDiskEntry(const QString &hash);
+    QString _fileName(const QString &hash) const;
+
+    mutable QMutex _mutex;
+    QCache<QString, SharedTile> _memory;                ///< Cost is TerrainTile::memoryBytes
+    const QDir _diskPath;
+    const bool _diskEnabled;
+    QThreadPool *const _diskThreadPool;
+    qint64 _maxDiskBytes;
+    qint64 _diskBytes = 0;
+    quint64 _nextAccessCounter = 0;
+    QHash<QString, DiskEntry> _diskEntries;
+    QMap<quint64, QString> _diskAccessOrder;            ///< Access counter to hash, least recently used first
+    QSet<QString> _pendingDiskWrites;                   ///< Hashes of the tiles whose file is being written
+    Statistics _statistics;
+
+    static constexpr quint32 kFileMagic = 0x51544331;   ///< "QTC1"
+    static constexpr quint32 kFileVersion = 1;
+    static constexpr qint64 kFileHeaderBytes = 2 * sizeof(quint32);
+    static constexpr const char *kFileExtension = ".terrain";
+    static constexpr const char *kIndexFileName = "access.index";   ///< Hashes, least recently used first
+};
@@ -15,13 +15,24 @@
 #include "QGeoMapReplyQGC.h"
 #include "QGCMapUrlEngine.h"
 #include "ElevationMapProvider.h"
+#include "QGCApplication.h"
+#include "QGCToolbox.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
+#include "MapsSettings.h"
 #include "QGCLoggingCategory.h"
 
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QStandardPaths>
+#include <QtLocation/private/qgeotiledmapreply_p.h>
 #include <QtLocation/private/qgeotilespec_p.h>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkProxy>
 #include <QtNetwork/QNetworkRequest>
 
+#include <algorithm>
+
 QGC_LOGGING_CATEGORY(TerrainTileManagerLog, "qgc.terrain.terraintilemanager")
 
 Q_GLOBAL_STATIC(TerrainTileManager, _terrainTileManager)
@@ -42,13 +53,43 @@ TerrainTileManager::TerrainTileManager(QObject *parent)
     proxy.setType(QNetworkProxy::DefaultProxy);
     _networkManager->setProxy(proxy);
 #endif
+
+    static constexpr qint64 kBytesPerMB = 1024 * 1024;
+
+    SettingsManager* const settingsManager = qgcApp()->toolbox()->settingsManager();
+    MapsSettings* const mapsSettings = settingsManager->mapsSettings();
+    Fact* const maxMemoryFact = mapsSettings->maxTerrainCacheMemorySize();
+    Fact* const maxDiskFact = mapsSettings->maxTerrainCacheDiskSize();
+
+    QString diskPath;
+    if (!settingsManager->appSettings()->disableAllPersistence()->rawValue().toBool()) {
+        diskPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/QGCTerrainCache");
+    }
+
+    // Tiles are read and written one at a time, the disk is not faster with more threads
+    _diskThreadPool.setMaxThreadCount(1);
+
+    _tileCache = std::make_unique<TerrainTileCache>(
+        diskPath,
+        maxMemoryFact->rawValue().toUInt() * kBytesPerMB,
+        maxDiskFact->rawValue().toUInt() * kBytesPerMB,
+        &_diskThreadPool
+    );
+
+    (void) connect(maxMemoryFact, &Fact::rawValueChanged, this, [this](const QVariant &value) {
+        _tileCache->setMaxMemoryBytes(value.toUInt() * kBytesPerMB);
+    });
+    (void) connect(maxDiskFact, &Fact::rawValueChanged, this, [this](const QVariant &value) {
+        _tileCache->setMaxDiskBytes(value.toUInt() * kBytesPerMB);
+    });
 }
 
 TerrainTileManager::~TerrainTileManager()
 {
-    qDeleteAll(_tiles);
-
     // qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << this;
+
+    // Disk reads and writes use the tile cache
+    _diskThreadPool.waitForDone();
 }
 
 void TerrainTileManager::addCoordinateQuery(TerrainQueryInterface *terrainQueryInterface, const QList<QGeoCoordinate> &coordinates)
@@ -59,30 +100,16 @@ void TerrainTileManager::addCoordinateQuery(TerrainQueryInterface *terrainQueryI
         return;
     }
 
-    bool error;
-    QList<double> altitudes;
-    if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "queue count" << _requestQueue.count();
-        const QueuedRequestInfo_t queuedRequestInfo = {
-            terrainQueryInterface,
-            TerrainQuery::QueryMode::QueryModeCoordinates,
-            0,
-            0,
-            coordinates
-        };
-        _requestQueue.enqueue(queuedRequestInfo);
-        return;
-    }
-
-    if (error) {
-        QList<double> noAltitudes;
-        qCWarning(TerrainTileManagerLog) << Q_FUNC_INFO << "signalling failure due to internal error";
-        terrainQueryInterface->signalCoordinateHeights(false, noAltitudes);
-        return;
-    }
-
-    qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "all altitudes taken from cached data";
-    terrainQueryInterface->signalCoordinateHeights((coordinates.count() == altitudes.count()), altitudes);
+    QueuedRequestInfo_t requestInfo = {
+        terrainQueryInterface,
+        TerrainQuery::QueryMode::QueryModeCoordinates,
+        0,
+        0,
+        coordinates,
+        {},
+        {}
+    };
+    _addRequest(requestInfo);
 }
 
 QList<QGeoCoordinate> TerrainTileManager::pathQueryToCoords(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, double &distanceBetween, double &finalDistanceBetween)
@@ -118,203 +145,309 @@ QList<QGeoCoordinate> TerrainTileManager::pathQueryToCoords(const QGeoCoordinate
 
 void TerrainTileManager::addPathQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
 {
-    double distanceBetween;
-    double finalDistanceBetween;
-    const QList<QGeoCoordinate> coordinates = pathQueryToCoords(startPoint, endPoint, distanceBetween, finalDistanceBetween);
+    QueuedRequestInfo_t requestInfo = {
+        terrainQueryInterface,
+        TerrainQuery::QueryMode::QueryModePath,
+        0,
+        0,
+        {},
+        {},
+        {}
+    };
+    requestInfo.coordinates = pathQueryToCoords(startPoint, endPoint, requestInfo.distanceBetween, requestInfo.finalDistanceBetween);
+    _addRequest(requestInfo);
+}
 
+bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error)
+{
+    QHash<QString, SharedTile> tiles;
+    QHash<QString, QPoint> missingTiles;
+    QSet<QString> diskTiles;
+    if (_getAltitudes(coordinates, tiles, altitudes, error, missingTiles, diskTiles)) {
+        return true;
+    }
+
+    _fetchTiles(missingTiles, diskTiles);
+    return false;
+}
+
+bool TerrainTileManager::_getAltitudes(const QList<QGeoCoordinate> &coordinates, QHash<QString, SharedTile> &tiles, QList<double> &altitudes, bool &error, QHash<QString, QPoint> &missingTiles, QSet<QString> &diskTiles)
+{
+    error = false;
+    altitudes.clear();
+
+    static const QString kMapType = CopernicusElevationProvider::kProviderKey;
+    const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
+
+    const qsizetype count = coordinates.count();
+    QList<double> latitudes(count);
+    QList<double> longitudes(count);
+    QList<const TerrainTile*> coordinateTiles(count, nullptr);
+
+    QString tileHash;
+    SharedTile tile;
+    for (qsizetype i = 0; i < count; i++) {
+        const QGeoCoordinate &coordinate = coordinates[i];
+        const int tileX = provider->long2tileX(coordinate.longitude(), 1);
+        const int tileY = provider->lat2tileY(coordinate.latitude(), 1);
+        const QString coordinateTileHash = UrlFactory::getTileHash(provider->getMapName(), tileX, tileY, 1);
+        qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "hash:coordinate" << coordinateTileHash << coordinate;
+
+        // Neighbouring coordinates mostly share a tile, only look it up when it changes
+        if (coordinateTileHash != tileHash) {
+            tileHash = coordinateTileHash;
+            tile = tiles.value(tileHash);
+            if (!tile && !missingTiles.contains(tileHash)) {
+                bool onDisk = false;
+                tile = _getCachedTile(tileHash, onDisk);
+                if (tile) {
+                    (void) tiles.insert(tileHash, tile);
+                } else {
+                    (void) missingTiles.insert(tileHash, QPoint(tileX, tileY));
+                    if (onDisk) {
+                        (void) diskTiles.insert(tileHash);
+                    }
+                }
+            }
+        }
+
+        latitudes[i] = coordinate.latitude();
+        longitudes[i] = coordinate.longitude();
+        coordinateTiles[i] = tile.get();
+    }
+
+    if (!missingTiles.isEmpty()) {
+        return false;
+    }
+
+    // Each run of coordinates on the same tile is interpolated in one batch, tiles stay alive through the tiles hash
+    altitudes.resize(count);
+    for (qsizetype runStart = 0; runStart < count;) {
+        qsizetype runEnd = runStart + 1;
+        while ((runEnd < count) && (coordinateTiles[runEnd] == coordinateTiles[runStart])) {
+            runEnd++;
+        }
+        coordinateTiles[runStart]->bilinearElevations(latitudes.constData() + runStart, longitudes.constData() + runStart, altitudes.data() + runStart, runEnd - runStart);
+        runStart = runEnd;
+    }
+
+    error = std::any_of(altitudes.constBegin(), altitudes.constEnd(), [](double elevation) { return qIsNaN(elevation); });
+    if (error) {
+        qCWarning(TerrainTileManagerLog) << Q_FUNC_INFO << "Internal Error: missing elevation in tile cache";
+    } else {
+        qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "returning elevations from tile cache" << altitudes;
+    }
+
+    return true;
+}
+
+void TerrainTileManager::_addRequest(QueuedRequestInfo_t &requestInfo)
+{
     bool error;
     QList<double> altitudes;
-    if (!getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "queue count" << _requestQueue.count();
-        const QueuedRequestInfo_t queuedRequestInfo = {
-            terrainQueryInterface,
-            TerrainQuery::QueryMode::QueryModePath,
-            distanceBetween,
-            finalDistanceBetween,
-            coordinates
-        };
-        _requestQueue.enqueue(queuedRequestInfo);
+    QHash<QString, QPoint> missingTiles;
+    QSet<QString> diskTiles;
+    if (!_getAltitudes(requestInfo.coordinates, requestInfo.tiles, altitudes, error, missingTiles, diskTiles)) {
+        requestInfo.missingTiles = QSet<QString>(missingTiles.keyBegin(), missingTiles.keyEnd());
+        _requestQueue.enqueue(requestInfo);
+        qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "queue count:missing tiles" << _requestQueue.count() << missingTiles.count();
+        _fetchTiles(missingTiles, diskTiles);
         return;
     }
 
     if (error) {
-        QList<double> noAltitudes;
         qCWarning(TerrainTileManagerLog) << Q_FUNC_INFO << "signalling failure due to internal error";
-        terrainQueryInterface->signalPathHeights(false, distanceBetween, finalDistanceBetween, noAltitudes);
+        _signalRequest(requestInfo, false, QList<double>());
         return;
     }
 
     qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "all altitudes taken from cached data";
-    terrainQueryInterface->signalPathHeights((coordinates.count() == altitudes.count()), distanceBetween, finalDistanceBetween, altitudes);
+    _signalRequest(requestInfo, (requestInfo.coordinates.count() == altitudes.count()), altitudes);
 }
 
-bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error)
+void TerrainTileManager::_signalRequest(const QueuedRequestInfo_t &requestInfo, bool success, const QList<double> &altitudes)
 {
-    error = false;
+    switch (requestInfo.queryMode) {
+    case TerrainQuery::QueryMode::QueryModeCoordinates:
+        requestInfo.terrainQueryInterface->signalCoordinateHeights(success, altitudes);
+        break;
+    case TerrainQuery::QueryMode::QueryModePath:
+        requestInfo.terrainQueryInterface->signalPathHeights(success, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, altitudes);
+        break;
+    default:
+        break;
+    }
+}
 
+void TerrainTileManager::_fetchTiles(const QHash<QString, QPoint> &tiles, const QSet<QString> &diskTiles)
+{
+    for (auto it = tiles.constBegin(); it != tiles.constEnd(); ++it) {
+        if (_requestedTiles.contains(it.key())) {
+            continue;
+        }
+
+        (void) _requestedTiles.insert(it.key(), it.value());
+        if (diskTiles.contains(it.key())) {
+            _loadDiskTile(it.key());
+        } else {
+            _tileFetchQueue.enqueue(it.key());
+        }
+    }
+
+    _startTileFetches();
+}
+
+void TerrainTileManager::_loadDiskTile(const QString &hash)
+{
+    QFutureWatcher<SharedTile>* const watcher = new QFutureWatcher<SharedTile>(this);
+    (void) connect(watcher, &QFutureWatcher<SharedTile>::finished, this, [this, watcher, hash]() {
+        watcher->deleteLater();
+
+        const SharedTile tile = watcher->result();
+        if (!tile) {
+            qCDebug(TerrainTileManagerLog) << "Cached tile not readable, downloading" << hash;
+            _tileFetchQueue.enqueue(hash);
+            _startTileFetches();
+            return;
+        }
+
+        (void) _requestedTiles.remove(hash);
+        _tileArrived(hash, tile);
+    });
+
+    TerrainTileCache* const tileCache = _tileCache.get();
+    watcher->setFuture(QtConcurrent::run(&_diskThreadPool, [tileCache, hash]() {
+        return tileCache->diskTile(hash);
+    }));
+}
+
+void TerrainTileManager::_startTileFetches()
+{
     static const QString kMapType = CopernicusElevationProvider::kProviderKey;
     const SharedMapProvider provider = UrlFactory::getMapProviderFromProviderType(kMapType);
-    for (const QGeoCoordinate &coordinate: coordinates) {
-        const QString tileHash = UrlFactory::getTileHash(
-            provider->getMapName(),
-            provider->long2tileX(coordinate.longitude(), 1),
-            provider->lat2tileY(coordinate.latitude(), 1),
-            1
-        );
-        qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "hash:coordinate" << tileHash << coordinate;
-
-        TerrainTile* const tile = _getCachedTile(tileHash);
-        if (tile) {
-            const double elevation = tile->elevation(coordinate);
-            if (qIsNaN(elevation)) {
-                error = true;
-                qCWarning(TerrainTileManagerLog) << Q_FUNC_INFO << "Internal Error: missing elevation in tile cache";
-            } else {
-                qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "returning elevation from tile cache" << elevation;
-            }
-            altitudes.push_back(elevation);
-        } else if (_state != TerrainQuery::State::Downloading) {
-            QGeoTileSpec spec;
-            spec.setX(provider->long2tileX(coordinate.longitude(), 1));
-            spec.setY(provider->lat2tileY(coordinate.latitude(), 1));
-            spec.setZoom(1);
-            spec.setMapId(provider->getMapId());
-            const QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
-            QGeoTiledMapReplyQGC* const reply = new QGeoTiledMapReplyQGC(_networkManager, request, spec, this);
-            (void) connect(reply, &QGeoTiledMapReplyQGC::finished, this, &TerrainTileManager::_terrainDone);
-            _state = TerrainQuery::State::Downloading;
-            // TODO: Batch Downloading?
-            return false;
+
+    while ((_activeTileFetches < kMaxConcurrentTileFetches) && !_tileFetchQueue.isEmpty()) {
+        const QPoint tile = _requestedTiles.value(_tileFetchQueue.dequeue());
+
+        QGeoTileSpec spec;
+        spec.setX(tile.x());
+        spec.setY(tile.y());
+        spec.setZoom(1);
+        spec.setMapId(provider->getMapId());
+
+        QGeoTiledMapReply* const reply = _createTileReply(spec);
+        (void) connect(reply, &QGeoTiledMapReply::finished, this, &TerrainTileManager::_terrainDone);
+        _activeTileFetches++;
+    }
+
+    qCDebug(TerrainTileManagerLog) << Q_FUNC_INFO << "active:queued" << _activeTileFetches << _tileFetchQueue.count();
+}
+
+QGeoTiledMapReply *TerrainTileManager::_createTileReply(const QGeoTileSpec &spec)
+{
+    const QNetworkRequest request = QGeoTileFetcherQGC::getNetworkRequest(spec.mapId(), spec.x(), spec.y(), spec.zoom());
+    return new QGeoTiledMapReplyQGC(_networkManager, request, spec, this);
+}
+
+void TerrainTileManager::_tileFailed(const QString &hash)
+{
+    // Only the requests which need this tile fail, the others keep waiting on their own tiles
+    QList<QueuedRequestInfo_t> failedRequests;
+    for (auto it = _requestQueue.begin(); it != _requestQueue.end();) {
+        if (it->missingTiles.contains(hash)) {
+            failedRequests.append(*it);
+            it = _requestQueue.erase(it);
         } else {
-            return false;
+            ++it;
         }
     }
 
-    return true;
+    for (const QueuedRequestInfo_t &requestInfo: failedRequests) {
+        _signalRequest(requestInfo, false, QList<double>());
+    }
 }
 
-void TerrainTileManager::_tileFailed()
+void TerrainTileManager::_tileArrived(const QString &hash, const SharedTile &tile)
 {
-    QList<double> noAltitudes;
-
-    for (const QueuedRequestInfo_t &requestInfo: _requestQueue) {
-        switch (requestInfo.queryMode) {
-        case TerrainQuery::QueryMode::QueryModeCoordinates:
-            requestInfo.terrainQueryInterface->signalCoordinateHeights(false, noAltitudes);
-            break;
-        case TerrainQuery::QueryMode::QueryModePath:
-            requestInfo.terrainQueryInterface->signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
-            break;
-        default:
+    QList<QueuedRequestInfo_t> readyRequests;
+    for (auto it = _requestQueue.begin(); it != _requestQueue.end();) {
+        if (!it->missingTiles.remove(hash)) {
+            ++it;
             continue;
         }
+
+        (void) it->tiles.insert(hash, tile);
+        if (it->missingTiles.isEmpty()) {
+            readyRequests.append(*it);
+            it = _requestQueue.erase(it);
+        } else {
+            ++it;
+        }
     }
 
-    _requestQueue.clear();
+    // The requests hold all of their tiles now, whatever the cache dropped in the meantime
+    for (QueuedRequestInfo_t &requestInfo: readyRequests) {
+        _addRequest(requestInfo);
+    }
 }
 
 void TerrainTileManager::_terrainDone()
 {
-    _state = TerrainQuery::State::Idle;
-
-    QGeoTiledMapReplyQGC* const reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
+    QGeoTiledMapReply* const reply = qobject_cast<QGeoTiledMapReply*>(QObject::sender());
     if (!reply) {
         qCWarning(TerrainTileManagerLog) << "Elevation tile fetched but invalid reply data type.";
         return;
     }
+    // Some replies signal finished more than once
+    (void) disconnect(reply, &QGeoTiledMapReply::finished, this, &TerrainTileManager::_terrainDone);
     reply->deleteLater();
 
+    _activeTileFetches--;
+
     const QByteArray responseBytes = reply->mapImageData();
     const QGeoTileSpec spec = reply->tileSpec();
+    const QString hash = UrlFactory::getTileHash(UrlFactory::getProviderTypeFromQtMapId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
+    (void) _requestedTiles.remove(hash);
 
-    if (reply->error() != QGeoTiledMapReplyQGC::NoError) {
+    // Keep the download slots busy before answering the requests
+    _startTileFetches();
+
+    if (reply->error() != QGeoTiledMapReply::NoError) {
         qCWarning(TerrainTileManagerLog) << "Elevation tile fetching returned error:" << reply->errorString();
-        _tileFailed();
+        _tileFailed(hash);
         return;
     }
 
     if (responseBytes.isEmpty()) {
         qCWarning(TerrainTileManagerLog) << "Error in fetching elevation tile. Empty response.";
-        _tileFailed();
+        _tileFailed(hash);
         return;
     }
 
     qCDebug(TerrainTileManagerLog) << "Received some bytes of terrain data:" << responseBytes.size();
 
-    const QString hash = UrlFactory::getTileHash(UrlFactory::getProviderTypeFromQtMapId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
-    _cacheTile(responseBytes, hash);
-
-    for (qsizetype i = _requestQueue.count() - 1; i >= 0; i--) {
-        bool error;
-        QList<double> altitudes;
-        QueuedRequestInfo_t &requestInfo = _requestQueue[i];
-
-        if (!getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
-            continue;
-        }
-
-        switch (requestInfo.queryMode) {
-        case TerrainQuery::QueryMode::QueryModeCoordinates:
-            if (error) {
-                qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
-                QList<double> noAltitudes;
-                requestInfo.terrainQueryInterface->signalCoordinateHeights(false, noAltitudes);
-            } else {
-                qCDebug(TerrainTileManagerLog) << "All altitudes taken from cached data";
-                requestInfo.terrainQueryInterface->signalCoordinateHeights(requestInfo.coordinates.count() == altitudes.count(), altitudes);
-            }
-            break;
-        case TerrainQuery::QueryMode::QueryModePath:
-            if (error) {
-                qCWarning(TerrainTileManagerLog) << "signalling failure due to internal error";
-                QList<double> noAltitudes;
-                requestInfo.terrainQueryInterface->signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
-            } else {
-                qCDebug(TerrainTileManagerLog) << "All altitudes taken from cached data";
-                requestInfo.terrainQueryInterface->signalPathHeights(requestInfo.coordinates.count() == altitudes.count(), requestInfo.distanceBetween, requestInfo.finalDistanceBetween, altitudes);
-            }
-            break;
-        default:
-            break;
-        }
-
-        _requestQueue.removeAt(i);
+    const SharedTile tile = _cacheTile(responseBytes, hash);
+    if (!tile) {
+        _tileFailed(hash);
+        return;
     }
+
+    _tileArrived(hash, tile);
 }
 
-void TerrainTileManager::_cacheTile(const QByteArray &data, const QString &hash)
+TerrainTileManager::SharedTile TerrainTileManager::_cacheTile(const QByteArray &data, const QString &hash)
 {
-    TerrainTile* const terrainTile = new TerrainTile(data);
-    if (terrainTile->isValid()) {
-        _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            (void) _tiles.insert(hash, terrainTile);
-        } else {
-            delete terrainTile;
-        }
-        _tilesMutex.unlock();
-    } else {
-        delete terrainTile;
+    // A tile which is too large for the cache still answers the requests waiting on it
+    SharedTile tile;
+    (void) _tileCache->insert(hash, data, &tile);
+    if (!tile) {
         qCWarning(TerrainTileManagerLog) << "Received invalid tile";
     }
+
+    return tile;
 }
 
-TerrainTile *TerrainTileManager::_getCachedTile(const QString &hash)
+TerrainTileManager::SharedTile TerrainTileManager::_getCachedTile(const QString &hash, bool &onDisk)
 {
-    _tilesMutex.lock();
-    if (!_tiles.contains(hash)) {
-        _tilesMutex.unlock();
-        return nullptr;
-    }
-
-    TerrainTile* const tile = _tiles[hash];
-
-    if (!tile->isValid()) {
-        _tilesMutex.unlock();
-        return nullptr;
-    }
-
-    _tilesMutex.unlock();
-
-    return tile;
+    return _tileCache->memoryTile(hash, &onDisk);
 }
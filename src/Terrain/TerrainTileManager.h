@@ -10,18 +10,30 @@
 #pragma once
 
 #include "TerrainQueryInterface.h"
+#include "TerrainTileCache.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QLoggingCategory>
-#include <QtCore/QMutex>
 #include <QtCore/QObject>
+#include <QtCore/QPoint>
 #include <QtCore/QQueue>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
 #include <QtPositioning/QGeoCoordinate>
 
+#include <memory>
+
 class TerrainTile;
+class QGeoTiledMapReply;
+class QGeoTileSpec;
 class QNetworkAccessManager;
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileManagerLog)
 
+/// Answers terrain queries from cached elevation tiles. The missing tiles of all queued queries are downloaded
+/// together, at most kMaxConcurrentTileFetches at a time, and each query is answered as soon as its own tiles are in.
+/// Tiles which are only in the disk tier of the cache are read on a worker thread. A queued query holds on to the
+/// tiles it already has, so a small cache can not drop them before the query is answered.
 class TerrainTileManager : public QObject
 {
     Q_OBJECT
@@ -35,21 +47,31 @@ public:
     void addCoordinateQuery(TerrainQueryInterface *terrainQueryInterface, const QList<QGeoCoordinate> &coordinates);
     void addPathQuery(TerrainQueryInterface *terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint);
 
-    /// Either returns altitudes from cache or queues database request
+    /// Either returns altitudes from cache or starts downloading the missing tiles
     ///     @param[out] error true: altitude not returned due to error, false: altitudes returned
-    ///     @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
+    ///     @return true: altitude returned (check error as well), false: tiles are being downloaded (altitudes not returned)
     bool getAltitudesForCoordinates(const QList<QGeoCoordinate> &coordinates, QList<double> &altitudes, bool &error);
 
     /// Returns a list of individual coordinates along the requested path spaced according to the terrain tile value spacing
     static QList<QGeoCoordinate> pathQueryToCoords(const QGeoCoordinate &fromCoord, const QGeoCoordinate &toCoord, double &distanceBetween, double &finalDistanceBetween);
 
+    /// Hit, miss and eviction counters of the tile cache
+    TerrainTileCache::Statistics cacheStatistics() const { return _tileCache->statistics(); }
+
+    /// Qt opens at most six connections per host, more downloads in flight would only queue inside QNetworkAccessManager
+    static constexpr int kMaxConcurrentTileFetches = 6;
+
+protected:
+    /// Creates the reply which fetches the tile from the map tile cache or the network
+    virtual QGeoTiledMapReply *_createTileReply(const QGeoTileSpec &spec);
+
+    std::unique_ptr<TerrainTileCache> _tileCache;
+
 private slots:
     void _terrainDone();
 
 private:
-    void _tileFailed();
-    void _cacheTile(const QByteArray &data, const QString &hash);
-    TerrainTile *_getCachedTile(const QString &hash);
+    typedef std::shared_ptr<const TerrainTile> SharedTile;
 
     struct QueuedRequestInfo_t {
         TerrainQueryInterface *terrainQueryInterface;
@@ -57,13 +79,31 @@ private:
         double distanceBetween;                         ///< Distance between each returned height
         double finalDistanceBetween;                    ///< Distance between for final height
         QList<QGeoCoordinate> coordinates;
+        QSet<QString> missingTiles;                     ///< Hashes of the tiles the request is waiting on
+        QHash<QString, SharedTile> tiles;               ///< Tiles the request already has, held until it is answered
     };
 
-    QQueue<QueuedRequestInfo_t> _requestQueue;
-    TerrainQuery::State _state = TerrainQuery::State::Idle;
+    /// Looks all coordinates up in tiles, then in the memory tier of the tile cache
+    ///     @param[in,out] tiles tiles by hash, tiles found in the cache are added
+    ///     @param[out] missingTiles tile x/y by hash of the tiles which are not in memory
+    ///     @param[out] diskTiles hashes of the missing tiles which are in the disk tier
+    ///     @return true: all tiles were found
+    bool _getAltitudes(const QList<QGeoCoordinate> &coordinates, QHash<QString, SharedTile> &tiles, QList<double> &altitudes, bool &error, QHash<QString, QPoint> &missingTiles, QSet<QString> &diskTiles);
+    void _addRequest(QueuedRequestInfo_t &requestInfo);
+    void _signalRequest(const QueuedRequestInfo_t &requestInfo, bool success, const QList<double> &altitudes);
+    void _fetchTiles(const QHash<QString, QPoint> &tiles, const QSet<QString> &diskTiles);
+    void _loadDiskTile(const QString &hash);
+    void _startTileFetches();
+    void _tileArrived(const QString &hash, const SharedTile &tile);
+    void _tileFailed(const QString &hash);
+    SharedTile _cacheTile(const QByteArray &data, const QString &hash);
+    SharedTile _getCachedTile(const QString &hash, bool &onDisk);
 
-    QMutex _tilesMutex;
-    QHash<QString, TerrainTile*> _tiles;
+    QQueue<QueuedRequestInfo_t> _requestQueue;
+    QQueue<QString> _tileFetchQueue;                    ///< Hashes of the tiles waiting for a download slot
+    QHash<QString, QPoint> _requestedTiles;             ///< Tile x/y of the tiles being read from disk, queued or being downloaded
+    int _activeTileFetches = 0;
 
     QNetworkAccessManager *_networkManager = nullptr;
+    QThreadPool _diskThreadPool;                        ///< Reads and writes the disk tier of the cache
 };
@@ -23,6 +23,9 @@ VehicleClockFactGroup::VehicleClockFactGroup(QObject* parent)
     _currentTimeFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
     _currentUTCTimeFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
     _currentDateFact.setRawValue(std::numeric_limits<float>::quiet_NaN());
+
+    // The clock ticks without any incoming values
+    _setPeriodicUpdates(true);
 }
 
 void VehicleClockFactGroup::_updateAllValues()
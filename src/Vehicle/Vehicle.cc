@@ -119,7 +119,17 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
+    // Only our own traffic is routed to us, plus RADIO_STATUS which can come from the radios on our links
+    (void) _mavlink->subscribe(this, {
+                                   { _id },
+                                   { 0 },
+                                   { MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, MAVLINK_MSG_ID_RADIO_STATUS }
+                               },
+                               [this](const MAVLinkProtocol::MessageBatch& messages) {
+        for (const MAVLinkProtocol::ReceivedMessageRef& received : messages) {
+            _mavlinkMessageReceived(received.link, *received.message);
+        }
+    });
     connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
 
     connect(this, &Vehicle::flightModeChanged,          this, &Vehicle::_handleFlightModeChanged);
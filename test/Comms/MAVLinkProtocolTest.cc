@@ -0,0 +1,318 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkProtocolTest.h"
+#include "MAVLinkProtocol.h"
+#include "QGCApplication.h"
+
+#include <QtCore/QThread>
+#include <QtTest/QTest>
+
+namespace {
+
+typedef QList<QList<int>> BatchValues;
+
+/// Handler which records the message values of each batch it is called with
+MAVLinkProtocol::MessageBatchHandler recordBatches(BatchValues& batches, int (*value)(const mavlink_message_t&))
+{
+    return [&batches, value](const MAVLinkProtocol::MessageBatch& messages) {
+        QList<int> values;
+        for (const MAVLinkProtocol::ReceivedMessageRef& received : messages) {
+            values.append(value(*received.message));
+        }
+        batches.append(values);
+    };
+}
+
+}
+
+QByteArray MAVLinkProtocolTest::_namedValueIntPacket(uint8_t sysid, uint8_t compid, int value, bool mavlink1)
+{
+    mavlink_status_t* const encodeStatus = mavlink_get_channel_status(_encodeChannel);
+    if (mavlink1) {
+        encodeStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    } else {
+        encodeStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
+
+    mavlink_message_t message;
+    (void) mavlink_msg_named_value_int_pack_chan(sysid, compid, _encodeChannel, &message, 0, "test", value);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const int len = mavlink_msg_to_send_buffer(buffer, &message);
+    return QByteArray(reinterpret_cast<const char*>(buffer), len);
+}
+
+QByteArray MAVLinkProtocolTest::_namedValueFloatPacket(uint8_t sysid, uint8_t compid, int value)
+{
+    mavlink_get_channel_status(_encodeChannel)->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+
+    mavlink_message_t message;
+    (void) mavlink_msg_named_value_float_pack_chan(sysid, compid, _encodeChannel, &message, 0, "test", static_cast<float>(value));
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const int len = mavlink_msg_to_send_buffer(buffer, &message);
+    return QByteArray(reinterpret_cast<const char*>(buffer), len);
+}
+
+int MAVLinkProtocolTest::_value(const mavlink_message_t& message)
+{
+    if (message.msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT) {
+        return static_cast<int>(mavlink_msg_named_value_float_get_value(&message));
+    }
+    return mavlink_msg_named_value_int_get_value(&message);
+}
+
+void MAVLinkProtocolTest::_connectQuietMockLink()
+{
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    _mockLink->setCommLost(true);
+
+    // Let the traffic which is already queued drain
+    QTest::qWait(100);
+
+    (void) memset(mavlink_get_channel_status(_encodeChannel), 0, sizeof(mavlink_status_t));
+}
+
+void MAVLinkProtocolTest::_receivePackets(const QList<QByteArray>& packets)
+{
+    QByteArray bytes;
+    for (const QByteArray& packet : packets) {
+        bytes.append(packet);
+    }
+
+    // A single receive is decoded and queued as a whole, so it is delivered as one batch
+    emit _mockLink->bytesReceived(_mockLink, bytes);
+}
+
+/// Receives mixed MAVLink 1/2 traffic through the worker thread while the main thread switches the outbound
+/// version. Every message must arrive in order and the channel must end up with the last requested version.
+void MAVLinkProtocolTest::_testVersionSwitchDuringReceive()
+{
+    static constexpr int kMessageCount = 2000;
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    (void) memset(mavlink_get_channel_status(_encodeChannel), 0, sizeof(mavlink_status_t));
+    QList<QByteArray> packets;
+    for (int i = 0; i < kMessageCount; i++) {
+        packets.append(_namedValueIntPacket(_sysid, MAV_COMP_ID_AUTOPILOT1, i, (i % 2) == 0));
+    }
+
+    int receivedCount = 0;
+    int mavlink1Count = 0;
+    bool inOrder = true;
+    QObject context;
+    (void) protocol->subscribe(&context, { { _sysid, MAVLinkProtocol::anyId, MAVLINK_MSG_ID_NAMED_VALUE_INT } }, [&](const MAVLinkProtocol::MessageBatch& messages) {
+        for (const MAVLinkProtocol::ReceivedMessageRef& received : messages) {
+            if (_value(*received.message) != receivedCount) {
+                inOrder = false;
+            }
+            if (received.message->magic == MAVLINK_STX_MAVLINK1) {
+                mavlink1Count++;
+            }
+            receivedCount++;
+        }
+    });
+
+    // Bytes arrive from a link thread, the same way the links deliver them
+    MockLink* const link = _mockLink;
+    QThread* const receiveThread = QThread::create([link, packets]() {
+        for (const QByteArray& packet : packets) {
+            emit link->bytesReceived(link, packet);
+        }
+    });
+    receiveThread->start();
+
+    unsigned version = 100;
+    while (!receiveThread->isFinished()) {
+        protocol->setVersion(version);
+        version = (version == 100) ? 200 : 100;
+        QTest::qWait(1);
+    }
+    QVERIFY(receiveThread->wait());
+    delete receiveThread;
+
+    QTRY_COMPARE_WITH_TIMEOUT(receivedCount, kMessageCount, 10000);
+    QVERIFY(inOrder);
+    QCOMPARE(mavlink1Count, kMessageCount / 2);
+
+    // Requests are applied in order, so the channel settles on the last one
+    protocol->setVersion(100);
+    QTRY_VERIFY(mavlink_get_channel_status(_mockLink->mavlinkChannel())->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1);
+    QCOMPARE(protocol->getCurrentVersion(), 100u);
+
+    // The worker reports the first mavlink 2.0 packet after a reset, which switches all links to v2
+    protocol->resetMetadataForLink(_mockLink);
+    emit _mockLink->bytesReceived(_mockLink, _namedValueIntPacket(_sysid, MAV_COMP_ID_AUTOPILOT1, kMessageCount));
+    QTRY_COMPARE(protocol->getCurrentVersion(), 200u);
+    QVERIFY(!(mavlink_get_channel_status(_mockLink->mavlinkChannel())->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1));
+
+    _disconnectMockLink();
+}
+
+/// Each subscription gets the messages matching any of its filters, in receive order, with one call per batch
+void MAVLinkProtocolTest::_testSubscribeFilters()
+{
+    _connectQuietMockLink();
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    static constexpr int anyId = MAVLinkProtocol::anyId;
+
+    BatchValues bySysid, byCompid, byMsgid, exact, overlapping, noMatch;
+    QObject context;
+    (void) protocol->subscribe(&context, { { _sysid } }, recordBatches(bySysid, _value));
+    (void) protocol->subscribe(&context, { { _sysid, 2 } }, recordBatches(byCompid, _value));
+    (void) protocol->subscribe(&context, { { anyId, anyId, MAVLINK_MSG_ID_NAMED_VALUE_FLOAT } }, recordBatches(byMsgid, _value));
+    (void) protocol->subscribe(&context, { { _sysid + 1, 1, MAVLINK_MSG_ID_NAMED_VALUE_INT } }, recordBatches(exact, _value));
+    // Both filters match the same messages, which must still only be delivered once
+    (void) protocol->subscribe(&context, { { _sysid, anyId, MAVLINK_MSG_ID_NAMED_VALUE_INT }, { _sysid, 1 } }, recordBatches(overlapping, _value));
+    (void) protocol->subscribe(&context, { { _sysid + 2 } }, recordBatches(noMatch, _value));
+
+    _receivePackets({
+        _namedValueIntPacket(_sysid, 1, 0),
+        _namedValueFloatPacket(_sysid, 2, 1),
+        _namedValueIntPacket(_sysid + 1, 1, 2),
+        _namedValueIntPacket(_sysid + 1, 2, 3),
+        _namedValueIntPacket(_sysid, 1, 4),
+    });
+
+    const BatchValues expectedBySysid = { { 0, 1, 4 } };
+    const BatchValues expectedFloat = { { 1 } };
+    const BatchValues expectedExact = { { 2 } };
+    const BatchValues expectedOverlapping = { { 0, 4 } };
+
+    QTRY_COMPARE(bySysid.count(), 1);
+    QCOMPARE(bySysid, expectedBySysid);
+    QCOMPARE(byCompid, expectedFloat);
+    QCOMPARE(byMsgid, expectedFloat);
+    QCOMPARE(exact, expectedExact);
+    QCOMPARE(overlapping, expectedOverlapping);
+    QVERIFY(noMatch.isEmpty());
+
+    _disconnectMockLink();
+}
+
+/// Handlers can remove subscriptions, including their own, while the batch is being dispatched
+void MAVLinkProtocolTest::_testUnsubscribeDuringDispatch()
+{
+    _connectQuietMockLink();
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    QObject context;
+    QObject* const removedContext = new QObject();
+
+    int firstCount = 0, removedCount = 0, removedByContextCount = 0, lastCount = 0;
+    int removedId = -1;
+    int firstId = -1;
+    firstId = protocol->subscribe(&context, { { _sysid } }, [&](const MAVLinkProtocol::MessageBatch&) {
+        firstCount++;
+        protocol->unsubscribe(firstId);
+        protocol->unsubscribe(removedId);
+        delete removedContext;
+    });
+    removedId = protocol->subscribe(&context, { { _sysid } }, [&](const MAVLinkProtocol::MessageBatch&) {
+        removedCount++;
+    });
+    (void) protocol->subscribe(removedContext, { { _sysid } }, [&](const MAVLinkProtocol::MessageBatch&) {
+        removedByContextCount++;
+    });
+    (void) protocol->subscribe(&context, { { _sysid } }, [&](const MAVLinkProtocol::MessageBatch&) {
+        lastCount++;
+    });
+
+    _receivePackets({ _namedValueIntPacket(_sysid, 1, 0) });
+    QTRY_COMPARE(lastCount, 1);
+    QCOMPARE(firstCount, 1);
+    QCOMPARE(removedCount, 0);
+    QCOMPARE(removedByContextCount, 0);
+
+    _receivePackets({ _namedValueIntPacket(_sysid, 1, 1) });
+    QTRY_COMPARE(lastCount, 2);
+    QCOMPARE(firstCount, 1);
+
+    _disconnectMockLink();
+}
+
+/// Subscriptions go away with their context
+void MAVLinkProtocolTest::_testContextDestroyed()
+{
+    _connectQuietMockLink();
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    const int startCount = protocol->subscriptionCount();
+
+    QObject context;
+    QObject* const destroyedContext = new QObject();
+    int destroyedCount = 0, sentinelCount = 0;
+    (void) protocol->subscribe(destroyedContext, { { _sysid } }, [&](const MAVLinkProtocol::MessageBatch&) {
+        destroyedCount++;
+    });
+    (void) protocol->subscribe(&context, { { _sysid } }, [&](const MAVLinkProtocol::MessageBatch&) {
+        sentinelCount++;
+    });
+    QCOMPARE(protocol->subscriptionCount(), startCount + 2);
+
+    delete destroyedContext;
+    QCOMPARE(protocol->subscriptionCount(), startCount + 1);
+
+    _receivePackets({ _namedValueIntPacket(_sysid, 1, 0) });
+    QTRY_COMPARE(sentinelCount, 1);
+    QCOMPARE(destroyedCount, 0);
+
+    _disconnectMockLink();
+}
+
+/// The saved calls statistic compares the batch handler calls with the messages the handlers actually received
+void MAVLinkProtocolTest::_testSavedDispatchCount()
+{
+    static constexpr int kMessageCount = 10;
+
+    _connectQuietMockLink();
+    MAVLinkProtocol* const protocol = qgcApp()->toolbox()->mavlinkProtocol();
+
+    BatchValues bySysid, byMsgid, noMatch;
+    QObject context;
+    (void) protocol->subscribe(&context, { { _sysid } }, recordBatches(bySysid, _value));
+    (void) protocol->subscribe(&context, { { MAVLinkProtocol::anyId, MAVLinkProtocol::anyId, MAVLINK_MSG_ID_NAMED_VALUE_INT } }, recordBatches(byMsgid, _value));
+    (void) protocol->subscribe(&context, { { _sysid + 2 } }, recordBatches(noMatch, _value));
+
+    const quint64 startRouted = protocol->routedMessageCount();
+    const quint64 startDispatched = protocol->subscriptionDispatchCount();
+    const quint64 startDelivered = protocol->deliveredMessageCount();
+    const quint64 startSaved = protocol->savedDispatchCount();
+
+    QList<QByteArray> packets;
+    for (int i = 0; i < kMessageCount; i++) {
+        packets.append(_namedValueIntPacket(_sysid, 1, i));
+    }
+    _receivePackets(packets);
+
+    QTRY_COMPARE(bySysid.count(), 1);
+    QCOMPARE(bySysid[0].count(), kMessageCount);
+    QCOMPARE(byMsgid.count(), 1);
+    QVERIFY(noMatch.isEmpty());
+
+    // Messages the handlers actually received, each one would have been a separate call with a per message signal
+    quint64 receivedCount = 0;
+    for (const BatchValues* const batches : { &bySysid, &byMsgid }) {
+        for (const QList<int>& batch : *batches) {
+            receivedCount += static_cast<quint64>(batch.count());
+        }
+    }
+    QCOMPARE(receivedCount, static_cast<quint64>(2 * kMessageCount));
+
+    QCOMPARE(protocol->routedMessageCount() - startRouted, static_cast<quint64>(kMessageCount));
+    QCOMPARE(protocol->subscriptionDispatchCount() - startDispatched, 2ULL);
+    QCOMPARE(protocol->deliveredMessageCount() - startDelivered, receivedCount);
+    QCOMPARE(protocol->savedDispatchCount() - startSaved, receivedCount - 2);
+
+    _disconnectMockLink();
+}
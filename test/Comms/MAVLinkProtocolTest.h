@@ -0,0 +1,42 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class MAVLinkProtocolTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkProtocolTest() = default;
+
+private slots:
+    void _testVersionSwitchDuringReceive();
+    void _testSubscribeFilters();
+    void _testUnsubscribeDuringDispatch();
+    void _testContextDestroyed();
+    void _testSavedDispatchCount();
+
+private:
+    /// Connects a MockLink which stops sending once the vehicle is up, so only the injected traffic is delivered
+    void _connectQuietMockLink();
+    /// Delivers the packets to the protocol as a single receive from the link
+    void _receivePackets(const QList<QByteArray>& packets);
+
+    static QByteArray _namedValueIntPacket(uint8_t sysid, uint8_t compid, int value, bool mavlink1 = false);
+    static QByteArray _namedValueFloatPacket(uint8_t sysid, uint8_t compid, int value);
+    /// @return Value of a NAMED_VALUE_INT/FLOAT message
+    static int _value(const mavlink_message_t& message);
+
+    static constexpr uint8_t            _sysid          = 200;
+    static constexpr mavlink_channel_t  _encodeChannel  = MAVLINK_COMM_14;
+};
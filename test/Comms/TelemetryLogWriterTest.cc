@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryLogWriterTest.h"
+#include "TelemetryLogWriter.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+QByteArray TelemetryLogWriterTest::_record(quint64 timestamp, const QByteArray& data)
+{
+    char bigEndianTimestamp[sizeof(quint64)];
+    qToBigEndian(timestamp, bigEndianTimestamp);
+    return QByteArray(bigEndianTimestamp, sizeof(bigEndianTimestamp)) + data;
+}
+
+void TelemetryLogWriterTest::_testWriteRecords()
+{
+    TelemetryLogWriter writer(_fileTemplate);
+    QSignalSpy spyStopped(&writer, &TelemetryLogWriter::loggingStopped);
+
+    QVERIFY(!writer.writeRecord(1, "x", 1));
+
+    writer.startLogging();
+    QVERIFY(writer.isLogging());
+
+    QByteArray expected;
+    for (int i = 0; i < 500; i++) {
+        const QByteArray data(1 + (i % 280), static_cast<char>(i));
+        QVERIFY(writer.writeRecord(static_cast<quint64>(i) * 1000, data.constData(), data.size()));
+        expected += _record(static_cast<quint64>(i) * 1000, data);
+        if ((i % 100) == 0) {
+            writer.flush();
+        }
+    }
+    writer.setVehicleWasArmed();
+    writer.stopLogging();
+
+    QVERIFY(!writer.isLogging());
+    QCOMPARE(writer.droppedRecordCount(), 0ULL);
+    QCOMPARE(spyStopped.count(), 1);
+    const QString fileName = spyStopped[0][0].toString();
+    QCOMPARE(spyStopped[0][1].toBool(), true);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), expected);
+    file.close();
+    QVERIFY(QFile::remove(fileName));
+}
+
+void TelemetryLogWriterTest::_testDropWhenFull()
+{
+    TelemetryLogWriter writer(_fileTemplate, 64 * 1024);
+    QSignalSpy spyStopped(&writer, &TelemetryLogWriter::loggingStopped);
+    QCOMPARE(writer.bufferSize(), static_cast<qsizetype>(64 * 1024));
+
+    writer.startLogging();
+
+    const QByteArray data(1000, 'd');
+    const qsizetype recordLength = static_cast<qsizetype>(sizeof(quint64)) + data.size();
+    const int recordsThatFit = static_cast<int>(writer.bufferSize() / recordLength);
+
+    // Nothing is drained, so the buffer fills up and the rest are dropped whole
+    QByteArray expected;
+    for (int i = 0; i < recordsThatFit + 10; i++) {
+        const bool written = writer.writeRecord(static_cast<quint64>(i), data.constData(), data.size());
+        QCOMPARE(written, i < recordsThatFit);
+        if (written) {
+            expected += _record(static_cast<quint64>(i), data);
+        }
+    }
+    QCOMPARE(writer.droppedRecordCount(), 10ULL);
+    QCOMPARE(writer.droppedByteCount(), static_cast<quint64>(10 * recordLength));
+
+    // Once drained the records wrap around the end of the buffer
+    writer.flush();
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(writer.writeRecord(static_cast<quint64>(i), data.constData(), data.size()));
+        expected += _record(static_cast<quint64>(i), data);
+    }
+    writer.stopLogging();
+
+    QCOMPARE(spyStopped.count(), 1);
+    const QString fileName = spyStopped[0][0].toString();
+    QCOMPARE(spyStopped[0][1].toBool(), false);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), expected);
+    file.close();
+    QVERIFY(QFile::remove(fileName));
+}
+
+void TelemetryLogWriterTest::_testSuspendForReplay()
+{
+    TelemetryLogWriter writer(_fileTemplate);
+    QSignalSpy spyStarted(&writer, &TelemetryLogWriter::loggingStarted);
+    QSignalSpy spyStopped(&writer, &TelemetryLogWriter::loggingStopped);
+
+    writer.suspendLogForReplay(true);
+    writer.startLogging();
+    QCOMPARE(spyStarted.count(), 0);
+    QVERIFY(!writer.isLogging());
+    QVERIFY(!writer.writeRecord(1, "x", 1));
+
+    writer.suspendLogForReplay(false);
+    writer.startLogging();
+    QCOMPARE(spyStarted.count(), 1);
+    QVERIFY(writer.isLogging());
+
+    // Empty logs are removed instead of being reported
+    writer.stopLogging();
+    QCOMPARE(spyStopped.count(), 0);
+}
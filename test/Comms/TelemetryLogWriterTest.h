@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TelemetryLogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TelemetryLogWriterTest() = default;
+
+private slots:
+    void _testWriteRecords();
+    void _testDropWhenFull();
+    void _testSuspendForReplay();
+
+private:
+    static QByteArray _record(quint64 timestamp, const QByteArray& data);
+
+    static constexpr const char* _fileTemplate = "TelemetryLogWriterTestXXXXXX.mavlink";
+};
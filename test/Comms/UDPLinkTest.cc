@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UDPLinkTest.h"
+#include "UDPLink.h"
+#include "LinkManager.h"
+
+#include <QtCore/QtEndian>
+#include <QtNetwork/QUdpSocket>
+#include <QtTest/QTest>
+
+UDPLink* UDPLinkTest::_connectUDPLink()
+{
+    // Let the system pick a port nothing else is listening on
+    QUdpSocket probe;
+    if (!probe.bind(QHostAddress::LocalHost, 0)) {
+        return nullptr;
+    }
+    _localPort = probe.localPort();
+    probe.close();
+
+    UDPConfiguration* const udpConfig = new UDPConfiguration(QStringLiteral("UDPLinkTest"));
+    udpConfig->setDynamic(true);
+    udpConfig->setLocalPort(_localPort);
+    SharedLinkConfigurationPtr config(udpConfig);
+    if (!_linkManager->createConnectedLink(config)) {
+        return nullptr;
+    }
+
+    UDPLink* const link = qobject_cast<UDPLink*>(config->link());
+    if (!link || !QTest::qWaitFor([link]() { return link->isConnected(); }, 5000)) {
+        return nullptr;
+    }
+    return link;
+}
+
+void UDPLinkTest::_testReceiveBurst()
+{
+    UDPLink* const link = _connectUDPLink();
+    QVERIFY(link);
+
+    QList<QByteArray> batches;
+    (void) connect(link, &LinkInterface::bytesReceived, this, [&batches](LinkInterface*, const QByteArray& data) {
+        batches.append(data);
+    });
+
+    // Well past a single receive batch, but within the socket receive buffer so nothing is dropped by the system
+    constexpr int datagramSize = 1000;
+    constexpr int datagramCount = 100;
+    static_assert(datagramSize * datagramCount > UDPLink::kMaxReceiveBatchBytes);
+
+    QUdpSocket sender;
+    QVERIFY(sender.bind(QHostAddress::LocalHost, 0));
+    QByteArray expected;
+    for (int i = 0; i < datagramCount; i++) {
+        QByteArray datagram(datagramSize, static_cast<char>('a' + (i % 26)));
+        qToBigEndian(static_cast<quint32>(i), datagram.data());
+        QCOMPARE(sender.writeDatagram(datagram, QHostAddress::LocalHost, _localPort), static_cast<qint64>(datagramSize));
+        expected += datagram;
+    }
+
+    const auto receivedSize = [&batches]() {
+        qsizetype size = 0;
+        for (const QByteArray& batch : batches) {
+            size += batch.size();
+        }
+        return size;
+    };
+    QTRY_COMPARE_WITH_TIMEOUT(receivedSize(), expected.size(), 5000);
+
+    // Everything arrives in order, split into batches which stop once they reach the limit
+    QByteArray received;
+    for (const QByteArray& batch : batches) {
+        QVERIFY(batch.size() < UDPLink::kMaxReceiveBatchBytes + datagramSize);
+        received += batch;
+    }
+    QCOMPARE(received, expected);
+    QVERIFY(batches.count() > 1);
+
+    const UDPLink::ReceiveStatistics_t statistics = link->receiveStatistics();
+    QCOMPARE(statistics.datagrams, static_cast<quint64>(datagramCount));
+    QCOMPARE(statistics.bytes, static_cast<quint64>(expected.size()));
+    QVERIFY(statistics.readyReadCount >= static_cast<quint64>(batches.count()));
+    QVERIFY(statistics.socketCalls > statistics.datagrams);
+
+    _linkManager->disconnectAll();
+}
+
+void UDPLinkTest::_testKnownSendersBounded()
+{
+    UDPLink* const link = _connectUDPLink();
+    QVERIFY(link);
+
+    int receivedCount = 0;
+    (void) connect(link, &LinkInterface::bytesReceived, this, [&receivedCount](LinkInterface*, const QByteArray& data) {
+        receivedCount += static_cast<int>(data.size());
+    });
+
+    // Each socket sends from its own port, like a port scanner would
+    constexpr int senderCount = UDPLink::kMaxKnownSenders + 10;
+    QList<QUdpSocket*> senders;
+    for (int i = 0; i < senderCount; i++) {
+        QUdpSocket* const sender = new QUdpSocket(this);
+        senders.append(sender);
+        QVERIFY(sender->bind(QHostAddress::LocalHost, 0));
+        QCOMPARE(sender->writeDatagram(QByteArray(1, 'x'), QHostAddress::LocalHost, _localPort), static_cast<qint64>(1));
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(receivedCount, senderCount, 5000);
+
+    // The link thread is idle once everything was delivered
+    QVERIFY(link->_knownSenders.size() <= UDPLink::kMaxKnownSenders);
+    {
+        QMutexLocker locker(&link->_sessionTargetsMutex);
+        QCOMPARE(link->_sessionTargets.count(), senderCount);
+    }
+
+    _linkManager->disconnectAll();
+    qDeleteAll(senders);
+}
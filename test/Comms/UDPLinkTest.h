@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class UDPLink;
+
+class UDPLinkTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    UDPLinkTest() = default;
+
+private slots:
+    void _testReceiveBurst();
+    void _testKnownSendersBounded();
+
+private:
+    /// Connects a UDPLink listening on a free local port
+    ///     @return nullptr if the link could not be connected
+    UDPLink* _connectUDPLink();
+
+    quint16 _localPort = 0;
+};
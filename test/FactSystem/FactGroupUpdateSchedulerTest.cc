@@ -0,0 +1,144 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupUpdateSchedulerTest.h"
+#include "FactGroupUpdateScheduler.h"
+#include "FactGroup.h"
+
+#include <QtCore/QThread>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+
+class TestFactGroup : public FactGroup
+{
+public:
+    TestFactGroup(int updateRateMsecs = 1)
+        : FactGroup (updateRateMsecs)
+        , fact1     (0, "fact1", FactMetaData::valueTypeDouble)
+        , fact2     (0, "fact2", FactMetaData::valueTypeDouble)
+    {
+        _addFact(&fact1, "fact1");
+        _addFact(&fact2, "fact2");
+    }
+
+    void addFact(Fact* fact, const QString& name) { _addFact(fact, name); }
+
+    Fact fact1;
+    Fact fact2;
+};
+
+} // namespace
+
+void FactGroupUpdateSchedulerTest::_processFrame()
+{
+    // Sleep rather than wait so the frame timer can't run in between
+    QThread::msleep(2);
+    FactGroupUpdateScheduler::instance()->processFrame();
+}
+
+void FactGroupUpdateSchedulerTest::_testCoalescedUpdates()
+{
+    TestFactGroup factGroup;
+    QSignalSpy spyFact1(&factGroup.fact1, &Fact::valueChanged);
+    QSignalSpy spyFact2(&factGroup.fact2, &Fact::valueChanged);
+
+    // A burst of messages only produces a single signal with the latest value
+    for (int i = 1; i <= 100; i++) {
+        factGroup.fact1.setRawValue(i);
+    }
+    QCOMPARE(spyFact1.count(), 0);
+
+    _processFrame();
+    QCOMPARE(spyFact1.count(), 1);
+    QCOMPARE(spyFact1[0][0].toDouble(), 100.0);
+    QCOMPARE(spyFact2.count(), 0);
+
+    // Nothing changed since the last frame
+    _processFrame();
+    QCOMPARE(spyFact1.count(), 1);
+
+    // rawValueChanged is never deferred
+    QSignalSpy spyRawFact2(&factGroup.fact2, &Fact::rawValueChanged);
+    factGroup.fact2.setRawValue(5);
+    QCOMPARE(spyRawFact2.count(), 1);
+    QCOMPARE(spyFact2.count(), 0);
+    _processFrame();
+    QCOMPARE(spyFact2.count(), 1);
+}
+
+void FactGroupUpdateSchedulerTest::_testLiveUpdates()
+{
+    TestFactGroup factGroup;
+    QSignalSpy spyFact1(&factGroup.fact1, &Fact::valueChanged);
+
+    factGroup.setLiveUpdates(true);
+    factGroup.fact1.setRawValue(1);
+    factGroup.fact1.setRawValue(2);
+    QCOMPARE(spyFact1.count(), 2);
+
+    factGroup.setLiveUpdates(false);
+    factGroup.fact1.setRawValue(3);
+    factGroup.fact1.setRawValue(4);
+    QCOMPARE(spyFact1.count(), 2);
+    _processFrame();
+    QCOMPARE(spyFact1.count(), 3);
+    QCOMPARE(spyFact1[2][0].toDouble(), 4.0);
+}
+
+void FactGroupUpdateSchedulerTest::_testFactDestroyedWhileDeferred()
+{
+    TestFactGroup factGroup;
+    Fact* const fact = new Fact(0, "fact3", FactMetaData::valueTypeDouble);
+    factGroup.addFact(fact, "fact3");
+
+    fact->setRawValue(1);
+    factGroup.fact1.setRawValue(1);
+    delete fact;
+
+    QSignalSpy spyFact1(&factGroup.fact1, &Fact::valueChanged);
+    _processFrame();
+    QCOMPARE(spyFact1.count(), 1);
+}
+
+void FactGroupUpdateSchedulerTest::_testZeroUpdateRate()
+{
+    TestFactGroup factGroup(0);
+    QSignalSpy spyFact1(&factGroup.fact1, &Fact::valueChanged);
+
+    factGroup.fact1.setRawValue(1);
+    factGroup.fact1.setRawValue(2);
+    QCOMPARE(spyFact1.count(), 2);
+
+    // Groups without an update rate always send live
+    factGroup.setLiveUpdates(false);
+    factGroup.fact1.setRawValue(3);
+    QCOMPARE(spyFact1.count(), 3);
+}
+
+void FactGroupUpdateSchedulerTest::_testFrameTimerIdle()
+{
+    FactGroupUpdateScheduler* const scheduler = FactGroupUpdateScheduler::instance();
+
+    TestFactGroup factGroup;
+    QSignalSpy spyFact1(&factGroup.fact1, &Fact::valueChanged);
+
+    // Nothing waiting, so the frame stops the timer
+    _processFrame();
+    QVERIFY(!scheduler->frameTimerActive());
+
+    // The first deferred value starts it
+    factGroup.fact1.setRawValue(1);
+    QVERIFY(scheduler->frameTimerActive());
+    QTRY_COMPARE(spyFact1.count(), 1);
+
+    // And it stops again once everything went out
+    QTRY_VERIFY(!scheduler->frameTimerActive());
+}
@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class FactGroupUpdateSchedulerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactGroupUpdateSchedulerTest() = default;
+
+private slots:
+    void _testCoalescedUpdates();
+    void _testLiveUpdates();
+    void _testFactDestroyedWhileDeferred();
+    void _testZeroUpdateRate();
+    void _testFrameTimerIdle();
+
+private:
+    /// Runs a frame once the 1 msec update rate of the test groups is due
+    static void _processFrame();
+};
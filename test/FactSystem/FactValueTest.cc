@@ -0,0 +1,241 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactValueTest.h"
+#include "FactValue.h"
+#include "Fact.h"
+#include "VehicleFactGroup.h"
+#include "VehicleGPSFactGroup.h"
+#include "VehicleGPS2FactGroup.h"
+#include "VehicleWindFactGroup.h"
+#include "VehicleVibrationFactGroup.h"
+#include "VehicleTemperatureFactGroup.h"
+#include "VehicleClockFactGroup.h"
+#include "VehicleSetpointFactGroup.h"
+#include "VehicleDistanceSensorFactGroup.h"
+#include "VehicleLocalPositionFactGroup.h"
+#include "VehicleLocalPositionSetpointFactGroup.h"
+#include "VehicleEscStatusFactGroup.h"
+#include "VehicleEstimatorStatusFactGroup.h"
+#include "VehicleHygrometerFactGroup.h"
+#include "VehicleGeneratorFactGroup.h"
+#include "VehicleEFIFactGroup.h"
+#include "TerrainFactGroup.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+#include <memory>
+
+namespace {
+
+/// Checks the fast path produces exactly the QVariant convertAndValidateRaw produces
+template<typename T>
+void _verifyNumeric(FactMetaData::ValueType_t type, T value)
+{
+    FactMetaData metaData(type);
+    QVariant expected;
+    QString errorString;
+    QVERIFY(metaData.convertAndValidateRaw(QVariant::fromValue(value), true /* convertOnly */, expected, errorString));
+
+    FactValue factValue;
+    QVERIFY(factValue.setNumeric(type, value));
+    const QVariant actual = factValue.toVariant();
+    QCOMPARE(actual.metaType(), expected.metaType());
+    QCOMPARE(actual, expected);
+    QVERIFY(factValue == expected);
+}
+
+/// @param variantCount Incremented by the facts whose values FactValue keeps in a heap allocated QVariant
+int _countFacts(FactGroup& factGroup, int& variantCount)
+{
+    int count = factGroup.factNames().count();
+    for (const QString& factName : factGroup.factNames()) {
+        const FactMetaData::ValueType_t type = factGroup.getFact(factName)->type();
+        if ((type == FactMetaData::valueTypeString) || (type == FactMetaData::valueTypeCustom)) {
+            variantCount++;
+        }
+    }
+    for (FactGroup* childGroup : factGroup.factGroups()) {
+        count += _countFacts(*childGroup, variantCount);
+    }
+    return count;
+}
+
+} // namespace
+
+void FactValueTest::_testMatchesVariantConversion()
+{
+    _verifyNumeric(FactMetaData::valueTypeInt8, static_cast<int8_t>(-5));
+    _verifyNumeric(FactMetaData::valueTypeInt16, static_cast<int16_t>(-3000));
+    _verifyNumeric(FactMetaData::valueTypeInt32, -70000);
+    _verifyNumeric(FactMetaData::valueTypeInt64, static_cast<qint64>(-5000000000LL));
+    _verifyNumeric(FactMetaData::valueTypeUint8, static_cast<uint8_t>(200));
+    _verifyNumeric(FactMetaData::valueTypeUint16, static_cast<uint16_t>(60000));
+    _verifyNumeric(FactMetaData::valueTypeUint32, 4000000000U);
+    _verifyNumeric(FactMetaData::valueTypeUint64, static_cast<quint64>(10000000000ULL));
+    _verifyNumeric(FactMetaData::valueTypeFloat, 1.25f);
+    _verifyNumeric(FactMetaData::valueTypeFloat, 3);
+    _verifyNumeric(FactMetaData::valueTypeDouble, 1.0 / 3.0);
+    _verifyNumeric(FactMetaData::valueTypeDouble, 7);
+    _verifyNumeric(FactMetaData::valueTypeElapsedTimeInSeconds, 12.5);
+    _verifyNumeric(FactMetaData::valueTypeBool, 1);
+    _verifyNumeric(FactMetaData::valueTypeBool, false);
+
+    // Conversions which QVariant rounds or range checks are not taken by the fast path
+    FactValue factValue;
+    QVERIFY(!factValue.setNumeric(FactMetaData::valueTypeInt32, 1.6));
+    QVERIFY(!factValue.setNumeric(FactMetaData::valueTypeUint32, -1));
+    QVERIFY(!factValue.setNumeric(FactMetaData::valueTypeInt32, static_cast<qint64>(1) << 40));
+    QVERIFY(!factValue.setNumeric(FactMetaData::valueTypeString, 1));
+}
+
+void FactValueTest::_testVariantFallback()
+{
+    const QVariant string(QStringLiteral("FactValueTest"));
+    FactValue factValue(string);
+    QCOMPARE(factValue.toVariant(), string);
+    QVERIFY(factValue == string);
+
+    FactValue copy(factValue);
+    QVERIFY(copy == factValue);
+    factValue = QVariant(5.0);
+    QCOMPARE(copy.toVariant(), string);
+    QCOMPARE(factValue.toVariant(), QVariant(5.0));
+
+    // Mixed numeric types compare like QVariant does
+    QCOMPARE(FactValue(QVariant(5)) == QVariant(5.0), QVariant(5) == QVariant(5.0));
+}
+
+void FactValueTest::_testTypedSetRawValue()
+{
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    QSignalSpy spyRawValueChanged(&fact, &Fact::rawValueChanged);
+    QSignalSpy spyValueChanged(&fact, &Fact::valueChanged);
+
+    fact.setRawValue(1.5);
+    QCOMPARE(fact.rawValue(), QVariant(1.5));
+    QCOMPARE(spyRawValueChanged.count(), 1);
+    QCOMPARE(spyValueChanged.count(), 1);
+
+    // Same value, no signals
+    fact.setRawValue(1.5);
+    QCOMPARE(spyRawValueChanged.count(), 1);
+
+    // Integer input is stored as the fact type
+    fact.setRawValue(2);
+    QCOMPARE(fact.rawValue().metaType(), QMetaType(QMetaType::Double));
+    QCOMPARE(spyRawValueChanged.count(), 2);
+
+    // Non numeric facts still go through QVariant
+    Fact stringFact(0, "stringFact", FactMetaData::valueTypeString);
+    stringFact.setRawValue(5);
+    QCOMPARE(stringFact.rawValue(), QVariant(QStringLiteral("5")));
+}
+
+void FactValueTest::_testSetRawValueBenchmark_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("setRawValue(QVariant)") << static_cast<int>(SetRawValueVariant);
+    QTest::newRow("setRawValue(double)") << static_cast<int>(SetRawValueTyped);
+    QTest::newRow("cookedValue()") << static_cast<int>(CookedValue);
+}
+
+void FactValueTest::_testSetRawValueBenchmark()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    constexpr int iterations = 1000000;
+
+    Fact fact(0, "fact", FactMetaData::valueTypeDouble);
+    fact.setSendValueChangedSignals(false);
+    fact.setRawValue(static_cast<double>(iterations - 1));
+
+    QElapsedTimer timer;
+    double sum = 0;
+    timer.start();
+    switch (path) {
+    case SetRawValueVariant:
+        for (int i = 0; i < iterations; i++) {
+            fact.setRawValue(QVariant(static_cast<double>(i)));
+        }
+        break;
+    case SetRawValueTyped:
+        for (int i = 0; i < iterations; i++) {
+            fact.setRawValue(static_cast<double>(i));
+        }
+        break;
+    case CookedValue:
+        for (int i = 0; i < iterations; i++) {
+            sum += fact.cookedValue().toDouble();
+        }
+        break;
+    }
+    const qint64 elapsedNsecs = timer.nsecsElapsed();
+
+    if (path == CookedValue) {
+        QCOMPARE(sum, static_cast<double>(iterations - 1) * iterations);
+    } else {
+        QCOMPARE(fact.rawValue().toDouble(), static_cast<double>(iterations - 1));
+    }
+
+    QTest::setBenchmarkResult(static_cast<qreal>(elapsedNsecs) / iterations, QTest::WalltimeNanoseconds);
+}
+
+void FactValueTest::_testVehicleMemoryFootprint_data()
+{
+    QTest::addColumn<bool>("factValue");
+
+    QTest::newRow("QVariant") << false;
+    QTest::newRow("FactValue") << true;
+}
+
+/// Value storage of the telemetry facts of a single vehicle, with every value held in a QVariant and with FactValue
+void FactValueTest::_testVehicleMemoryFootprint()
+{
+    QFETCH(bool, factValue);
+
+    // The telemetry fact groups every Vehicle instantiates
+    std::vector<std::unique_ptr<FactGroup>> factGroups;
+    factGroups.emplace_back(new VehicleFactGroup());
+    factGroups.emplace_back(new VehicleGPSFactGroup());
+    factGroups.emplace_back(new VehicleGPS2FactGroup());
+    factGroups.emplace_back(new VehicleWindFactGroup());
+    factGroups.emplace_back(new VehicleVibrationFactGroup());
+    factGroups.emplace_back(new VehicleTemperatureFactGroup());
+    factGroups.emplace_back(new VehicleClockFactGroup());
+    factGroups.emplace_back(new VehicleSetpointFactGroup());
+    factGroups.emplace_back(new VehicleDistanceSensorFactGroup());
+    factGroups.emplace_back(new VehicleLocalPositionFactGroup());
+    factGroups.emplace_back(new VehicleLocalPositionSetpointFactGroup());
+    factGroups.emplace_back(new VehicleEscStatusFactGroup());
+    factGroups.emplace_back(new VehicleEstimatorStatusFactGroup());
+    factGroups.emplace_back(new VehicleHygrometerFactGroup());
+    factGroups.emplace_back(new VehicleGeneratorFactGroup());
+    factGroups.emplace_back(new VehicleEFIFactGroup());
+    factGroups.emplace_back(new TerrainFactGroup());
+
+    int factCount = 0;
+    int variantCount = 0;
+    for (const std::unique_ptr<FactGroup>& factGroup : factGroups) {
+        factCount += _countFacts(*factGroup, variantCount);
+    }
+    QVERIFY(factCount > 0);
+
+    const size_t variantBytes = static_cast<size_t>(factCount) * sizeof(QVariant);
+    // Strings and custom values still carry a heap allocated QVariant next to the FactValue
+    const size_t factValueBytes = (static_cast<size_t>(factCount) * sizeof(FactValue)) + (static_cast<size_t>(variantCount) * sizeof(QVariant));
+    QVERIFY(factValueBytes < variantBytes);
+
+    QTest::setBenchmarkResult(static_cast<qreal>(factValue ? factValueBytes : variantBytes), QTest::BytesAllocated);
+}
@@ -0,0 +1,36 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class FactValueTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactValueTest() = default;
+
+private slots:
+    void _testMatchesVariantConversion();
+    void _testVariantFallback();
+    void _testTypedSetRawValue();
+    void _testSetRawValueBenchmark_data();
+    void _testSetRawValueBenchmark();
+    void _testVehicleMemoryFootprint_data();
+    void _testVehicleMemoryFootprint();
+
+private:
+    enum BenchmarkPath {
+        SetRawValueVariant,
+        SetRawValueTyped,
+        CookedValue,
+    };
+};
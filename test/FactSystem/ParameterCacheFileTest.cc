@@ -0,0 +1,295 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterCacheFileTest.h"
+#include "Fact.h"
+#include "ParameterCacheFile.h"
+#include "ParameterComponentStore.h"
+#include "QGC.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <cstring>
+#include <memory>
+
+namespace {
+
+QList<ParameterCacheFile::Entry> _allTypeEntries()
+{
+    return {
+        { QStringLiteral("A_DOUBLE"),   FactMetaData::valueTypeDouble,  QVariant(-12345.678901) },
+        { QStringLiteral("A_FLOAT"),    FactMetaData::valueTypeFloat,   QVariant(3.25f) },
+        { QStringLiteral("A_INT16"),    FactMetaData::valueTypeInt16,   QVariant(static_cast<int>(-1234)) },
+        { QStringLiteral("A_INT32"),    FactMetaData::valueTypeInt32,   QVariant(static_cast<int>(-123456789)) },
+        { QStringLiteral("A_INT64"),    FactMetaData::valueTypeInt64,   QVariant(static_cast<qlonglong>(-1234567890123LL)) },
+        { QStringLiteral("A_INT8"),     FactMetaData::valueTypeInt8,    QVariant(static_cast<int>(-12)) },
+        { QStringLiteral("A_UINT16"),   FactMetaData::valueTypeUint16,  QVariant(static_cast<uint>(65000)) },
+        { QStringLiteral("A_UINT32"),   FactMetaData::valueTypeUint32,  QVariant(static_cast<uint>(4000000000u)) },
+        { QStringLiteral("A_UINT64"),   FactMetaData::valueTypeUint64,  QVariant(static_cast<qulonglong>(12345678901234ULL)) },
+        { QStringLiteral("A_UINT8"),    FactMetaData::valueTypeUint8,   QVariant(static_cast<uint>(250)) },
+    };
+}
+
+/// Parameter set the size of a typical PX4 vehicle, sorted by name
+QList<ParameterCacheFile::Entry> _vehicleSizedEntries(int count)
+{
+    QList<ParameterCacheFile::Entry> entries;
+
+    for (int i = 0; i < count; i++) {
+        if (i % 2) {
+            entries.append({ QStringLiteral("PARAM_%1").arg(i, 5, 10, QLatin1Char('0')), FactMetaData::valueTypeFloat, QVariant(static_cast<float>(i) / 3) });
+        } else {
+            entries.append({ QStringLiteral("PARAM_%1").arg(i, 5, 10, QLatin1Char('0')), FactMetaData::valueTypeInt32, QVariant(i) });
+        }
+    }
+
+    return entries;
+}
+
+quint32 _hashCrc(const QList<ParameterCacheFile::Entry>& entries)
+{
+    quint32 crc = 0;
+    for (const ParameterCacheFile::Entry& entry: entries) {
+        crc = QGC::crc32(reinterpret_cast<const quint8*>(qPrintable(entry.name)), entry.name.length(), crc);
+        crc = QGC::crc32(reinterpret_cast<const quint8*>(entry.rawValue.constData()), FactMetaData::typeToSize(entry.type), crc);
+    }
+    return crc;
+}
+
+}
+
+void ParameterCacheFileTest::_testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("1_1.v3"));
+
+    const QList<ParameterCacheFile::Entry> entries = _allTypeEntries();
+    QVERIFY(ParameterCacheFile::write(fileName, entries, 0x12345678));
+
+    ParameterCacheFile cacheFile;
+    QVERIFY(cacheFile.open(fileName));
+    QVERIFY(cacheFile.isOpen());
+    QCOMPARE(cacheFile.count(), entries.count());
+    QCOMPARE(cacheFile.hashCrc(), 0x12345678u);
+
+    for (int i = 0; i < entries.count(); i++) {
+        const ParameterCacheFile::Entry& entry = entries[i];
+        QCOMPARE(cacheFile.name(i), entry.name);
+        QCOMPARE(cacheFile.type(i), entry.type);
+        QCOMPARE(cacheFile.rawValue(i), entry.rawValue);
+        QCOMPARE(cacheFile.rawValue(i).metaType(), entry.rawValue.metaType());
+        // The stored bytes hash the same as the value the vehicle sent
+        QCOMPARE(memcmp(cacheFile.valueData(i), entry.rawValue.constData(), FactMetaData::typeToSize(entry.type)), 0);
+    }
+
+    cacheFile.close();
+    QVERIFY(!cacheFile.isOpen());
+    QCOMPARE(cacheFile.count(), 0);
+}
+
+void ParameterCacheFileTest::_testIndexOf()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("1_1.v3"));
+
+    const QList<ParameterCacheFile::Entry> entries = _vehicleSizedEntries(1001);
+    QVERIFY(ParameterCacheFile::write(fileName, entries, 0));
+
+    ParameterCacheFile cacheFile;
+    QVERIFY(cacheFile.open(fileName));
+    for (int i = 0; i < entries.count(); i++) {
+        QCOMPARE(cacheFile.indexOf(entries[i].name), i);
+    }
+    QCOMPARE(cacheFile.indexOf(QStringLiteral("A")), -1);
+    QCOMPARE(cacheFile.indexOf(QStringLiteral("PARAM_00000_")), -1);
+    QCOMPARE(cacheFile.indexOf(QStringLiteral("ZZZ")), -1);
+    QCOMPARE(cacheFile.indexOf(QString()), -1);
+}
+
+void ParameterCacheFileTest::_testRejectsDamagedFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("1_1.v3"));
+
+    QVERIFY(ParameterCacheFile::write(fileName, _allTypeEntries(), 0));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray good = file.readAll();
+    file.close();
+
+    auto writeBytes = [&fileName](const QByteArray& bytes) {
+        QFile damagedFile(fileName);
+        QVERIFY(damagedFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(damagedFile.write(bytes), bytes.size());
+    };
+
+    ParameterCacheFile cacheFile;
+
+    // Missing file
+    QVERIFY(!cacheFile.open(dir.filePath(QStringLiteral("missing.v3"))));
+
+    // Flipped value byte
+    QByteArray bytes = good;
+    bytes[44] = static_cast<char>(bytes[44] ^ 0x01);
+    writeBytes(bytes);
+    QVERIFY(!cacheFile.open(fileName));
+
+    // Truncated
+    writeBytes(good.left(good.size() - 1));
+    QVERIFY(!cacheFile.open(fileName));
+    writeBytes(good.left(10));
+    QVERIFY(!cacheFile.open(fileName));
+
+    // Other version
+    bytes = good;
+    bytes[4] = static_cast<char>(bytes[4] + 1);
+    writeBytes(bytes);
+    QVERIFY(!cacheFile.open(fileName));
+
+    // Previous QDataStream cache format
+    QByteArray previousFormat;
+    QDataStream ds(&previousFormat, QIODevice::WriteOnly);
+    ds << QMap<QString, QPair<int, QVariant>>{ { QStringLiteral("A"), qMakePair(static_cast<int>(FactMetaData::valueTypeInt32), QVariant(1)) } };
+    writeBytes(previousFormat);
+    QVERIFY(!cacheFile.open(fileName));
+
+    writeBytes(good);
+    QVERIFY(cacheFile.open(fileName));
+    QVERIFY(!cacheFile.open(dir.filePath(QStringLiteral("missing.v3"))));
+    QVERIFY(!cacheFile.isOpen());
+}
+
+void ParameterCacheFileTest::_testLazyStore()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("1_1.v3"));
+
+    const QList<ParameterCacheFile::Entry> entries = _allTypeEntries();
+    QVERIFY(ParameterCacheFile::write(fileName, entries, 0));
+
+    auto cacheFile = std::make_shared<ParameterCacheFile>();
+    QVERIFY(cacheFile->open(fileName));
+
+    Fact receivedFact;
+    Fact createdFact;
+
+    ParameterComponentStore store;
+    const int receivedNameId = store.internName(QStringLiteral("RECEIVED"));
+    store.setFact(receivedNameId, &receivedFact);
+    const int requestedNameId = store.internName(QStringLiteral("REQUESTED"));
+
+    store.cacheFile = cacheFile;
+    for (int cacheIndex = 0; cacheIndex < cacheFile->count(); cacheIndex++) {
+        store.setCacheIndex(store.internName(cacheFile->name(cacheIndex)), cacheIndex);
+    }
+
+    QCOMPARE(store.factCount(), entries.count() + 1);
+    QVERIFY(store.hasParameter(QStringLiteral("A_FLOAT")));
+    QVERIFY(store.hasParameter(receivedNameId));
+    QVERIFY(!store.hasParameter(requestedNameId));
+    QVERIFY(!store.fact(QStringLiteral("A_FLOAT")));
+    QCOMPARE(store.factNames().first(), QStringLiteral("A_DOUBLE"));
+    QCOMPARE(store.factNames().last(), QStringLiteral("RECEIVED"));
+
+    // Creating the Fact replaces the cache entry without changing the count
+    const int floatNameId = store.nameId(QStringLiteral("A_FLOAT"));
+    QCOMPARE(store.cacheIndex(floatNameId), cacheFile->indexOf(QStringLiteral("A_FLOAT")));
+    store.setFact(floatNameId, &createdFact);
+    QCOMPARE(store.cacheIndex(floatNameId), -1);
+    QCOMPARE(store.factCount(), entries.count() + 1);
+
+    store.setFact(floatNameId, nullptr);
+    QVERIFY(!store.hasParameter(floatNameId));
+    QCOMPARE(store.factCount(), entries.count());
+}
+
+void ParameterCacheFileTest::_benchmarkStartup_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("QDataStream") << static_cast<int>(DataStreamStartup);
+    QTest::newRow("mapped") << static_cast<int>(MappedStartup);
+}
+
+/// Startup cost of the previous QDataStream cache (deserialize everything, then hash it) and of opening the mapped
+/// cache and checking its stored hash, one row each
+void ParameterCacheFileTest::_benchmarkStartup()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    typedef QPair<int, QVariant> ParamTypeVal;
+
+    static constexpr int paramCount = 1500;
+    static constexpr int iterations = 50;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QList<ParameterCacheFile::Entry> entries = _vehicleSizedEntries(paramCount);
+    const quint32 hashCrc = _hashCrc(entries);
+
+    const QString dataStreamFileName = dir.filePath(QStringLiteral("1_1.v2"));
+    {
+        QMap<QString, ParamTypeVal> cacheMap;
+        for (const ParameterCacheFile::Entry& entry: entries) {
+            cacheMap[entry.name] = ParamTypeVal(entry.type, entry.rawValue);
+        }
+        QFile file(dataStreamFileName);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QDataStream ds(&file);
+        ds << cacheMap;
+    }
+
+    const QString mappedFileName = dir.filePath(QStringLiteral("1_1.v3"));
+    QVERIFY(ParameterCacheFile::write(mappedFileName, entries, hashCrc));
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++) {
+        if (path == DataStreamStartup) {
+            QMap<QString, ParamTypeVal> cacheMap;
+            QFile file(dataStreamFileName);
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            QDataStream ds(&file);
+            ds >> cacheMap;
+
+            quint32 crc = 0;
+            for (auto it = cacheMap.constBegin(); it != cacheMap.constEnd(); it++) {
+                crc = QGC::crc32(reinterpret_cast<const quint8*>(qPrintable(it.key())), it.key().length(), crc);
+                crc = QGC::crc32(reinterpret_cast<const quint8*>(it->second.constData()), FactMetaData::typeToSize(static_cast<FactMetaData::ValueType_t>(it->first)), crc);
+            }
+            QCOMPARE(crc, hashCrc);
+            QCOMPARE(cacheMap.count(), paramCount);
+        } else {
+            auto cacheFile = std::make_shared<ParameterCacheFile>();
+            QVERIFY(cacheFile->open(mappedFileName));
+            QCOMPARE(cacheFile->hashCrc(), hashCrc);
+
+            ParameterComponentStore store;
+            store.cacheFile = cacheFile;
+            for (int cacheIndex = 0; cacheIndex < cacheFile->count(); cacheIndex++) {
+                store.setCacheIndex(store.internName(cacheFile->name(cacheIndex)), cacheIndex);
+            }
+            QCOMPARE(store.factCount(), paramCount);
+        }
+    }
+
+    QTest::setBenchmarkResult(static_cast<qreal>(timer.nsecsElapsed()) / iterations, QTest::WalltimeNanoseconds);
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class ParameterCacheFileTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterCacheFileTest() = default;
+
+private slots:
+    void _testRoundTrip();
+    void _testIndexOf();
+    void _testRejectsDamagedFile();
+    void _testLazyStore();
+    void _benchmarkStartup_data();
+    void _benchmarkStartup();
+
+private:
+    enum StartupPath {
+        DataStreamStartup,
+        MappedStartup,
+    };
+};
@@ -13,10 +13,17 @@
 #include "Vehicle.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "ParameterComponentStore.h"
+#include "ParameterRequestWindow.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMap>
+#include <QtCore/QRandomGenerator>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 
+#include <vector>
+
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
 {
@@ -184,6 +191,256 @@ void ParameterManagerTest::_FTPnoFailure()
     QCOMPARE(arguments.at(0).toFloat(), 0.0f);
 }
 
+void ParameterManagerTest::_componentStore(void)
+{
+    ParameterComponentStore store;
+    QList<Fact*> facts;
+
+    // Enough names to force several rehashes of the index
+    for (int i = 0; i < 1000; i++) {
+        const QString name = QStringLiteral("PARAM_%1").arg(i);
+        const int nameId = store.internName(name);
+        QCOMPARE(nameId, i);
+        QCOMPARE(store.internName(name), nameId);
+        if (i % 2) {
+            Fact* fact = new Fact(MAV_COMP_ID_AUTOPILOT1, name, FactMetaData::valueTypeInt32, this);
+            store.setFact(nameId, fact);
+            facts.append(fact);
+        }
+    }
+    QCOMPARE(store.nameCount(), 1000);
+    QCOMPARE(store.factCount(), 500);
+
+    for (int i = 0; i < 1000; i++) {
+        const QString name = QStringLiteral("PARAM_%1").arg(i);
+        QCOMPARE(store.nameId(name), i);
+        QCOMPARE(store.name(i), name);
+        QCOMPARE(store.fact(name), (i % 2) ? facts[i / 2] : nullptr);
+    }
+    QCOMPARE(store.nameId(QStringLiteral("PARAM_1000")), static_cast<int>(ParameterComponentStore::invalidNameId));
+    QVERIFY(!store.fact(QStringLiteral("MISSING")));
+
+    // Only names with a Fact are reported, in the same order as a QMap keyed by name
+    const QStringList names = store.factNames();
+    QCOMPARE(names.count(), 500);
+    QStringList sortedNames = names;
+    sortedNames.sort();
+    QCOMPARE(names, sortedNames);
+    QCOMPARE(names.first(), QStringLiteral("PARAM_1"));
+    const QList<int> sortedIds = store.sortedFactIds();
+    QCOMPARE(sortedIds.count(), names.count());
+    for (int i = 0; i < sortedIds.count(); i++) {
+        QCOMPARE(store.name(sortedIds[i]), names[i]);
+    }
+
+    ParameterWaitSet waitSet;
+    QCOMPARE(waitSet.count(), 0);
+    QVERIFY(!waitSet.contains(0));
+    waitSet.insert(5);
+    waitSet.insert(200);
+    waitSet.insert(5);
+    QCOMPARE(waitSet.count(), 2);
+    QCOMPARE(waitSet.keys(), QList<int>({ 5, 200 }));
+    QCOMPARE(waitSet.bumpRetryCount(5), 1);
+    QCOMPARE(waitSet.bumpRetryCount(5), 2);
+    waitSet.insert(5);
+    QCOMPARE(waitSet.retryCount(5), 0);
+    waitSet.remove(5);
+    waitSet.remove(6);
+    QCOMPARE(waitSet.count(), 1);
+    QCOMPARE(waitSet.keys(), QList<int>({ 200 }));
+    waitSet.clear();
+    QCOMPARE(waitSet.count(), 0);
+    QVERIFY(!waitSet.contains(200));
+
+    // Index re-requests only walk the waiting indices which have nothing in flight
+    store.paramCount = 5;
+    store.waitForAllIndices();
+    QCOMPARE(store.readIndexWaits.count(), 5);
+    QCOMPARE(std::vector<int>(store.pendingIndexRequests.begin(), store.pendingIndexRequests.end()), std::vector<int>({ 0, 1, 2, 3, 4 }));
+    store.pendingIndexRequests.erase(1);
+    store.pendingIndexRequests.erase(3);
+    store.readIndexWaits.remove(3);
+    store.requeueIndices({ 1, 3 });
+    QCOMPARE(std::vector<int>(store.pendingIndexRequests.begin(), store.pendingIndexRequests.end()), std::vector<int>({ 0, 1, 2, 4 }));
+    store.clearIndexWaits();
+    QCOMPARE(store.readIndexWaits.count(), 0);
+    QVERIFY(store.pendingIndexRequests.empty());
+}
+
+void ParameterManagerTest::_benchmarkLoadAndLookup_data(void)
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("load") << static_cast<int>(LoadPath);
+    // The QMap<QString, Fact*> per component the hash indexed store replaced
+    QTest::newRow("lookup QMap") << static_cast<int>(LookupQMapPath);
+    QTest::newRow("lookup hash index") << static_cast<int>(LookupHashIndexPath);
+}
+
+void ParameterManagerTest::_benchmarkLoadAndLookup(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyVehicle(vehicleMgr, SIGNAL(activeVehicleAvailableChanged(bool)));
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4MockLink(false);
+
+    QCOMPARE(spyVehicle.wait(5000), true);
+    QCOMPARE(spyParamsReady.wait(60000), true);
+    const qint64 loadMSecs = timer.elapsed();
+
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    ParameterManager* parameterManager = vehicle->parameterManager();
+    const QStringList names = parameterManager->parameterNames(ParameterManager::defaultComponentId);
+    QVERIFY(!names.isEmpty());
+
+    if (path == LoadPath) {
+        QTest::setBenchmarkResult(static_cast<qreal>(loadMSecs), QTest::WalltimeMilliseconds);
+        return;
+    }
+
+    QMap<QString, Fact*> factMap;
+    for (const QString& name: names) {
+        factMap[name] = parameterManager->getParameter(ParameterManager::defaultComponentId, name);
+    }
+
+    const int lookupCount = 100000;
+    QList<int> nameIndices;
+    nameIndices.reserve(lookupCount);
+    for (int i = 0; i < lookupCount; i++) {
+        nameIndices.append(static_cast<int>(QRandomGenerator::global()->bounded(names.count())));
+    }
+
+    int found = 0;
+    timer.restart();
+    if (path == LookupQMapPath) {
+        for (int nameIndex: nameIndices) {
+            if (factMap.value(names[nameIndex])->name() == names[nameIndex]) {
+                found++;
+            }
+        }
+    } else {
+        for (int nameIndex: nameIndices) {
+            if (parameterManager->getParameter(ParameterManager::defaultComponentId, names[nameIndex])->name() == names[nameIndex]) {
+                found++;
+            }
+        }
+    }
+    const qint64 lookupNSecs = timer.nsecsElapsed();
+
+    QCOMPARE(found, lookupCount);
+    QTest::setBenchmarkResult(static_cast<qreal>(lookupNSecs) / lookupCount, QTest::WalltimeNanoseconds);
+}
+
+void ParameterManagerTest::_requestWindow(void)
+{
+    ParameterRequestWindow window;
+    QCOMPARE(window.size(), static_cast<int>(ParameterRequestWindow::initialWindow));
+    QCOMPARE(window.timeoutMSecs(), static_cast<int>(ParameterRequestWindow::initialTimeoutMSecs));
+
+    // Slow start: each response opens the window by one
+    qint64 now = 0;
+    for (int key = 0; key < window.size(); key++) {
+        window.requestSent(key, now, false /* retransmit */);
+    }
+    QVERIFY(!window.canSend());
+    now += 100;
+    QVERIFY(window.responseReceived(0, now));
+    QVERIFY(!window.responseReceived(0, now));
+    QCOMPARE(window.size(), ParameterRequestWindow::initialWindow + 1);
+    QCOMPARE(window.smoothedRttMSecs(), 100);
+    QCOMPARE(window.timeoutMSecs(), 300);    // srtt + 4 * rttvar
+    QVERIFY(window.canSend());
+
+    // Retransmits are not used for the round trip time
+    window.requestSent(100, now, true /* retransmit */);
+    now += 5000;
+    QVERIFY(window.responseReceived(100, now));
+    QCOMPARE(window.smoothedRttMSecs(), 100);
+
+    // Requests outstanding past the timeout are lost and halve the window
+    const int sizeBeforeLoss = window.size();
+    const QList<int> expired = window.takeExpired(now);
+    QCOMPARE(expired.count(), ParameterRequestWindow::initialWindow - 1);
+    QCOMPARE(window.inFlightCount(), 0);
+    QCOMPARE(window.size(), sizeBeforeLoss / 2);
+
+    // Congestion avoidance: roughly one more per window of responses
+    const int sizeAfterLoss = window.size();
+    for (int key = 0; key < 2 * sizeAfterLoss; key++) {
+        window.requestSent(key, now, false /* retransmit */);
+    }
+    now += 100;
+    for (int key = 0; key < 2 * sizeAfterLoss; key++) {
+        QVERIFY(window.responseReceived(key, now));
+    }
+    QCOMPARE(window.size(), sizeAfterLoss + 1);
+
+    // A timeout with nothing answered collapses the window and backs off the timeout
+    const int timeoutBefore = window.timeoutMSecs();
+    window.requestSent(1000, now, false /* retransmit */);
+    window.timeout();
+    QCOMPARE(window.size(), static_cast<int>(ParameterRequestWindow::minWindow));
+    QCOMPARE(window.timeoutMSecs(), qMin(timeoutBefore * 2, static_cast<int>(ParameterRequestWindow::maxTimeoutMSecs)));
+    QCOMPARE(window.inFlightCount(), 0);
+
+    // The window never grows past the maximum
+    for (int key = 0; key < 5000; key++) {
+        window.requestSent(key, now, false /* retransmit */);
+        window.responseReceived(key, now + 10);
+    }
+    QCOMPARE(window.size(), static_cast<int>(ParameterRequestWindow::maxWindow));
+}
+
+void ParameterManagerTest::_lossyLinkLoad_data(void)
+{
+    QTest::addColumn<int>("paramLossPercent");
+
+    QTest::newRow("no loss") << 0;
+    QTest::newRow("10% loss") << 10;
+}
+
+/// Loads parameters over a MockLink which loses and delays parameter values, the missing parameters must all be
+/// recovered through the windowed re-requests. Reports the time to complete the load.
+void ParameterManagerTest::_lossyLinkLoad(void)
+{
+    QFETCH(int, paramLossPercent);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyVehicle(vehicleMgr, SIGNAL(activeVehicleAvailableChanged(bool)));
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4LossyParamMockLink(paramLossPercent, 50 /* paramLatencyMSecs */);
+
+    QCOMPARE(spyVehicle.wait(5000), true);
+    QCOMPARE(spyParamsReady.wait(60000), true);
+    const qint64 loadMSecs = timer.elapsed();
+
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    QCOMPARE(vehicle->parameterManager()->missingParameters(), false);
+
+    QTest::setBenchmarkResult(static_cast<qreal>(loadMSecs), QTest::WalltimeMilliseconds);
+}
+
 #if 0
 void ParameterManagerTest::_FTPChangeParam()
 {
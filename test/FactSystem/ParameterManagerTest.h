@@ -24,11 +24,23 @@ private slots:
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
     void _FTPnoFailure(void);
+    void _componentStore(void);
+    void _benchmarkLoadAndLookup_data(void);
+    void _benchmarkLoadAndLookup(void);
+    void _requestWindow(void);
+    void _lossyLinkLoad_data(void);
+    void _lossyLinkLoad(void);
     // void _FTPChangeParam(void);
 
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
+
+    enum BenchmarkPath {
+        LoadPath,
+        LookupQMapPath,
+        LookupHashIndexPath,
+    };
 };
 
 #endif
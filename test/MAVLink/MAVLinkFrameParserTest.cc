@@ -0,0 +1,254 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFrameParserTest.h"
+#include "MAVLinkFrameParser.h"
+#include "QGCMAVLink.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QtEndian>
+#include <QtTest/QTest>
+
+void MAVLinkFrameParserTest::init(void)
+{
+    UnitTest::init();
+
+    // Start each test with unsigned channels and fresh counters
+    (void) memset(mavlink_get_channel_status(_encodeChannel), 0, sizeof(mavlink_status_t));
+    (void) memset(mavlink_get_channel_status(_decodeChannel), 0, sizeof(mavlink_status_t));
+    (void) memset(QGCMAVLink::getChannelReceiveStatus(_decodeChannel), 0, sizeof(mavlink_status_t));
+    (void) memset(mavlink_get_channel_status(_byteChannel), 0, sizeof(mavlink_status_t));
+}
+
+QByteArray MAVLinkFrameParserTest::_buildTlog(int messageCount, QList<mavlink_message_t> *messages)
+{
+    QByteArray tlog;
+    quint64 timestamp = 1000000;
+
+    for (int i = 0; i < messageCount; i++) {
+        mavlink_message_t message;
+        switch (i % 3) {
+        case 0:
+            (void) mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _encodeChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            (void) mavlink_msg_attitude_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _encodeChannel, &message, i, 0.1f * i, 0.2f, -0.3f, 0.f, 0.f, 0.f);
+            break;
+        default:
+            (void) mavlink_msg_statustext_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _encodeChannel, &message, MAV_SEVERITY_INFO, "MAVLinkFrameParserTest", 0, 0);
+            break;
+        }
+
+        uint8_t buffer[sizeof(quint64) + MAVLINK_MAX_PACKET_LEN];
+        qToBigEndian(timestamp, buffer);
+        for (size_t j = 0; j < sizeof(quint64); j++) {
+            // Keep timestamps free of start bytes so both parsers see the same frames
+            if (buffer[j] >= MAVLINK_STX) {
+                buffer[j] = 0;
+            }
+        }
+        const int len = mavlink_msg_to_send_buffer(buffer + sizeof(quint64), &message);
+        tlog.append(reinterpret_cast<const char*>(buffer), sizeof(quint64) + len);
+        timestamp += 20000;
+
+        if (messages) {
+            messages->append(message);
+        }
+    }
+
+    return tlog;
+}
+
+void MAVLinkFrameParserTest::_testParseCompleteFrames()
+{
+    QList<mavlink_message_t> expected;
+    const QByteArray tlog = _buildTlog(30, &expected);
+
+    qsizetype position = 0;
+    mavlink_message_t message;
+    int count = 0;
+    while (MAVLinkFrameParser::parseNext(_decodeChannel, tlog, position, message)) {
+        QVERIFY(count < expected.count());
+        QCOMPARE(static_cast<uint32_t>(message.msgid), static_cast<uint32_t>(expected[count].msgid));
+        QCOMPARE(message.seq, expected[count].seq);
+        QCOMPARE(message.len, expected[count].len);
+        QCOMPARE(message.checksum, expected[count].checksum);
+        QVERIFY(memcmp(_MAV_PAYLOAD(&message), _MAV_PAYLOAD(&expected[count]), message.len) == 0);
+        count++;
+    }
+
+    QCOMPARE(count, expected.count());
+    QCOMPARE(position, tlog.size());
+    QCOMPARE(QGCMAVLink::getChannelReceiveStatus(_decodeChannel)->packet_rx_success_count, static_cast<uint16_t>(expected.count()));
+}
+
+void MAVLinkFrameParserTest::_testParseSplitFrames()
+{
+    const QByteArray tlog = _buildTlog(6);
+
+    // Every split point must yield the same messages as the unsplit stream
+    for (qsizetype split = 1; split < tlog.size(); split++) {
+        mavlink_reset_channel_status(_decodeChannel);
+
+        int count = 0;
+        mavlink_message_t message;
+        for (const QByteArrayView chunk : { QByteArrayView(tlog).first(split), QByteArrayView(tlog).sliced(split) }) {
+            qsizetype position = 0;
+            while (MAVLinkFrameParser::parseNext(_decodeChannel, chunk, position, message)) {
+                count++;
+            }
+        }
+
+        QCOMPARE(count, 6);
+    }
+}
+
+void MAVLinkFrameParserTest::_testParseBadCrc()
+{
+    QList<mavlink_message_t> expected;
+    QByteArray tlog = _buildTlog(3, &expected);
+
+    // Corrupt the payload of the first frame
+    const qsizetype firstPayload = sizeof(quint64) + MAVLINK_NUM_HEADER_BYTES;
+    tlog[firstPayload] = static_cast<char>(tlog[firstPayload] ^ 0xFF);
+
+    qsizetype position = 0;
+    mavlink_message_t message;
+    QList<uint32_t> msgIds;
+    while (MAVLinkFrameParser::parseNext(_decodeChannel, tlog, position, message)) {
+        msgIds.append(message.msgid);
+    }
+
+    QCOMPARE(msgIds, QList<uint32_t>({ static_cast<uint32_t>(expected[1].msgid), static_cast<uint32_t>(expected[2].msgid) }));
+}
+
+void MAVLinkFrameParserTest::_testChannelStatus()
+{
+    QList<mavlink_message_t> messages;
+    QByteArray tlog = _buildTlog(30, &messages);
+
+    // Corrupt the payload of a heartbeat in the middle
+    static constexpr int corruptIndex = 9;
+    qsizetype frameOffset = 0;
+    for (int i = 0; i < corruptIndex; i++) {
+        frameOffset += sizeof(quint64) + MAVLINK_NUM_NON_PAYLOAD_BYTES + messages[i].len;
+    }
+    const qsizetype corruptPayload = frameOffset + sizeof(quint64) + MAVLINK_NUM_HEADER_BYTES;
+    tlog[corruptPayload] = static_cast<char>(tlog[corruptPayload] ^ 0xFF);
+
+    mavlink_message_t message;
+    mavlink_status_t status;
+    for (const char byte : tlog) {
+        (void) mavlink_parse_char(_byteChannel, static_cast<uint8_t>(byte), &message, &status);
+    }
+    qsizetype position = 0;
+    while (MAVLinkFrameParser::parseNext(_decodeChannel, tlog, position, message)) {}
+
+    // Link statistics read from the channel status must not depend on which parser decoded the stream
+    const mavlink_status_t* const byteStatus = mavlink_get_channel_status(_byteChannel);
+    const mavlink_status_t* const frameStatus = QGCMAVLink::getChannelReceiveStatus(_decodeChannel);
+    QCOMPARE(frameStatus->packet_rx_success_count, static_cast<uint16_t>(messages.count() - 1));
+    QCOMPARE(frameStatus->packet_rx_success_count, byteStatus->packet_rx_success_count);
+    QCOMPARE(frameStatus->packet_rx_drop_count, byteStatus->packet_rx_drop_count);
+    QCOMPARE(frameStatus->current_rx_seq, byteStatus->current_rx_seq);
+    QCOMPARE(frameStatus->flags, byteStatus->flags);
+    QCOMPARE(frameStatus->msg_received, byteStatus->msg_received);
+    QCOMPARE(frameStatus->parse_error, byteStatus->parse_error);
+    // The state used to pack outgoing messages on the channel is left alone
+    QCOMPARE(mavlink_get_channel_status(_decodeChannel)->packet_rx_success_count, static_cast<uint16_t>(0));
+
+    // A stream ending in a bad frame leaves the parse error counted. Pick a heartbeat without start bytes past its
+    // first one, so the fast path has nothing to resync on within the frame.
+    QByteArray badFrame;
+    for (uint32_t customMode = 0; badFrame.isEmpty(); customMode++) {
+        QVERIFY(customMode < 1000);
+        (void) mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _encodeChannel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, customMode, MAV_STATE_ACTIVE);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const int len = mavlink_msg_to_send_buffer(buffer, &message);
+        buffer[MAVLINK_NUM_HEADER_BYTES] ^= 0x55;
+        const QByteArray frame(reinterpret_cast<const char*>(buffer), len);
+        if (!frame.sliced(1).contains(static_cast<char>(MAVLINK_STX)) && !frame.sliced(1).contains(static_cast<char>(MAVLINK_STX_MAVLINK1))) {
+            badFrame = frame;
+        }
+    }
+    for (const char byte : badFrame) {
+        (void) mavlink_parse_char(_byteChannel, static_cast<uint8_t>(byte), &message, &status);
+    }
+    position = 0;
+    QVERIFY(!MAVLinkFrameParser::parseNext(_decodeChannel, badFrame, position, message));
+    QCOMPARE(byteStatus->parse_error, static_cast<uint8_t>(1));
+    QCOMPARE(frameStatus->parse_error, byteStatus->parse_error);
+    QCOMPARE(frameStatus->msg_received, byteStatus->msg_received);
+    QCOMPARE(frameStatus->packet_rx_success_count, byteStatus->packet_rx_success_count);
+}
+
+void MAVLinkFrameParserTest::_testLongTlogReplay()
+{
+    const QByteArray tlog = _buildTlog(100000);
+
+    mavlink_message_t message;
+    mavlink_status_t status;
+
+    // A long replay must decode the same frames as the byte parser
+    int byteCount = 0;
+    for (const char byte : tlog) {
+        if (mavlink_parse_char(_byteChannel, static_cast<uint8_t>(byte), &message, &status)) {
+            byteCount++;
+        }
+    }
+
+    int frameCount = 0;
+    qsizetype position = 0;
+    while (MAVLinkFrameParser::parseNext(_decodeChannel, tlog, position, message)) {
+        frameCount++;
+    }
+
+    QCOMPARE(frameCount, byteCount);
+    QCOMPARE(frameCount, 100000);
+}
+
+void MAVLinkFrameParserTest::_benchmarkTlogReplay_data()
+{
+    QTest::addColumn<bool>("frameParser");
+
+    QTest::newRow("mavlink_parse_char") << false;
+    QTest::newRow("MAVLinkFrameParser") << true;
+}
+
+/// Replay throughput of a tlog through the byte at a time state machine and through the frame parser
+void MAVLinkFrameParserTest::_benchmarkTlogReplay()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(bool, frameParser);
+
+    const QByteArray tlog = _buildTlog(100000);
+    mavlink_message_t message;
+    mavlink_status_t status;
+    int count = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    if (frameParser) {
+        qsizetype position = 0;
+        while (MAVLinkFrameParser::parseNext(_decodeChannel, tlog, position, message)) {
+            count++;
+        }
+    } else {
+        for (const char byte : tlog) {
+            if (mavlink_parse_char(_byteChannel, static_cast<uint8_t>(byte), &message, &status)) {
+                count++;
+            }
+        }
+    }
+    const qint64 nsecs = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    QCOMPARE(count, 100000);
+    QTest::setBenchmarkResult(static_cast<qreal>(tlog.size()) * 1e9 / nsecs, QTest::BytesPerSecond);
+}
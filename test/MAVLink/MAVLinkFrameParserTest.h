@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkFrameParserTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MAVLinkFrameParserTest() = default;
+
+private slots:
+    void init(void) final;
+
+    void _testParseCompleteFrames();
+    void _testParseSplitFrames();
+    void _testParseBadCrc();
+    void _testChannelStatus();
+    void _testLongTlogReplay();
+    void _benchmarkTlogReplay_data();
+    void _benchmarkTlogReplay();
+
+private:
+    /// Builds a .tlog formatted (timestamp + frame) byte stream
+    static QByteArray _buildTlog(int messageCount, QList<mavlink_message_t> *messages = nullptr);
+
+    static constexpr mavlink_channel_t _encodeChannel = MAVLINK_COMM_14;
+    static constexpr mavlink_channel_t _decodeChannel = MAVLINK_COMM_15;
+    static constexpr mavlink_channel_t _byteChannel = MAVLINK_COMM_13;    ///< Decoded by mavlink_parse_char for comparison
+};
@@ -9,6 +9,8 @@
 
 #include "SigningTest.h"
 #include "MAVLinkSigning.h"
+#include "MAVLinkFrameParser.h"
+#include "QGCMAVLink.h"
 
 #include <QtTest/QTest>
 
@@ -43,3 +45,43 @@ void SigningTest::_testCreateSetupSigning()
     QCOMPARE(setup_signing.target_system, target_system.sysid);
     QCOMPARE(setup_signing.target_component, target_system.compid);
 }
+
+/// Signature checks of incoming messages use the receive state, the outgoing signing state of the channel is not touched
+void SigningTest::_testReceiveSigning()
+{
+    static constexpr mavlink_channel_t sendChannel = MAVLINK_COMM_1;
+    static constexpr mavlink_channel_t receiveChannel = MAVLINK_COMM_2;
+
+    QVERIFY(MAVLinkSigning::initSigning(sendChannel, "secret_key", MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    QVERIFY(MAVLinkSigning::initSigning(receiveChannel, "secret_key", MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    QVERIFY(MAVLinkSigning::initReceiveSigning(receiveChannel, "secret_key", MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    QGCMAVLink::resetChannelReceiveStatus(receiveChannel);
+
+    const mavlink_signing_t* const outboundSigning = mavlink_get_channel_status(receiveChannel)->signing;
+    const mavlink_signing_t* const receiveSigning = QGCMAVLink::getChannelReceiveStatus(receiveChannel)->signing;
+    QVERIFY(receiveSigning);
+    QVERIFY(outboundSigning != receiveSigning);
+    const uint64_t outboundTimestamp = outboundSigning->timestamp;
+
+    const mavlink_heartbeat_t heartbeat = {0};
+    mavlink_message_t message;
+    (void) mavlink_msg_heartbeat_encode_chan(1, MAV_COMP_ID_AUTOPILOT1, sendChannel, &message, &heartbeat);
+    QVERIFY(message.incompat_flags & MAVLINK_IFLAG_SIGNED);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const QByteArray bytes(reinterpret_cast<const char*>(buffer), mavlink_msg_to_send_buffer(buffer, &message));
+
+    mavlink_message_t received;
+    qsizetype position = 0;
+    QVERIFY(MAVLinkFrameParser::parseNext(receiveChannel, bytes, position, received));
+    QCOMPARE(received.msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+    QCOMPARE(outboundSigning->timestamp, outboundTimestamp);
+
+    // A message signed with another key is rejected
+    QVERIFY(MAVLinkSigning::initReceiveSigning(receiveChannel, "other_key", MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    position = 0;
+    QVERIFY(!MAVLinkFrameParser::parseNext(receiveChannel, bytes, position, received));
+
+    QVERIFY(MAVLinkSigning::initSigning(sendChannel, QByteArrayView(), MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    QVERIFY(MAVLinkSigning::initSigning(receiveChannel, QByteArrayView(), MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+    QVERIFY(MAVLinkSigning::initReceiveSigning(receiveChannel, QByteArrayView(), MAVLinkSigning::insecureConnectionAccceptUnsignedCallback));
+}
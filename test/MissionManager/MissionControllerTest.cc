@@ -17,9 +17,19 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 #include "MultiSignalSpy.h"
-
+#include "SpeedSection.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
 #include <QtTest/QTest>
 
+#include <functional>
+
 MissionControllerTest::MissionControllerTest(void)
 {
     
@@ -291,3 +301,274 @@ void MissionControllerTest::_testGlobalAltMode(void)
         }
     }
 }
+
+/// Writes a plan with a takeoff followed by waypointCount waypoints zig zagging at varying altitudes
+QString MissionControllerTest::_writeLargePlan(const QString& dirPath, int waypointCount)
+{
+    const QGeoCoordinate homeCoord(47.633, -122.091, 20);
+
+    QJsonArray items;
+    QGeoCoordinate coord = homeCoord;
+    for (int i=0; i<=waypointCount; i++) {
+        if (i != 0) {
+            coord = coord.atDistanceAndAzimuth(100, (i % 2) ? 45 : 135);
+        }
+
+        QJsonObject item;
+        item["autoContinue"] =  true;
+        item["command"] =       i == 0 ? MAV_CMD_NAV_TAKEOFF : MAV_CMD_NAV_WAYPOINT;
+        item["coordinate"] =    QJsonArray({ coord.latitude(), coord.longitude(), 20 + (i % 10) * 5 });
+        item["doJumpId"] =      i + 1;
+        item["frame"] =         MAV_FRAME_GLOBAL_RELATIVE_ALT;
+        item["params"] =        QJsonArray({ 0, 0, 0, QJsonValue() });
+        item["type"] =          "SimpleItem";
+        items.append(item);
+    }
+
+    QJsonObject mission;
+    mission["cruiseSpeed"] =            15;
+    mission["firmwareType"] =           MAV_AUTOPILOT_PX4;
+    mission["hoverSpeed"] =             5;
+    mission["items"] =                  items;
+    mission["plannedHomePosition"] =    QJsonArray({ homeCoord.latitude(), homeCoord.longitude(), homeCoord.altitude() });
+    mission["vehicleType"] =            MAV_TYPE_QUADROTOR;
+    mission["version"] =                2;
+
+    QJsonObject plan;
+    plan["fileType"] =      "Plan";
+    plan["geoFence"] =      QJsonObject({ { "polygon", QJsonArray() }, { "version", 1 } });
+    plan["groundStation"] = "QGroundControl";
+    plan["mission"] =       mission;
+    plan["rallyPoints"] =   QJsonObject({ { "points", QJsonArray() }, { "version", 1 } });
+    plan["version"] =       1;
+
+    const QString filename = QDir(dirPath).filePath(QStringLiteral("Large%1.plan").arg(waypointCount));
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    (void) file.write(QJsonDocument(plan).toJson());
+
+    return filename;
+}
+
+/// @return Mission totals followed by the flight status values of each item
+QList<double> MissionControllerTest::_flightStatusSnapshot(void)
+{
+    QList<double> snapshot = {
+        _missionController->missionDistance(),
+        _missionController->missionTime(),
+        _missionController->missionHoverDistance(),
+        _missionController->missionCruiseDistance(),
+        _missionController->missionMaxTelemetry(),
+    };
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    for (int i=0; i<visualItems->count(); i++) {
+        VisualMissionItem* visualItem = visualItems->value<VisualMissionItem*>(i);
+        snapshot << visualItem->distance() << visualItem->distanceFromStart() << visualItem->azimuth() << visualItem->altDifference()
+                 << visualItem->altPercent() << visualItem->missionVehicleYaw() << visualItem->missionGimbalYaw();
+    }
+
+    return snapshot;
+}
+
+void MissionControllerTest::_testIncrementalFlightStatusRecalc(void)
+{
+    static constexpr int waypointCount = 100;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    const QString planFilename = _writeLargePlan(tempDir.path(), waypointCount);
+    QVERIFY(!planFilename.isEmpty());
+    _masterController->loadFromFile(planFilename);
+    QCOMPARE(_missionController->visualItems()->count(), waypointCount + 2);
+    QTest::qWait(100); // Recalcs in MissionController are queued to remove dups. Allow return to main message loop.
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    SimpleMissionItem* middleItem = visualItems->value<SimpleMissionItem*>(waypointCount / 2);
+    SimpleMissionItem* lateItem = visualItems->value<SimpleMissionItem*>(waypointCount - 5);
+    QVERIFY(middleItem);
+    QVERIFY(lateItem);
+
+    // Each edit only recalcs from the edited item forward, which must give the same results as a recalc of the whole mission
+    std::function<void()> edits[] = {
+        [middleItem]() { middleItem->altitude()->setRawValue(500); },
+        [lateItem]() { lateItem->setCoordinate(lateItem->coordinate().atDistanceAndAzimuth(250, 270)); },
+        [middleItem]() { middleItem->speedSection()->setSpecifyFlightSpeed(true); middleItem->speedSection()->flightSpeed()->setRawValue(2); },
+        [lateItem]() { lateItem->altitude()->setRawValue(1); },
+    };
+    for (const std::function<void()>& edit: edits) {
+        edit();
+        QTest::qWait(100);
+        const QList<double> incremental = _flightStatusSnapshot();
+
+        emit _missionController->_recalcMissionFlightStatusSignal();
+        QTest::qWait(100);
+        const QList<double> full = _flightStatusSnapshot();
+
+        // Compared one by one since QList comparison treats NaN values as different
+        QCOMPARE(incremental.count(), full.count());
+        for (int i=0; i<full.count(); i++) {
+            QCOMPARE(incremental[i], full[i]);
+        }
+    }
+}
+
+void MissionControllerTest::_benchmarkFlightStatusRecalc_data(void)
+{
+    QTest::addColumn<int>("waypointCount");
+    QTest::addColumn<int>("path");
+
+    for (int waypointCount: { 500, 2000 }) {
+        QTest::addRow("%d waypoints: first item edit", waypointCount) << waypointCount << static_cast<int>(FirstItemEditPath);
+        QTest::addRow("%d waypoints: middle item edit", waypointCount) << waypointCount << static_cast<int>(MiddleItemEditPath);
+        QTest::addRow("%d waypoints: last item edit", waypointCount) << waypointCount << static_cast<int>(LastItemEditPath);
+        QTest::addRow("%d waypoints: full recalc", waypointCount) << waypointCount << static_cast<int>(FullRecalcPath);
+    }
+}
+
+/// Time for editCount single item edits, each followed by its incremental recalc, against editCount recalcs of the
+/// whole mission
+void MissionControllerTest::_benchmarkFlightStatusRecalc(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, waypointCount);
+    QFETCH(int, path);
+
+    static constexpr int editCount = 20;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    const QString planFilename = _writeLargePlan(tempDir.path(), waypointCount);
+    QVERIFY(!planFilename.isEmpty());
+    _masterController->loadFromFile(planFilename);
+    QTest::qWait(500);
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QCOMPARE(visualItems->count(), waypointCount + 2);
+
+    int itemIndex = 2;
+    if (path == MiddleItemEditPath) {
+        itemIndex = visualItems->count() / 2;
+    } else if (path == LastItemEditPath) {
+        itemIndex = visualItems->count() - 1;
+    }
+    SimpleMissionItem* item = visualItems->value<SimpleMissionItem*>(itemIndex);
+    QVERIFY(item);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i=0; i<editCount; i++) {
+        if (path == FullRecalcPath) {
+            emit _missionController->_recalcMissionFlightStatusSignal();
+        } else {
+            // Each edit is followed by its queued recalc
+            item->altitude()->setRawValue(30 + i);
+        }
+        QCoreApplication::processEvents();
+    }
+
+    QTest::setBenchmarkResult(timer.elapsed(), QTest::WalltimeMilliseconds);
+}
+
+/// @return Resident set size of the process in KB, -1 where not available
+///     @param peak true: Peak resident set size since the process started or since _resetPeakResidentKBytes
+static qint64 _residentKBytes(bool peak)
+{
+    QFile file(QStringLiteral("/proc/self/status"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    const QByteArray key = peak ? QByteArrayLiteral("VmHWM:") : QByteArrayLiteral("VmRSS:");
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray& line: lines) {
+        if (line.startsWith(key)) {
+            return line.mid(key.length()).trimmed().split(' ').first().toLongLong();
+        }
+    }
+
+    return -1;
+}
+
+/// Resets the peak resident set size to the current one
+///     @return false: Not supported
+static bool _resetPeakResidentKBytes(void)
+{
+    QFile file(QStringLiteral("/proc/self/clear_refs"));
+    return file.open(QIODevice::WriteOnly) && (file.write("5") == 1);
+}
+
+void MissionControllerTest::_benchmarkLoadLargePlan_data(void)
+{
+    QTest::addColumn<int>("path");
+    QTest::addColumn<bool>("peakMemory");
+
+    QTest::newRow("on demand editor facts: msecs") << static_cast<int>(OnDemandEditorFactsPath) << false;
+    QTest::newRow("up front editor facts: msecs") << static_cast<int>(UpFrontEditorFactsPath) << false;
+    QTest::newRow("on demand editor facts: peak rss growth") << static_cast<int>(OnDemandEditorFactsPath) << true;
+    QTest::newRow("up front editor facts: peak rss growth") << static_cast<int>(UpFrontEditorFactsPath) << true;
+}
+
+/// Load time and peak resident memory growth for a large plan. Editor facts are built on demand now, building them
+/// for every item right after the load gives the cost of building them up front as loading used to.
+void MissionControllerTest::_benchmarkLoadLargePlan(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+    QFETCH(bool, peakMemory);
+
+    static constexpr int waypointCount = 5000;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    const QString planFilename = _writeLargePlan(tempDir.path(), waypointCount);
+    QVERIFY(!planFilename.isEmpty());
+
+    qint64 startKBytes = -1;
+    if (peakMemory) {
+        if (!_resetPeakResidentKBytes()) {
+            QSKIP("Peak resident set size can't be reset on this platform");
+        }
+        startKBytes = _residentKBytes(false /* peak */);
+        if (startKBytes < 0) {
+            QSKIP("Resident set size not available on this platform");
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    _masterController->loadFromFile(planFilename);
+
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    QCOMPARE(visualItems->count(), waypointCount + 2);
+
+    if (path == UpFrontEditorFactsPath) {
+        for (int i=1; i<visualItems->count(); i++) {
+            SimpleMissionItem* item = visualItems->value<SimpleMissionItem*>(i);
+            QVERIFY(item);
+            (void) item->textFieldFacts();
+            (void) item->nanFacts();
+            (void) item->comboboxFacts();
+        }
+    }
+    const qint64 elapsedMSecs = timer.elapsed();
+
+    if (peakMemory) {
+        const qint64 peakKBytes = _residentKBytes(true /* peak */);
+        QVERIFY(peakKBytes >= startKBytes);
+        QTest::setBenchmarkResult((peakKBytes - startKBytes) * 1024, QTest::BytesAllocated);
+    } else {
+        QTest::setBenchmarkResult(elapsedMSecs, QTest::WalltimeMilliseconds);
+    }
+}
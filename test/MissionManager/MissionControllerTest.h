@@ -34,6 +34,11 @@ private slots:
     void _testGlobalAltMode             (void);
     void _testGimbalRecalc              (void);
     void _testVehicleYawRecalc          (void);
+    void _testIncrementalFlightStatusRecalc(void);
+    void _benchmarkFlightStatusRecalc_data(void);
+    void _benchmarkFlightStatusRecalc   (void);
+    void _benchmarkLoadLargePlan_data   (void);
+    void _benchmarkLoadLargePlan        (void);
 
 private:
 #if 0
@@ -49,6 +54,20 @@ private:
     void _testOfflineToOnlineWorker(MAV_AUTOPILOT firmwareType);
 #endif
     void _setupVisualItemSignals(VisualMissionItem* visualItem);
+    QString _writeLargePlan(const QString& dirPath, int waypointCount);
+    QList<double> _flightStatusSnapshot(void);
+
+    enum FlightStatusBenchmarkPath {
+        FirstItemEditPath,
+        MiddleItemEditPath,
+        LastItemEditPath,
+        FullRecalcPath,
+    };
+
+    enum LoadLargePlanBenchmarkPath {
+        OnDemandEditorFactsPath,
+        UpFrontEditorFactsPath,
+    };
 
     // MissiomItems signals
 
@@ -11,7 +11,11 @@
 #include "MissionManagerTest.h"
 #include "MissionManager.h"
 #include "MultiSignalSpy.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+#include "PlanViewSettings.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 
@@ -363,3 +367,107 @@ void MissionManagerTest::_testErrorAckFailureStrings(void)
     }
 
 }
+
+void MissionManagerTest::_writeWaypoints(int waypointCount)
+{
+    QList<MissionItem*> missionItems;
+
+    // Editor has a home position item on the front, so we do the same
+    for (int i=0; i<=waypointCount; i++) {
+        MissionItem* missionItem = new MissionItem(this);
+        missionItem->setCommand(MAV_CMD_NAV_WAYPOINT);
+        missionItem->setFrame(MAV_FRAME_GLOBAL_RELATIVE_ALT);
+        missionItem->setParam5(47.3769 + (i * 0.0001));
+        missionItem->setParam6(8.549444);
+        missionItem->setParam7(50);
+        missionItem->setSequenceNumber(i);
+        missionItems.append(missionItem);
+    }
+
+    _missionManager->writeMissionItems(missionItems);
+    QVERIFY(_multiSpyMissionManager->waitForSignalByIndex(sendCompleteSignalIndex, _missionManagerSignalWaitTime));
+    QCOMPARE(_multiSpyMissionManager->checkSignalByMask(sendCompleteSignalMask), true);
+    QCOMPARE(_multiSpyMissionManager->pullBoolFromSignalIndex(sendCompleteSignalIndex), false /* error */);
+    _multiSpyMissionManager->clearAllSignals();
+}
+
+void MissionManagerTest::_timedRead(bool pipelined, int expectedCount, qint64& elapsedMSecs)
+{
+    qgcApp()->toolbox()->settingsManager()->planViewSettings()->pipelinedMissionDownload()->setRawValue(pipelined);
+
+    QElapsedTimer timer;
+    timer.start();
+    _missionManager->loadFromVehicle();
+    QVERIFY(_multiSpyMissionManager->waitForSignalByIndex(newMissionItemsAvailableSignalIndex, _missionManagerSignalWaitTime));
+    elapsedMSecs = timer.elapsed();
+    QCOMPARE(_multiSpyMissionManager->checkNoSignalByMask(errorSignalMask), true);
+    _multiSpyMissionManager->clearAllSignals();
+
+    // Items must come back complete and in sequence no matter which requests were lost
+    const QList<MissionItem*>& missionItems = _missionManager->missionItems();
+    QCOMPARE(missionItems.count(), expectedCount);
+    for (int i=0; i<missionItems.count(); i++) {
+        QCOMPARE(missionItems[i]->sequenceNumber(), i);
+        // Coordinates travel as 1e7 scaled integers
+        QVERIFY(qAbs(missionItems[i]->param5() - (47.3769 + ((i + 1) * 0.0001))) < 1e-6);
+    }
+}
+
+/// Writes a mission and reads it back both ways over a slow link which loses a few item messages
+MissionManagerTest::RoundTripMSecs_t MissionManagerTest::_lossyLinkRoundTrip(int waypointCount)
+{
+    RoundTripMSecs_t roundTripMSecs;
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    // Satellite/LTE like link: slow responses, a few lost item messages
+    _mockLink->setMissionItemLinkSimulation(20 /* latencyMsecs */, 5 /* lossPct */);
+
+    QElapsedTimer timer;
+    timer.start();
+    _writeWaypoints(waypointCount);
+    roundTripMSecs.upload = timer.elapsed();
+
+    // PX4 does not store home, so only the waypoints come back
+    _timedRead(false /* pipelined */, waypointCount, roundTripMSecs.sequentialRead);
+    _timedRead(true /* pipelined */, waypointCount, roundTripMSecs.pipelinedRead);
+
+    _mockLink->setMissionItemLinkSimulation(0, 0);
+    qgcApp()->toolbox()->settingsManager()->planViewSettings()->pipelinedMissionDownload()->setRawValue(false);
+
+    return roundTripMSecs;
+}
+
+void MissionManagerTest::_testLossyLinkRead(void)
+{
+    (void) _lossyLinkRoundTrip(20);
+}
+
+void MissionManagerTest::_benchmarkPipelinedRead_data(void)
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("upload") << static_cast<int>(UploadPath);
+    QTest::newRow("sequential read") << static_cast<int>(SequentialReadPath);
+    QTest::newRow("pipelined read") << static_cast<int>(PipelinedReadPath);
+}
+
+void MissionManagerTest::_benchmarkPipelinedRead(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    const RoundTripMSecs_t roundTripMSecs = _lossyLinkRoundTrip(100);
+    switch (path) {
+    case UploadPath:
+        QTest::setBenchmarkResult(roundTripMSecs.upload, QTest::WalltimeMilliseconds);
+        break;
+    case SequentialReadPath:
+        QTest::setBenchmarkResult(roundTripMSecs.sequentialRead, QTest::WalltimeMilliseconds);
+        break;
+    case PipelinedReadPath:
+        QTest::setBenchmarkResult(roundTripMSecs.pipelinedRead, QTest::WalltimeMilliseconds);
+        break;
+    }
+}
@@ -26,8 +26,23 @@ private slots:
     void _testReadFailureHandlingPX4(void);
     //void _testReadFailureHandlingAPM(void);
     //void _testErrorAckFailureStrings(void);
+    void _testLossyLinkRead(void);
+    void _benchmarkPipelinedRead_data(void);
+    void _benchmarkPipelinedRead(void);
 
 private:
+    struct RoundTripMSecs_t {
+        qint64 upload           = 0;
+        qint64 sequentialRead   = 0;
+        qint64 pipelinedRead    = 0;
+    };
+
+    enum PipelinedReadBenchmarkPath {
+        UploadPath,
+        SequentialReadPath,
+        PipelinedReadPath,
+    };
+
     void _testWriteFailureHandlingPX4(void);
     void _testWriteFailureHandlingAPM(void);
     //void _testReadFailureHandlingPX4(void);
@@ -37,6 +52,9 @@ private:
     void _writeItems(MockLinkMissionItemHandler::FailureMode_t failureMode, MAV_MISSION_RESULT failureAckResult, bool shouldFail);
     void _testWriteFailureHandlingWorker(void);
     void _testReadFailureHandlingWorker(void);
+    void _writeWaypoints(int waypointCount);
+    void _timedRead(bool pipelined, int expectedCount, qint64& elapsedMSecs);
+    RoundTripMSecs_t _lossyLinkRoundTrip(int waypointCount);
     
     static const TestCase_t _rgTestCases[];
     static const size_t     _cTestCases;
@@ -12,6 +12,10 @@
 #include "PlanViewSettings.h"
 #include "MultiSignalSpy.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThreadPool>
+#include <QtTest/QTest>
+
 SurveyComplexItemTest::SurveyComplexItemTest(void)
 {
     _rgSurveySignals[surveyVisualTransectPointsChangedIndex] =    SIGNAL(visualTransectPointsChanged());
@@ -355,3 +359,167 @@ void SurveyComplexItemTest::_testHoverCaptureItemGeneration(void)
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, true /* useConditionGate */, expectedCommands);
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, false /* useConditionGate */, expectedCommands);
 }
+
+bool SurveyComplexItemTest::_waitForTransectsBuild(void)
+{
+    for (int i=0; (i<500) && _surveyItem->transectsBuildInProgress(); i++) {
+        QTest::qWait(10);
+    }
+    return !_surveyItem->transectsBuildInProgress();
+}
+
+/// Concave and many sided polygons, about 2km across, which are slow to build transects for
+QList<QList<QGeoCoordinate>> SurveyComplexItemTest::_complexPolygonFixtures(void) const
+{
+    QList<QList<QGeoCoordinate>> fixtures;
+    const QGeoCoordinate center = _polyVertices[0];
+
+    // Star with 40 points
+    QList<QGeoCoordinate> star;
+    for (int i=0; i<80; i++) {
+        star.append(center.atDistanceAndAzimuth((i & 1) ? 400 : 1000, i * 360.0 / 80));
+    }
+    fixtures.append(star);
+
+    // Comb with 20 teeth opening to the south
+    QList<QGeoCoordinate> comb;
+    const QGeoCoordinate combOrigin = center.atDistanceAndAzimuth(1000, 270);
+    for (int tooth=0; tooth<20; tooth++) {
+        const QGeoCoordinate toothWest = combOrigin.atDistanceAndAzimuth(tooth * 100, 90);
+        comb.append(toothWest);
+        comb.append(toothWest.atDistanceAndAzimuth(1500, 180));
+        comb.append(toothWest.atDistanceAndAzimuth(1500, 180).atDistanceAndAzimuth(50, 90));
+        comb.append(toothWest.atDistanceAndAzimuth(50, 90));
+    }
+    comb.append(combOrigin.atDistanceAndAzimuth(2000, 90));
+    comb.append(combOrigin.atDistanceAndAzimuth(2000, 90).atDistanceAndAzimuth(300, 0));
+    comb.append(combOrigin.atDistanceAndAzimuth(300, 0));
+    fixtures.append(comb);
+
+    // Circle with 360 vertices
+    QList<QGeoCoordinate> circle;
+    for (int i=0; i<360; i++) {
+        circle.append(center.atDistanceAndAzimuth(1000, i));
+    }
+    fixtures.append(circle);
+
+    return fixtures;
+}
+
+void SurveyComplexItemTest::_testBackgroundTransectsBuild(void)
+{
+    const QVariantList initialTransectPoints = _surveyItem->visualTransectPoints();
+    const VisualMissionItem::ReadyForSaveState initialReadyForSaveState = _surveyItem->readyForSaveState();
+
+    _surveyItem->setBuildTransectsInBackground(true);
+
+    // Several edits in a row only publish the transects of the last one
+    const QGeoCoordinate vertex = _mapPolygon->vertexCoordinate(2);
+    for (int i=1; i<=5; i++) {
+        _mapPolygon->adjustVertex(2, vertex.atDistanceAndAzimuth(i * 20, 135));
+    }
+    QVERIFY(_surveyItem->transectsBuildInProgress());
+    QCOMPARE(_surveyItem->readyForSaveState(), VisualMissionItem::NotReadyForSaveData);
+    QCOMPARE(_surveyItem->visualTransectPoints(), initialTransectPoints);
+    QVERIFY(_waitForTransectsBuild());
+    QCOMPARE(_surveyItem->readyForSaveState(), initialReadyForSaveState);
+    const QVariantList backgroundTransectPoints = _surveyItem->visualTransectPoints();
+    QVERIFY(backgroundTransectPoints != initialTransectPoints);
+
+    // Same transects as a synchronous build
+    _surveyItem->setBuildTransectsInBackground(false);
+    _mapPolygon->adjustVertex(2, vertex);
+    _mapPolygon->adjustVertex(2, vertex.atDistanceAndAzimuth(5 * 20, 135));
+    QVERIFY(!_surveyItem->transectsBuildInProgress());
+    QCOMPARE(_surveyItem->visualTransectPoints(), backgroundTransectPoints);
+
+    // A change to another input drops the background build in flight
+    _surveyItem->setBuildTransectsInBackground(true);
+    _mapPolygon->adjustVertex(2, vertex);
+    QVERIFY(_surveyItem->transectsBuildInProgress());
+    _surveyItem->gridAngle()->setRawValue(45);
+    QVERIFY(!_surveyItem->transectsBuildInProgress());
+    const QVariantList gridAngleTransectPoints = _surveyItem->visualTransectPoints();
+    QTest::qWait(100);
+    QCOMPARE(_surveyItem->visualTransectPoints(), gridAngleTransectPoints);
+
+    // Mission items are never built from stale transects
+    _mapPolygon->adjustVertex(2, vertex.atDistanceAndAzimuth(5 * 20, 135));
+    QVERIFY(_surveyItem->transectsBuildInProgress());
+    QList<MissionItem*> items;
+    _surveyItem->appendMissionItems(items, this);
+    QVERIFY(!_surveyItem->transectsBuildInProgress());
+    QVERIFY(_surveyItem->visualTransectPoints() != gridAngleTransectPoints);
+    qDeleteAll(items);
+
+    // A build the worker is done with stays in progress until its result is picked up on the gui thread
+    _mapPolygon->adjustVertex(2, vertex);
+    QThreadPool::globalInstance()->waitForDone();
+    QVERIFY(_surveyItem->transectsBuildInProgress());
+    QCOMPARE(_surveyItem->readyForSaveState(), VisualMissionItem::NotReadyForSaveData);
+    QVERIFY(_waitForTransectsBuild());
+}
+
+void SurveyComplexItemTest::_benchmarkTransectsBuild_data(void)
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("synchronous") << static_cast<int>(SynchronousBuildPath);
+    QTest::newRow("background gui thread") << static_cast<int>(BackgroundGuiThreadPath);
+    QTest::newRow("background until published") << static_cast<int>(BackgroundPublishedPath);
+}
+
+/// Time taken by a drag of the first vertex, one rebuild per step: building on the gui thread, the gui thread time
+/// of building in the background, and the time until the background build of the last step is published
+void SurveyComplexItemTest::_benchmarkTransectsBuild(void)
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    static constexpr int dragSteps = 20;
+    qint64 elapsedMSecs = 0;
+
+    _surveyItem->cameraCalc()->adjustedFootprintSide()->setRawValue(10);
+
+    const QList<QList<QGeoCoordinate>> fixtures = _complexPolygonFixtures();
+    for (int fixtureIndex=0; fixtureIndex<fixtures.count(); fixtureIndex++) {
+        const QList<QGeoCoordinate>& fixture = fixtures[fixtureIndex];
+
+        _surveyItem->setBuildTransectsInBackground(false);
+        _mapPolygon->clear();
+        _mapPolygon->appendVertices(fixture);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i=1; i<=dragSteps; i++) {
+            _mapPolygon->adjustVertex(0, fixture[0].atDistanceAndAzimuth(i * 5, 45));
+        }
+        if (path == SynchronousBuildPath) {
+            elapsedMSecs += timer.elapsed();
+        }
+        const QVariantList synchronousTransectPoints = _surveyItem->visualTransectPoints();
+
+        if (path != SynchronousBuildPath) {
+            _surveyItem->setBuildTransectsInBackground(true);
+            _mapPolygon->adjustVertex(0, fixture[0]);
+            QVERIFY(_waitForTransectsBuild());
+
+            timer.restart();
+            for (int i=1; i<=dragSteps; i++) {
+                _mapPolygon->adjustVertex(0, fixture[0].atDistanceAndAzimuth(i * 5, 45));
+            }
+            if (path == BackgroundGuiThreadPath) {
+                elapsedMSecs += timer.elapsed();
+            }
+            QVERIFY(_waitForTransectsBuild());
+            if (path == BackgroundPublishedPath) {
+                elapsedMSecs += timer.elapsed();
+            }
+
+            QCOMPARE(_surveyItem->visualTransectPoints(), synchronousTransectPoints);
+        }
+    }
+
+    QTest::setBenchmarkResult(elapsedMSecs, QTest::WalltimeMilliseconds);
+}
@@ -37,6 +37,9 @@ private slots:
     void _testItemGeneration(void);
     void _testItemCount(void);
     void _testHoverCaptureItemGeneration(void);
+    void _testBackgroundTransectsBuild(void);
+    void _benchmarkTransectsBuild_data(void);
+    void _benchmarkTransectsBuild(void);
 #else
     // Handy mechanism to to a single test
 private slots:
@@ -53,6 +56,14 @@ private:
     double          _clampGridAngle180(double gridAngle);
     QList<MAV_CMD>  _createExpectedCommands(bool hasTurnaround, bool useConditionGate);
     void            _testItemGenerationWorker(bool imagesInTurnaround, bool hasTurnaround, bool useConditionGate, const QList<MAV_CMD>& expectedCommands);
+    bool            _waitForTransectsBuild(void);
+    QList<QList<QGeoCoordinate>> _complexPolygonFixtures(void) const;
+
+    enum TransectsBuildBenchmarkPath {
+        SynchronousBuildPath,
+        BackgroundGuiThreadPath,
+        BackgroundPublishedPath,
+    };
 
     // SurveyComplexItem signals
 
@@ -12,6 +12,7 @@
 #include "PlanMasterController.h"
 #include "MultiSignalSpyV2.h"
 #include "TerrainQueryTest.h"
+#include "TerrainTileServer.h"
 
 #include <QtTest/QTest>
 
@@ -210,6 +211,67 @@ void TransectStyleComplexItemTest::_testAltitudes(void)
     }
 }
 
+void TransectStyleComplexItemTest::_testTerrainSegmentRequery(void)
+{
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    TerrainTileServerManager tileManager(server.url());
+    _transectStyleItem->_terrainTileManager = &tileManager;
+    _transectStyleItem->transectThroughVertices = true;
+
+    auto waitForTerrain = [this]() {
+        return QTest::qWaitFor([this]() { return _transectStyleItem->readyForSaveState() == TransectStyleComplexItem::ReadyForSave; }, 5000);
+    };
+
+    // Path through the four vertices, every segment is queried
+    _transectStyleItem->cameraCalc()->setDistanceMode(QGroundControlQmlGlobal::AltitudeModeCalcAboveTerrain);
+    QVERIFY(waitForTerrain());
+    QCOMPARE(_transectStyleItem->_terrainSegmentsRequested, 3);
+    QCOMPARE(_transectStyleItem->_rgPathHeightInfo.count(), 3);
+
+    // Moving the last vertex only changes the last segment
+    QGCMapPolygon* const polygon = _transectStyleItem->surveyAreaPolygon();
+    polygon->adjustVertex(3, polygon->vertexCoordinate(3).atDistanceAndAzimuth(20, 0));
+    QVERIFY(_transectStyleItem->readyForSaveState() != TransectStyleComplexItem::ReadyForSave);
+    QVERIFY(waitForTerrain());
+    QCOMPARE(_transectStyleItem->_terrainSegmentsRequested, 1);
+
+    // Moving an inner vertex changes the segments on either side
+    polygon->adjustVertex(1, polygon->vertexCoordinate(1).atDistanceAndAzimuth(20, 90));
+    QVERIFY(_transectStyleItem->readyForSaveState() != TransectStyleComplexItem::ReadyForSave);
+    QVERIFY(waitForTerrain());
+    QCOMPARE(_transectStyleItem->_terrainSegmentsRequested, 2);
+
+    // Heights stitched from cached and re-queried segments match a query of the whole path
+    QList<QGeoCoordinate> transectPoints;
+    for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: _transectStyleItem->_transects) {
+        for (const TransectStyleComplexItem::CoordInfo_t& coordInfo: transect) {
+            transectPoints.append(coordInfo.coord);
+        }
+    }
+    TerrainPolyPathQuery fullQuery(&tileManager, false /* autoDelete */);
+    bool fullQueryDone = false;
+    QList<TerrainPathQuery::PathHeightInfo_t> rgFullPathHeightInfo;
+    connect(&fullQuery, &TerrainPolyPathQuery::terrainDataReceived, this, [&fullQueryDone, &rgFullPathHeightInfo](bool success, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo) {
+        QVERIFY(success);
+        fullQueryDone = true;
+        rgFullPathHeightInfo = rgPathHeightInfo;
+    });
+    fullQuery.requestData(transectPoints);
+    QVERIFY(QTest::qWaitFor([&fullQueryDone]() { return fullQueryDone; }, 5000));
+
+    const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo = _transectStyleItem->_rgPathHeightInfo;
+    QCOMPARE(rgPathHeightInfo.count(), rgFullPathHeightInfo.count());
+    for (int i=0; i<rgPathHeightInfo.count(); i++) {
+        QCOMPARE(rgPathHeightInfo[i].distanceBetween, rgFullPathHeightInfo[i].distanceBetween);
+        QCOMPARE(rgPathHeightInfo[i].finalDistanceBetween, rgFullPathHeightInfo[i].finalDistanceBetween);
+        QCOMPARE(rgPathHeightInfo[i].heights, rgFullPathHeightInfo[i].heights);
+    }
+
+    // The tile manager goes away with this test
+    _transectStyleItem->_terrainTileManager = nullptr;
+}
+
 // TODO: Move To Terrain Testing
 /*void TransectStyleComplexItemTest::_testFollowTerrain(void)
 {
@@ -237,6 +299,7 @@ TestTransectStyleItem::TestTransectStyleItem(PlanMasterController* masterControl
     , rebuildTransectsPhase1Called  (false)
     , recalcComplexDistanceCalled   (false)
     , recalcCameraShotsCalled       (false)
+    , transectThroughVertices       (false)
 {
     // We use a 100m by 100m square test polygon
     const double edgeDistance = 100;
@@ -255,6 +318,16 @@ void TestTransectStyleItem::_rebuildTransectsPhase1(void)
         return;
     }
 
+    if (transectThroughVertices) {
+        QList<TransectStyleComplexItem::CoordInfo_t> transect;
+        for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+            transect.append({ surveyAreaPolygon()->vertexCoordinate(i), i == 0 ? CoordTypeSurveyEntry : CoordTypeInterior });
+        }
+        transect.last().coordType = CoordTypeSurveyExit;
+        _transects.append(transect);
+        return;
+    }
+
     _transects.append(QList<TransectStyleComplexItem::CoordInfo_t>{
         {surveyAreaPolygon()->vertexCoordinate(0), CoordTypeSurveyEntry},
         {surveyAreaPolygon()->vertexCoordinate(2), CoordTypeSurveyExit}}
@@ -34,6 +34,7 @@ private slots:
     void _testRebuildTransects  (void);
     void _testDistanceSignalling(void);
     void _testAltitudes         (void);
+    void _testTerrainSegmentRequery(void);
     // void _testFollowTerrain     (void);
 
 private:
@@ -63,6 +64,7 @@ public:
     bool rebuildTransectsPhase1Called;
     bool recalcComplexDistanceCalled;
     bool recalcCameraShotsCalled;
+    bool transectThroughVertices;   ///< true: single transect through all polygon vertices in order
 
 private slots:
     // Overrides from TransectStyleComplexItem
@@ -0,0 +1,1058 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheWorkerTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCMapTasks.h"
+#include "QGCCacheTile.h"
+#include "QGCCachedTileSet.h"
+#include "QGCMapUrlEngine.h"
+#include "MapProvider.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+#include <QtCore/QTemporaryDir>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlQuery>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+
+/// Typical size of a compressed satellite tile
+QByteArray _tileImage(int seed)
+{
+    QByteArray img(20 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < img.size(); i++) {
+        img[i] = static_cast<char>((i * 31) + seed);
+    }
+    return img;
+}
+
+constexpr const char *_tileType = "Bing Satellite";
+
+/// Spreads index over the tiles of zoom level 18
+quint64 _tileKey(int index)
+{
+    return UrlFactory::getTileKey(QLatin1String(_tileType), 1000 + (index % 1000), 2000 + (index / 1000), 18);
+}
+
+QString _tileHash(int index)
+{
+    return UrlFactory::getTileHash(QLatin1String(_tileType), 1000 + (index % 1000), 2000 + (index / 1000), 18);
+}
+
+/// City sized area down to zoom level 19
+constexpr double _setTopleftLat = 47.40;
+constexpr double _setTopleftLon = 8.50;
+constexpr double _setBottomRightLat = 47.35;
+constexpr double _setBottomRightLon = 8.55;
+constexpr int _setMinZoom = 10;
+constexpr int _setMaxZoom = 19;
+
+QGCTileSet _setTileCount(int z)
+{
+    return UrlFactory::getTileCount(z, _setTopleftLon, _setTopleftLat, _setBottomRightLon, _setBottomRightLat, QLatin1String(_tileType));
+}
+
+/// Tile set of the area, which has yet to be created
+QGCCachedTileSet *_areaTileSet(quint64 &tileCount)
+{
+    tileCount = 0;
+    for (int z = _setMinZoom; z <= _setMaxZoom; z++) {
+        tileCount += _setTileCount(z).tileCount;
+    }
+
+    const QString type = QLatin1String(_tileType);
+    QGCCachedTileSet* const set = new QGCCachedTileSet(QStringLiteral("Test Set"));
+    set->setMapTypeStr(type);
+    set->setType(type);
+    set->setTopleftLat(_setTopleftLat);
+    set->setTopleftLon(_setTopleftLon);
+    set->setBottomRightLat(_setBottomRightLat);
+    set->setBottomRightLon(_setBottomRightLon);
+    set->setMinZoom(_setMinZoom);
+    set->setMaxZoom(_setMaxZoom);
+    set->setTotalTileCount(static_cast<quint32>(tileCount));
+    return set;
+}
+
+QGCSaveTileTask *_saveTileTask(quint64 key, const QByteArray &img)
+{
+    return new QGCSaveTileTask(new QGCCacheTile(key, img, QStringLiteral("png"), QLatin1String(_tileType)));
+}
+
+/// Tables as they were before tile keys
+bool _createHashTables(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    return query.exec("CREATE TABLE Tiles (tileID INTEGER PRIMARY KEY NOT NULL, hash TEXT NOT NULL UNIQUE, format TEXT NOT NULL, tile BLOB NULL, size INTEGER, type INTEGER, date INTEGER DEFAULT 0)") &&
+           query.exec("CREATE INDEX hash ON Tiles ( hash, size, type )") &&
+           query.exec("CREATE TABLE TileSets (setID INTEGER PRIMARY KEY NOT NULL, name TEXT NOT NULL UNIQUE, typeStr TEXT, topleftLat REAL DEFAULT 0.0, topleftLon REAL DEFAULT 0.0, bottomRightLat REAL DEFAULT 0.0, bottomRightLon REAL DEFAULT 0.0, minZoom INTEGER DEFAULT 3, maxZoom INTEGER DEFAULT 3, type INTEGER DEFAULT -1, numTiles INTEGER DEFAULT 0, defaultSet INTEGER DEFAULT 0, date INTEGER DEFAULT 0)") &&
+           query.exec("CREATE TABLE SetTiles (setID INTEGER, tileID INTEGER)") &&
+           query.exec("CREATE TABLE TilesDownload (setID INTEGER, hash TEXT NOT NULL UNIQUE, type INTEGER, x INTEGER, y INTEGER, z INTEGER, state INTEGER DEFAULT 0)") &&
+           query.exec("INSERT INTO TileSets(name, defaultSet, date) VALUES('Default Tile Set', 1, 0)");
+}
+
+/// Inserts count tiles keyed by key(index) into the Tiles table of db in one transaction
+///     @return Elapsed msecs
+template<typename KeyFunction>
+qint64 _insertTiles(QSqlDatabase &db, const char *sql, int count, const QByteArray &img, KeyFunction key)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    (void) db.transaction();
+    QSqlQuery query(db);
+    (void) query.prepare(sql);
+    QSqlQuery setQuery(db);
+    (void) setQuery.prepare("INSERT INTO SetTiles(tileID, setID) VALUES(?, 1)");
+    for (int i = 0; i < count; i++) {
+        query.bindValue(0, key(i));
+        query.bindValue(1, QStringLiteral("png"));
+        query.bindValue(2, img);
+        query.bindValue(3, img.size());
+        query.bindValue(4, QLatin1String(_tileType));
+        query.bindValue(5, 0);
+        if (!query.exec()) {
+            qWarning() << query.lastError().text();
+            return -1;
+        }
+        setQuery.bindValue(0, query.lastInsertId());
+        (void) setQuery.exec();
+    }
+    (void) db.commit();
+
+    return qMax(timer.elapsed(), qint64(1));
+}
+
+/// Looks up count tiles by key(index)
+///     @return Elapsed msecs, -1 if a tile is missing
+template<typename KeyFunction>
+qint64 _lookupTiles(QSqlDatabase &db, const char *sql, int count, KeyFunction key)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlQuery query(db);
+    (void) query.prepare(sql);
+    for (int i = 0; i < count; i++) {
+        query.bindValue(0, key(i));
+        if (!query.exec() || !query.next()) {
+            return -1;
+        }
+    }
+    query.finish();
+
+    return qMax(timer.elapsed(), qint64(1));
+}
+
+}
+
+bool QGCTileCacheWorkerTest::_initWorker(QGCCacheWorker &worker, const QString &databasePath)
+{
+    worker.setDatabaseFile(databasePath);
+    return _runTask(worker, new QGCMapTask(QGCMapTask::taskInit));
+}
+
+/// Queues the task and waits until the worker is done with it. Tasks run in order so everything queued before it
+/// is done as well.
+bool QGCTileCacheWorkerTest::_runTask(QGCCacheWorker &worker, QGCMapTask *task)
+{
+    // Tasks are deleted on this thread once the worker has run them
+    QSignalSpy spyDestroyed(task, &QObject::destroyed);
+    if (!worker.enqueueTask(task)) {
+        return false;
+    }
+    return (spyDestroyed.count() != 0) || spyDestroyed.wait(30000);
+}
+
+QByteArray QGCTileCacheWorkerTest::_fetchTile(QGCCacheWorker &worker, quint64 key)
+{
+    QByteArray img;
+
+    QGCFetchTileTask* const task = new QGCFetchTileTask(key);
+    (void) connect(task, &QGCFetchTileTask::tileFetched, this, [&img](QGCCacheTile *tile) {
+        img = tile->img();
+        delete tile;
+    });
+    if (!_runTask(worker, task)) {
+        return QByteArray();
+    }
+
+    return img;
+}
+
+/// @return true: Totals maintained by the worker match a full count
+bool QGCTileCacheWorkerTest::_checkTotals(QGCCacheWorker &worker, bool repair)
+{
+    bool consistent = false;
+
+    QGCCheckTotalsTask* const task = new QGCCheckTotalsTask(repair);
+    (void) connect(task, &QGCCheckTotalsTask::totalsChecked, this, [&consistent](bool checked) {
+        consistent = checked;
+    });
+
+    return _runTask(worker, task) && consistent;
+}
+
+void QGCTileCacheWorkerTest::_stopWorker(QGCCacheWorker &worker)
+{
+    worker.stop();
+    QVERIFY(worker.wait(30000));
+}
+
+void QGCTileCacheWorkerTest::_testTileKeys()
+{
+    constexpr int maxZoom = static_cast<int>(MAX_MAP_ZOOM);
+    constexpr int maxXY = (1 << maxZoom) - 1;
+    const QList<QList<int>> rgXYZ = {
+        { 0, 0, 0 },
+        { 0, 0, 1 },
+        { 1, 1, 1 },
+        { 1000, 2000, 18 },
+        { maxXY, 0, maxZoom },
+        { 0, maxXY, maxZoom },
+        { maxXY, maxXY, maxZoom },
+    };
+
+    // Every provider and tile gets its own key, which gives both of them back
+    QSet<quint64> keys;
+    for (const SharedMapProvider &provider : UrlFactory::getProviders()) {
+        const QString type = provider->getMapName();
+        for (const QList<int> &xyz : rgXYZ) {
+            const quint64 key = UrlFactory::getTileKey(type, xyz[0], xyz[1], xyz[2]);
+            QVERIFY(key != UrlFactory::kInvalidTileKey);
+            QVERIFY(key != UrlFactory::kAllTilesKey);
+            QVERIFY(!keys.contains(key));
+            keys.insert(key);
+
+            QCOMPARE(UrlFactory::tileKeyToType(key), type);
+            int x = -1, y = -1, z = -1;
+            UrlFactory::tileKeyToXYZ(key, x, y, z);
+            QCOMPARE(x, xyz[0]);
+            QCOMPARE(y, xyz[1]);
+            QCOMPARE(z, xyz[2]);
+        }
+    }
+
+    // Hashes of the old string format convert to the same key
+    const QString type = QLatin1String(_tileType);
+    QCOMPARE(UrlFactory::tileHashToKey(UrlFactory::getTileHash(type, maxXY, 5, maxZoom)), UrlFactory::getTileKey(type, maxXY, 5, maxZoom));
+    QCOMPARE(UrlFactory::tileHashToKey(QStringLiteral("garbage")), UrlFactory::kInvalidTileKey);
+
+    // Out of range tiles don't get a key, their bits would run into the zoom marker or the provider id
+    QCOMPARE(UrlFactory::getTileKey(type, 0, -1, 18), UrlFactory::kInvalidTileKey);
+    QCOMPARE(UrlFactory::getTileKey(type, -1, 0, 18), UrlFactory::kInvalidTileKey);
+    QCOMPARE(UrlFactory::getTileKey(type, 1 << 18, 0, 18), UrlFactory::kInvalidTileKey);
+    QCOMPARE(UrlFactory::getTileKey(type, 0, 1 << 18, 18), UrlFactory::kInvalidTileKey);
+    QCOMPARE(UrlFactory::getTileKey(type, 0, 0, maxZoom + 1), UrlFactory::kInvalidTileKey);
+    QCOMPARE(UrlFactory::getTileKey(type, 0, 0, -1), UrlFactory::kInvalidTileKey);
+}
+
+void QGCTileCacheWorkerTest::_testSaveAndFetch()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    // A batch of saves, including the same tile twice
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(worker.enqueueTask(_saveTileTask(_tileKey(i), _tileImage(i))));
+    }
+    QVERIFY(worker.enqueueTask(_saveTileTask(_tileKey(3), _tileImage(100))));
+
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(_fetchTile(worker, _tileKey(i)), _tileImage(i));
+    }
+    QVERIFY(_fetchTile(worker, _tileKey(11)).isEmpty());
+
+    // Single save
+    QVERIFY(_runTask(worker, _saveTileTask(_tileKey(42), _tileImage(42))));
+    QCOMPARE(_fetchTile(worker, _tileKey(42)), _tileImage(42));
+
+    _stopWorker(worker);
+}
+
+void QGCTileCacheWorkerTest::_benchmarkTileThroughput_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("single write") << static_cast<int>(SingleWritePath);
+    QTest::newRow("batched write") << static_cast<int>(BatchedWritePath);
+    QTest::newRow("read") << static_cast<int>(ReadPath);
+}
+
+/// Tiles per second (one tile per frame) written when every save is its own transaction (saves trickling in while
+/// panning), written when saves are queued up as during an offline download, which are written in batches, and read
+void QGCTileCacheWorkerTest::_benchmarkTileThroughput()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    static constexpr int tileCount = 2000;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    const QByteArray img = _tileImage(0);
+    QElapsedTimer timer;
+
+    if (path == SingleWritePath) {
+        timer.start();
+        for (int i = 0; i < tileCount; i++) {
+            QVERIFY(_runTask(worker, _saveTileTask(_tileKey(i), img)));
+        }
+    } else {
+        timer.start();
+        for (int i = 0; i < tileCount; i++) {
+            QVERIFY(worker.enqueueTask(_saveTileTask(_tileKey(i), img)));
+        }
+        // Fetches run ahead of saves, so wait behind the saves with a no-op task
+        QVERIFY(_runTask(worker, new QGCMapTask(QGCMapTask::taskInit)));
+    }
+
+    if (path == ReadPath) {
+        QGCFetchTileTask* lastTask = nullptr;
+        int fetchedCount = 0;
+
+        timer.restart();
+        for (int i = 0; i < tileCount; i++) {
+            lastTask = new QGCFetchTileTask(_tileKey(i));
+            (void) connect(lastTask, &QGCFetchTileTask::tileFetched, this, [&fetchedCount](QGCCacheTile *tile) {
+                fetchedCount++;
+                delete tile;
+            });
+            QVERIFY(worker.enqueueTask(lastTask));
+        }
+        QSignalSpy spyDestroyed(lastTask, &QObject::destroyed);
+        QVERIFY(spyDestroyed.wait(30000));
+        QCoreApplication::processEvents();
+        QCOMPARE(fetchedCount, tileCount);
+    }
+
+    const qint64 elapsedMSecs = qMax(timer.elapsed(), qint64(1));
+    QCOMPARE(_fetchTile(worker, _tileKey(tileCount - 1)), img);
+
+    QTest::setBenchmarkResult((tileCount * 1000.0) / elapsedMSecs, QTest::FramesPerSecond);
+
+    _stopWorker(worker);
+}
+
+void QGCTileCacheWorkerTest::_testMigrateTileHashes()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString databasePath = dir.filePath(QStringLiteral("qgcMapCache.db"));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QVERIFY(_createHashTables(db));
+        QVERIFY(_insertTiles(db, "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)", 10, _tileImage(0), _tileHash) > 0);
+
+        QSqlQuery query(db);
+        // Tile of a provider which no longer exists
+        QVERIFY(query.exec(QStringLiteral("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES('%1', 'png', x'00', 1, 0, 0)").arg(QString::asprintf("%010d%08d%08d%03d", 12345, 1, 1, 1))));
+        QVERIFY(query.exec(QStringLiteral("INSERT INTO SetTiles(tileID, setID) VALUES(%1, 1)").arg(query.lastInsertId().toLongLong())));
+        QVERIFY(query.exec(QStringLiteral("INSERT INTO TilesDownload(setID, hash, type, x, y, z, state) VALUES(2, '%1', 0, 1000, 2020, 18, 0)").arg(_tileHash(20000))));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, databasePath));
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(_fetchTile(worker, _tileKey(i)), _tileImage(0));
+    }
+
+    // Pending download carried over with its key
+    QGCGetTileDownloadListTask* const task = new QGCGetTileDownloadListTask(2, 10);
+    QList<QGCTile*> tiles;
+    (void) connect(task, &QGCGetTileDownloadListTask::tileListFetched, this, [&tiles](const QQueue<QGCTile*> &fetched) {
+        tiles = fetched;
+    });
+    QVERIFY(_runTask(worker, task));
+    QCOMPARE(tiles.count(), 1);
+    QCOMPARE(tiles.first()->key(), _tileKey(20000));
+    qDeleteAll(tiles);
+
+    _stopWorker(worker);
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT COUNT(tileID) FROM Tiles") && query.next());
+        QCOMPARE(query.value(0).toInt(), 10);
+        QVERIFY(query.exec("SELECT COUNT(tileID) FROM SetTiles") && query.next());
+        QCOMPARE(query.value(0).toInt(), 10);
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+}
+
+/// A cache which fails to convert is kept aside and an empty one takes its place
+void QGCTileCacheWorkerTest::_testMigrationFailure()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString databasePath = dir.filePath(QStringLiteral("qgcMapCache.db"));
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QVERIFY(_createHashTables(db));
+        QVERIFY(_insertTiles(db, "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)", 10, _tileImage(0), _tileHash) > 0);
+        // Without its format column the tiles can't be copied over
+        QSqlQuery query(db);
+        QVERIFY(query.exec("ALTER TABLE Tiles DROP COLUMN format"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, databasePath));
+    QVERIFY(_fetchTile(worker, _tileKey(0)).isEmpty());
+    QVERIFY(_runTask(worker, _saveTileTask(_tileKey(0), _tileImage(0))));
+    QCOMPARE(_fetchTile(worker, _tileKey(0)), _tileImage(0));
+    _stopWorker(worker);
+
+    const QStringList backups = QDir(dir.path()).entryList({ QStringLiteral("qgcMapCache.db.*.bak") }, QDir::Files);
+    QCOMPARE(backups.count(), 1);
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(dir.filePath(backups.first()));
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT COUNT(hash) FROM Tiles") && query.next());
+        QCOMPARE(query.value(0).toInt(), 10);
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+}
+
+void QGCTileCacheWorkerTest::_benchmarkTileKeys_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("hash insert") << static_cast<int>(HashInsertPath);
+    QTest::newRow("key insert") << static_cast<int>(KeyInsertPath);
+    QTest::newRow("hash lookup") << static_cast<int>(HashLookupPath);
+    QTest::newRow("key lookup") << static_cast<int>(KeyLookupPath);
+    QTest::newRow("hash database size") << static_cast<int>(HashSizePath);
+    QTest::newRow("key database size") << static_cast<int>(KeySizePath);
+    QTest::newRow("conversion") << static_cast<int>(ConversionPath);
+}
+
+/// Insert and lookup times of tiles keyed by the old tile hashes and by tile keys, and the size of the database before
+/// and after conversion, and the time the conversion takes. Both databases hold the same tiles when they are timed.
+void QGCTileCacheWorkerTest::_benchmarkTileKeys()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    static constexpr int tileCount = 20000;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString databasePath = dir.filePath(QStringLiteral("qgcMapCache.db"));
+    const QString hashDatabasePath = dir.filePath(QStringLiteral("qgcMapCacheHash.db"));
+    // Small tiles so the keys and their index make up a noticeable part of the database
+    const QByteArray img = _tileImage(0).left(256);
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QVERIFY(_createHashTables(db));
+        QVERIFY(_insertTiles(db, "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)", tileCount, img, _tileHash) > 0);
+        QSqlQuery query(db);
+        QVERIFY(query.exec("VACUUM"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+    const qint64 hashSize = QFileInfo(databasePath).size();
+    QVERIFY(QFile::copy(databasePath, hashDatabasePath));
+
+    // Conversion happens when the worker opens the database
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QGCCacheWorker worker;
+        QVERIFY(_initWorker(worker, databasePath));
+        _stopWorker(worker);
+    }
+    const qint64 conversionMSecs = timer.elapsed();
+
+    qint64 hashLookupMSecs = 0;
+    qint64 hashInsertMSecs = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(hashDatabasePath);
+        QVERIFY(db.open());
+        hashLookupMSecs = _lookupTiles(db, "SELECT tile, format, type FROM Tiles WHERE hash = ?", tileCount, _tileHash);
+        QVERIFY(hashLookupMSecs > 0);
+        hashInsertMSecs = _insertTiles(db, "INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)", tileCount, img, [](int i) { return _tileHash(tileCount + i); });
+        QVERIFY(hashInsertMSecs > 0);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    qint64 keyLookupMSecs = 0;
+    qint64 keyInsertMSecs = 0;
+    qint64 keySize = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("PRAGMA wal_checkpoint(TRUNCATE)"));
+        keySize = QFileInfo(databasePath).size();
+        keyLookupMSecs = _lookupTiles(db, "SELECT tile, format, type FROM Tiles WHERE tileKey = ?", tileCount, [](int i) { return static_cast<qint64>(_tileKey(i)); });
+        QVERIFY(keyLookupMSecs > 0);
+        keyInsertMSecs = _insertTiles(db, "INSERT INTO Tiles(tileKey, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)", tileCount, img, [](int i) { return static_cast<qint64>(_tileKey(tileCount + i)); });
+        QVERIFY(keyInsertMSecs > 0);
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    QVERIFY(keySize < hashSize);
+
+    switch (static_cast<TileKeysPath>(path)) {
+    case HashInsertPath:
+        QTest::setBenchmarkResult(hashInsertMSecs, QTest::WalltimeMilliseconds);
+        break;
+    case KeyInsertPath:
+        QTest::setBenchmarkResult(keyInsertMSecs, QTest::WalltimeMilliseconds);
+        break;
+    case HashLookupPath:
+        QTest::setBenchmarkResult(hashLookupMSecs, QTest::WalltimeMilliseconds);
+        break;
+    case KeyLookupPath:
+        QTest::setBenchmarkResult(keyLookupMSecs, QTest::WalltimeMilliseconds);
+        break;
+    case HashSizePath:
+        QTest::setBenchmarkResult(hashSize, QTest::BytesAllocated);
+        break;
+    case KeySizePath:
+        QTest::setBenchmarkResult(keySize, QTest::BytesAllocated);
+        break;
+    case ConversionPath:
+        QTest::setBenchmarkResult(conversionMSecs, QTest::WalltimeMilliseconds);
+        break;
+    }
+}
+
+/// Tiles of the area which are already cached join the new set, the others go on its download list
+void QGCTileCacheWorkerTest::_testCreateTileSet()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    const QString type = QLatin1String(_tileType);
+    const QGCTileSet cachedSet = _setTileCount(15);
+    for (int i = 0; i < 3; i++) {
+        QVERIFY(worker.enqueueTask(_saveTileTask(UrlFactory::getTileKey(type, cachedSet.tileX0 + i, cachedSet.tileY0, 15), _tileImage(i))));
+    }
+
+    quint64 tileCount = 0;
+    QGCCachedTileSet* const set = _areaTileSet(tileCount);
+    set->setCreationProgress(0);
+    QGCCreateTileSetTask* const task = new QGCCreateTileSetTask(set);
+    (void) connect(task, &QGCCreateTileSetTask::actionProgress, set, &QGCCachedTileSet::setCreationProgress);
+    int progress = -1;
+    int progressCount = 0;
+    bool saved = false;
+    (void) connect(task, &QGCCreateTileSetTask::actionProgress, this, [&progress, &progressCount](int percentage) {
+        QVERIFY(percentage >= progress);
+        progress = percentage;
+        progressCount++;
+    });
+    (void) connect(task, &QGCCreateTileSetTask::tileSetSaved, this, [&saved](QGCCachedTileSet *) {
+        saved = true;
+    });
+
+    QVERIFY(_runTask(worker, task));
+
+    QVERIFY(saved);
+    QCOMPARE(progress, 100);
+    QVERIFY(progressCount > 2);
+    QCOMPARE(set->creationProgress(), 100);
+    QCOMPARE(set->savedTileCount(), 3u);
+
+    QGCGetTileDownloadListTask* const listTask = new QGCGetTileDownloadListTask(set->id(), static_cast<int>(tileCount));
+    QList<QGCTile*> tiles;
+    (void) connect(listTask, &QGCGetTileDownloadListTask::tileListFetched, this, [&tiles](const QQueue<QGCTile*> &fetched) {
+        tiles = fetched;
+    });
+    QVERIFY(_runTask(worker, listTask));
+    QCOMPARE(static_cast<quint64>(tiles.count()), tileCount - 3);
+    qDeleteAll(tiles);
+    delete set;
+
+    _stopWorker(worker);
+}
+
+void QGCTileCacheWorkerTest::_benchmarkCreateTileSet_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("empty cache") << static_cast<int>(EmptyCachePath);
+    QTest::newRow("cached area") << static_cast<int>(CachedAreaPath);
+}
+
+/// Tiles per second (one tile per frame) of creating the area tile set when none of its tiles are cached, so they all go
+/// on the download list, and when the tiles of all but its two deepest zoom levels are cached and join the set
+void QGCTileCacheWorkerTest::_benchmarkCreateTileSet()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    const QString type = QLatin1String(_tileType);
+    quint64 cachedCount = 0;
+    if (path == CachedAreaPath) {
+        const QByteArray img = _tileImage(0).left(256);
+        for (int z = _setMinZoom; z <= _setMaxZoom - 2; z++) {
+            const QGCTileSet zoomSet = _setTileCount(z);
+            for (int y = zoomSet.tileY0; y <= zoomSet.tileY1; y++) {
+                for (int x = zoomSet.tileX0; x <= zoomSet.tileX1; x++) {
+                    QVERIFY(worker.enqueueTask(_saveTileTask(UrlFactory::getTileKey(type, x, y, z), img)));
+                    cachedCount++;
+                }
+            }
+        }
+        QVERIFY(_runTask(worker, new QGCMapTask(QGCMapTask::taskInit)));
+    }
+
+    quint64 tileCount = 0;
+    QGCCachedTileSet* const set = _areaTileSet(tileCount);
+    bool saved = false;
+    QGCCreateTileSetTask* const task = new QGCCreateTileSetTask(set);
+    (void) connect(task, &QGCCreateTileSetTask::tileSetSaved, this, [&saved](QGCCachedTileSet *) {
+        saved = true;
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(_runTask(worker, task));
+    const qint64 elapsedMSecs = qMax(timer.elapsed(), qint64(1));
+
+    QVERIFY(saved);
+    QCOMPARE(static_cast<quint64>(set->savedTileCount()), cachedCount);
+    delete set;
+
+    QTest::setBenchmarkResult((tileCount * 1000.0) / elapsedMSecs, QTest::FramesPerSecond);
+
+    _stopWorker(worker);
+}
+
+/// Maintained totals follow tile saves, shared tiles, pruning and set deletion
+void QGCTileCacheWorkerTest::_testTotals()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString databasePath = dir.filePath(QStringLiteral("qgcMapCache.db"));
+
+    QGCCacheWorker worker;
+    quint32 totalTiles = 0;
+    quint32 defaultTiles = 0;
+    (void) connect(&worker, &QGCCacheWorker::updateTotals, this, [&totalTiles, &defaultTiles](quint32 totaltiles, quint64, quint32 defaulttiles, quint64) {
+        totalTiles = totaltiles;
+        defaultTiles = defaulttiles;
+    });
+    QVERIFY(_initWorker(worker, databasePath));
+
+    // Default set
+    const QString type = QLatin1String(_tileType);
+    const QGCTileSet area = UrlFactory::getTileCount(15, 8.50, 47.40, 8.55, 47.35, type);
+    for (int i = 0; i < 4; i++) {
+        QVERIFY(worker.enqueueTask(_saveTileTask(UrlFactory::getTileKey(type, area.tileX0 + i, area.tileY0, 15), _tileImage(i))));
+    }
+    QVERIFY(_checkTotals(worker));
+
+    // Set sharing the cached tiles, then one of its own downloaded
+    QGCCachedTileSet* const set = new QGCCachedTileSet(QStringLiteral("Test Set"));
+    set->setMapTypeStr(type);
+    set->setType(type);
+    set->setTopleftLat(47.40);
+    set->setTopleftLon(8.50);
+    set->setBottomRightLat(47.35);
+    set->setBottomRightLon(8.55);
+    set->setMinZoom(15);
+    set->setMaxZoom(15);
+    set->setTotalTileCount(static_cast<quint32>(area.tileCount));
+    QVERIFY(_runTask(worker, new QGCCreateTileSetTask(set)));
+    QCOMPARE(set->savedTileCount(), 4u);
+    QVERIFY(_runTask(worker, new QGCSaveTileTask(new QGCCacheTile(UrlFactory::getTileKey(type, area.tileX0, area.tileY0 + 1, 15), _tileImage(10), QStringLiteral("png"), type, set->id()))));
+    QVERIFY(_checkTotals(worker));
+    QCOMPARE(totalTiles, 5u);
+    QCOMPARE(defaultTiles, 0u);
+
+    // Tiles only in the default set are pruned
+    QVERIFY(worker.enqueueTask(_saveTileTask(_tileKey(0), _tileImage(20))));
+    QVERIFY(_runTask(worker, new QGCPruneCacheTask(1)));
+    QVERIFY(_checkTotals(worker));
+
+    // Shared tiles are left to the default set
+    QVERIFY(_runTask(worker, new QGCDeleteTileSetTask(set->id())));
+    QVERIFY(_checkTotals(worker));
+    QCOMPARE(totalTiles, 4u);
+    QCOMPARE(defaultTiles, 4u);
+    delete set;
+
+    // Totals which went wrong are found and repaired
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("UPDATE SetTotals SET tileCount = tileCount + 1 WHERE setID = 0"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+    QVERIFY(!_checkTotals(worker, true));
+    QVERIFY(_checkTotals(worker));
+    QCOMPARE(totalTiles, 4u);
+
+    _stopWorker(worker);
+}
+
+/// Tile fetches overtake queued saves and can read tiles which are still waiting to be saved. Canceled fetches are
+/// dropped.
+void QGCTileCacheWorkerTest::_testTaskPriority()
+{
+    static constexpr int tileCount = 1000;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+    QVERIFY(_runTask(worker, _saveTileTask(_tileKey(0), _tileImage(0))));
+
+    QList<QGCMapTask*> saveTasks;
+    for (int i = 1; i <= tileCount; i++) {
+        saveTasks.append(_saveTileTask(_tileKey(i), _tileImage(i)));
+    }
+
+    QStringList order;
+    QByteArray fetchedImg;
+    QGCMapTask* const barrierTask = new QGCMapTask(QGCMapTask::taskInit);
+    (void) connect(barrierTask, &QObject::destroyed, this, [&order]() {
+        order.append(QStringLiteral("barrier"));
+    });
+    QSignalSpy spyBarrier(barrierTask, &QObject::destroyed);
+
+    QGCFetchTileTask* const fetchTask = new QGCFetchTileTask(_tileKey(tileCount));
+    (void) connect(fetchTask, &QGCFetchTileTask::tileFetched, this, [&order, &fetchedImg](QGCCacheTile *tile) {
+        order.append(QStringLiteral("fetch"));
+        fetchedImg = tile->img();
+        delete tile;
+    });
+
+    bool canceledRan = false;
+    QGCFetchTileTask* const canceledTask = new QGCFetchTileTask(_tileKey(0));
+    (void) connect(canceledTask, &QGCFetchTileTask::tileFetched, this, [&canceledRan](QGCCacheTile *tile) {
+        canceledRan = true;
+        delete tile;
+    });
+    (void) connect(canceledTask, &QGCMapTask::error, this, [&canceledRan]() {
+        canceledRan = true;
+    });
+    QSignalSpy spyCanceled(canceledTask, &QObject::destroyed);
+    canceledTask->cancel();
+
+    for (QGCMapTask* const task: saveTasks) {
+        QVERIFY(worker.enqueueTask(task));
+    }
+    QVERIFY(worker.enqueueTask(barrierTask));
+    QVERIFY(worker.enqueueTask(fetchTask));
+    QVERIFY(worker.enqueueTask(canceledTask));
+
+    QVERIFY(spyBarrier.count() || spyBarrier.wait(30000));
+    QVERIFY(spyCanceled.count() || spyCanceled.wait(30000));
+    QCoreApplication::processEvents();
+
+    QCOMPARE(order, QStringList({ QStringLiteral("fetch"), QStringLiteral("barrier") }));
+    QCOMPARE(fetchedImg, _tileImage(tileCount));
+    QVERIFY(!canceledRan);
+    QCOMPARE(_fetchTile(worker, _tileKey(tileCount)), _tileImage(tileCount));
+
+    const QGCCacheWorker::TaskWait fetchWait = worker.taskWait(QGCMapTask::taskFetchTile);
+    const QGCCacheWorker::TaskWait saveWait = worker.taskWait(QGCMapTask::taskCacheTile);
+    QCOMPARE(fetchWait.count, quint64(2));
+    QCOMPARE(saveWait.count, quint64(tileCount + 1));
+
+    _stopWorker(worker);
+}
+
+void QGCTileCacheWorkerTest::_benchmarkTaskQueueWait_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("fetch") << static_cast<int>(FetchWaitPath);
+    QTest::newRow("save") << static_cast<int>(SaveWaitPath);
+}
+
+/// Longest time a fetch and a save spent queued, when a fetch comes in behind a burst of saves as during an offline
+/// download
+void QGCTileCacheWorkerTest::_benchmarkTaskQueueWait()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    static constexpr int tileCount = 1000;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    for (int i = 0; i < tileCount; i++) {
+        QVERIFY(worker.enqueueTask(_saveTileTask(_tileKey(i), _tileImage(i))));
+    }
+    QGCFetchTileTask* const fetchTask = new QGCFetchTileTask(_tileKey(0));
+    (void) connect(fetchTask, &QGCFetchTileTask::tileFetched, this, [](QGCCacheTile *tile) {
+        delete tile;
+    });
+    QSignalSpy spyFetch(fetchTask, &QObject::destroyed);
+    QVERIFY(worker.enqueueTask(fetchTask));
+    QVERIFY(spyFetch.wait(30000));
+    QVERIFY(_runTask(worker, new QGCMapTask(QGCMapTask::taskInit)));
+
+    const QGCCacheWorker::TaskWait wait = worker.taskWait((path == FetchWaitPath) ? QGCMapTask::taskFetchTile : QGCMapTask::taskCacheTile);
+    QVERIFY(wait.count > 0);
+    QTest::setBenchmarkResult(wait.maxNSecs, QTest::WalltimeNanoseconds);
+
+    _stopWorker(worker);
+}
+
+/// Pruning drops the least recently read tiles of the default set, tiles of other sets are kept
+void QGCTileCacheWorkerTest::_testPruneCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    const QString type = QLatin1String(_tileType);
+    const QGCTileSet area = UrlFactory::getTileCount(15, 8.50, 47.40, 8.55, 47.35, type);
+    QGCCachedTileSet* const set = new QGCCachedTileSet(QStringLiteral("Test Set"));
+    set->setMapTypeStr(type);
+    set->setType(type);
+    set->setTopleftLat(47.40);
+    set->setTopleftLon(8.50);
+    set->setBottomRightLat(47.35);
+    set->setBottomRightLon(8.55);
+    set->setMinZoom(15);
+    set->setMaxZoom(15);
+    set->setTotalTileCount(static_cast<quint32>(area.tileCount));
+    QVERIFY(_runTask(worker, new QGCCreateTileSetTask(set)));
+    const quint64 setTileKey = UrlFactory::getTileKey(type, area.tileX0, area.tileY0, 15);
+    QVERIFY(worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(setTileKey, _tileImage(100), QStringLiteral("png"), type, set->id()))));
+    delete set;
+
+    // Saved before the reads, which would otherwise be answered from the queued saves
+    for (int i = 0; i < 10; i++) {
+        QVERIFY(_runTask(worker, _saveTileTask(_tileKey(i), _tileImage(i))));
+    }
+
+    // Save times are in whole seconds and could tie with the reads below. Explicit times make tile 0 the oldest, so
+    // only the reads keep tiles 0-4 from being pruned.
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(dir.filePath(QStringLiteral("qgcMapCache.db")));
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.prepare("UPDATE TileAccess SET access = ? WHERE tileID = (SELECT tileID FROM Tiles WHERE tileKey = ?)"));
+        for (int i = 0; i < 10; i++) {
+            query.bindValue(0, i + 1);
+            query.bindValue(1, static_cast<qint64>(_tileKey(i)));
+            QVERIFY2(query.exec() && (query.numRowsAffected() == 1), qPrintable(query.lastError().text()));
+        }
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    for (int i = 0; i < 5; i++) {
+        QCOMPARE(_fetchTile(worker, _tileKey(i)), _tileImage(i));
+    }
+
+    QVERIFY(_runTask(worker, new QGCPruneCacheTask(static_cast<quint64>(5 * _tileImage(0).size()))));
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(_fetchTile(worker, _tileKey(i)), (i < 5) ? _tileImage(i) : QByteArray());
+    }
+    QCOMPARE(_fetchTile(worker, setTileKey), _tileImage(100));
+    QVERIFY(_checkTotals(worker));
+
+    _stopWorker(worker);
+}
+
+void QGCTileCacheWorkerTest::_benchmarkPruneCache_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("passes of 128 tiles") << static_cast<int>(PrunePassesPath);
+    QTest::newRow("single pass") << static_cast<int>(PruneSinglePassPath);
+}
+
+/// Pruning more tiles than one delete statement takes removes all of them
+void QGCTileCacheWorkerTest::_testPruneCacheChunks()
+{
+    static constexpr int tileCount = 1200;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, dir.filePath(QStringLiteral("qgcMapCache.db"))));
+
+    const QByteArray img = _tileImage(0).left(256);
+    for (int i = 0; i < tileCount; i++) {
+        QVERIFY(worker.enqueueTask(_saveTileTask(_tileKey(i), img)));
+    }
+    QVERIFY(_runTask(worker, new QGCMapTask(QGCMapTask::taskInit)));
+
+    QVERIFY(_runTask(worker, new QGCPruneCacheTask(static_cast<quint64>(tileCount) * img.size())));
+    QVERIFY(_fetchTile(worker, _tileKey(0)).isEmpty());
+    QVERIFY(_fetchTile(worker, _tileKey(tileCount - 1)).isEmpty());
+    QVERIFY(_checkTotals(worker));
+
+    _stopWorker(worker);
+}
+
+/// Frees 10 % of a 5 GB cache of 20 KiB tiles, the way it was done before in passes which each select the 128 oldest
+/// default set tiles and delete them one by one, and in the single pass of the prune task. Tile images are left out,
+/// only their size is recorded.
+void QGCTileCacheWorkerTest::_benchmarkPruneCache()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    static constexpr int tileCount = 262144;
+    static constexpr int tileSize = 20 * 1024;
+    static constexpr int pruneCount = tileCount / 10;
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString databasePath = dir.filePath(QStringLiteral("qgcMapCache.db"));
+
+    QGCCacheWorker worker;
+    QVERIFY(_initWorker(worker, databasePath));
+
+    quint64 defaultSet = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT setID FROM TileSets WHERE defaultSet = 1") && query.next());
+        defaultSet = query.value(0).toULongLong();
+        query.finish();
+
+        // Dates are in tile order, oldest first
+        QVERIFY(db.transaction());
+        QVERIFY2(query.exec(QStringLiteral("INSERT INTO Tiles(tileKey, format, tile, size, type, date) "
+                                           "WITH RECURSIVE N(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM N WHERE i < %1) "
+                                           "SELECT i + 1, 'png', X'00', %2, '%3', i FROM N").arg(tileCount - 1).arg(tileSize).arg(QLatin1String(_tileType))),
+                 qPrintable(query.lastError().text()));
+        QVERIFY(query.exec(QStringLiteral("INSERT INTO SetTiles(tileID, setID) SELECT tileID, %1 FROM Tiles").arg(defaultSet)));
+        QVERIFY(db.commit());
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    qint64 elapsedMSecs = 0;
+    if (path == PrunePassesPath) {
+        _stopWorker(worker);
+
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("PRAGMA synchronous = NORMAL"));
+
+        QElapsedTimer timer;
+        timer.start();
+        int prunedCount = 0;
+        while (prunedCount < pruneCount) {
+            QVERIFY(query.exec(QStringLiteral("SELECT tileID, size, tileKey FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(defaultSet)));
+            QList<qint64> tileIDs;
+            while (((prunedCount + tileIDs.count()) < pruneCount) && query.next()) {
+                tileIDs.append(query.value(0).toLongLong());
+            }
+            query.finish();
+            QVERIFY(!tileIDs.isEmpty());
+            for (const qint64 tileID : tileIDs) {
+                QVERIFY(query.exec(QStringLiteral("DELETE FROM Tiles WHERE tileID = %1").arg(tileID)));
+            }
+            prunedCount += tileIDs.count();
+        }
+        elapsedMSecs = timer.elapsed();
+
+        db.close();
+        QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+    } else {
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(_runTask(worker, new QGCPruneCacheTask(static_cast<quint64>(pruneCount) * tileSize)));
+        elapsedMSecs = timer.elapsed();
+        _stopWorker(worker);
+    }
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("QGCTileCacheWorkerTest"));
+        db.setDatabaseName(databasePath);
+        QVERIFY(db.open());
+        QSqlQuery query(db);
+        QVERIFY(query.exec("SELECT COUNT(*), MIN(date) FROM Tiles") && query.next());
+        QCOMPARE(query.value(0).toInt(), tileCount - pruneCount);
+        QCOMPARE(query.value(1).toInt(), pruneCount);
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("QGCTileCacheWorkerTest"));
+
+    QTest::setBenchmarkResult(elapsedMSecs, QTest::WalltimeMilliseconds);
+}
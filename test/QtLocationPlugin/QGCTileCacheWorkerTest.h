@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCCacheWorker;
+class QGCMapTask;
+
+class QGCTileCacheWorkerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QGCTileCacheWorkerTest() = default;
+
+private slots:
+    void _testTileKeys();
+    void _testSaveAndFetch();
+    void _benchmarkTileThroughput_data();
+    void _benchmarkTileThroughput();
+    void _testMigrateTileHashes();
+    void _testMigrationFailure();
+    void _benchmarkTileKeys_data();
+    void _benchmarkTileKeys();
+    void _testCreateTileSet();
+    void _benchmarkCreateTileSet_data();
+    void _benchmarkCreateTileSet();
+    void _testTotals();
+    void _testTaskPriority();
+    void _benchmarkTaskQueueWait_data();
+    void _benchmarkTaskQueueWait();
+    void _testPruneCache();
+    void _testPruneCacheChunks();
+    void _benchmarkPruneCache_data();
+    void _benchmarkPruneCache();
+
+private:
+    enum TileThroughputPath {
+        SingleWritePath,
+        BatchedWritePath,
+        ReadPath,
+    };
+
+    enum TileKeysPath {
+        HashInsertPath,
+        KeyInsertPath,
+        HashLookupPath,
+        KeyLookupPath,
+        HashSizePath,
+        KeySizePath,
+        ConversionPath,
+    };
+
+    enum CreateTileSetPath {
+        EmptyCachePath,
+        CachedAreaPath,
+    };
+
+    enum TaskQueueWaitPath {
+        FetchWaitPath,
+        SaveWaitPath,
+    };
+
+    enum PruneCachePath {
+        PrunePassesPath,
+        PruneSinglePassPath,
+    };
+
+    bool _initWorker(QGCCacheWorker &worker, const QString &databasePath);
+    bool _runTask(QGCCacheWorker &worker, QGCMapTask *task);
+    QByteArray _fetchTile(QGCCacheWorker &worker, quint64 key);
+    bool _checkTotals(QGCCacheWorker &worker, bool repair = false);
+    void _stopWorker(QGCCacheWorker &worker);
+};
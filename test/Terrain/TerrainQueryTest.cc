@@ -10,7 +10,12 @@
 #include "TerrainQueryTest.h"
 #include "TerrainTileManager.h"
 #include "TerrainQuery.h"
+#include "TerrainTileServer.h"
+#include "TerrainTileCopernicus.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSet>
+#include <QtCore/QtMath>
 #include <QtTest/QTest>
 #include <QtTest/QSignalSpy>
 
@@ -195,6 +200,146 @@ void TerrainQueryTest::_testRequestCarpetHeights()
     QVERIFY(arguments.at(3).toList().constFirst().toList().constFirst().toDouble() == UnitTestTerrainQuery::Flat10Region::amslElevation);
 }
 
+void TerrainQueryTest::_testBatchManager()
+{
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    server.setLatencyMSecs(50);
+
+    TerrainTileServerManager tileManager(server.url());
+    TerrainAtCoordinateBatchManager batchManager(&tileManager);
+
+    // b is in the tile of a, c one tile east
+    const QGeoCoordinate a(pointNemo.latitude() + 0.001, pointNemo.longitude() + 0.001);
+    const QGeoCoordinate b(a.latitude() + 0.002, a.longitude());
+    const QGeoCoordinate c(a.latitude(), a.longitude() + TerrainTileCopernicus::tileSizeDegrees);
+    const QGeoCoordinate aNearby(a.latitude() + 1e-9, a.longitude());
+
+    TerrainAtCoordinateQuery query1(false);
+    TerrainAtCoordinateQuery query2(false);
+    TerrainAtCoordinateQuery query3(false);
+    QSignalSpy spy1(&query1, &TerrainAtCoordinateQuery::terrainDataReceived);
+    QSignalSpy spy2(&query2, &TerrainAtCoordinateQuery::terrainDataReceived);
+    QSignalSpy spy3(&query3, &TerrainAtCoordinateQuery::terrainDataReceived);
+
+    batchManager.addQuery(&query1, { a, b, a });
+    batchManager.addQuery(&query2, { a });
+    batchManager.addQuery(&query3, { aNearby, c });
+
+    for (int i = 0; (i < 100) && ((spy1.count() == 0) || (spy2.count() == 0) || (spy3.count() == 0)); i++) {
+        QTest::qWait(100);
+    }
+    QCOMPARE(spy1.count(), 1);
+    QCOMPARE(spy2.count(), 1);
+    QCOMPARE(spy3.count(), 1);
+
+    const double elevationA = TerrainTileServer::elevation(a);
+    const double elevationC = TerrainTileServer::elevation(c);
+    QVERIFY(spy1.first()[0].toBool());
+    QCOMPARE(spy1.first()[1].value<QList<double>>(), (QList<double>{ elevationA, elevationA, elevationA }));
+    QVERIFY(spy2.first()[0].toBool());
+    QCOMPARE(spy2.first()[1].value<QList<double>>(), QList<double>{ elevationA });
+    QVERIFY(spy3.first()[0].toBool());
+    QCOMPARE(spy3.first()[1].value<QList<double>>(), (QList<double>{ elevationA, elevationC }));
+
+    // One download per tile, however many queries wanted it
+    QCOMPARE(server.requestCount(), 2);
+
+    // Cached tiles are answered right away
+    batchManager.addQuery(&query2, { b, c });
+    QCOMPARE(spy2.count(), 2);
+    QCOMPARE(spy2.last()[1].value<QList<double>>(), (QList<double>{ elevationA, elevationC }));
+    QCOMPARE(server.requestCount(), 2);
+}
+
+void TerrainQueryTest::_benchmarkBatchManager_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("downloaded") << static_cast<int>(DownloadedPath);
+    QTest::newRow("cached") << static_cast<int>(CachedPath);
+}
+
+/// Time to answer all the queries while their tiles are downloaded, and once the tiles are cached
+void TerrainQueryTest::_benchmarkBatchManager()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    // Survey sized mission: 1000 waypoints 100m apart, each queried twice as a mission editor does when items move
+    static constexpr int rows = 25;
+    static constexpr int columns = 40;
+    static constexpr double spacingMeters = 100;
+
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    server.setLatencyMSecs(20);
+
+    TerrainTileServerManager tileManager(server.url());
+    TerrainAtCoordinateBatchManager batchManager(&tileManager);
+
+    QList<QGeoCoordinate> waypoints;
+    QSet<QString> tileHashes;
+    for (int row = 0; row < rows; row++) {
+        const QGeoCoordinate rowStart = pointNemo.atDistanceAndAzimuth(row * spacingMeters, 180);
+        for (int column = 0; column < columns; column++) {
+            const QGeoCoordinate waypoint = rowStart.atDistanceAndAzimuth(column * spacingMeters, 90);
+            waypoints.append(waypoint);
+            tileHashes.insert(QStringLiteral("%1,%2").arg(qFloor((waypoint.latitude() + 90.0) / TerrainTileCopernicus::tileSizeDegrees))
+                                                     .arg(qFloor((waypoint.longitude() + 180.0) / TerrainTileCopernicus::tileSizeDegrees)));
+        }
+    }
+
+    QList<TerrainAtCoordinateQuery*> queries;
+    int answerCount = 0;
+    int successCount = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (const QGeoCoordinate &waypoint: std::as_const(waypoints)) {
+            TerrainAtCoordinateQuery* const query = new TerrainAtCoordinateQuery(false, this);
+            (void) connect(query, &TerrainAtCoordinateQuery::terrainDataReceived, this, [&answerCount, &successCount, waypoint](bool success, const QList<double> &heights) {
+                answerCount++;
+                if (success && (heights == QList<double>{ static_cast<double>(TerrainTileServer::elevation(waypoint)) })) {
+                    successCount++;
+                }
+            });
+            queries.append(query);
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (qsizetype i = 0; i < queries.count(); i++) {
+        batchManager.addQuery(queries[i], { waypoints[i % waypoints.count()] });
+    }
+    for (int i = 0; i < 200 && (answerCount < queries.count()); i++) {
+        QTest::qWait(50);
+    }
+    qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    QCOMPARE(answerCount, queries.count());
+    QCOMPARE(successCount, queries.count());
+    QCOMPARE(server.requestCount(), tileHashes.count());
+
+    if (path == CachedPath) {
+        // Everything is cached now, answered right away
+        answerCount = 0;
+        successCount = 0;
+        timer.restart();
+        for (qsizetype i = 0; i < queries.count(); i++) {
+            batchManager.addQuery(queries[i], { waypoints[i % waypoints.count()] });
+        }
+        elapsedNSecs = timer.nsecsElapsed();
+        QCOMPARE(answerCount, queries.count());
+        QCOMPARE(successCount, queries.count());
+        QCOMPARE(server.requestCount(), tileHashes.count());
+    }
+
+    QTest::setBenchmarkResult(elapsedNSecs / 1000000.0, QTest::WalltimeMilliseconds);
+
+    qDeleteAll(queries);
+}
+
 // Test Requires Internet, so disable by default.
 // Or, check if internet and elevation server are available?
 #if 0
@@ -88,5 +88,14 @@ private slots:
     void _testRequestCoordinateHeights();
     void _testRequestPathHeights();
     void _testRequestCarpetHeights();
+    void _testBatchManager();
+    void _benchmarkBatchManager_data();
+    void _benchmarkBatchManager();
     // void _testTerrainAtCoordinateQuery();
+
+private:
+    enum BatchManagerBenchmarkPath {
+        DownloadedPath,
+        CachedPath,
+    };
 };
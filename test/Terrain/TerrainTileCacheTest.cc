@@ -0,0 +1,273 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileCacheTest.h"
+#include "TerrainTileCache.h"
+#include "TerrainTile.h"
+#include "TerrainTileCopernicus.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThreadPool>
+#include <QtTest/QTest>
+
+namespace {
+
+/// Small flat tile at the given elevation
+QByteArray _serializedTile(int elevation)
+{
+    static constexpr int kGridSize = 10;
+
+    QJsonArray carpet;
+    for (int i = 0; i < kGridSize; i++) {
+        QJsonArray row;
+        for (int j = 0; j < kGridSize; j++) {
+            row.append(elevation);
+        }
+        carpet.append(row);
+    }
+
+    const QJsonObject bounds {
+        { "sw", QJsonArray{ -48.88, -123.40 } },
+        { "ne", QJsonArray{ -48.87, -123.39 } },
+    };
+    const QJsonObject stats {
+        { "min", elevation },
+        { "max", elevation },
+        { "avg", elevation },
+    };
+    const QJsonObject data {
+        { "bounds", bounds },
+        { "stats", stats },
+        { "carpet", carpet },
+    };
+    const QJsonObject root {
+        { "status", "success" },
+        { "data", data },
+    };
+
+    return TerrainTileCopernicus::serializeFromJson(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+qint64 _tileMemoryBytes()
+{
+    return TerrainTile(_serializedTile(0)).memoryBytes();
+}
+
+QString _hash(int index)
+{
+    return QString::number(1000 + index);
+}
+
+}
+
+void TerrainTileCacheTest::_testMemoryEviction()
+{
+    TerrainTileCache cache(QString(), 3 * _tileMemoryBytes(), 0);
+
+    for (int i = 0; i < 4; i++) {
+        QVERIFY(cache.insert(_hash(i), _serializedTile(i)));
+    }
+    QVERIFY(!cache.insert(_hash(10), QByteArray("garbage")));
+
+    // Least recently used tile is dropped, memory only cache has nothing to fall back on
+    QVERIFY(!cache.tile(_hash(0)));
+    for (int i = 1; i < 4; i++) {
+        const std::shared_ptr<const TerrainTile> tile = cache.tile(_hash(i));
+        QVERIFY(tile);
+        QCOMPARE(tile->minElevation(), static_cast<double>(i));
+    }
+
+    TerrainTileCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.memoryHits, 3ULL);
+    QCOMPARE(statistics.misses, 1ULL);
+    QCOMPARE(statistics.memoryEvictions, 1ULL);
+    QCOMPARE(statistics.memoryTileCount, 3);
+    QVERIFY(statistics.memoryBytes <= 3 * _tileMemoryBytes());
+
+    // Shrinking the limit evicts right away
+    cache.setMaxMemoryBytes(_tileMemoryBytes());
+    statistics = cache.statistics();
+    QCOMPARE(statistics.memoryTileCount, 1);
+    QCOMPARE(statistics.memoryEvictions, 3ULL);
+}
+
+void TerrainTileCacheTest::_testDiskReload()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    TerrainTileCache cache(tempDir.path(), _tileMemoryBytes(), 1024 * 1024);
+    QVERIFY(cache.insert(_hash(0), _serializedTile(10)));
+    QVERIFY(cache.insert(_hash(1), _serializedTile(20)));
+
+    // First tile was pushed out of memory by the second one
+    bool onDisk = false;
+    QVERIFY(!cache.memoryTile(_hash(0), &onDisk));
+    QVERIFY(onDisk);
+    std::shared_ptr<const TerrainTile> tile = cache.tile(_hash(0));
+    QVERIFY(tile);
+    QCOMPARE(tile->minElevation(), 10.0);
+
+    // And is back in memory now
+    tile = cache.tile(_hash(0));
+    QVERIFY(tile);
+
+    const TerrainTileCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.diskHits, 1ULL);
+    QCOMPARE(statistics.memoryHits, 1ULL);
+    QCOMPARE(statistics.misses, 0ULL);
+    QCOMPARE(statistics.memoryEvictions, 2ULL);
+    QCOMPARE(statistics.diskTileCount, 2);
+    QCOMPARE(statistics.diskEvictions, 0ULL);
+}
+
+void TerrainTileCacheTest::_testDiskPersistence()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    {
+        TerrainTileCache cache(tempDir.path(), 4 * _tileMemoryBytes(), 1024 * 1024);
+        for (int i = 0; i < 3; i++) {
+            QVERIFY(cache.insert(_hash(i), _serializedTile(i * 100)));
+        }
+    }
+
+    // Damaged file is dropped on access
+    QFile damagedFile(QDir(tempDir.path()).filePath(_hash(2) + QStringLiteral(".terrain")));
+    QVERIFY(damagedFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    (void) damagedFile.write("garbage");
+    damagedFile.close();
+
+    TerrainTileCache cache(tempDir.path(), 4 * _tileMemoryBytes(), 1024 * 1024);
+    QCOMPARE(cache.statistics().diskTileCount, 3);
+
+    for (int i = 0; i < 2; i++) {
+        const std::shared_ptr<const TerrainTile> tile = cache.tile(_hash(i));
+        QVERIFY(tile);
+        QCOMPARE(tile->minElevation(), static_cast<double>(i * 100));
+    }
+    QVERIFY(!cache.tile(_hash(2)));
+    QVERIFY(!damagedFile.exists());
+
+    const TerrainTileCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.diskHits, 2ULL);
+    QCOMPARE(statistics.misses, 1ULL);
+    QCOMPARE(statistics.diskTileCount, 2);
+}
+
+void TerrainTileCacheTest::_testDiskEviction()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Header plus serialized tile
+    const qint64 fileBytes = 8 + _serializedTile(0).size();
+
+    TerrainTileCache cache(tempDir.path(), _tileMemoryBytes(), 2 * fileBytes);
+    QVERIFY(cache.insert(_hash(0), _serializedTile(0)));
+    QVERIFY(cache.insert(_hash(1), _serializedTile(1)));
+
+    // Reading the first tile back from disk makes the second one the least recently used
+    QVERIFY(cache.tile(_hash(0)));
+    QVERIFY(cache.insert(_hash(2), _serializedTile(2)));
+
+    TerrainTileCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.diskEvictions, 1ULL);
+    QCOMPARE(statistics.diskTileCount, 2);
+    QCOMPARE(statistics.diskBytes, 2 * fileBytes);
+
+    cache.clearMemory();
+    QVERIFY(cache.tile(_hash(0)));
+    QVERIFY(!cache.tile(_hash(1)));
+    QVERIFY(cache.tile(_hash(2)));
+
+    cache.setMaxDiskBytes(fileBytes);
+    statistics = cache.statistics();
+    QCOMPARE(statistics.diskEvictions, 2ULL);
+    QCOMPARE(statistics.diskTileCount, 1);
+    QVERIFY(QDir(tempDir.path()).entryList(QDir::Files).count() == 1);
+}
+
+void TerrainTileCacheTest::_testTileTooLarge()
+{
+    TerrainTileCache cache(QString(), _tileMemoryBytes() - 1, 0);
+
+    // Valid tile which no tier keeps is still handed back
+    std::shared_ptr<const TerrainTile> tile;
+    QVERIFY(!cache.insert(_hash(0), _serializedTile(5), &tile));
+    QVERIFY(tile);
+    QCOMPARE(tile->minElevation(), 5.0);
+
+    QVERIFY(!cache.tile(_hash(0)));
+    QCOMPARE(cache.statistics().memoryTileCount, 0);
+}
+
+void TerrainTileCacheTest::_testDiskWriteThreadPool()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QThreadPool diskThreadPool;
+    diskThreadPool.setMaxThreadCount(1);
+
+    TerrainTileCache cache(tempDir.path(), _tileMemoryBytes(), 1024 * 1024, &diskThreadPool);
+    for (int i = 0; i < 3; i++) {
+        QVERIFY(cache.insert(_hash(i), _serializedTile(i)));
+    }
+    // Same tile again while its file may still be queued is written once
+    QVERIFY(cache.insert(_hash(2), _serializedTile(2)));
+    diskThreadPool.waitForDone();
+
+    const TerrainTileCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.diskTileCount, 3);
+    QCOMPARE(statistics.diskBytes, 3 * (8 + _serializedTile(0).size()));
+
+    cache.clearMemory();
+    for (int i = 0; i < 3; i++) {
+        const std::shared_ptr<const TerrainTile> tile = cache.tile(_hash(i));
+        QVERIFY(tile);
+        QCOMPARE(tile->minElevation(), static_cast<double>(i));
+    }
+}
+
+void TerrainTileCacheTest::_testAccessOrderPersistence()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const qint64 fileBytes = 8 + _serializedTile(0).size();
+
+    {
+        TerrainTileCache cache(tempDir.path(), _tileMemoryBytes(), 3 * fileBytes);
+        for (int i = 0; i < 3; i++) {
+            QVERIFY(cache.insert(_hash(i), _serializedTile(i)));
+        }
+        // Oldest file, but most recently used
+        cache.clearMemory();
+        QVERIFY(cache.tile(_hash(0)));
+    }
+
+    // The next run evicts by the recorded access order, not by file times
+    TerrainTileCache cache(tempDir.path(), _tileMemoryBytes(), 3 * fileBytes);
+    QCOMPARE(cache.statistics().diskTileCount, 3);
+    QVERIFY(cache.insert(_hash(3), _serializedTile(3)));
+
+    cache.clearMemory();
+    QVERIFY(cache.tile(_hash(0)));
+    QVERIFY(!cache.tile(_hash(1)));
+    QVERIFY(cache.tile(_hash(2)));
+    QVERIFY(cache.tile(_hash(3)));
+    QCOMPARE(cache.statistics().diskEvictions, 1ULL);
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TerrainTileCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileCacheTest() = default;
+
+private slots:
+    void _testMemoryEviction();
+    void _testDiskReload();
+    void _testDiskPersistence();
+    void _testDiskEviction();
+    void _testTileTooLarge();
+    void _testDiskWriteThreadPool();
+    void _testAccessOrderPersistence();
+};
@@ -0,0 +1,231 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileManagerTest.h"
+#include "TerrainTileManager.h"
+#include "TerrainTileServer.h"
+#include "TerrainTileCopernicus.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+namespace {
+
+/// Somewhere near Point Nemo, away from tile boundaries
+const QGeoCoordinate _pathStart(-48.8755, -123.3935);
+
+/// Path which crosses tileCount tiles from west to east
+QGeoCoordinate _pathEnd(int tileCount)
+{
+    return QGeoCoordinate(_pathStart.latitude(), _pathStart.longitude() + ((tileCount - 1) * TerrainTileCopernicus::tileSizeDegrees));
+}
+
+}
+
+void TerrainTileManagerTest::_testConcurrentDownloads()
+{
+    static constexpr int tileCount = 20;
+    static constexpr int latencyMSecs = 100;
+
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    server.setLatencyMSecs(latencyMSecs);
+
+    TerrainTileServerManager manager(server.url());
+    TerrainQueryInterface query;
+    QSignalSpy spyPath(&query, &TerrainQueryInterface::pathHeightsReceived);
+
+    QElapsedTimer timer;
+    timer.start();
+    manager.addPathQuery(&query, _pathStart, _pathEnd(tileCount));
+    QVERIFY(spyPath.wait(10000));
+    const qint64 elapsedMSecs = timer.elapsed();
+
+    QCOMPARE(spyPath.count(), 1);
+    const QList<QVariant> arguments = spyPath.takeFirst();
+    QVERIFY(arguments[0].toBool());
+    const QList<double> heights = arguments[3].value<QList<double>>();
+    double distanceBetween;
+    double finalDistanceBetween;
+    const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(_pathStart, _pathEnd(tileCount), distanceBetween, finalDistanceBetween);
+    QCOMPARE(heights.count(), coordinates.count());
+    for (qsizetype i = 0; i < heights.count(); i++) {
+        QCOMPARE(heights[i], static_cast<double>(TerrainTileServer::elevation(coordinates[i])));
+    }
+
+    // Every tile is downloaded once, several at a time
+    QCOMPARE(server.requestCount(), tileCount);
+    QVERIFY(server.maxConcurrentRequests() > 1);
+    QVERIFY(server.maxConcurrentRequests() <= TerrainTileManager::kMaxConcurrentTileFetches);
+    // Faster than downloading one tile after the other
+    QVERIFY(elapsedMSecs < (tileCount * latencyMSecs));
+
+    // Everything is cached now
+    manager.addPathQuery(&query, _pathStart, _pathEnd(tileCount));
+    QCOMPARE(spyPath.count(), 1);
+    QCOMPARE(server.requestCount(), tileCount);
+}
+
+void TerrainTileManagerTest::_benchmarkPathQuery_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("serial download") << static_cast<int>(SerialDownloadPath);
+    QTest::newRow("concurrent download") << static_cast<int>(ConcurrentDownloadPath);
+    QTest::newRow("cached") << static_cast<int>(CachedPath);
+}
+
+/// End to end latency of a path query over tileCount tiles which are downloaded one after the other, downloaded
+/// concurrently, or already cached
+void TerrainTileManagerTest::_benchmarkPathQuery()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    static constexpr int tileCount = 20;
+    static constexpr int latencyMSecs = 100;
+
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    server.setLatencyMSecs(latencyMSecs);
+
+    TerrainTileServerManager manager(server.url());
+    TerrainQueryInterface query;
+    QSignalSpy spyPath(&query, &TerrainQueryInterface::pathHeightsReceived);
+    QSignalSpy spyCoordinate(&query, &TerrainQueryInterface::coordinateHeightsReceived);
+
+    QElapsedTimer timer;
+    if (path == SerialDownloadPath) {
+        // One coordinate query per tile, each waiting for the previous one
+        timer.start();
+        for (int i = 0; i < tileCount; i++) {
+            const QGeoCoordinate coordinate(_pathStart.latitude(), _pathStart.longitude() + (i * TerrainTileCopernicus::tileSizeDegrees));
+            manager.addCoordinateQuery(&query, { coordinate });
+            QVERIFY(spyCoordinate.wait(10000));
+        }
+        const qint64 elapsedNSecs = timer.nsecsElapsed();
+        QCOMPARE(spyCoordinate.count(), tileCount);
+        QCOMPARE(server.maxConcurrentRequests(), 1);
+        QTest::setBenchmarkResult(elapsedNSecs / 1000000.0, QTest::WalltimeMilliseconds);
+        return;
+    }
+
+    if (path == CachedPath) {
+        manager.addPathQuery(&query, _pathStart, _pathEnd(tileCount));
+        QVERIFY(spyPath.wait(10000));
+        spyPath.clear();
+    }
+
+    timer.start();
+    manager.addPathQuery(&query, _pathStart, _pathEnd(tileCount));
+    if (path == ConcurrentDownloadPath) {
+        QVERIFY(spyPath.wait(10000));
+    }
+    const qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    QCOMPARE(spyPath.count(), 1);
+    QVERIFY(spyPath.first()[0].toBool());
+    QCOMPARE(server.requestCount(), tileCount);
+    QTest::setBenchmarkResult(elapsedNSecs / 1000000.0, QTest::WalltimeMilliseconds);
+}
+
+void TerrainTileManagerTest::_testRequestCompletesWithOwnTiles()
+{
+    static constexpr int tileCount = 20;
+
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    server.setLatencyMSecs(100);
+
+    TerrainTileServerManager manager(server.url());
+    TerrainQueryInterface coordinateQuery;
+    TerrainQueryInterface pathQuery;
+    QSignalSpy spyCoordinate(&coordinateQuery, &TerrainQueryInterface::coordinateHeightsReceived);
+    QSignalSpy spyPath(&pathQuery, &TerrainQueryInterface::pathHeightsReceived);
+
+    // Single tile south of the path, queued first so it is in the first batch of downloads
+    const QGeoCoordinate coordinate = _pathStart.atDistanceAndAzimuth(5000, 180);
+    manager.addCoordinateQuery(&coordinateQuery, { coordinate });
+    manager.addPathQuery(&pathQuery, _pathStart, _pathEnd(tileCount));
+
+    QVERIFY(spyCoordinate.wait(10000));
+    QCOMPARE(spyPath.count(), 0);
+    QVERIFY(spyCoordinate.first()[0].toBool());
+    QCOMPARE(spyCoordinate.first()[1].value<QList<double>>(), QList<double>{ static_cast<double>(TerrainTileServer::elevation(coordinate)) });
+
+    QVERIFY(spyPath.wait(10000));
+    QVERIFY(spyPath.first()[0].toBool());
+    QCOMPARE(server.requestCount(), tileCount + 1);
+}
+
+void TerrainTileManagerTest::_testTileFailure()
+{
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+    server.setFailRequests(true);
+
+    TerrainTileServerManager manager(server.url());
+    TerrainQueryInterface query;
+    QSignalSpy spyCoordinate(&query, &TerrainQueryInterface::coordinateHeightsReceived);
+
+    manager.addCoordinateQuery(&query, { _pathStart });
+    QVERIFY(spyCoordinate.wait(10000));
+    QVERIFY(!spyCoordinate.first()[0].toBool());
+    QVERIFY(spyCoordinate.first()[1].value<QList<double>>().isEmpty());
+
+    // Failed tiles are downloaded again by the next query
+    server.setFailRequests(false);
+    spyCoordinate.clear();
+    manager.addCoordinateQuery(&query, { _pathStart });
+    QVERIFY(spyCoordinate.wait(10000));
+    QVERIFY(spyCoordinate.first()[0].toBool());
+    QCOMPARE(server.requestCount(), 2);
+}
+
+void TerrainTileManagerTest::_testTinyCache()
+{
+    static constexpr int tileCount = 10;
+
+    TerrainTileServer server;
+    QVERIFY(server.listen());
+
+    // No tile fits into memory and there is no disk tier
+    TerrainTileServerManager manager(server.url(), 1);
+    TerrainQueryInterface query;
+    QSignalSpy spyPath(&query, &TerrainQueryInterface::pathHeightsReceived);
+
+    QElapsedTimer timer;
+    timer.start();
+    manager.addPathQuery(&query, _pathStart, _pathEnd(tileCount));
+    QVERIFY(spyPath.wait(10000));
+    const qint64 elapsedMSecs = timer.elapsed();
+
+    QCOMPARE(spyPath.count(), 1);
+    const QList<QVariant> arguments = spyPath.takeFirst();
+    QVERIFY(arguments[0].toBool());
+    const QList<double> heights = arguments[3].value<QList<double>>();
+    double distanceBetween;
+    double finalDistanceBetween;
+    const QList<QGeoCoordinate> coordinates = TerrainTileManager::pathQueryToCoords(_pathStart, _pathEnd(tileCount), distanceBetween, finalDistanceBetween);
+    QCOMPARE(heights.count(), coordinates.count());
+    for (qsizetype i = 0; i < heights.count(); i++) {
+        QCOMPARE(heights[i], static_cast<double>(TerrainTileServer::elevation(coordinates[i])));
+    }
+
+    // Answered from the tiles the request held on to, nothing was downloaded twice
+    QCOMPARE(server.requestCount(), tileCount);
+    QCOMPARE(manager.cacheStatistics().memoryTileCount, 0);
+
+    // And nothing is left running
+    QTest::qWait(200);
+    QCOMPARE(server.requestCount(), tileCount);
+    QCOMPARE(spyPath.count(), 0);
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TerrainTileManagerTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileManagerTest() = default;
+
+private slots:
+    void _testConcurrentDownloads();
+    void _testRequestCompletesWithOwnTiles();
+    void _testTileFailure();
+    void _testTinyCache();
+    void _benchmarkPathQuery_data();
+    void _benchmarkPathQuery();
+
+private:
+    enum PathQueryBenchmarkPath {
+        SerialDownloadPath,
+        ConcurrentDownloadPath,
+        CachedPath,
+    };
+};
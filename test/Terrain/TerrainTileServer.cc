@@ -0,0 +1,219 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileServer.h"
+#include "TerrainTileCopernicus.h"
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QPointer>
+#include <QtCore/QtMath>
+#include <QtCore/QTimer>
+#include <QtCore/QUrlQuery>
+#include <QtLocation/private/qgeotiledmapreply_p.h>
+#include <QtLocation/private/qgeotilespec_p.h>
+#include <QtNetwork/QNetworkProxy>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+#include <QtPositioning/QGeoCoordinate>
+
+namespace {
+
+int _tileElevation(int tileX, int tileY)
+{
+    return ((tileX * 7) + tileY) % 1000;
+}
+
+/// Downloads a tile from TerrainTileServer
+class TestTileReply : public QGeoTiledMapReply
+{
+public:
+    TestTileReply(QNetworkAccessManager *networkManager, const QUrl &url, const QGeoTileSpec &spec, QObject *parent)
+        : QGeoTiledMapReply(spec, parent)
+    {
+        QNetworkReply* const reply = networkManager->get(QNetworkRequest(url));
+        reply->setParent(this);
+        (void) connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+            if (reply->error() != QNetworkReply::NoError) {
+                setError(QGeoTiledMapReply::CommunicationError, reply->errorString());
+                return;
+            }
+
+            const QByteArray tile = TerrainTileCopernicus::serializeFromJson(reply->readAll());
+            if (tile.isEmpty()) {
+                setError(QGeoTiledMapReply::ParseError, QStringLiteral("Failed to Serialize Terrain Tile"));
+                return;
+            }
+
+            setMapImageData(tile);
+            setMapImageFormat(QStringLiteral("bin"));
+            setFinished(true);
+        });
+    }
+};
+
+}
+
+TerrainTileServer::TerrainTileServer(QObject *parent)
+    : QObject(parent)
+    , _server(new QTcpServer(this))
+{
+    (void) connect(_server, &QTcpServer::newConnection, this, &TerrainTileServer::_newConnection);
+}
+
+bool TerrainTileServer::listen()
+{
+    return _server->listen(QHostAddress::LocalHost);
+}
+
+QUrl TerrainTileServer::url() const
+{
+    QUrl url;
+    url.setScheme(QStringLiteral("http"));
+    url.setHost(_server->serverAddress().toString());
+    url.setPort(_server->serverPort());
+    return url;
+}
+
+void TerrainTileServer::_newConnection()
+{
+    while (QTcpSocket* const socket = _server->nextPendingConnection()) {
+        (void) connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            _readRequests(socket);
+        });
+        (void) connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            (void) _buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void TerrainTileServer::_readRequests(QTcpSocket *socket)
+{
+    QByteArray &buffer = _buffers[socket];
+    buffer.append(socket->readAll());
+
+    // GET requests have no body, each one ends with an empty line
+    qsizetype headerEnd;
+    while ((headerEnd = buffer.indexOf("\r\n\r\n")) >= 0) {
+        const QByteArray requestLine = buffer.left(buffer.indexOf("\r\n"));
+        buffer.remove(0, headerEnd + 4);
+
+        const QList<QByteArray> parts = requestLine.split(' ');
+        const QByteArray target = (parts.count() >= 2) ? parts[1] : QByteArray();
+
+        _requestCount++;
+        _pendingRequests++;
+        _maxConcurrentRequests = qMax(_maxConcurrentRequests, _pendingRequests);
+
+        const QPointer<QTcpSocket> socketPointer(socket);
+        QTimer::singleShot(_latencyMSecs, this, [this, socketPointer, target]() {
+            _pendingRequests--;
+            if (socketPointer) {
+                _sendReply(socketPointer, target);
+            }
+        });
+    }
+}
+
+void TerrainTileServer::_sendReply(QTcpSocket *socket, const QByteArray &target)
+{
+    const QByteArray body = _failRequests ? QByteArray() : _carpetJson(target);
+
+    QByteArray reply;
+    if (body.isEmpty()) {
+        reply = QByteArrayLiteral("HTTP/1.1 500 Internal Server Error\r\n");
+    } else {
+        reply = QByteArrayLiteral("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n");
+    }
+    reply.append(QByteArrayLiteral("Content-Length: ") + QByteArray::number(body.size()) + QByteArrayLiteral("\r\n\r\n"));
+    reply.append(body);
+
+    (void) socket->write(reply);
+}
+
+QByteArray TerrainTileServer::_carpetJson(const QByteArray &target)
+{
+    const QUrlQuery query(QUrl(QString::fromLatin1(target)));
+    const QStringList points = query.queryItemValue(QStringLiteral("points")).split(',');
+    if (points.count() != 4) {
+        return QByteArray();
+    }
+
+    // One arc second spacing as the real server
+    const int gridSize = qRound(TerrainTileCopernicus::tileSizeDegrees / TerrainTileCopernicus::tileValueSpacingDegrees);
+    const int tileX = qRound((points[1].toDouble() + 180.0) / TerrainTileCopernicus::tileSizeDegrees);
+    const int tileY = qRound((points[0].toDouble() + 90.0) / TerrainTileCopernicus::tileSizeDegrees);
+    const int tileElevation = _tileElevation(tileX, tileY);
+
+    QJsonArray row;
+    for (int i = 0; i < gridSize; i++) {
+        row.append(tileElevation);
+    }
+    QJsonArray carpet;
+    for (int i = 0; i < gridSize; i++) {
+        carpet.append(row);
+    }
+
+    const QJsonObject bounds {
+        { "sw", QJsonArray{ points[0].toDouble(), points[1].toDouble() } },
+        { "ne", QJsonArray{ points[2].toDouble(), points[3].toDouble() } },
+    };
+    const QJsonObject stats {
+        { "min", tileElevation },
+        { "max", tileElevation },
+        { "avg", tileElevation },
+    };
+    const QJsonObject data {
+        { "bounds", bounds },
+        { "stats", stats },
+        { "carpet", carpet },
+    };
+    const QJsonObject root {
+        { "status", "success" },
+        { "data", data },
+    };
+
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+int TerrainTileServer::elevation(const QGeoCoordinate &coordinate)
+{
+    return _tileElevation(
+        qFloor((coordinate.longitude() + 180.0) / TerrainTileCopernicus::tileSizeDegrees),
+        qFloor((coordinate.latitude() + 90.0) / TerrainTileCopernicus::tileSizeDegrees)
+    );
+}
+
+/*===========================================================================*/
+
+TerrainTileServerManager::TerrainTileServerManager(const QUrl &serverUrl, qint64 maxMemoryBytes, QObject *parent)
+    : TerrainTileManager(parent)
+    , _serverUrl(serverUrl)
+{
+    _tileCache = std::make_unique<TerrainTileCache>(QString(), maxMemoryBytes, 0);
+    _networkManager.setProxy(QNetworkProxy::NoProxy);
+}
+
+QGeoTiledMapReply *TerrainTileServerManager::_createTileReply(const QGeoTileSpec &spec)
+{
+    // Same tile bounds as CopernicusElevationProvider
+    const double tileSize = TerrainTileCopernicus::tileSizeDegrees;
+    QUrl url = _serverUrl;
+    url.setPath(QStringLiteral("/api/v1/carpet"));
+    url.setQuery(QStringLiteral("points=%1,%2,%3,%4")
+        .arg((spec.y() * tileSize) - 90.0, 0, 'f', 2)
+        .arg((spec.x() * tileSize) - 180.0, 0, 'f', 2)
+        .arg(((spec.y() + 1) * tileSize) - 90.0, 0, 'f', 2)
+        .arg(((spec.x() + 1) * tileSize) - 180.0, 0, 'f', 2));
+
+    return new TestTileReply(&_networkManager, url, spec, this);
+}
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "TerrainTileManager.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QUrl>
+#include <QtNetwork/QNetworkAccessManager>
+
+class QGeoCoordinate;
+class QTcpServer;
+class QTcpSocket;
+
+/// Local HTTP stand-in for the Copernicus elevation server.
+/// Answers GET <path>?points=swLat,swLon,neLat,neLon with a flat carpet after a fixed latency, each tile at its own
+/// elevation. Requests on the same connection are answered in order.
+class TerrainTileServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TerrainTileServer(QObject *parent = nullptr);
+
+    bool listen();
+
+    /// @return Base url of the server, without path
+    QUrl url() const;
+
+    void setLatencyMSecs(int latencyMSecs) { _latencyMSecs = latencyMSecs; }
+
+    /// true: answer every request with 500 Internal Server Error
+    void setFailRequests(bool failRequests) { _failRequests = failRequests; }
+
+    int requestCount() const { return _requestCount; }
+
+    /// @return Largest number of requests which were waiting for their reply at the same time
+    int maxConcurrentRequests() const { return _maxConcurrentRequests; }
+
+    /// @return Elevation the server returns for the tile holding coordinate
+    static int elevation(const QGeoCoordinate &coordinate);
+
+private:
+    void _newConnection();
+    void _readRequests(QTcpSocket *socket);
+    void _sendReply(QTcpSocket *socket, const QByteArray &target);
+    static QByteArray _carpetJson(const QByteArray &target);
+
+    QTcpServer *_server = nullptr;
+    QHash<QTcpSocket*, QByteArray> _buffers;
+    int _latencyMSecs = 0;
+    bool _failRequests = false;
+    int _requestCount = 0;
+    int _pendingRequests = 0;
+    int _maxConcurrentRequests = 0;
+};
+
+/// TerrainTileManager which downloads from a TerrainTileServer, bypassing the map tile cache, and only caches tiles
+/// in memory
+class TerrainTileServerManager : public TerrainTileManager
+{
+public:
+    explicit TerrainTileServerManager(const QUrl &serverUrl, qint64 maxMemoryBytes = 64 * 1024 * 1024, QObject *parent = nullptr);
+
+protected:
+    QGeoTiledMapReply *_createTileReply(const QGeoTileSpec &spec) final;
+
+private:
+    const QUrl _serverUrl;
+    QNetworkAccessManager _networkManager;
+};
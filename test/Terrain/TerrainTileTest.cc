@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTile.h"
+#include "TerrainTileCopernicus.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtPositioning/QGeoCoordinate>
+#include <QtTest/QTest>
+
+#include <algorithm>
+
+namespace {
+
+constexpr double kCellSizeDegrees = 0.01;
+
+/// Tile with its south west corner at 0,0 where the value of row r, column c is 100 + (10 * r) + c
+QByteArray _slopedTile(int rows, int columns, double cellSizeDegrees = kCellSizeDegrees)
+{
+    QJsonArray carpet;
+    for (int r = 0; r < rows; r++) {
+        QJsonArray row;
+        for (int c = 0; c < columns; c++) {
+            row.append(100 + (10 * r) + c);
+        }
+        carpet.append(row);
+    }
+
+    const QJsonObject bounds {
+        { "sw", QJsonArray{ 0.0, 0.0 } },
+        { "ne", QJsonArray{ rows * cellSizeDegrees, columns * cellSizeDegrees } },
+    };
+    const QJsonObject stats {
+        { "min", 100 },
+        { "max", 100 + (10 * (rows - 1)) + (columns - 1) },
+        { "avg", 100 },
+    };
+    const QJsonObject data {
+        { "bounds", bounds },
+        { "stats", stats },
+        { "carpet", carpet },
+    };
+    const QJsonObject root {
+        { "status", "success" },
+        { "data", data },
+    };
+
+    return TerrainTileCopernicus::serializeFromJson(QJsonDocument(root).toJson(QJsonDocument::Compact));
+}
+
+/// Center of cell row, column
+QGeoCoordinate _cellCenter(double row, double column)
+{
+    return QGeoCoordinate((row + 0.5) * kCellSizeDegrees, (column + 0.5) * kCellSizeDegrees);
+}
+
+}
+
+void TerrainTileTest::_testElevation()
+{
+    const TerrainTile tile(_slopedTile(4, 5));
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.minElevation(), 100.0);
+    QCOMPARE(tile.maxElevation(), 134.0);
+
+    QCOMPARE(tile.elevation(_cellCenter(0, 0)), 100.0);
+    QCOMPARE(tile.elevation(_cellCenter(2, 3)), 123.0);
+    QCOMPARE(tile.elevation(_cellCenter(3, 4)), 134.0);
+    QVERIFY(qIsNaN(tile.elevation(_cellCenter(4, 0))));
+    QVERIFY(qIsNaN(tile.elevation(_cellCenter(0, -1))));
+
+    QVERIFY(!TerrainTile(QByteArray("garbage")).isValid());
+    const QByteArray truncatedTile = _slopedTile(4, 5).chopped(2);
+    QVERIFY(!TerrainTile(truncatedTile).isValid());
+}
+
+void TerrainTileTest::_testBilinearElevations()
+{
+    const TerrainTile tile(_slopedTile(4, 5));
+    QVERIFY(tile.isValid());
+
+    const QList<QGeoCoordinate> coordinates = {
+        _cellCenter(0, 0),          // Exactly on a sample
+        _cellCenter(2, 3),
+        _cellCenter(1.5, 2.5),      // Halfway between four samples
+        _cellCenter(1.25, 0.5),
+        _cellCenter(-0.25, 1),      // Outer half cell is held at the edge value
+        _cellCenter(3.25, 4.25),
+        _cellCenter(-0.75, 1),      // Outside the tile
+        _cellCenter(1, 4.75),
+    };
+    const QList<double> elevations = tile.bilinearElevations(coordinates);
+    QCOMPARE(elevations.count(), coordinates.count());
+
+    QCOMPARE(elevations[0], 100.0);
+    QCOMPARE(elevations[1], 123.0);
+    QCOMPARE(elevations[2], 117.5);
+    QCOMPARE(elevations[3], 113.0);
+    QCOMPARE(elevations[4], 101.0);
+    QCOMPARE(elevations[5], 134.0);
+    QVERIFY(qIsNaN(elevations[6]));
+    QVERIFY(qIsNaN(elevations[7]));
+
+    // Non finite positions are outside the tile
+    const double latitudes[] = { qQNaN(), 0.005, qInf(), -qInf(), 1e300 };
+    const double longitudes[] = { 0.005, qQNaN(), 0.005, 0.005, 0.005 };
+    double nonFiniteElevations[5] = { 0, 0, 0, 0, 0 };
+    tile.bilinearElevations(latitudes, longitudes, nonFiniteElevations, 5);
+    for (const double elevation: nonFiniteElevations) {
+        QVERIFY(qIsNaN(elevation));
+    }
+
+    // Sample values match the nearest cell lookup
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 5; c++) {
+            const QGeoCoordinate coordinate = _cellCenter(r, c);
+            QCOMPARE(tile.bilinearElevations({ coordinate }).first(), tile.elevation(coordinate));
+        }
+    }
+}
+
+void TerrainTileTest::_benchmarkBilinearElevations_data()
+{
+    QTest::addColumn<int>("path");
+
+    QTest::newRow("elevation()") << static_cast<int>(ElevationPath);
+    QTest::newRow("bilinear coordinates") << static_cast<int>(BilinearCoordinatesPath);
+    QTest::newRow("bilinear arrays") << static_cast<int>(BilinearArraysPath);
+}
+
+/// Nanoseconds per point for the per coordinate elevation() lookup and the two bilinear batch lookups
+void TerrainTileTest::_benchmarkBilinearElevations()
+{
+    UT_BENCHMARK_ONLY();
+
+    QFETCH(int, path);
+
+    // A Copernicus tile is .01 degrees at one arc second spacing
+    static constexpr int gridSize = 36;
+    static constexpr int pointCount = 100000;
+
+    const TerrainTile tile(_slopedTile(gridSize, gridSize, TerrainTileCopernicus::tileValueSpacingDegrees));
+    QVERIFY(tile.isValid());
+
+    QList<double> latitudes(pointCount);
+    QList<double> longitudes(pointCount);
+    QList<QGeoCoordinate> coordinates(pointCount);
+    for (int i = 0; i < pointCount; i++) {
+        latitudes[i] = TerrainTileCopernicus::tileSizeDegrees * (i % 997) / 997.0;
+        longitudes[i] = TerrainTileCopernicus::tileSizeDegrees * (i % 991) / 991.0;
+        coordinates[i] = QGeoCoordinate(latitudes[i], longitudes[i]);
+    }
+
+    QList<double> elevations(pointCount);
+    QElapsedTimer timer;
+    timer.start();
+    switch (path) {
+    case ElevationPath:
+        for (int i = 0; i < pointCount; i++) {
+            elevations[i] = tile.elevation(coordinates[i]);
+        }
+        break;
+    case BilinearCoordinatesPath:
+        elevations = tile.bilinearElevations(coordinates);
+        break;
+    case BilinearArraysPath:
+        tile.bilinearElevations(latitudes.constData(), longitudes.constData(), elevations.data(), pointCount);
+        break;
+    }
+    const qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    QCOMPARE(elevations.count(), pointCount);
+    QVERIFY(std::none_of(elevations.constBegin(), elevations.constEnd(), [](double elevation) { return qIsNaN(elevation); }));
+    QTest::setBenchmarkResult(static_cast<qreal>(elapsedNSecs) / pointCount, QTest::WalltimeNanoseconds);
+}
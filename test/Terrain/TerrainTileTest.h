@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2024 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TerrainTileTest() = default;
+
+private slots:
+    void _testElevation();
+    void _testBilinearElevations();
+    void _benchmarkBilinearElevations_data();
+    void _benchmarkBilinearElevations();
+
+private:
+    enum ElevationBenchmarkPath {
+        ElevationPath,
+        BilinearCoordinatesPath,
+        BilinearArraysPath,
+    };
+};
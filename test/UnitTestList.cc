@@ -29,11 +29,17 @@
 // #include "RadioConfigTest.h"
 
 // Comms
+#include "MAVLinkProtocolTest.h"
 #include "QGCSerialPortInfoTest.h"
+#include "TelemetryLogWriterTest.h"
+#include "UDPLinkTest.h"
 
 // FactSystem
+#include "FactGroupUpdateSchedulerTest.h"
 #include "FactSystemTestGeneric.h"
 #include "FactSystemTestPX4.h"
+#include "FactValueTest.h"
+#include "ParameterCacheFileTest.h"
 #include "ParameterManagerTest.h"
 
 // FollowMe
@@ -46,6 +52,7 @@
 #include "GpsTest.h"
 
 // MAVLink
+#include "MAVLinkFrameParserTest.h"
 #include "StatusTextHandlerTest.h"
 #include "SigningTest.h"
 
@@ -82,8 +89,14 @@
 
 // QmlControls
 
+// QtLocationPlugin
+#include "QGCTileCacheWorkerTest.h"
+
 // Terrain
 #include "TerrainQueryTest.h"
+#include "TerrainTileCacheTest.h"
+#include "TerrainTileManagerTest.h"
+#include "TerrainTileTest.h"
 
 // UI
 
@@ -131,11 +144,17 @@ int runTests(bool stress, QStringView unitTestOptions)
     // UT_REGISTER_TEST(RadioConfigTest)
 
     // Comms
+    UT_REGISTER_TEST(MAVLinkProtocolTest)
     UT_REGISTER_TEST(QGCSerialPortInfoTest)
+    UT_REGISTER_TEST(TelemetryLogWriterTest)
+    UT_REGISTER_TEST(UDPLinkTest)
 
     // FactSystem
+    UT_REGISTER_TEST(FactGroupUpdateSchedulerTest)
     UT_REGISTER_TEST(FactSystemTestGeneric)
     UT_REGISTER_TEST(FactSystemTestPX4)
+    UT_REGISTER_TEST(FactValueTest)
+    UT_REGISTER_TEST(ParameterCacheFileTest)
     UT_REGISTER_TEST(ParameterManagerTest)
 
     // FollowMe
@@ -148,6 +167,7 @@ int runTests(bool stress, QStringView unitTestOptions)
     // UT_REGISTER_TEST(GpsTest)
 
     // MAVLink
+    UT_REGISTER_TEST(MAVLinkFrameParserTest)
     UT_REGISTER_TEST(StatusTextHandlerTest)
     UT_REGISTER_TEST(SigningTest)
 
@@ -182,8 +202,14 @@ int runTests(bool stress, QStringView unitTestOptions)
 
     // QmlControls
 
+    // QtLocationPlugin
+    UT_REGISTER_TEST(QGCTileCacheWorkerTest)
+
     // Terrain
     UT_REGISTER_TEST(TerrainQueryTest)
+    UT_REGISTER_TEST(TerrainTileCacheTest)
+    UT_REGISTER_TEST(TerrainTileManagerTest)
+    UT_REGISTER_TEST(TerrainTileTest)
 
     // UI
 
@@ -20,6 +20,14 @@
 #define UT_REGISTER_TEST(className)             static UnitTestWrapper<className> className(#className, false);
 #define UT_REGISTER_TEST_STANDALONE(className)  static UnitTestWrapper<className> className(#className, true);  // Test will only be run with specifically called to from command line
 
+// Benchmarks only measure, so they are skipped unless QGC_UNITTEST_BENCHMARKS is set (see the benchmark target)
+#define UT_BENCHMARK_ONLY() \
+    do { \
+        if (!UnitTest::benchmarksEnabled()) { \
+            QSKIP("Benchmark, set QGC_UNITTEST_BENCHMARKS=1 to run"); \
+        } \
+    } while (false)
+
 class QGCMessageBox;
 class QGCQFileDialog;
 class LinkManager;
@@ -95,6 +103,9 @@ public:
     /// Does not check altitude.
     static bool fuzzyCompareLatLon(const QGeoCoordinate& coord1, const QGeoCoordinate& coord2);
 
+    /// @return true: Benchmark test functions should run, see UT_BENCHMARK_ONLY
+    static bool benchmarksEnabled(void);
+
 protected slots:
 
     // These are all pure virtuals to force the derived class to implement each one and in turn